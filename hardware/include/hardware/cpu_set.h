@@ -0,0 +1,237 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------
+Description : set of logical CPUs (dynamic bitset, for CPU affinity with any number of CPUs)
+Classes : CpuSet
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <iterator>
+#include <initializer_list>
+#include <thread>
+
+namespace pandora {
+  namespace hardware {
+    /// @class CpuSet
+    /// @brief Set of logical CPUs, identified by their OS index (bit N set: CPU N included) - no limit on the number of CPUs.
+    /// @description Used to set the CPU affinity of processes/threads (see 'hardware/process_affinity.h'),
+    ///              or to describe parts of the CPU topology (see 'CpuTopology::nodeCpus/physicalCoreCpus').
+    ///              Supports iteration on CPU indexes (ascending order) and set algebra (union, intersection, difference).
+    /// @remarks The storage is sized from the number of CPUs detected on the system, and grows if needed (for higher CPU indexes).
+    class CpuSet final {
+    public:
+      using word_type = uint64_t;
+      static constexpr uint32_t wordBits = 64u;
+
+      /// @brief Create empty set (storage sized for all CPUs of current system)
+      CpuSet() : _words(_wordCount(_systemCpuCount())) {}
+      /// @brief Create set containing a list of CPU indexes
+      CpuSet(std::initializer_list<uint32_t> cpuIndexes) : CpuSet() {
+        for (auto index : cpuIndexes)
+          set(index);
+      }
+      /// @brief Create set from legacy affinity bitmask (bit 0-63: CPU 0-63)
+      static inline CpuSet fromBitmask(uint64_t cpuBitmask) {
+        CpuSet cpus;
+        cpus._words[0] = cpuBitmask;
+        return cpus;
+      }
+      /// @brief Create set with all CPUs from 0 to cpuCount-1 (default: all CPUs detected on current system)
+      static inline CpuSet all(uint32_t cpuCount = 0) {
+        if (cpuCount == 0)
+          cpuCount = _systemCpuCount();
+        CpuSet cpus;
+        cpus._resize(cpuCount);
+        for (uint32_t i = 0; i < cpuCount / wordBits; ++i)
+          cpus._words[i] = ~word_type{ 0 };
+        if (cpuCount % wordBits)
+          cpus._words[cpuCount / wordBits] = (word_type{ 1u } << (cpuCount % wordBits)) - 1u;
+        return cpus;
+      }
+
+      CpuSet(const CpuSet&) = default;
+      CpuSet(CpuSet&&) noexcept = default;
+      CpuSet& operator=(const CpuSet&) = default;
+      CpuSet& operator=(CpuSet&&) noexcept = default;
+
+      // -- accessors --
+
+      /// @brief Verify if a CPU is included in the set
+      inline bool test(uint32_t cpuIndex) const noexcept {
+        return (cpuIndex / wordBits < this->_words.size() && (this->_words[cpuIndex / wordBits] & _bit(cpuIndex)) != 0);
+      }
+      /// @brief Get number of CPUs included in the set
+      uint32_t count() const noexcept {
+        uint32_t total = 0;
+        for (auto word : this->_words) {
+          for (; word != 0; word &= (word - 1u)) // clear lowest bit
+            ++total;
+        }
+        return total;
+      }
+      /// @brief Verify if the set contains no CPU
+      inline bool empty() const noexcept {
+        for (auto word : this->_words)
+          if (word != 0)
+            return false;
+        return true;
+      }
+      /// @brief Get number of CPU indexes that can be stored without growing (multiple of 64)
+      inline uint32_t capacity() const noexcept { return static_cast<uint32_t>(this->_words.size()) * wordBits; }
+      /// @brief Get index of first CPU of the set (or capacity() if empty)
+      inline uint32_t first() const noexcept { return next(0); }
+      /// @brief Get index of first CPU of the set, starting at 'cpuIndex' (or capacity() if none)
+      uint32_t next(uint32_t cpuIndex) const noexcept {
+        for (size_t w = cpuIndex / wordBits; w < this->_words.size(); ++w) {
+          word_type word = this->_words[w];
+          if (w == cpuIndex / wordBits)
+            word &= ~(_bit(cpuIndex) - 1u); // ignore lower indexes
+          if (word != 0)
+            return static_cast<uint32_t>(w) * wordBits + _lowestBitIndex(word);
+        }
+        return capacity();
+      }
+
+      /// @brief Get raw storage: bit N of word N/64 represents CPU N
+      inline const std::vector<word_type>& words() const noexcept { return this->_words; }
+      /// @brief Convert to legacy affinity bitmask (bit 0-31: CPU 0-31) - CPUs with higher indexes are ignored
+      inline int32_t toBitmask32() const noexcept { return (!this->_words.empty()) ? static_cast<int32_t>(this->_words[0] & 0xFFFFFFFFu) : 0; }
+
+      // -- modifiers --
+
+      /// @brief Add a CPU to the set
+      inline CpuSet& set(uint32_t cpuIndex) {
+        if (cpuIndex >= capacity())
+          _resize(cpuIndex + 1u);
+        this->_words[cpuIndex / wordBits] |= _bit(cpuIndex);
+        return *this;
+      }
+      /// @brief Remove a CPU from the set
+      inline CpuSet& reset(uint32_t cpuIndex) noexcept {
+        if (cpuIndex < capacity())
+          this->_words[cpuIndex / wordBits] &= ~_bit(cpuIndex);
+        return *this;
+      }
+      /// @brief Remove all CPUs from the set
+      inline void clear() noexcept {
+        for (auto& word : this->_words)
+          word = 0;
+      }
+
+      // -- set algebra --
+
+      /// @brief Union: add all CPUs of another set
+      CpuSet& operator|=(const CpuSet& rhs) {
+        if (rhs._words.size() > this->_words.size())
+          this->_words.resize(rhs._words.size(), 0);
+        for (size_t i = 0; i < rhs._words.size(); ++i)
+          this->_words[i] |= rhs._words[i];
+        return *this;
+      }
+      /// @brief Intersection: only keep CPUs also included in another set
+      CpuSet& operator&=(const CpuSet& rhs) noexcept {
+        for (size_t i = 0; i < this->_words.size(); ++i)
+          this->_words[i] &= (i < rhs._words.size()) ? rhs._words[i] : 0;
+        return *this;
+      }
+      /// @brief Difference: remove all CPUs included in another set
+      CpuSet& operator-=(const CpuSet& rhs) noexcept {
+        for (size_t i = 0; i < this->_words.size() && i < rhs._words.size(); ++i)
+          this->_words[i] &= ~(rhs._words[i]);
+        return *this;
+      }
+      inline CpuSet operator|(const CpuSet& rhs) const { CpuSet result(*this); result |= rhs; return result; }
+      inline CpuSet operator&(const CpuSet& rhs) const { CpuSet result(*this); result &= rhs; return result; }
+      inline CpuSet operator-(const CpuSet& rhs) const { CpuSet result(*this); result -= rhs; return result; }
+
+      /// @brief Verify if the set and another set have at least one CPU in common
+      bool intersects(const CpuSet& rhs) const noexcept {
+        for (size_t i = 0; i < this->_words.size() && i < rhs._words.size(); ++i)
+          if (this->_words[i] & rhs._words[i])
+            return true;
+        return false;
+      }
+      /// @brief Verify if all CPUs of the set are included in another set
+      bool isSubsetOf(const CpuSet& rhs) const noexcept {
+        for (size_t i = 0; i < this->_words.size(); ++i)
+          if (this->_words[i] & ~((i < rhs._words.size()) ? rhs._words[i] : 0))
+            return false;
+        return true;
+      }
+
+      /// @brief Compare CPUs included in sets (capacity ignored)
+      inline bool operator==(const CpuSet& rhs) const noexcept { return (isSubsetOf(rhs) && rhs.isSubsetOf(*this)); }
+      inline bool operator!=(const CpuSet& rhs) const noexcept { return !(*this == rhs); }
+
+      // -- iteration --
+
+      /// @class CpuSet::Iterator
+      /// @brief Forward iterator on the indexes of the CPUs of a set (ascending order)
+      class Iterator final {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = uint32_t;
+        using difference_type = ptrdiff_t;
+        using pointer = const uint32_t*;
+        using reference = const uint32_t&;
+
+        Iterator(const CpuSet& cpus, uint32_t cpuIndex) noexcept : _cpus(&cpus), _index(cpuIndex) {}
+        Iterator(const Iterator&) = default;
+        Iterator& operator=(const Iterator&) = default;
+
+        inline reference operator*() const noexcept { return this->_index; }
+        inline pointer operator->() const noexcept { return &(this->_index); }
+        inline Iterator& operator++() noexcept { this->_index = this->_cpus->next(this->_index + 1u); return *this; }
+        inline Iterator operator++(int) noexcept { Iterator copy(*this); ++(*this); return copy; }
+        inline bool operator==(const Iterator& rhs) const noexcept { return (this->_index == rhs._index); }
+        inline bool operator!=(const Iterator& rhs) const noexcept { return (this->_index != rhs._index); }
+
+      private:
+        const CpuSet* _cpus;
+        uint32_t _index;
+      };
+
+      inline Iterator begin() const noexcept { return Iterator(*this, first()); }
+      inline Iterator end() const noexcept { return Iterator(*this, capacity()); }
+
+    private:
+      static inline word_type _bit(uint32_t cpuIndex) noexcept { return (word_type{ 1u } << (cpuIndex % wordBits)); }
+      static inline size_t _wordCount(uint32_t cpuCount) noexcept { return (cpuCount > 0) ? (cpuCount + wordBits - 1u) / wordBits : 1u; }
+      static inline uint32_t _systemCpuCount() noexcept { return static_cast<uint32_t>(std::thread::hardware_concurrency()); }
+      static inline uint32_t _lowestBitIndex(word_type word) noexcept {
+        uint32_t index = 0;
+        for (; (word & 0xFFu) == 0; word >>= 8)
+          index += 8u;
+        for (; (word & 0x1u) == 0; word >>= 1)
+          ++index;
+        return index;
+      }
+      inline void _resize(uint32_t cpuCount) {
+        size_t wordCount = _wordCount(cpuCount);
+        if (wordCount > this->_words.size())
+          this->_words.resize(wordCount, 0);
+      }
+
+    private:
+      std::vector<word_type> _words; // only empty after move
+    };
+  }
+}
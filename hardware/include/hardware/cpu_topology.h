@@ -0,0 +1,94 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------
+Description : CPU topology (logical CPUs, physical cores, SMT siblings, memory nodes)
+Classes : LogicalCpu, CpuTopology
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "./cpu_set.h"
+
+namespace pandora {
+  namespace hardware {
+    /// @brief Location of a logical CPU in the system topology
+    struct LogicalCpu final {
+      uint32_t index = 0;        ///< OS index of the logical CPU (used for affinity)
+      uint32_t package = 0;      ///< Physical package (socket)
+      uint32_t core = 0;         ///< Physical core (unique index in the whole system)
+      uint32_t node = 0;         ///< Memory node (NUMA node: 0 to nodeCount-1)
+      bool isSmtSibling = false; ///< Additional hardware thread of a physical core (false for the first logical CPU of each core)
+    };
+
+    /// @class CpuTopology
+    /// @brief CPU topology reader: logical CPUs, physical cores and memory nodes (NUMA).
+    /// @remarks Detected with sysfs on linux/android, and with processor information on Windows.
+    ///          On other systems (or if detection fails), each logical CPU is considered as a physical core of node 0.
+    class CpuTopology final {
+    public:
+      /// @brief Detect topology of current system
+      CpuTopology();
+      /// @brief Use custom topology (each 'core' index should be unique in the system, 'node' indexes should be contiguous)
+      explicit CpuTopology(std::vector<LogicalCpu>&& cpus);
+      CpuTopology(const CpuTopology&) = default;
+      CpuTopology(CpuTopology&&) noexcept = default;
+      CpuTopology& operator=(const CpuTopology&) = default;
+      CpuTopology& operator=(CpuTopology&&) noexcept = default;
+
+      // -- getters --
+
+      inline const std::vector<LogicalCpu>& cpus() const noexcept { return this->_cpus; } ///< All logical CPUs (sorted by OS index)
+      inline uint32_t logicalCores() const noexcept { return static_cast<uint32_t>(this->_cpus.size()); }
+      inline uint32_t physicalCores() const noexcept { return this->_physicalCores; }
+      inline uint32_t nodeCount() const noexcept { return this->_nodeCount; } ///< Number of memory nodes (NUMA nodes)
+      inline bool isHyperThreadingCapable() const noexcept { return (logicalCores() > this->_physicalCores); }
+
+      // -- CPU sets (for affinity) --
+
+      /// @brief Get set of all logical CPUs
+      CpuSet allCpus() const;
+      /// @brief Get set of all logical CPUs of a memory node (NUMA node)
+      CpuSet nodeCpus(uint32_t node) const;
+      /// @brief Get set of all logical CPUs of a physical package (socket)
+      CpuSet packageCpus(uint32_t package) const;
+      /// @brief Get set with one logical CPU per physical core (first hardware thread of each core: no SMT sibling)
+      /// @remarks Combine with other sets to restrict it: 'topology.nodeCpus(k) & topology.physicalCoreCpus()'.
+      CpuSet physicalCoreCpus() const;
+
+      // -- placement --
+
+      /// @brief Get logical CPUs of a memory node, in placement order: one logical CPU per physical core first, then SMT siblings
+      std::vector<LogicalCpu> placementOrder(uint32_t node) const;
+      /// @brief Choose a logical CPU for each thread of a pool (threads distributed round-robin between nodes).
+      /// @description Threads are placed on distinct physical cores first (all nodes), then on SMT siblings.
+      ///              Nodes without free CPU are skipped: small nodes are never oversubscribed while other nodes have free CPUs.
+      ///              CPUs are only reused when all logical CPUs are taken (in the same order).
+      std::vector<LogicalCpu> threadPlacement(size_t threadCount) const;
+
+    private:
+      void _computeCounters() noexcept;
+
+    private:
+      std::vector<LogicalCpu> _cpus;
+      uint32_t _physicalCores = 0;
+      uint32_t _nodeCount = 0;
+    };
+  }
+}
@@ -18,12 +18,13 @@ IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 ------------------------------------------------------------------------
 Description : set process/thread affinity with CPU
 Functions : getCurrentProcessAffinity, setCurrentProcessAffinity,
-            setCurrentThreadAffinity, setThreadAffinity
+            getCurrentThreadAffinity, setCurrentThreadAffinity, setThreadAffinity
 *******************************************************************************/
 #pragma once
 
 #include <cstdint>
 #include <thread>
+#include "./cpu_set.h"
 
 namespace pandora { 
   namespace hardware {
@@ -37,6 +38,16 @@ namespace pandora {
     /// @warning Not supported on Apple systems.
     ///          May require privileges on linux/unix systems.
     bool setCurrentProcessAffinity(int32_t cpuCoresBitmask) noexcept;
+
+    /// @brief Get set of logical CPUs the current process is allowed to run on (any number of CPUs).
+    /// @warning Requires privileges on Apple systems.
+    ///          Windows: only CPUs of the first processor group (0-63).
+    bool getCurrentProcessAffinity(CpuSet& outCpus);
+    /// @brief Set processor affinity of current process with a set of logical CPUs (any number of CPUs).
+    /// @warning Not supported on Apple systems.
+    ///          May require privileges on linux/unix systems.
+    ///          Windows: only CPUs of the first processor group (0-63).
+    bool setCurrentProcessAffinity(const CpuSet& cpus) noexcept;
     
     // -- thread affinity --
     
@@ -49,5 +60,20 @@ namespace pandora {
     /// @warning The thread affinity mask should only be a subset of the current process affinity mask.
     ///          Not supported on Android systems.
     bool setThreadAffinity(std::thread& thread, int32_t cpuCoresBitmask) noexcept;
+
+    /// @brief Get set of logical CPUs the current thread is allowed to run on (any number of CPUs).
+    /// @warning Not supported on Android and Apple systems.
+    ///          Windows: only CPUs of the processor group of the thread.
+    bool getCurrentThreadAffinity(CpuSet& outCpus);
+    /// @brief Set processor affinity of current thread with a set of logical CPUs (any number of CPUs).
+    /// @warning The thread affinity set should only be a subset of the current process affinity set.
+    ///          Not supported on Android systems.
+    ///          Windows: all CPUs must belong to the same processor group (64 CPUs per group).
+    bool setCurrentThreadAffinity(const CpuSet& cpus) noexcept;
+    /// @brief Set processor affinity of a specific thread with a set of logical CPUs (any number of CPUs).
+    /// @warning The thread affinity set should only be a subset of the current process affinity set.
+    ///          Not supported on Android systems.
+    ///          Windows: all CPUs must belong to the same processor group (64 CPUs per group).
+    bool setThreadAffinity(std::thread& thread, const CpuSet& cpus) noexcept;
   }
 }
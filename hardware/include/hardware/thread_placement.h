@@ -0,0 +1,66 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+------------------------------------------------------------------------
+Description : topology-aware placement of thread pool workers (for 'thread/numa_thread_pool.h')
+Functions : toWorkerPlacement, setWorkerAffinity
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <thread/numa_thread_pool.h>
+#include "./cpu_topology.h"
+#include "./cpu_set.h"
+#include "./process_affinity.h"
+
+namespace pandora {
+  namespace hardware {
+    /// @brief Compute the placement of each worker of a NumaThreadPool, based on CPU topology:
+    ///        workers distributed between memory nodes, each one pinned to a logical CPU (physical cores first, then SMT siblings).
+    /// @param isPinned  Set a CPU affinity for each worker (false: only assign memory nodes)
+    /// @remarks The logical CPU of each worker is stored in 'cpus' (any index), and in 'cpuMask' if its index is lower than 32:
+    ///          use 'setWorkerAffinity' to pin workers on systems with more than 32 CPUs ('setThreadAffinity' only uses 'cpuMask').
+    /// @example NumaThreadPool<Job> pool(toWorkerPlacement(CpuTopology{}, 8), &processJob, &setWorkerAffinity);
+    inline std::vector<pandora::thread::WorkerPlacement> toWorkerPlacement(const CpuTopology& topology, size_t threadCount, bool isPinned = true) {
+      std::vector<LogicalCpu> cpus = topology.threadPlacement(threadCount);
+      std::vector<pandora::thread::WorkerPlacement> placements(cpus.size());
+      for (size_t i = 0; i < cpus.size(); ++i) {
+        placements[i].node = cpus[i].node;
+        if (isPinned) {
+          placements[i].cpuMask = (cpus[i].index < 32u) ? static_cast<int32_t>(1u << cpus[i].index) : 0;
+          placements[i].cpus.emplace_back(cpus[i].index);
+        }
+      }
+      return placements;
+    }
+
+    /// @brief Pin a worker thread of a NumaThreadPool to the CPUs of its placement ('cpus' + 'cpuMask'), without limit on CPU indexes
+    /// @remarks Compatible with NumaThreadPool constructor (WorkerAffinitySetter).
+    inline bool setWorkerAffinity(std::thread& thread, const pandora::thread::WorkerPlacement& placement) noexcept {
+      try {
+        CpuSet cpus = CpuSet::fromBitmask(static_cast<uint32_t>(placement.cpuMask));
+        for (auto cpu : placement.cpus)
+          cpus.set(cpu);
+        return (!cpus.empty() && setThreadAffinity(thread, cpus));
+      }
+      catch (...) { return false; } // allocation failure
+    }
+  }
+}
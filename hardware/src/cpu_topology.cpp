@@ -0,0 +1,331 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <map>
+#include <utility>
+#include <algorithm>
+#include <thread>
+
+#include <system/operating_system.h>
+#ifdef _WINDOWS
+# include <system/api/windows_api.h>
+#elif _SYSTEM_OPERATING_SYSTEM == _SYSTEM_OS_LINUX || _SYSTEM_OPERATING_SYSTEM == _SYSTEM_OS_ANDROID
+# define __P_USE_SYSFS_TOPOLOGY
+#endif
+
+#include "hardware/cpu_topology.h"
+
+using namespace pandora::hardware;
+
+
+// -- topology detection --
+
+// Default topology: each logical CPU considered as a physical core of node 0
+static void _fillDefaultTopology(std::vector<LogicalCpu>& outCpus) {
+  uint32_t cpuCount = std::thread::hardware_concurrency();
+  if (cpuCount == 0)
+    cpuCount = 1u;
+  outCpus.resize(cpuCount);
+  for (uint32_t i = 0; i < cpuCount; ++i) {
+    outCpus[i].index = i;
+    outCpus[i].core = i;
+  }
+}
+
+#if defined(__P_USE_SYSFS_TOPOLOGY)
+  // Read first line of a sysfs file
+  static bool _readSysfsLine(const char* path, char* buffer, size_t bufferSize) noexcept {
+    FILE* file = fopen(path, "r");
+    if (file == nullptr)
+      return false;
+    bool isRead = (fgets(buffer, static_cast<int>(bufferSize), file) != nullptr);
+    fclose(file);
+    return isRead;
+  }
+  // Read integer value in a sysfs file
+  static bool _readSysfsValue(const char* path, uint32_t& outValue) noexcept {
+    char buffer[32];
+    if (!_readSysfsLine(path, buffer, sizeof(buffer)))
+      return false;
+    unsigned long value = 0;
+    if (sscanf(buffer, "%lu", &value) != 1)
+      return false;
+    outValue = static_cast<uint32_t>(value);
+    return true;
+  }
+  // Read list of indexes in a sysfs file (format: "0-3,8,10-11")
+  static bool _readSysfsList(const char* path, std::vector<uint32_t>& outList) {
+    char buffer[1024];
+    if (!_readSysfsLine(path, buffer, sizeof(buffer)))
+      return false;
+
+    const char* it = buffer;
+    while (*it >= '0' && *it <= '9') {
+      char* end = nullptr;
+      uint32_t first = static_cast<uint32_t>(strtoul(it, &end, 10));
+      uint32_t last = first;
+      it = end;
+      if (*it == '-') {
+        last = static_cast<uint32_t>(strtoul(it + 1, &end, 10));
+        it = end;
+      }
+      for (uint32_t index = first; index <= last; ++index)
+        outList.emplace_back(index);
+      if (*it == ',')
+        ++it;
+    }
+    return !outList.empty();
+  }
+
+  // Read topology with sysfs
+  static bool _readTopology(std::vector<LogicalCpu>& outCpus) {
+    std::vector<uint32_t> cpuIndexes;
+    if (!_readSysfsList("/sys/devices/system/cpu/online", cpuIndexes))
+      return false;
+
+    char path[128];
+    std::map<std::pair<uint32_t,uint32_t>, uint32_t> physicalCores; // (package, core ID) -> unique core index
+    outCpus.reserve(cpuIndexes.size());
+    for (auto cpuIndex : cpuIndexes) {
+      LogicalCpu cpu;
+      cpu.index = cpuIndex;
+      uint32_t coreId = cpuIndex;
+      snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/physical_package_id", cpuIndex);
+      _readSysfsValue(path, cpu.package);
+      snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/core_id", cpuIndex);
+      _readSysfsValue(path, coreId);
+
+      auto existing = physicalCores.find(std::make_pair(cpu.package, coreId));
+      if (existing != physicalCores.end()) {
+        cpu.core = existing->second;
+        cpu.isSmtSibling = true;
+      }
+      else {
+        cpu.core = static_cast<uint32_t>(physicalCores.size());
+        physicalCores[std::make_pair(cpu.package, coreId)] = cpu.core;
+      }
+      outCpus.emplace_back(cpu);
+    }
+
+    // memory nodes (sparse OS indexes -> contiguous indexes)
+    std::vector<uint32_t> nodeIndexes;
+    if (_readSysfsList("/sys/devices/system/node/online", nodeIndexes)) {
+      uint32_t node = 0;
+      for (auto nodeIndex : nodeIndexes) {
+        std::vector<uint32_t> nodeCpus;
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist", nodeIndex);
+        if (!_readSysfsList(path, nodeCpus)) // memory-only node
+          continue;
+        for (auto& cpu : outCpus) {
+          if (std::find(nodeCpus.begin(), nodeCpus.end(), cpu.index) != nodeCpus.end())
+            cpu.node = node;
+        }
+        ++node;
+      }
+    }
+    return true;
+  }
+
+#elif defined(_WINDOWS)
+  // Read topology with processor information
+  static bool _readTopology(std::vector<LogicalCpu>& outCpus) {
+    DWORD bufferSize = 0;
+    GetLogicalProcessorInformation(nullptr, &bufferSize);
+    if (bufferSize == 0)
+      return false;
+    std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> infos(bufferSize / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION) + 1u);
+    if (GetLogicalProcessorInformation(infos.data(), &bufferSize) == FALSE)
+      return false;
+    infos.resize(bufferSize / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+
+    const uint32_t maxCpus = static_cast<uint32_t>(sizeof(ULONG_PTR) * 8u);
+    std::vector<bool> isCpuFound(maxCpus, false);
+    std::vector<LogicalCpu> cpus(maxCpus);
+    uint32_t core = 0, package = 0;
+    for (const auto& info : infos) {
+      if (info.Relationship == RelationProcessorCore) {
+        bool isFirstThread = true;
+        for (uint32_t i = 0; i < maxCpus; ++i) {
+          if (info.ProcessorMask & (static_cast<ULONG_PTR>(1u) << i)) {
+            isCpuFound[i] = true;
+            cpus[i].index = i;
+            cpus[i].core = core;
+            cpus[i].isSmtSibling = !isFirstThread;
+            isFirstThread = false;
+          }
+        }
+        ++core;
+      }
+    }
+    std::vector<uint32_t> nodeIds; // OS node numbers -> contiguous indexes
+    for (const auto& info : infos) {
+      if (info.Relationship == RelationNumaNode) {
+        auto it = std::find(nodeIds.begin(), nodeIds.end(), static_cast<uint32_t>(info.NumaNode.NodeNumber));
+        uint32_t node = static_cast<uint32_t>(it - nodeIds.begin());
+        if (it == nodeIds.end())
+          nodeIds.emplace_back(static_cast<uint32_t>(info.NumaNode.NodeNumber));
+        for (uint32_t i = 0; i < maxCpus; ++i)
+          if (info.ProcessorMask & (static_cast<ULONG_PTR>(1u) << i))
+            cpus[i].node = node;
+      }
+      else if (info.Relationship == RelationProcessorPackage) {
+        for (uint32_t i = 0; i < maxCpus; ++i)
+          if (info.ProcessorMask & (static_cast<ULONG_PTR>(1u) << i))
+            cpus[i].package = package;
+        ++package;
+      }
+    }
+
+    for (uint32_t i = 0; i < maxCpus; ++i)
+      if (isCpuFound[i])
+        outCpus.emplace_back(cpus[i]);
+    return !outCpus.empty();
+  }
+
+#else
+  static inline bool _readTopology(std::vector<LogicalCpu>&) { return false; }
+#endif
+
+
+// -- CpuTopology --
+
+CpuTopology::CpuTopology() {
+  if (!_readTopology(this->_cpus)) {
+    this->_cpus.clear();
+    _fillDefaultTopology(this->_cpus);
+  }
+  _computeCounters();
+}
+
+CpuTopology::CpuTopology(std::vector<LogicalCpu>&& cpus)
+  : _cpus(std::move(cpus)) {
+  std::sort(this->_cpus.begin(), this->_cpus.end(), [](const LogicalCpu& lhs, const LogicalCpu& rhs) { return (lhs.index < rhs.index); });
+  _computeCounters();
+}
+
+void CpuTopology::_computeCounters() noexcept {
+  this->_physicalCores = 0;
+  this->_nodeCount = this->_cpus.empty() ? 0 : 1u;
+  for (const auto& cpu : this->_cpus) {
+    if (!cpu.isSmtSibling)
+      ++(this->_physicalCores);
+    if (cpu.node >= this->_nodeCount)
+      this->_nodeCount = cpu.node + 1u;
+  }
+}
+
+// -- CPU sets --
+
+CpuSet CpuTopology::allCpus() const {
+  CpuSet cpus;
+  for (const auto& cpu : this->_cpus)
+    cpus.set(cpu.index);
+  return cpus;
+}
+
+CpuSet CpuTopology::nodeCpus(uint32_t node) const {
+  CpuSet cpus;
+  for (const auto& cpu : this->_cpus) {
+    if (cpu.node == node)
+      cpus.set(cpu.index);
+  }
+  return cpus;
+}
+
+CpuSet CpuTopology::packageCpus(uint32_t package) const {
+  CpuSet cpus;
+  for (const auto& cpu : this->_cpus) {
+    if (cpu.package == package)
+      cpus.set(cpu.index);
+  }
+  return cpus;
+}
+
+CpuSet CpuTopology::physicalCoreCpus() const {
+  CpuSet cpus;
+  for (const auto& cpu : this->_cpus) {
+    if (!cpu.isSmtSibling)
+      cpus.set(cpu.index);
+  }
+  return cpus;
+}
+
+// -- placement --
+
+std::vector<LogicalCpu> CpuTopology::placementOrder(uint32_t node) const {
+  std::vector<LogicalCpu> order;
+  for (const auto& cpu : this->_cpus) { // physical cores first
+    if (cpu.node == node && !cpu.isSmtSibling)
+      order.emplace_back(cpu);
+  }
+  for (const auto& cpu : this->_cpus) { // then SMT siblings
+    if (cpu.node == node && cpu.isSmtSibling)
+      order.emplace_back(cpu);
+  }
+  return order;
+}
+
+std::vector<LogicalCpu> CpuTopology::threadPlacement(size_t threadCount) const {
+  std::vector<std::vector<LogicalCpu> > nodeOrders;
+  std::vector<size_t> physicalCounts;
+  nodeOrders.reserve(this->_nodeCount);
+  physicalCounts.reserve(this->_nodeCount);
+  for (uint32_t node = 0; node < this->_nodeCount; ++node) {
+    std::vector<LogicalCpu> order = placementOrder(node);
+    if (!order.empty()) { // ignore nodes without CPU
+      physicalCounts.emplace_back(static_cast<size_t>(std::count_if(order.begin(), order.end(),
+                                                                    [](const LogicalCpu& cpu) { return !cpu.isSmtSibling; })));
+      nodeOrders.emplace_back(std::move(order));
+    }
+  }
+
+  std::vector<LogicalCpu> placement;
+  if (nodeOrders.empty())
+    return placement;
+  placement.reserve(threadCount);
+
+  // round-robin between nodes with free CPUs: physical cores of all nodes first, then SMT siblings
+  // (each node receives at most its own CPU count: remaining threads spill to larger nodes)
+  std::vector<size_t> positions(nodeOrders.size(), 0);
+  for (int pass = 0; pass < 2; ++pass) {
+    bool isCpuAvailable = true;
+    while (isCpuAvailable && placement.size() < threadCount) {
+      isCpuAvailable = false;
+      for (size_t node = 0; node < nodeOrders.size() && placement.size() < threadCount; ++node) {
+        size_t limit = (pass == 0) ? physicalCounts[node] : nodeOrders[node].size();
+        if (positions[node] < limit) {
+          placement.emplace_back(nodeOrders[node][positions[node]]);
+          ++(positions[node]);
+          isCpuAvailable = true;
+        }
+      }
+    }
+  }
+  // more threads than logical CPUs: reuse CPUs (in the same order)
+  for (size_t i = 0; placement.size() < threadCount; ++i) {
+    LogicalCpu cpu = placement[i];
+    placement.emplace_back(cpu);
+  }
+  return placement;
+}
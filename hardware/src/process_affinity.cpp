@@ -17,6 +17,7 @@ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
 IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 *******************************************************************************/
 #include <cstdint>
+#include <cerrno>
 #include <thread>
 
 #ifdef _WINDOWS
@@ -106,3 +107,201 @@ bool pandora::hardware::setThreadAffinity(std::thread& thread, int32_t cpuCoresB
     return false;
 # endif
 }
+
+
+// -- CPU sets --
+
+#if defined(_WINDOWS)
+  static constexpr uint32_t __P_CPU_GROUP_SIZE = static_cast<uint32_t>(sizeof(KAFFINITY) * 8u);
+
+  // Convert CPU set to affinity mask of a processor group -> returns false if CPUs belong to multiple groups (or if empty)
+  static bool _toGroupAffinity(const CpuSet& cpus, GROUP_AFFINITY& outAffinity) noexcept {
+    ZeroMemory(&outAffinity, sizeof(GROUP_AFFINITY));
+    uint32_t firstCpu = cpus.first();
+    if (firstCpu >= cpus.capacity())
+      return false;
+    uint32_t group = firstCpu / __P_CPU_GROUP_SIZE;
+    for (auto cpu : cpus) {
+      if (cpu / __P_CPU_GROUP_SIZE != group)
+        return false;
+      outAffinity.Mask |= (static_cast<KAFFINITY>(1u) << (cpu % __P_CPU_GROUP_SIZE));
+    }
+    outAffinity.Group = static_cast<WORD>(group);
+    return true;
+  }
+
+#elif defined(__P_USE_POSIX_PTHREAD)
+# if defined(CPU_ALLOC) && !defined(__APPLE__)
+#   define __P_USE_DYNAMIC_CPU_SET
+#   define __P_MAX_CPU_SET_SIZE 0x100000u
+    // Native CPU set with dynamic size (any number of CPUs)
+    class _NativeCpuSet final {
+    public:
+      explicit _NativeCpuSet(uint32_t cpuCount) noexcept
+        : _cpus(CPU_ALLOC(cpuCount)), _size(CPU_ALLOC_SIZE(cpuCount)) {
+        if (this->_cpus != nullptr)
+          CPU_ZERO_S(this->_size, this->_cpus);
+      }
+      explicit _NativeCpuSet(const CpuSet& cpus) noexcept : _NativeCpuSet(cpus.capacity()) {
+        if (this->_cpus != nullptr) {
+          for (auto cpu : cpus)
+            CPU_SET_S(cpu, this->_size, this->_cpus);
+        }
+      }
+      ~_NativeCpuSet() noexcept {
+        if (this->_cpus != nullptr)
+          CPU_FREE(this->_cpus);
+      }
+      _NativeCpuSet(const _NativeCpuSet&) = delete;
+      _NativeCpuSet& operator=(const _NativeCpuSet&) = delete;
+
+      inline bool isValid() const noexcept { return (this->_cpus != nullptr); }
+      inline cpu_set_t* data() noexcept { return this->_cpus; }
+      inline size_t size() const noexcept { return this->_size; }
+
+      void toCpuSet(CpuSet& outCpus) const {
+        outCpus.clear();
+        for (uint32_t cpu = 0; cpu < static_cast<uint32_t>(this->_size * 8u); ++cpu)
+          if (CPU_ISSET_S(cpu, this->_size, this->_cpus))
+            outCpus.set(cpu);
+      }
+
+    private:
+      cpu_set_t* _cpus;
+      size_t _size;
+    };
+
+    // Read affinity with a native CPU set large enough for the kernel mask (size unknown: grow until accepted)
+    // -> reader must return an errno-style code (0 on success, EINVAL if the set is too small)
+    template <typename _Reader>
+    static bool _readNativeCpuSet(CpuSet& outCpus, _Reader reader) {
+      uint32_t cpuCount = (std::thread::hardware_concurrency() > CPU_SETSIZE) ? std::thread::hardware_concurrency() : CPU_SETSIZE;
+      for (; cpuCount <= __P_MAX_CPU_SET_SIZE; cpuCount *= 2u) {
+        _NativeCpuSet nativeCpus(cpuCount);
+        if (!nativeCpus.isValid())
+          return false;
+        int errorCode = reader(nativeCpus);
+        if (errorCode == 0) {
+          nativeCpus.toCpuSet(outCpus);
+          return true;
+        }
+        if (errorCode != EINVAL)
+          return false;
+      }
+      return false;
+    }
+
+# else
+    static constexpr uint32_t __P_STATIC_CPU_SET_SIZE = static_cast<uint32_t>(sizeof(cpu_set_t) * 8u);
+
+    // Convert CPU set to fixed-size native CPU set -> returns false if some CPU indexes are too high
+    static bool _toStaticCpuSet(const CpuSet& cpus, cpu_set_t& outCpus) noexcept {
+      CPU_ZERO(&outCpus);
+      for (auto cpu : cpus) {
+        if (cpu >= __P_STATIC_CPU_SET_SIZE)
+          return false;
+        CPU_SET(static_cast<int>(cpu), &outCpus);
+      }
+      return true;
+    }
+# endif
+#endif
+
+// -- process affinity (CPU set) --
+
+bool pandora::hardware::getCurrentProcessAffinity(CpuSet& outCpus) {
+# if defined(_WINDOWS)
+    DWORD_PTR appAffinityMask = 0u;
+    DWORD_PTR systemAffinityMask = 0u;
+    if (GetProcessAffinityMask(::GetCurrentProcess(), &appAffinityMask, &systemAffinityMask) != 0u) {
+      outCpus = CpuSet::fromBitmask(static_cast<uint64_t>(appAffinityMask));
+      return true;
+    }
+    return false;
+# elif defined(__P_USE_DYNAMIC_CPU_SET)
+    return _readNativeCpuSet(outCpus, [](_NativeCpuSet& cpus) { return (sched_getaffinity(getpid(), cpus.size(), cpus.data()) == 0) ? 0 : errno; });
+# elif defined(__P_USE_POSIX_PTHREAD)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    if (sched_getaffinity(getpid(), sizeof(cpu_set_t), &cpuSet) != 0)
+      return false;
+    outCpus.clear();
+    for (uint32_t cpu = 0; cpu < __P_STATIC_CPU_SET_SIZE; ++cpu)
+      if (CPU_ISSET(static_cast<int>(cpu), &cpuSet))
+        outCpus.set(cpu);
+    return true;
+# else
+    (void)outCpus;
+    return false;
+# endif
+}
+
+bool pandora::hardware::setCurrentProcessAffinity(const CpuSet& cpus) noexcept {
+# if defined(_WINDOWS)
+    GROUP_AFFINITY affinity;
+    if (!_toGroupAffinity(cpus, affinity) || affinity.Group != 0)
+      return false;
+    return (SetProcessAffinityMask(::GetCurrentProcess(), static_cast<DWORD_PTR>(affinity.Mask)) != 0u);
+# elif defined(__P_USE_DYNAMIC_CPU_SET)
+    _NativeCpuSet nativeCpus(cpus);
+    return (nativeCpus.isValid() && sched_setaffinity(getpid(), nativeCpus.size(), nativeCpus.data()) == 0);
+# elif defined(__P_USE_POSIX_PTHREAD)
+    cpu_set_t cpuSet;
+    return (_toStaticCpuSet(cpus, cpuSet) && sched_setaffinity(getpid(), sizeof(cpu_set_t), &cpuSet) == 0);
+# else
+    (void)cpus;
+    return false;
+# endif
+}
+
+// -- thread affinity (CPU set) --
+
+bool pandora::hardware::getCurrentThreadAffinity(CpuSet& outCpus) {
+# if defined(_WINDOWS)
+    GROUP_AFFINITY affinity;
+    if (GetThreadGroupAffinity(::GetCurrentThread(), &affinity) == FALSE)
+      return false;
+    outCpus.clear();
+    for (uint32_t bit = 0; bit < __P_CPU_GROUP_SIZE; ++bit)
+      if (affinity.Mask & (static_cast<KAFFINITY>(1u) << bit))
+        outCpus.set(static_cast<uint32_t>(affinity.Group) * __P_CPU_GROUP_SIZE + bit);
+    return true;
+# elif defined(__P_USE_DYNAMIC_CPU_SET) && !defined(__ANDROID__)
+    return _readNativeCpuSet(outCpus, [](_NativeCpuSet& cpus) { return pthread_getaffinity_np(pthread_self(), cpus.size(), cpus.data()); }); // returns error code (errno not set)
+# else
+    (void)outCpus;
+    return false;
+# endif
+}
+
+bool pandora::hardware::setCurrentThreadAffinity(const CpuSet& cpus) noexcept {
+# if defined(_WINDOWS)
+    GROUP_AFFINITY affinity;
+    return (_toGroupAffinity(cpus, affinity) && SetThreadGroupAffinity(::GetCurrentThread(), &affinity, nullptr) != FALSE);
+# elif defined(__P_USE_DYNAMIC_CPU_SET)
+    _NativeCpuSet nativeCpus(cpus);
+    return (nativeCpus.isValid() && pthread_setaffinity_np(pthread_self(), nativeCpus.size(), nativeCpus.data()) == 0);
+# elif defined(__P_USE_POSIX_PTHREAD)
+    cpu_set_t cpuSet;
+    return (_toStaticCpuSet(cpus, cpuSet) && pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet) == 0);
+# else
+    (void)cpus;
+    return false;
+# endif
+}
+
+bool pandora::hardware::setThreadAffinity(std::thread& thread, const CpuSet& cpus) noexcept {
+# if defined(_WINDOWS)
+    GROUP_AFFINITY affinity;
+    return (_toGroupAffinity(cpus, affinity) && SetThreadGroupAffinity((HANDLE)thread.native_handle(), &affinity, nullptr) != FALSE);
+# elif defined(__P_USE_DYNAMIC_CPU_SET)
+    _NativeCpuSet nativeCpus(cpus);
+    return (nativeCpus.isValid() && pthread_setaffinity_np((pthread_t)thread.native_handle(), nativeCpus.size(), nativeCpus.data()) == 0);
+# elif defined(__P_USE_POSIX_PTHREAD)
+    cpu_set_t cpuSet;
+    return (_toStaticCpuSet(cpus, cpuSet) && pthread_setaffinity_np((pthread_t)thread.native_handle(), sizeof(cpu_set_t), &cpuSet) == 0);
+# else
+    (void)thread; (void)cpus;
+    return false;
+# endif
+}
@@ -0,0 +1,138 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include <gtest/gtest.h>
+#include <vector>
+#include <thread>
+#include <hardware/cpu_set.h>
+
+using namespace pandora::hardware;
+
+class CpuSetTest : public testing::Test {
+public:
+protected:
+  //static void SetUpTestCase() {}
+  //static void TearDownTestCase() {}
+
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+
+// -- accessors / modifiers --
+
+TEST_F(CpuSetTest, emptySet) {
+  CpuSet cpus;
+  EXPECT_TRUE(cpus.empty());
+  EXPECT_EQ(0u, cpus.count());
+  EXPECT_TRUE(cpus.capacity() >= std::thread::hardware_concurrency());
+  EXPECT_EQ(0u, cpus.capacity() % CpuSet::wordBits);
+  EXPECT_EQ(cpus.capacity(), cpus.first());
+  EXPECT_FALSE(cpus.test(0));
+  EXPECT_FALSE(cpus.test(5000u));
+  EXPECT_EQ(0, cpus.toBitmask32());
+  EXPECT_TRUE(cpus.begin() == cpus.end());
+}
+
+TEST_F(CpuSetTest, setResetCpus) {
+  CpuSet cpus;
+  cpus.set(3u).set(63u).set(64u).set(95u); // more than 32/64 CPUs
+  EXPECT_FALSE(cpus.empty());
+  EXPECT_EQ(4u, cpus.count());
+  EXPECT_TRUE(cpus.test(3u));
+  EXPECT_TRUE(cpus.test(63u));
+  EXPECT_TRUE(cpus.test(64u));
+  EXPECT_TRUE(cpus.test(95u));
+  EXPECT_FALSE(cpus.test(4u));
+  EXPECT_TRUE(cpus.capacity() >= 128u);
+  EXPECT_EQ(0x8, cpus.toBitmask32());
+
+  cpus.set(1000u); // grow
+  EXPECT_TRUE(cpus.capacity() >= 1001u);
+  EXPECT_TRUE(cpus.test(1000u));
+  cpus.reset(63u).reset(2000u);
+  EXPECT_FALSE(cpus.test(63u));
+  EXPECT_EQ(4u, cpus.count());
+
+  std::vector<uint32_t> indexes;
+  for (auto cpu : cpus)
+    indexes.emplace_back(cpu);
+  ASSERT_EQ(size_t{ 4u }, indexes.size());
+  EXPECT_EQ(3u, indexes[0]);
+  EXPECT_EQ(64u, indexes[1]);
+  EXPECT_EQ(95u, indexes[2]);
+  EXPECT_EQ(1000u, indexes[3]);
+  EXPECT_EQ(64u, cpus.next(4u));
+  EXPECT_EQ(cpus.capacity(), cpus.next(1001u));
+
+  cpus.clear();
+  EXPECT_TRUE(cpus.empty());
+}
+
+TEST_F(CpuSetTest, factories) {
+  CpuSet mask = CpuSet::fromBitmask(0x8000000000000005uLL);
+  EXPECT_EQ(3u, mask.count());
+  EXPECT_TRUE(mask.test(0));
+  EXPECT_TRUE(mask.test(2u));
+  EXPECT_TRUE(mask.test(63u));
+
+  CpuSet all = CpuSet::all(96u);
+  EXPECT_EQ(96u, all.count());
+  EXPECT_TRUE(all.test(95u));
+  EXPECT_FALSE(all.test(96u));
+  EXPECT_EQ(64u, CpuSet::all(64u).count());
+  EXPECT_EQ(static_cast<uint32_t>(std::thread::hardware_concurrency()), CpuSet::all().count());
+
+  CpuSet list{ 1u, 70u, 1u };
+  EXPECT_EQ(2u, list.count());
+  EXPECT_TRUE(list.test(70u));
+}
+
+// -- set algebra --
+
+TEST_F(CpuSetTest, setAlgebra) {
+  CpuSet a{ 0u, 1u, 64u, 200u };
+  CpuSet b{ 1u, 2u, 64u };
+
+  CpuSet unionSet = a | b;
+  EXPECT_EQ(5u, unionSet.count());
+  EXPECT_TRUE(unionSet.test(2u));
+  EXPECT_TRUE(unionSet.test(200u));
+  CpuSet intersection = a & b;
+  EXPECT_EQ(2u, intersection.count());
+  EXPECT_TRUE(intersection.test(1u));
+  EXPECT_TRUE(intersection.test(64u));
+  CpuSet difference = a - b;
+  EXPECT_EQ(2u, difference.count());
+  EXPECT_TRUE(difference.test(0u));
+  EXPECT_TRUE(difference.test(200u));
+  EXPECT_EQ(1u, (b - a).count());
+
+  EXPECT_TRUE(a.intersects(b));
+  EXPECT_FALSE(difference.intersects(b));
+  EXPECT_TRUE(intersection.isSubsetOf(a));
+  EXPECT_TRUE(intersection.isSubsetOf(b));
+  EXPECT_FALSE(a.isSubsetOf(b));
+  EXPECT_TRUE(CpuSet{}.isSubsetOf(b));
+
+  EXPECT_TRUE(a == (difference | intersection));
+  EXPECT_TRUE(a != b);
+  CpuSet grown{ 1u };
+  grown.set(5000u).reset(5000u); // different capacity, same CPUs
+  EXPECT_TRUE(grown == CpuSet{ 1u });
+}
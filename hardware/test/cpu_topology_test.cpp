@@ -0,0 +1,167 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include <gtest/gtest.h>
+#include <vector>
+#include <hardware/cpu_topology.h>
+#include <hardware/thread_placement.h>
+
+using namespace pandora::hardware;
+
+class CpuTopologyTest : public testing::Test {
+public:
+protected:
+  //static void SetUpTestCase() {}
+  //static void TearDownTestCase() {}
+
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+// -- helpers --
+
+static LogicalCpu _topologyCpu(uint32_t index, uint32_t core, uint32_t node, bool isSmtSibling) {
+  LogicalCpu cpu;
+  cpu.index = index;
+  cpu.package = node;
+  cpu.core = core;
+  cpu.node = node;
+  cpu.isSmtSibling = isSmtSibling;
+  return cpu;
+}
+// 2 nodes * 2 cores * 2 threads (siblings numbered after all physical cores, as on most linux systems)
+static std::vector<LogicalCpu> _dualNodeTopology() {
+  return std::vector<LogicalCpu>{
+    _topologyCpu(0, 0, 0, false), _topologyCpu(1, 1, 0, false), _topologyCpu(2, 2, 1, false), _topologyCpu(3, 3, 1, false),
+    _topologyCpu(4, 0, 0, true),  _topologyCpu(5, 1, 0, true),  _topologyCpu(6, 2, 1, true),  _topologyCpu(7, 3, 1, true)
+  };
+}
+
+// node 0: 2 cores (no SMT) / node 1: 4 cores * 2 threads
+static std::vector<LogicalCpu> _unevenNodeTopology() {
+  return std::vector<LogicalCpu>{
+    _topologyCpu(0, 0, 0, false), _topologyCpu(1, 1, 0, false),
+    _topologyCpu(2, 2, 1, false), _topologyCpu(3, 3, 1, false), _topologyCpu(4, 4, 1, false), _topologyCpu(5, 5, 1, false),
+    _topologyCpu(6, 2, 1, true),  _topologyCpu(7, 3, 1, true),  _topologyCpu(8, 4, 1, true),  _topologyCpu(9, 5, 1, true)
+  };
+}
+
+
+// -- detection --
+
+TEST_F(CpuTopologyTest, detectedTopology) {
+  CpuTopology topology;
+  EXPECT_TRUE(topology.logicalCores() > 0u);
+  EXPECT_TRUE(topology.physicalCores() > 0u);
+  EXPECT_TRUE(topology.physicalCores() <= topology.logicalCores());
+  EXPECT_TRUE(topology.nodeCount() > 0u);
+  EXPECT_EQ(topology.logicalCores() > topology.physicalCores(), topology.isHyperThreadingCapable());
+  for (const auto& cpu : topology.cpus()) {
+    EXPECT_TRUE(cpu.node < topology.nodeCount());
+    EXPECT_TRUE(cpu.core < topology.physicalCores());
+  }
+
+  auto placement = topology.threadPlacement(topology.logicalCores());
+  EXPECT_EQ(static_cast<size_t>(topology.logicalCores()), placement.size());
+}
+
+TEST_F(CpuTopologyTest, customTopology) {
+  CpuTopology topology(_dualNodeTopology());
+  EXPECT_EQ(8u, topology.logicalCores());
+  EXPECT_EQ(4u, topology.physicalCores());
+  EXPECT_EQ(2u, topology.nodeCount());
+  EXPECT_TRUE(topology.isHyperThreadingCapable());
+
+  CpuTopology emptyTopology(std::vector<LogicalCpu>{});
+  EXPECT_EQ(0u, emptyTopology.logicalCores());
+  EXPECT_EQ(0u, emptyTopology.nodeCount());
+  EXPECT_TRUE(emptyTopology.threadPlacement(4u).empty());
+}
+
+// -- placement --
+
+TEST_F(CpuTopologyTest, placementOrder) {
+  CpuTopology topology(_dualNodeTopology());
+  auto order = topology.placementOrder(1u);
+  ASSERT_EQ(size_t{ 4u }, order.size());
+  EXPECT_EQ(2u, order[0].index); // physical cores first
+  EXPECT_EQ(3u, order[1].index);
+  EXPECT_EQ(6u, order[2].index); // then SMT siblings
+  EXPECT_EQ(7u, order[3].index);
+  EXPECT_TRUE(topology.placementOrder(2u).empty());
+}
+
+TEST_F(CpuTopologyTest, threadPlacement) {
+  CpuTopology topology(_dualNodeTopology());
+  auto placement = topology.threadPlacement(10u);
+  ASSERT_EQ(size_t{ 10u }, placement.size());
+  const uint32_t expectedCpus[] = { 0, 2, 1, 3, 4, 6, 5, 7, 0, 2 }; // nodes alternated, physical cores -> siblings -> reuse
+  for (size_t i = 0; i < placement.size(); ++i) {
+    EXPECT_EQ(expectedCpus[i], placement[i].index);
+    EXPECT_EQ(static_cast<uint32_t>(i % 2u), placement[i].node);
+  }
+
+  auto workers = toWorkerPlacement(topology, 3u);
+  ASSERT_EQ(size_t{ 3u }, workers.size());
+  EXPECT_EQ(0u, workers[0].node);
+  EXPECT_EQ(0x1, workers[0].cpuMask);
+  EXPECT_EQ(1u, workers[1].node);
+  EXPECT_EQ(0x4, workers[1].cpuMask);
+  EXPECT_EQ(0x2, workers[2].cpuMask);
+  ASSERT_EQ(size_t{ 1u }, workers[1].cpus.size());
+  EXPECT_EQ(2u, workers[1].cpus[0]);
+  workers = toWorkerPlacement(topology, 2u, false);
+  EXPECT_EQ(0, workers[0].cpuMask);
+  EXPECT_TRUE(workers[0].cpus.empty());
+  EXPECT_EQ(1u, workers[1].node);
+}
+
+TEST_F(CpuTopologyTest, threadPlacementUnevenNodes) {
+  CpuTopology topology(_unevenNodeTopology());
+  EXPECT_EQ(10u, topology.logicalCores());
+  EXPECT_EQ(2u, topology.nodeCount());
+
+  auto placement = topology.threadPlacement(6u);
+  ASSERT_EQ(size_t{ 6u }, placement.size());
+  const uint32_t expectedCpus[] = { 0, 2, 1, 3, 4, 5 }; // small node full -> other threads on free physical cores of node 1
+  for (size_t i = 0; i < placement.size(); ++i)
+    EXPECT_EQ(expectedCpus[i], placement[i].index);
+
+  placement = topology.threadPlacement(12u);
+  ASSERT_EQ(size_t{ 12u }, placement.size());
+  const uint32_t expectedAllCpus[] = { 0, 2, 1, 3, 4, 5, 6, 7, 8, 9, 0, 2 }; // physical cores -> siblings -> reuse
+  for (size_t i = 0; i < placement.size(); ++i)
+    EXPECT_EQ(expectedAllCpus[i], placement[i].index);
+}
+
+// -- CPU sets --
+
+TEST_F(CpuTopologyTest, topologyCpuSets) {
+  CpuTopology topology(_dualNodeTopology());
+  EXPECT_TRUE(topology.allCpus() == CpuSet::all(8u));
+  EXPECT_TRUE(topology.nodeCpus(0) == (CpuSet{ 0u, 1u, 4u, 5u }));
+  EXPECT_TRUE(topology.nodeCpus(1u) == (CpuSet{ 2u, 3u, 6u, 7u }));
+  EXPECT_TRUE(topology.nodeCpus(2u).empty());
+  EXPECT_TRUE(topology.packageCpus(1u) == topology.nodeCpus(1u));
+  EXPECT_TRUE(topology.physicalCoreCpus() == (CpuSet{ 0u, 1u, 2u, 3u }));
+  EXPECT_FALSE(topology.nodeCpus(0).intersects(topology.nodeCpus(1u)));
+
+  CpuTopology detected;
+  EXPECT_EQ(detected.logicalCores(), detected.allCpus().count());
+  EXPECT_TRUE(detected.physicalCoreCpus().isSubsetOf(detected.allCpus()));
+}
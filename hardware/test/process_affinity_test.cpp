@@ -101,3 +101,52 @@ TEST_F(ProcessAffinityTest, threadAffinity) {
     printf("No thread affinity system available for Android...");
 # endif
 }
+
+
+// -- CPU set affinity --
+
+TEST_F(ProcessAffinityTest, cpuSetAffinity) {
+  CpuSet processCpus;
+  if (getCurrentProcessAffinity(processCpus)) { // may fail on some systems, but should never crash
+    EXPECT_FALSE(processCpus.empty());
+    if (setCurrentProcessAffinity(processCpus)) { // same affinity: no effect on gtest process
+      CpuSet verifiedCpus;
+      EXPECT_TRUE(getCurrentProcessAffinity(verifiedCpus));
+      EXPECT_TRUE(processCpus == verifiedCpus);
+    }
+    else
+      printf("setCurrentProcessAffinity is not supported or not allowed in current context...");
+  }
+  else
+    printf("getCurrentProcessAffinity is not supported or not allowed in current context...");
+  EXPECT_FALSE(setCurrentProcessAffinity(CpuSet{}));
+}
+
+TEST_F(ProcessAffinityTest, cpuSetThreadAffinity) {
+# if !defined(__ANDROID__) && !defined(__APPLE__)
+    CpuSet processCpus;
+    if (getCurrentProcessAffinity(processCpus) && !processCpus.empty()) {
+      CpuSet firstCpu{ processCpus.first() };
+      bool result = false;
+      CpuSet threadCpus;
+      std::thread secondThread([&firstCpu, &result, &threadCpus]() {
+        result = setCurrentThreadAffinity(firstCpu);
+        getCurrentThreadAffinity(threadCpus);
+      });
+      secondThread.join();
+      EXPECT_TRUE(result);
+      if (result) {
+        EXPECT_TRUE(threadCpus == firstCpu);
+      }
+
+      std::atomic_bool isRunning{ true };
+      std::thread thirdThread([&isRunning]() {
+        while (isRunning)
+          std::this_thread::yield();
+      });
+      EXPECT_TRUE(setThreadAffinity(thirdThread, processCpus));
+      isRunning = false;
+      thirdThread.join();
+    }
+# endif
+}
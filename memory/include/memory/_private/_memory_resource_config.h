@@ -0,0 +1,42 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+// -- std::pmr memory resources: only available with C++17 standard libraries --
+#if (!defined(_CPP_REVISION) || _CPP_REVISION != 14) && defined(__has_include)
+# if __has_include(<memory_resource>)
+#   include <memory_resource>
+#   if defined(__cpp_lib_memory_resource)
+#     define __P_HAS_MEMORY_RESOURCE 1 // memory resources can be used with containers (LightVector, DynamicArray, LightString)
+#   endif
+# endif
+#endif
+
+#ifdef __P_HAS_MEMORY_RESOURCE
+# include <type_traits>
+  namespace pandora {
+    namespace memory {
+      namespace _resource {
+        // memory resource as single argument: template, to avoid ambiguous calls with literal 0 (length / null pointer)
+        template <typename _Resource>
+        using EnableIfResource = typename std::enable_if<std::is_base_of<std::pmr::memory_resource, _Resource>::value, int>::type;
+      }
+    }
+  }
+#endif
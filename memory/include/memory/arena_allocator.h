@@ -0,0 +1,295 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cassert>
+#include <new>
+#include <utility>
+#include "./memory_pool.h"
+
+namespace pandora {
+  namespace memory {
+    /// @class ArenaAllocator
+    /// @brief Monotonic arena allocator (bump pointer) for short-lived scratch memory (per request, per frame...).
+    /// @description - Allocations are carved from chunks by moving a pointer: no header per allocation, no individual release.
+    ///              - Memory is reclaimed all at once: with 'reset()' (all allocations) or 'rollback(marker)' (allocations since a checkpoint).
+    ///                Chunks are kept for reuse: once warmed up, a workload that fits in existing chunks doesn't allocate anymore.
+    ///              - The first chunk may be a pre-reserved MemoryPool (ex: stack buffer): no system allocation as long as it's big enough.
+    ///              - Peak usage is recorded ('peakSize()'), to right-size the initial pool/chunk size for a workload.
+    /// @warning - Destructors of objects created in the arena are never called: use it for trivially destructible types,
+    ///            or destroy objects manually before reset/rollback.
+    ///          - Not thread-safe: use one arena per thread (see 'threadLocalArena()').
+    template <size_t _ChunkSize = size_t{ 64u*1024u }> ///< Size of chunks allocated from the system (bigger allocations: dedicated chunk)
+    class ArenaAllocator final {
+    private:
+      struct _Chunk;
+    public:
+      using Type = ArenaAllocator<_ChunkSize>;
+      static_assert(_ChunkSize >= 256u, "ArenaAllocator: _ChunkSize must be at least 256 bytes.");
+
+      static constexpr inline size_t chunkSize() noexcept { return _ChunkSize; } ///< Size of chunks allocated from the system (bytes)
+
+      /// @class ArenaAllocator::Marker
+      /// @brief Checkpoint in an arena (see 'mark()' / 'rollback()')
+      class Marker final {
+      public:
+        Marker() noexcept = default; ///< Marker of an empty arena (rollback = reset)
+        Marker(const Marker&) noexcept = default;
+        Marker& operator=(const Marker&) noexcept = default;
+
+        inline size_t size() const noexcept { ///< Arena usage when the marker was created (bytes)
+          return (this->_chunk != nullptr) ? this->_usedBefore + static_cast<size_t>(this->_cursor - this->_chunk->data()) : 0;
+        }
+      private:
+        friend class ArenaAllocator<_ChunkSize>;
+        Marker(_Chunk* chunk, uint8_t* cursor, size_t usedBefore) noexcept
+          : _chunk(chunk), _cursor(cursor), _usedBefore(usedBefore) {}
+
+        _Chunk* _chunk = nullptr;
+        uint8_t* _cursor = nullptr;
+        size_t _usedBefore = 0;
+      };
+
+      /// @class ArenaAllocator::Scope
+      /// @brief Scoped checkpoint: allocations made during the lifetime of the scope are reclaimed on destruction (rollback)
+      class Scope final {
+      public:
+        explicit Scope(Type& arena) noexcept : _arena(arena), _marker(arena.mark()) {}
+        ~Scope() noexcept { this->_arena.rollback(this->_marker); }
+
+        Scope(const Scope&) = delete;
+        Scope(Scope&&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        Scope& operator=(Scope&&) = delete;
+      private:
+        Type& _arena;
+        Marker _marker;
+      };
+
+      // -- lifecycle --
+
+      /// @brief Create empty arena (first chunk allocated on first allocation)
+      ArenaAllocator() noexcept = default;
+      /// @brief Create arena using a pre-reserved pool as first chunk (bigger workloads: additional chunks from the system)
+      /// @warning The pool must outlive the arena, and must not be used for anything else.
+      template <size_t _BytesCapacity, size_t _GuardBandSize, MemoryPoolAllocation _Alloc, bool _DoSizeCheck>
+      explicit ArenaAllocator(MemoryPool<_BytesCapacity,_GuardBandSize,_Alloc,_DoSizeCheck>& initialPool) noexcept {
+        static_assert(_BytesCapacity >= 256u, "ArenaAllocator: initial pool must contain at least 256 bytes.");
+        uintptr_t address = reinterpret_cast<uintptr_t>(initialPool.get());
+        size_t padding = static_cast<size_t>(_alignUp(address, alignof(std::max_align_t)) - address);
+        this->_first = new(reinterpret_cast<void*>(address + padding)) _Chunk(_BytesCapacity - padding - _Chunk::headerSize(), false);
+        this->_reserved = this->_first->capacity;
+        ++(this->_chunkCount);
+        _useChunk(this->_first, 0);
+      }
+      ~ArenaAllocator() noexcept { _releaseChunks(); }
+
+      ArenaAllocator(const Type&) = delete;
+      Type& operator=(const Type&) = delete;
+      ArenaAllocator(Type&& rhs) noexcept { _moveFrom(rhs); }
+      Type& operator=(Type&& rhs) noexcept {
+        if (this != &rhs) {
+          _releaseChunks();
+          _moveFrom(rhs);
+        }
+        return *this;
+      }
+
+      /// @brief Default arena of current thread (created on first use, released when the thread exits)
+      static inline Type& threadLocalArena() noexcept {
+        static thread_local Type arena;
+        return arena;
+      }
+
+      // -- allocation --
+
+      /// @brief Allocate a memory block of 'size' bytes, aligned on 'alignment' bytes (power of 2)
+      /// @throws std::bad_alloc if the system is out of memory
+      inline void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+        assert(alignment != 0 && (alignment & (alignment - 1u)) == 0);
+        uintptr_t block = _alignUp(reinterpret_cast<uintptr_t>(this->_cursor), alignment);
+        uintptr_t end = reinterpret_cast<uintptr_t>(this->_end);
+        if (block != 0 && block <= end && size <= end - block) {
+          this->_cursor = reinterpret_cast<uint8_t*>(block + size);
+          return reinterpret_cast<void*>(block);
+        }
+        return _allocateInNextChunk(size, alignment);
+      }
+      /// @brief Allocate uninitialized storage for 'count' items of a type (aligned for the type)
+      /// @throws std::bad_alloc if the system is out of memory
+      template <typename _DataType>
+      inline _DataType* alloc(size_t count = 1u) {
+        if (count > static_cast<size_t>(-1) / sizeof(_DataType))
+          throw std::bad_alloc{};
+        return static_cast<_DataType*>(allocate(count*sizeof(_DataType), alignof(_DataType)));
+      }
+      /// @brief Allocate + construct an object in the arena
+      /// @warning Its destructor is never called by the arena.
+      /// @throws std::bad_alloc if the system is out of memory (or any exception thrown by the constructor)
+      template <typename _DataType, typename ... _Args>
+      inline _DataType* create(_Args&&... args) {
+        return new(alloc<_DataType>(1u)) _DataType(std::forward<_Args>(args)...);
+      }
+
+      // -- reclaim memory --
+
+      /// @brief Create checkpoint (current usage of the arena), to reclaim later allocations with 'rollback'
+      inline Marker mark() const noexcept { return Marker(this->_current, this->_cursor, this->_usedBefore); }
+      /// @brief Reclaim all allocations made after a checkpoint (chunks kept for reuse)
+      /// @warning - Markers must be rolled back in reverse order of creation (a marker is invalidated by rolling back or resetting before it).
+      ///          - Objects allocated after the checkpoint must not be used anymore.
+      void rollback(const Marker& marker) noexcept {
+        if (marker._chunk == nullptr) {
+          reset();
+          return;
+        }
+        _updatePeakSize();
+        _useChunk(marker._chunk, marker._usedBefore);
+        this->_cursor = marker._cursor;
+      }
+      /// @brief Reclaim all allocations (chunks kept for reuse)
+      /// @warning Objects allocated in the arena must not be used anymore.
+      void reset() noexcept {
+        _updatePeakSize();
+        if (this->_first != nullptr)
+          _useChunk(this->_first, 0);
+      }
+      /// @brief Reclaim all allocations + release all chunks allocated from the system (initial pool kept)
+      /// @warning Objects allocated in the arena must not be used anymore.
+      void release() noexcept {
+        _updatePeakSize();
+        _Chunk* initialPool = (this->_first != nullptr && !this->_first->isOwned) ? this->_first : nullptr;
+        if (initialPool != nullptr) {
+          _releaseChunkList(initialPool->next);
+          initialPool->next = nullptr;
+          this->_reserved = initialPool->capacity;
+          this->_chunkCount = 1u;
+          _useChunk(initialPool, 0);
+        }
+        else {
+          _releaseChunkList(this->_first);
+          this->_first = this->_current = nullptr;
+          this->_cursor = this->_end = nullptr;
+          this->_usedBefore = this->_reserved = this->_chunkCount = 0;
+        }
+      }
+
+      // -- instrumentation --
+
+      /// @brief Current usage of the arena: allocated bytes, including alignment padding
+      inline size_t size() const noexcept {
+        return (this->_current != nullptr) ? this->_usedBefore + static_cast<size_t>(this->_cursor - this->_current->data()) : 0;
+      }
+      /// @brief Max usage of the arena since creation (or since 'resetPeakSize()'): useful to choose initial pool/chunk size
+      inline size_t peakSize() const noexcept { size_t current = size(); return (current > this->_peakSize) ? current : this->_peakSize; }
+      inline void resetPeakSize() noexcept { this->_peakSize = 0; } ///< Restart peak usage measurement (from current usage)
+      inline size_t capacity() const noexcept { return this->_reserved; }     ///< Total capacity of all chunks (bytes)
+      inline size_t chunkCount() const noexcept { return this->_chunkCount; } ///< Number of chunks (including initial pool)
+
+    private:
+      // memory chunk: header + data
+      struct _Chunk final {
+        _Chunk(size_t capacity, bool isOwned) noexcept : capacity(capacity), isOwned(isOwned) {}
+        static constexpr inline size_t headerSize() noexcept {
+          return (sizeof(_Chunk) + alignof(std::max_align_t) - 1u) & ~(alignof(std::max_align_t) - 1u);
+        }
+        inline uint8_t* data() noexcept { return reinterpret_cast<uint8_t*>(this) + headerSize(); }
+
+        _Chunk* next = nullptr;
+        size_t capacity;
+        bool isOwned; // false: initial pool
+      };
+
+      static constexpr inline uintptr_t _alignUp(uintptr_t address, size_t alignment) noexcept {
+        return (address + (alignment - 1u)) & ~static_cast<uintptr_t>(alignment - 1u);
+      }
+      inline void _useChunk(_Chunk* chunk, size_t usedBefore) noexcept {
+        this->_current = chunk;
+        this->_cursor = chunk->data();
+        this->_end = this->_cursor + chunk->capacity;
+        this->_usedBefore = usedBefore;
+      }
+      inline void _updatePeakSize() noexcept { this->_peakSize = peakSize(); }
+
+      // current chunk full -> use next chunk (or insert new chunk after current one)
+      void* _allocateInNextChunk(size_t size, size_t alignment) {
+        size_t padding = (alignment > alignof(std::max_align_t)) ? alignment : 0;
+        if (size > static_cast<size_t>(-1) - padding - _Chunk::headerSize())
+          throw std::bad_alloc{};
+
+        _Chunk* next = (this->_current != nullptr) ? this->_current->next : nullptr;
+        if (next == nullptr || next->capacity < size + padding) {
+          size_t chunkSize = (size + padding + _Chunk::headerSize() > _ChunkSize) ? size + padding + _Chunk::headerSize() : _ChunkSize;
+          void* buffer = malloc(chunkSize);
+          if (buffer == nullptr)
+            throw std::bad_alloc{};
+          _Chunk* chunk = new(buffer) _Chunk(chunkSize - _Chunk::headerSize(), true);
+          this->_reserved += chunk->capacity;
+          ++(this->_chunkCount);
+
+          chunk->next = next; // unused chunks kept after new chunk (too small for this allocation, but reusable later)
+          if (this->_current != nullptr)
+            this->_current->next = chunk;
+          else
+            this->_first = chunk;
+          next = chunk;
+        }
+
+        _useChunk(next, this->size()); // remaining space of previous chunk not counted as used
+        uintptr_t block = _alignUp(reinterpret_cast<uintptr_t>(this->_cursor), alignment);
+        this->_cursor = reinterpret_cast<uint8_t*>(block + size);
+        return reinterpret_cast<void*>(block);
+      }
+
+      static void _releaseChunkList(_Chunk* chunk) noexcept {
+        while (chunk != nullptr) {
+          _Chunk* next = chunk->next;
+          if (chunk->isOwned)
+            free(reinterpret_cast<void*>(chunk));
+          chunk = next;
+        }
+      }
+      inline void _releaseChunks() noexcept { _releaseChunkList(this->_first); }
+
+      inline void _moveFrom(Type& rhs) noexcept {
+        this->_first = rhs._first;     rhs._first = nullptr;
+        this->_current = rhs._current; rhs._current = nullptr;
+        this->_cursor = rhs._cursor;   rhs._cursor = nullptr;
+        this->_end = rhs._end;         rhs._end = nullptr;
+        this->_usedBefore = rhs._usedBefore; rhs._usedBefore = 0;
+        this->_peakSize = rhs._peakSize;     rhs._peakSize = 0;
+        this->_reserved = rhs._reserved;     rhs._reserved = 0;
+        this->_chunkCount = rhs._chunkCount; rhs._chunkCount = 0;
+      }
+
+    private:
+      _Chunk* _first = nullptr;
+      _Chunk* _current = nullptr; // NULL: no chunk
+      uint8_t* _cursor = nullptr; // first free byte of current chunk
+      uint8_t* _end = nullptr;    // end of current chunk
+      size_t _usedBefore = 0;     // bytes used in chunks before current chunk
+      size_t _peakSize = 0;       // peak usage (before last rollback/reset)
+      size_t _reserved = 0;
+      size_t _chunkCount = 0;
+    };
+  }
+}
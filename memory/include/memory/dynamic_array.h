@@ -22,7 +22,9 @@ IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <new>
 #include <type_traits>
+#include "./_private/_memory_resource_config.h"
 
 namespace pandora {
   namespace memory {
@@ -30,7 +32,9 @@ namespace pandora {
     /// @brief RAII dynamically-allocated array container with size defined at runtime (as a constructor param).
     ///        Useful to avoid the huge weight/overhead of std::vector (or even the reduced cost of LightVector)
     ///        when the container size never changes.
-    /// @remarks If the container needs to be resized (entries appended/inserted/erased), use LightVector instead.
+    /// @remarks - If the container needs to be resized (entries appended/inserted/erased), use LightVector instead.
+    ///          - C++17: a memory resource (std::pmr) may be provided to the constructor (ex: arena to release many containers in one shot).
+    ///            The resource is moved with the content of the array (move constructor/assignment). Copies use operator new, unless a resource is specified.
     template <typename _DataType>
     struct DynamicArray final {
       constexpr inline DynamicArray() noexcept : _value(nullptr) {} ///< Create empty array
@@ -40,30 +44,51 @@ namespace pandora {
         : _value(length ? new _DataType[length] : nullptr), _length(length) {
         _constructCopyData<_DataType>(_value, values, _length);
       }
-      inline ~DynamicArray() noexcept {
-        if (_value != nullptr)
-          delete[] _value;
-      }
+#     ifdef __P_HAS_MEMORY_RESOURCE
+        template <typename _Resource, _resource::EnableIfResource<_Resource> = 0>
+        inline explicit DynamicArray(_Resource* resource) noexcept ///< Create empty array using a memory resource
+          : _value(nullptr), _resource(resource) {}
+        inline DynamicArray(size_t length, std::pmr::memory_resource* resource) ///< Create fixed-size array of default constructed values using a memory resource
+          : _length(length), _resource(resource) {
+          this->_value = _allocateArray(length, true);
+        }
+        inline DynamicArray(const _DataType* values, size_t length, std::pmr::memory_resource* resource) ///< Create initialized array using a memory resource
+          : _length(length), _resource(resource) {
+          this->_value = _allocateArray(length, false);
+          _constructCopyData<_DataType>(_value, values, _length);
+        }
+        inline DynamicArray(const DynamicArray& rhs, std::pmr::memory_resource* resource) ///< Copy array using a memory resource
+          : DynamicArray(rhs._value, rhs._length, resource) {}
+#     endif
+      inline ~DynamicArray() noexcept { _release(); }
 
       inline DynamicArray(const DynamicArray& rhs)
         : _value(rhs._length ? new _DataType[rhs._length] : nullptr), _length(rhs._length) {
         _constructCopyData<_DataType>(_value, rhs._value, _length);
       }
       inline DynamicArray& operator=(const DynamicArray& rhs) {
-        clear();
-        this->_value = rhs._length ? new _DataType[rhs._length] : nullptr;
-        this->_length = rhs._length;
-        _constructCopyData<_DataType>(_value, rhs._value, _length);
+        if (this != &rhs) {
+          clear();
+          this->_value = _allocateArray(rhs._length, false);
+          this->_length = rhs._length;
+          _constructCopyData<_DataType>(_value, rhs._value, _length);
+        }
+        return *this;
       }
       inline DynamicArray(DynamicArray&& rhs) noexcept : _value(rhs._value), _length(rhs._length) {
+#       ifdef __P_HAS_MEMORY_RESOURCE
+          this->_resource = rhs._resource;
+#       endif
         rhs._value = nullptr;
         rhs._length = 0;
       }
       inline DynamicArray& operator=(DynamicArray&& rhs) noexcept { 
-        if (_value != nullptr)
-          delete[] _value;
+        _release();
         _value = rhs._value;
         _length = rhs._length;
+#       ifdef __P_HAS_MEMORY_RESOURCE
+          this->_resource = rhs._resource;
+#       endif
         rhs._value = nullptr;
         rhs._length = 0;
         return *this;
@@ -77,6 +102,9 @@ namespace pandora {
       constexpr inline size_t length() const noexcept { return this->_length; } ///< Get fixed array size
       constexpr inline size_t size() const noexcept { return this->_length; }   ///< Get fixed array size
       constexpr inline bool empty() const noexcept { return (this->_length == 0); } ///< Verify if the array is empty
+#     ifdef __P_HAS_MEMORY_RESOURCE
+        inline std::pmr::memory_resource* resource() const noexcept { return this->_resource; } ///< Get memory resource (NULL: operator new)
+#     endif
       
       inline const _DataType& operator[](size_t index) const noexcept {
         assert(index < _length);
@@ -103,13 +131,56 @@ namespace pandora {
       // -- operators --
 
       void clear() noexcept { ///< Clear array (set size 0)
-        if (_value != nullptr)
-          delete[] _value;
+        _release();
         _value = nullptr;
         _length = 0;
       }
 
     private:
+      // allocate array + construct items (default-initialized or value-initialized)
+      _DataType* _allocateArray(size_t length, bool isValueInit) {
+        if (length == 0)
+          return nullptr;
+#       ifdef __P_HAS_MEMORY_RESOURCE
+          if (this->_resource != nullptr) {
+            _DataType* values = (_DataType*)this->_resource->allocate(length*sizeof(_DataType), alignof(_DataType));
+            size_t index = 0;
+            try {
+              for (; index < length; ++index) {
+                if (isValueInit)
+                  new(values + (intptr_t)index) _DataType();
+                else
+                  new(values + (intptr_t)index) _DataType;
+              }
+            }
+            catch (...) {
+              _destroyItems(values, index);
+              this->_resource->deallocate((void*)values, length*sizeof(_DataType), alignof(_DataType));
+              throw;
+            }
+            return values;
+          }
+#       endif
+        return isValueInit ? new _DataType[length]() : new _DataType[length];
+      }
+      // destroy items + release array
+      inline void _release() noexcept {
+        if (this->_value != nullptr) {
+#         ifdef __P_HAS_MEMORY_RESOURCE
+            if (this->_resource != nullptr) {
+              _destroyItems(this->_value, this->_length);
+              this->_resource->deallocate((void*)this->_value, this->_length*sizeof(_DataType), alignof(_DataType));
+              return;
+            }
+#         endif
+          delete[] this->_value;
+        }
+      }
+      static inline void _destroyItems(_DataType* values, size_t length) noexcept {
+        for (_DataType* it = values + (intptr_t)length; it > values; )
+          (*(--it)).~_DataType();
+      }
+
       template <typename T = _DataType>
       static inline void _constructCopyData(typename std::enable_if<std::is_class<T>::value, _DataType*>::type lhs,
                                             const _DataType* rhs, size_t length) noexcept {
@@ -125,6 +196,9 @@ namespace pandora {
     private:
       _DataType* _value = nullptr;
       size_t _length = 0;
+#     ifdef __P_HAS_MEMORY_RESOURCE
+        std::pmr::memory_resource* _resource = nullptr; // NULL: new[]/delete[]
+#     endif
     };
   }
 }
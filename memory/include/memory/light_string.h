@@ -19,6 +19,7 @@ IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 #include <cstddef>
+#include "./_private/_memory_resource_config.h"
 
 namespace pandora {
   namespace memory {
@@ -27,18 +28,29 @@ namespace pandora {
     ///        Useful to avoid the huge weight/overhead of std::string when not needed.
     /// @warning - No exception thrown: for required values, verify if not empty after setting it (or use assign() -> returns success).
     ///          - On allocation failure, constructors create an empty string (NULL data).
+    /// @remarks C++17: a memory resource (std::pmr) may be provided to the constructor (ex: arena to release many strings in one shot).
+    ///          The resource is moved with the content of the string (move constructor/assignment). Copies use malloc, unless a resource is specified.
     class LightString final {
     public:
       LightString() noexcept = default;
       LightString(const LightString& rhs) noexcept { assign(rhs._value, rhs._size); }
-      LightString(LightString&& rhs) noexcept : _value(rhs._value), _size(rhs._size) { rhs._value = nullptr; rhs._size = 0; }
+      LightString(LightString&& rhs) noexcept { _moveFrom(rhs); }
       LightString& operator=(const LightString& rhs) noexcept { assign(rhs._value, rhs._size); return *this; }
-      LightString& operator=(LightString&& rhs) noexcept { this->_value = rhs._value; this->_size = rhs._size; rhs._value = nullptr; rhs._size = 0; return *this; }
+      LightString& operator=(LightString&& rhs) noexcept { if (this != &rhs) { clear(); _moveFrom(rhs); } return *this; }
       ~LightString() noexcept { clear(); }
       
-      LightString(size_t length, char repeated = ' ') noexcept; ///< Create string with repeated char (also useful to prealloc before calling assign / updating through data()[])
+      LightString(size_t length, char repeated = ' ') noexcept { _fill(length, repeated); } ///< Create string with repeated char (also useful to prealloc before calling assign / updating through data()[])
       LightString(const char* value) noexcept { assign(value); } ///< Create initialized string
       LightString(const char* value, size_t length) noexcept { assign(value, length); } ///< Create initialized string
+#     ifdef __P_HAS_MEMORY_RESOURCE
+        template <typename _Resource, _resource::EnableIfResource<_Resource> = 0>
+        explicit LightString(_Resource* resource) noexcept : _resource(resource) {} ///< Create empty string using a memory resource
+        LightString(size_t length, char repeated, std::pmr::memory_resource* resource) noexcept : _resource(resource) { _fill(length, repeated); } ///< Create string with repeated char using a memory resource
+        template <typename _Resource, _resource::EnableIfResource<_Resource> = 0>
+        LightString(const char* value, _Resource* resource) noexcept : _resource(resource) { assign(value); } ///< Create initialized string using a memory resource
+        LightString(const char* value, size_t length, std::pmr::memory_resource* resource) noexcept : _resource(resource) { assign(value, length); } ///< Create initialized string using a memory resource
+        LightString(const LightString& rhs, std::pmr::memory_resource* resource) noexcept : _resource(resource) { assign(rhs._value, rhs._size); } ///< Copy string using a memory resource
+#     endif
       
       // -- accessors --
       
@@ -49,6 +61,9 @@ namespace pandora {
       constexpr inline size_t length() const noexcept { return this->_size; } ///< Get current length of the string
       constexpr inline size_t size() const noexcept { return this->_size; }   ///< Get current length of the string
       constexpr inline bool empty() const noexcept { return (this->_value == nullptr); } ///< Verify if the string is empty
+#     ifdef __P_HAS_MEMORY_RESOURCE
+        inline std::pmr::memory_resource* resource() const noexcept { return this->_resource; } ///< Get memory resource (NULL: malloc)
+#     endif
       
       bool operator==(const LightString& rhs) const noexcept;
       inline bool operator!=(const LightString& rhs) const noexcept { return !(this->operator==(rhs)); }
@@ -72,8 +87,23 @@ namespace pandora {
 
     private:
       static constexpr const char* _emptyValue() noexcept { return ""; }
+      void _fill(size_t length, char repeated) noexcept;
+      char* _allocate(size_t length) noexcept;
+      void _replaceValue(char* value, size_t allocLength) noexcept;
+      inline void _moveFrom(LightString& rhs) noexcept {
+        this->_value = rhs._value; this->_size = rhs._size; rhs._value = nullptr; rhs._size = 0;
+#       ifdef __P_HAS_MEMORY_RESOURCE
+          this->_resource = rhs._resource; this->_allocLength = rhs._allocLength; rhs._allocLength = 0;
+#       endif
+      }
+
+    private:
       char* _value = nullptr;
       size_t _size = 0u;
+#     ifdef __P_HAS_MEMORY_RESOURCE
+        std::pmr::memory_resource* _resource = nullptr; // NULL: malloc/free
+        size_t _allocLength = 0u; // allocated length (without ending zero)
+#     endif
     };
     
     // ---
@@ -83,18 +113,29 @@ namespace pandora {
     ///        Useful to avoid the huge weight/overhead of std::wstring when not needed.
     /// @warning - No exception thrown: for required values, verify if not empty after setting it (or use assign() -> returns success).
     ///          - On allocation failure, constructors create an empty string (NULL data).
+    /// @remarks C++17: a memory resource (std::pmr) may be provided to the constructor (ex: arena to release many strings in one shot).
+    ///          The resource is moved with the content of the string (move constructor/assignment). Copies use malloc, unless a resource is specified.
     class LightWString final {
     public:
       LightWString() noexcept = default;
       LightWString(const LightWString& rhs) noexcept { assign(rhs._value, rhs._size); }
-      LightWString(LightWString&& rhs) noexcept : _value(rhs._value), _size(rhs._size) { rhs._value = nullptr; rhs._size = 0; }
+      LightWString(LightWString&& rhs) noexcept { _moveFrom(rhs); }
       LightWString& operator=(const LightWString& rhs) noexcept { assign(rhs._value, rhs._size); return *this; }
-      LightWString& operator=(LightWString&& rhs) noexcept { this->_value = rhs._value; this->_size = rhs._size; rhs._value = nullptr; rhs._size = 0; return *this; }
+      LightWString& operator=(LightWString&& rhs) noexcept { if (this != &rhs) { clear(); _moveFrom(rhs); } return *this; }
       ~LightWString() noexcept { clear(); }
       
-      LightWString(size_t length, wchar_t repeated = L' ') noexcept; ///< Create string with repeated char (also useful to prealloc before calling assign / updating through data()[])
+      LightWString(size_t length, wchar_t repeated = L' ') noexcept { _fill(length, repeated); } ///< Create string with repeated char (also useful to prealloc before calling assign / updating through data()[])
       LightWString(const wchar_t* value) noexcept { assign(value); } ///< Create initialized string
       LightWString(const wchar_t* value, size_t length) noexcept { assign(value, length); } ///< Create initialized string
+#     ifdef __P_HAS_MEMORY_RESOURCE
+        template <typename _Resource, _resource::EnableIfResource<_Resource> = 0>
+        explicit LightWString(_Resource* resource) noexcept : _resource(resource) {} ///< Create empty string using a memory resource
+        LightWString(size_t length, wchar_t repeated, std::pmr::memory_resource* resource) noexcept : _resource(resource) { _fill(length, repeated); } ///< Create string with repeated char using a memory resource
+        template <typename _Resource, _resource::EnableIfResource<_Resource> = 0>
+        LightWString(const wchar_t* value, _Resource* resource) noexcept : _resource(resource) { assign(value); } ///< Create initialized string using a memory resource
+        LightWString(const wchar_t* value, size_t length, std::pmr::memory_resource* resource) noexcept : _resource(resource) { assign(value, length); } ///< Create initialized string using a memory resource
+        LightWString(const LightWString& rhs, std::pmr::memory_resource* resource) noexcept : _resource(resource) { assign(rhs._value, rhs._size); } ///< Copy string using a memory resource
+#     endif
       
       // -- accessors --
       
@@ -105,6 +146,9 @@ namespace pandora {
       constexpr inline size_t length() const noexcept { return this->_size; } ///< Get current length of the string
       constexpr inline size_t size() const noexcept { return this->_size; }   ///< Get current length of the string
       constexpr inline bool empty() const noexcept { return (this->_value == nullptr); } ///< Verify if the string is empty
+#     ifdef __P_HAS_MEMORY_RESOURCE
+        inline std::pmr::memory_resource* resource() const noexcept { return this->_resource; } ///< Get memory resource (NULL: malloc)
+#     endif
       
       bool operator==(const LightWString& rhs) const noexcept;
       inline bool operator!=(const LightWString& rhs) const noexcept { return !(this->operator==(rhs)); }
@@ -128,8 +172,23 @@ namespace pandora {
 
     private:
       static constexpr const wchar_t* _emptyValue() noexcept { return L""; }
+      void _fill(size_t length, wchar_t repeated) noexcept;
+      wchar_t* _allocate(size_t length) noexcept;
+      void _replaceValue(wchar_t* value, size_t allocLength) noexcept;
+      inline void _moveFrom(LightWString& rhs) noexcept {
+        this->_value = rhs._value; this->_size = rhs._size; rhs._value = nullptr; rhs._size = 0;
+#       ifdef __P_HAS_MEMORY_RESOURCE
+          this->_resource = rhs._resource; this->_allocLength = rhs._allocLength; rhs._allocLength = 0;
+#       endif
+      }
+
+    private:
       wchar_t* _value = nullptr;
       size_t _size = 0u;
+#     ifdef __P_HAS_MEMORY_RESOURCE
+        std::pmr::memory_resource* _resource = nullptr; // NULL: malloc/free
+        size_t _allocLength = 0u; // allocated length (without ending zero)
+#     endif
     };
   }
 }
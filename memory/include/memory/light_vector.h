@@ -21,8 +21,13 @@ IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <cassert>
 #include <cstdint>
 #include <cstddef>
+#include <cstdlib>
 #include <cstring>
+#include <new>
+#include <iterator>
+#include <utility>
 #include <type_traits>
+#include "./_private/_memory_resource_config.h"
 
 #define __P_LTVEC_TYPE_CLASS(datatype)   typename std::enable_if<std::is_class<T>::value, datatype>::type
 #define __P_LTVEC_TYPE_TRIVIAL(datatype) typename std::enable_if<!std::is_class<T>::value, datatype>::type
@@ -32,41 +37,75 @@ namespace pandora {
     /// @class LightVector
     /// @brief Simple vector container with dynamic allocation.
     ///        Useful to avoid the huge weight/overhead of std::vector when not needed.
-    /// @remarks If the container size never changes (immutable/fixed-size), use DynamicArray instead.
-    template <typename _DataType>
+    /// @description The capacity grows geometrically when items are appended/inserted (amortized O(1) appends):
+    ///              new capacity = current capacity * _GrowthFactorPercent / 100 (at least 4 items).
+    ///              Trivially copyable types are relocated with realloc/memcpy, other types are moved item by item
+    ///              (or copied if their move constructor may throw, as std::vector: vector unchanged if relocation fails).
+    /// @remarks - If the container size never changes (immutable/fixed-size), use DynamicArray instead.
+    ///          - C++17: a memory resource (std::pmr) may be provided to the constructor (ex: arena to release many containers in one shot).
+    ///            The resource is moved with the content of the vector (move constructor/assignment). Copies use malloc, unless a resource is specified.
+    template <typename _DataType, size_t _GrowthFactorPercent = 200u> // Capacity growth factor (percent: 150 = x1.5, 200 = x2)
     class LightVector final {
     public:
-      using Type = LightVector<_DataType>;
+      using Type = LightVector<_DataType,_GrowthFactorPercent>;
+      static_assert(_GrowthFactorPercent > 100u, "LightVector: growth factor must be greater than 100 percent");
 
       inline LightVector() noexcept : _value(nullptr), _size(0), _allocSize(0) {}            ///< Create empty vector
       inline LightVector(size_t length) : _size(length), _allocSize(_getAllocSize(length)) { ///< Create vector of default constructed values
         if (this->_size > 0) {
-          this->_value = new uint8_t[this->_allocSize*sizeof(_DataType)];
+          this->_value = _allocate(this->_allocSize);
           _constructDefault((_DataType*)this->_value, this->_size);
         }
       }
       inline LightVector(const _DataType* values, size_t length) : _size(length), _allocSize(_getAllocSize(length)) { ///< Create initialized vector
         if (this->_size > 0) {
-          this->_value = new uint8_t[this->_allocSize*sizeof(_DataType)];
+          this->_value = _allocate(this->_allocSize);
           _constructCopyData((_DataType*)this->_value, values, length);
         }
       }
+#     ifdef __P_HAS_MEMORY_RESOURCE
+        template <typename _Resource, _resource::EnableIfResource<_Resource> = 0>
+        inline explicit LightVector(_Resource* resource) noexcept ///< Create empty vector using a memory resource
+          : _value(nullptr), _size(0), _allocSize(0), _resource(resource) {}
+        inline LightVector(size_t length, std::pmr::memory_resource* resource) ///< Create vector of default constructed values using a memory resource
+          : _size(length), _allocSize(_getAllocSize(length)), _resource(resource) {
+          if (this->_size > 0) {
+            this->_value = _allocate(this->_allocSize);
+            _constructDefault((_DataType*)this->_value, this->_size);
+          }
+        }
+        inline LightVector(const _DataType* values, size_t length, std::pmr::memory_resource* resource) ///< Create initialized vector using a memory resource
+          : _size(length), _allocSize(_getAllocSize(length)), _resource(resource) {
+          if (this->_size > 0) {
+            this->_value = _allocate(this->_allocSize);
+            _constructCopyData((_DataType*)this->_value, values, length);
+          }
+        }
+        inline LightVector(const Type& rhs, std::pmr::memory_resource* resource) ///< Copy vector using a memory resource
+          : LightVector((const _DataType*)rhs._value, rhs._size, resource) {}
+#     endif
       inline ~LightVector() noexcept { clear(); }
 
       inline LightVector(const Type& rhs) : _size(rhs._size), _allocSize(_getAllocSize(rhs._size)) {
         if (this->_size > 0) {
-          this->_value = new uint8_t[this->_allocSize*sizeof(_DataType)];
+          this->_value = _allocate(this->_allocSize);
           _constructCopyData((_DataType*)this->_value, (const _DataType*)rhs._value, rhs._size);
         }
       }
       inline Type& operator=(const Type& rhs) { assign((const _DataType*)rhs._value, rhs._size); return *this; }
       
       inline LightVector(Type&& rhs) noexcept : _value(rhs._value), _size(rhs._size), _allocSize(rhs._allocSize) {
+#       ifdef __P_HAS_MEMORY_RESOURCE
+          this->_resource = rhs._resource;
+#       endif
         rhs._value = nullptr; rhs._allocSize = rhs._size = 0;
       }
       inline Type& operator=(Type&& rhs) noexcept {
         clear();
         this->_value = rhs._value; this->_size = rhs._size; this->_allocSize = rhs._allocSize;
+#       ifdef __P_HAS_MEMORY_RESOURCE
+          this->_resource = rhs._resource;
+#       endif
         rhs._value = nullptr; rhs._allocSize = rhs._size = 0;
         return *this;
       }
@@ -79,7 +118,11 @@ namespace pandora {
       
       constexpr inline size_t length() const noexcept { return this->_size; } ///< Get current size of the vector
       constexpr inline size_t size() const noexcept { return this->_size; }   ///< Get current size of the vector
-      constexpr inline bool empty() const noexcept { return (this->_value == nullptr); } ///< Verify if the vector is empty
+      constexpr inline size_t capacity() const noexcept { return this->_allocSize; } ///< Get number of items that can be stored without reallocation
+      constexpr inline bool empty() const noexcept { return (this->_size == 0); } ///< Verify if the vector is empty
+#     ifdef __P_HAS_MEMORY_RESOURCE
+        inline std::pmr::memory_resource* resource() const noexcept { return this->_resource; } ///< Get memory resource (NULL: malloc)
+#     endif
       
       inline const _DataType& operator[](size_t index) const {
         assert(index < this->_size);
@@ -107,18 +150,31 @@ namespace pandora {
       void clear() noexcept { ///< Clear vector content (set to NULL)
         if (this->_value != nullptr) {
           _destroy((_DataType*)this->_value, this->_size);
-          delete[] this->_value;
+          _deallocate(this->_value, this->_allocSize);
           this->_value = nullptr;
         }
         this->_allocSize = this->_size = 0;
       }
+
+      /// @brief Pre-allocate memory for at least 'capacity' items (no effect if current capacity is already sufficient)
+      void reserve(size_t capacity) {
+        if (capacity > this->_allocSize)
+          _reallocate(capacity);
+      }
+      /// @brief Release unused capacity (capacity = size)
+      void shrink_to_fit() {
+        if (this->_size == 0)
+          clear();
+        else if (this->_allocSize > this->_size)
+          _reallocate(this->_size);
+      }
       
       void assign(const _DataType* value, size_t length) { ///< Assign vector data
         if (this->_allocSize < length) {
-          uint8_t* extValue = new uint8_t[_getAllocSize(length)*sizeof(_DataType)];
+          uint8_t* extValue = _allocate(_getAllocSize(length));
           if (this->_value != nullptr) {
             _destroy((_DataType*)this->_value, this->_size);
-            delete[] this->_value;
+            _deallocate(this->_value, this->_allocSize);
           }
           this->_value = extValue;
           this->_allocSize = _getAllocSize(length);
@@ -141,51 +197,33 @@ namespace pandora {
 
       void insert(uint32_t index, const _DataType& value) { ///< Insert new vector data at index
         assert(index <= this->_size);
-        if (this->_size >= this->_allocSize) {
-          size_t allocSize = (this->_allocSize > 0) ? (this->_allocSize << 1) : 4;
-          uint8_t* extValue = new uint8_t[allocSize*sizeof(_DataType)];
-          if (this->_value != nullptr) {
-            _constructMoveData((_DataType*)extValue, (_DataType*)this->_value, index);
-            if (index < this->_size) {
-              _constructMoveData((_DataType*)extValue + (intptr_t)index + (intptr_t)1,
-                                 (_DataType*)this->_value + (intptr_t)index, this->_size - (size_t)index);
-              _constructCopyOne((_DataType*)extValue + (intptr_t)index, value);
-            }
-            else
-              _constructCopyOne((_DataType*)extValue + (intptr_t)this->_size, value);
-            _destroy((_DataType*)this->_value, this->_size);
-            delete[] this->_value;
-          }
-          else
-            _constructCopyOne((_DataType*)extValue, value);
+        _DataType copy(value); // copy before moving items (value may be stored in vector)
+        _insertMoved(index, std::move(copy));
+      }
+      void insert(uint32_t index, _DataType&& value) { ///< Insert new vector data at index (moved)
+        assert(index <= this->_size);
+        _insertMoved(index, std::move(value));
+      }
 
-          this->_value = extValue;
-          this->_allocSize = allocSize;
-        }
-        else {
-          if (index < this->_size) {
-            _shiftRight((_DataType*)this->_value, (intptr_t)index, this->_size);
-            *((_DataType*)_value + (intptr_t)index) = value;
-          }
-          else
-            _constructCopyOne((_DataType*)this->_value + (intptr_t)this->_size, value);
-        }
-        ++_size;
+      inline void push_back(const _DataType& value) { emplace_back(value); }       ///< Append new vector data
+      inline void push_back(_DataType&& value) { emplace_back(std::move(value)); } ///< Append new vector data (moved)
+      /// @brief Construct new vector data at the end of the vector
+      /// @returns Reference to new item
+      template <typename ... _Args>
+      _DataType& emplace_back(_Args&&... args) {
+        if (this->_size >= this->_allocSize)
+          _growEmplaceBack(_IsRelocatable{}, std::forward<_Args>(args)...);
+        else
+          new((_DataType*)this->_value + (intptr_t)this->_size) _DataType(std::forward<_Args>(args)...);
+        return *((_DataType*)this->_value + (intptr_t)(this->_size++));
       }
-      void push_back(const _DataType& value) { ///< Append new vector data
-        if (this->_size >= this->_allocSize) {
-          size_t allocSize = (this->_allocSize > 0) ? (this->_allocSize << 1) : 4;
-          uint8_t* extValue = new uint8_t[allocSize*sizeof(_DataType)];
-          if (this->_value != nullptr) {
-            _constructMoveData((_DataType*)extValue, (_DataType*)this->_value, this->_size);
-            _destroy((_DataType*)this->_value, this->_size);
-            delete[] this->_value;
-          }
-          this->_value = extValue;
-          this->_allocSize = allocSize;
-        }
-        _constructCopyOne((_DataType*)this->_value + (intptr_t)this->_size, value);
-        ++_size;
+
+      /// @brief Append multiple items (copies)
+      inline void append(const _DataType* values, size_t length) { append(values, values + (intptr_t)length); }
+      /// @brief Append a range of items (copies) - single reallocation if the length of the range is known (forward iterators)
+      template <typename _Iterator>
+      inline void append(_Iterator first, _Iterator last) {
+        _appendRange(first, last, typename std::iterator_traits<_Iterator>::iterator_category{});
       }
 
       void erase(uint32_t index) noexcept { ///< Remove vector data at index
@@ -193,7 +231,7 @@ namespace pandora {
           _shiftLeft((_DataType*)this->_value, index, this->_size);
           --_size;
           if (this->_size == 0) {
-            delete[] this->_value;
+            _deallocate(this->_value, this->_allocSize);
             this->_value = nullptr;
             this->_allocSize = 0;
           }
@@ -204,7 +242,7 @@ namespace pandora {
           --_size;
           _destroyOne((_DataType*)this->_value + (intptr_t)this->_size);
           if (this->_size == 0) {
-            delete[] this->_value;
+            _deallocate(this->_value, this->_allocSize);
             this->_value = nullptr;
             this->_allocSize = 0;
           }
@@ -214,7 +252,167 @@ namespace pandora {
       // ---
 
     private:
+      using _IsRelocatable = std::integral_constant<bool, std::is_trivially_copyable<_DataType>::value>; // items can be moved with memcpy/realloc
+      using _IsNothrowRelocatable = std::integral_constant<bool, std::is_trivially_copyable<_DataType>::value // relocation can't throw
+                                    || std::is_nothrow_constructible<_DataType, decltype(std::move_if_noexcept(std::declval<_DataType&>()))>::value>;
+
       static constexpr inline size_t _getAllocSize(size_t length) noexcept { return ((length + 3) & ~(size_t)0x3); }
+      // geometric growth: new capacity for at least 'minSize' items
+      inline size_t _getGrowthSize(size_t minSize) const noexcept {
+        size_t allocSize = (this->_allocSize >= 4u)
+                         ? (this->_allocSize / 100u) * _GrowthFactorPercent + ((this->_allocSize % 100u) * _GrowthFactorPercent) / 100u
+                         : 4u;
+        return (allocSize >= minSize) ? allocSize : _getAllocSize(minSize);
+      }
+
+      // -- private - allocation --
+
+      inline uint8_t* _allocate(size_t allocSize) {
+        if (allocSize > (size_t)-1 / sizeof(_DataType))
+          throw std::bad_alloc{};
+#       ifdef __P_HAS_MEMORY_RESOURCE
+          if (this->_resource != nullptr)
+            return (uint8_t*)this->_resource->allocate(allocSize*sizeof(_DataType), alignof(_DataType));
+#       endif
+        uint8_t* buffer = (uint8_t*)malloc(allocSize*sizeof(_DataType));
+        if (buffer == nullptr)
+          throw std::bad_alloc{};
+        return buffer;
+      }
+      inline void _deallocate(uint8_t* buffer, size_t allocSize) noexcept {
+#       ifdef __P_HAS_MEMORY_RESOURCE
+          if (this->_resource != nullptr) {
+            this->_resource->deallocate((void*)buffer, allocSize*sizeof(_DataType), alignof(_DataType));
+            return;
+          }
+#       endif
+        (void)allocSize;
+        free(buffer);
+      }
+
+      // change capacity (and relocate items)
+      inline void _reallocate(size_t allocSize) {
+        _reallocate(allocSize, _IsRelocatable{});
+      }
+      inline void _reallocate(size_t allocSize, std::true_type) { // trivially copyable -> may grow in place
+#       ifdef __P_HAS_MEMORY_RESOURCE
+          if (this->_resource != nullptr) { // no realloc with memory resources
+            _reallocate(allocSize, std::false_type{});
+            return;
+          }
+#       endif
+        uint8_t* buffer = (allocSize <= (size_t)-1 / sizeof(_DataType)) ? (uint8_t*)realloc(this->_value, allocSize*sizeof(_DataType)) : nullptr;
+        if (buffer == nullptr)
+          throw std::bad_alloc{};
+        this->_value = buffer;
+        this->_allocSize = allocSize;
+      }
+      inline void _reallocate(size_t allocSize, std::false_type) {
+        uint8_t* buffer = _allocate(allocSize);
+        try {
+          _replaceBuffer(buffer, allocSize);
+        }
+        catch (...) { _deallocate(buffer, allocSize); throw; }
+      }
+      // relocate items to new buffer + release previous buffer (on exception: current buffer/items kept, new buffer must be released by caller)
+      inline void _replaceBuffer(uint8_t* buffer, size_t allocSize) noexcept(_IsNothrowRelocatable::value) {
+        if (this->_value != nullptr) {
+          _relocateData((_DataType*)buffer, (_DataType*)this->_value, this->_size);
+          _deallocate(this->_value, this->_allocSize);
+        }
+        this->_value = buffer;
+        this->_allocSize = allocSize;
+      }
+
+      // grow buffer and construct new last item (arguments may reference current items)
+      template <typename ... _Args>
+      inline void _growEmplaceBack(std::true_type, _Args&&... args) {
+        _DataType item(std::forward<_Args>(args)...); // construct before realloc (args may reference current buffer)
+        _reallocate(_getGrowthSize(this->_size + 1u), std::true_type{});
+        memcpy((void*)((_DataType*)this->_value + (intptr_t)this->_size), (const void*)&item, sizeof(_DataType));
+      }
+      template <typename ... _Args>
+      inline void _growEmplaceBack(std::false_type, _Args&&... args) {
+        size_t allocSize = _getGrowthSize(this->_size + 1u);
+        uint8_t* buffer = _allocate(allocSize);
+        try {
+          new((_DataType*)buffer + (intptr_t)this->_size) _DataType(std::forward<_Args>(args)...); // before relocation (args may reference items)
+        }
+        catch (...) { _deallocate(buffer, allocSize); throw; }
+        try {
+          _replaceBuffer(buffer, allocSize);
+        }
+        catch (...) {
+          _destroyOne((_DataType*)buffer + (intptr_t)this->_size);
+          _deallocate(buffer, allocSize);
+          throw;
+        }
+      }
+
+      // insert item at index (value not stored in vector)
+      void _insertMoved(uint32_t index, _DataType&& value) {
+        if (this->_size >= this->_allocSize) {
+          size_t allocSize = _getGrowthSize(this->_size + 1u);
+          uint8_t* buffer = _allocate(allocSize);
+          try {
+            new((_DataType*)buffer + (intptr_t)index) _DataType(std::move(value));
+          }
+          catch (...) { _deallocate(buffer, allocSize); throw; }
+          if (this->_value != nullptr) {
+            try {
+              _relocateData((_DataType*)buffer, (_DataType*)this->_value, this->_size, (size_t)index);
+            }
+            catch (...) {
+              _destroyOne((_DataType*)buffer + (intptr_t)index);
+              _deallocate(buffer, allocSize);
+              throw;
+            }
+            _deallocate(this->_value, this->_allocSize);
+          }
+          this->_value = buffer;
+          this->_allocSize = allocSize;
+        }
+        else if (index < this->_size) {
+          _shiftRight((_DataType*)this->_value, index, this->_size);
+          *((_DataType*)this->_value + (intptr_t)index) = std::move(value);
+        }
+        else
+          new((_DataType*)this->_value + (intptr_t)this->_size) _DataType(std::move(value));
+        ++_size;
+      }
+
+      // append range: known length -> max one reallocation
+      template <typename _Iterator>
+      void _appendRange(_Iterator first, _Iterator last, std::forward_iterator_tag) {
+        size_t length = (size_t)std::distance(first, last);
+        if (this->_size + length > this->_allocSize) { // new buffer: copy range before relocating current items (range may reference them)
+          size_t allocSize = _getGrowthSize(this->_size + length);
+          uint8_t* buffer = _allocate(allocSize);
+          _DataType* rangeBegin = (_DataType*)buffer + (intptr_t)this->_size;
+          _DataType* it = rangeBegin;
+          try {
+            for (; first != last; ++first, ++it)
+              new(it) _DataType(*first);
+            _replaceBuffer(buffer, allocSize);
+          }
+          catch (...) {
+            _destroy(rangeBegin, (size_t)(it - rangeBegin));
+            _deallocate(buffer, allocSize);
+            throw;
+          }
+          this->_size += length;
+        }
+        else {
+          for (; first != last; ++first, ++(this->_size))
+            new((_DataType*)this->_value + (intptr_t)this->_size) _DataType(*first);
+        }
+      }
+      // append range: unknown length -> geometric growth
+      template <typename _Iterator>
+      inline void _appendRange(_Iterator first, _Iterator last, std::input_iterator_tag) {
+        for (; first != last; ++first)
+          emplace_back(*first);
+      }
 
       // -- private - class item types --
 
@@ -232,11 +430,47 @@ namespace pandora {
         for (const _DataType* lhsEnd = lhs + (intptr_t)length; lhs < lhsEnd; ++lhs, ++rhs)
           new(lhs) _DataType(*rhs);
       }
+      // move items to other buffer (copied if their move constructor may throw: on exception, copies destroyed and source items intact)
       template <typename T = _DataType>
       static inline void _constructMoveData(typename std::enable_if<std::is_class<T>::value
-                                            && std::is_move_constructible<T>::value, _DataType*>::type lhs, _DataType* rhs, size_t length) noexcept {
-        for (const _DataType* lhsEnd = lhs + (intptr_t)length; lhs < lhsEnd; ++lhs, ++rhs)
-          new(lhs) _DataType(*rhs);
+                                            && std::is_move_constructible<T>::value, _DataType*>::type lhs, _DataType* rhs, size_t length)
+                                            noexcept(_IsNothrowRelocatable::value) {
+        _DataType* first = lhs;
+        try {
+          for (const _DataType* lhsEnd = lhs + (intptr_t)length; lhs < lhsEnd; ++lhs, ++rhs)
+            new(lhs) _DataType(std::move_if_noexcept(*rhs));
+        }
+        catch (...) { _destroy(first, (size_t)(lhs - first)); throw; }
+      }
+      // move items to other buffer + destroy source items (on exception: source items intact)
+      template <typename T = _DataType>
+      static inline void _relocateData(typename std::enable_if<!std::is_trivially_copyable<T>::value, _DataType*>::type lhs,
+                                       _DataType* rhs, size_t length) noexcept(_IsNothrowRelocatable::value) {
+        _constructMoveData(lhs, rhs, length);
+        _destroy(rhs, length);
+      }
+      template <typename T = _DataType>
+      static inline void _relocateData(typename std::enable_if<std::is_trivially_copyable<T>::value, _DataType*>::type lhs,
+                                       _DataType* rhs, size_t length) noexcept {
+        if (length > 0)
+          memcpy((void*)lhs, (const void*)rhs, length*sizeof(_DataType));
+      }
+      // move items to other buffer, with a gap at 'gapIndex' + destroy source items (on exception: source items intact)
+      template <typename T = _DataType>
+      static inline void _relocateData(typename std::enable_if<!std::is_trivially_copyable<T>::value, _DataType*>::type lhs,
+                                       _DataType* rhs, size_t length, size_t gapIndex) noexcept(_IsNothrowRelocatable::value) {
+        _constructMoveData(lhs, rhs, gapIndex);
+        try {
+          _constructMoveData(lhs + (intptr_t)gapIndex + (intptr_t)1, rhs + (intptr_t)gapIndex, length - gapIndex);
+        }
+        catch (...) { _destroy(lhs, gapIndex); throw; }
+        _destroy(rhs, length);
+      }
+      template <typename T = _DataType>
+      static inline void _relocateData(typename std::enable_if<std::is_trivially_copyable<T>::value, _DataType*>::type lhs,
+                                       _DataType* rhs, size_t length, size_t gapIndex) noexcept {
+        _relocateData(lhs, rhs, gapIndex);
+        _relocateData(lhs + (intptr_t)gapIndex + (intptr_t)1, rhs + (intptr_t)gapIndex, length - gapIndex);
       }
 
       template <typename T = _DataType>
@@ -327,6 +561,9 @@ namespace pandora {
       uint8_t* _value = nullptr;
       size_t _size = 0u;
       size_t _allocSize = 0u;
+#     ifdef __P_HAS_MEMORY_RESOURCE
+        std::pmr::memory_resource* _resource = nullptr; // NULL: malloc/realloc/free
+#     endif
     };
   }
 }
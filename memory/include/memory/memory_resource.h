@@ -0,0 +1,215 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "./_private/_memory_resource_config.h"
+
+#ifdef __P_HAS_MEMORY_RESOURCE
+# include <type_traits>
+# include "./memory_pool.h"
+# include "./arena_allocator.h"
+# include "./object_pool.h"
+# include "./slab_allocator.h"
+
+  namespace pandora {
+    namespace memory {
+      /// @class MonotonicPoolResource
+      /// @brief Monotonic memory resource (arena) using a pre-allocated MemoryPool as initial buffer.
+      /// @description Allocations are carved from the pool (bump pointer), then from the upstream resource when the pool is full.
+      ///              Releasing individual allocations has no effect: all memory is reclaimed at once with 'release()' (or on destruction).
+      ///              Typically used to build a whole document/frame in one arena (containers with a memory resource), then drop it in one shot.
+      /// @remarks Not thread-safe.
+      template <size_t _BytesCapacity,                                          ///< Size of pre-allocated pool
+                MemoryPoolAllocation _Alloc = MemoryPoolAllocation::automatic> ///< Allocation type of pool: automatic/onHeap recommended
+      class MonotonicPoolResource final : public std::pmr::memory_resource {
+      public:
+        using Type = MonotonicPoolResource<_BytesCapacity,_Alloc>;
+        using pool_type = MemoryPool<_BytesCapacity, size_t{ 0 }, _Alloc, false>;
+
+        /// @brief Create arena resource (upstream: used when pool is full)
+        MonotonicPoolResource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+          : _pool(), _arena((void*)_pool.get(), _BytesCapacity, upstream) {}
+        ~MonotonicPoolResource() noexcept override = default;
+
+        MonotonicPoolResource(const Type&) = delete;
+        MonotonicPoolResource(Type&&) = delete;
+        Type& operator=(const Type&) = delete;
+        Type& operator=(Type&&) = delete;
+
+        static constexpr inline size_t capacity() noexcept { return _BytesCapacity; } ///< Size of pre-allocated pool (bytes)
+        inline std::pmr::memory_resource* upstream_resource() const noexcept { return this->_arena.upstream_resource(); } ///< Resource used when pool is full
+
+        /// @brief Release all allocations at once (pool reused for next allocations, upstream buffers released)
+        /// @warning Objects allocated in the arena must not be used anymore (their memory is reused).
+        inline void release() noexcept { this->_arena.release(); }
+
+      protected:
+        void* do_allocate(size_t bytes, size_t alignment) override { return this->_arena.allocate(bytes, alignment); }
+        void do_deallocate(void*, size_t, size_t) override {} // monotonic: memory only reclaimed on release
+        bool do_is_equal(const std::pmr::memory_resource& rhs) const noexcept override { return (this == &rhs); }
+
+      private:
+        pool_type _pool;
+        std::pmr::monotonic_buffer_resource _arena;
+      };
+
+      // ---
+
+      /// @class ArenaResource
+      /// @brief Memory resource using an existing ArenaAllocator (bump pointer).
+      /// @description Releasing individual allocations has no effect: memory is reclaimed by the owner of the arena
+      ///              ('reset', 'rollback', ArenaAllocator::Scope), typically at the end of a request/frame.
+      ///              Useful to give per-request scratch memory to standard containers (or LightVector/LightString...).
+      /// @remarks Not thread-safe (same as the arena).
+      template <size_t _ChunkSize = size_t{ 64u*1024u }> ///< Chunk size of arena (see ArenaAllocator)
+      class ArenaResource final : public std::pmr::memory_resource {
+      public:
+        using Type = ArenaResource<_ChunkSize>;
+        using arena_type = ArenaAllocator<_ChunkSize>;
+
+        /// @brief Create resource using an arena (must outlive the resource)
+        explicit ArenaResource(arena_type& arena) noexcept : _arena(&arena) {}
+        ~ArenaResource() noexcept override = default;
+
+        ArenaResource(const Type&) = delete;
+        ArenaResource(Type&&) = delete;
+        Type& operator=(const Type&) = delete;
+        Type& operator=(Type&&) = delete;
+
+        inline arena_type& arena() const noexcept { return *(this->_arena); } ///< Arena used for allocations
+
+      protected:
+        void* do_allocate(size_t bytes, size_t alignment) override { return this->_arena->allocate(bytes, alignment); }
+        void do_deallocate(void*, size_t, size_t) override {} // monotonic: memory only reclaimed by arena owner
+        bool do_is_equal(const std::pmr::memory_resource& rhs) const noexcept override { return (this == &rhs); }
+
+      private:
+        arena_type* _arena = nullptr;
+      };
+
+      // ---
+
+      /// @class FixedPoolResource
+      /// @brief Memory resource with fixed-size blocks pre-allocated in a MemoryPool (ObjectPool) - no allocation after construction.
+      /// @description Allocations up to '_BlockSize' bytes use free blocks of the pool (O(1) allocation/release).
+      ///              Bigger allocations, over-aligned allocations and allocations when the pool is full use the upstream resource.
+      ///              Typically used for node-based containers (lists, maps) with nodes of similar sizes.
+      /// @remarks Not thread-safe.
+      template <size_t _BlockSize,                                              ///< Max size of allocations served by the pool
+                size_t _BlockCount,                                             ///< Number of pre-allocated blocks
+                MemoryPoolAllocation _Alloc = MemoryPoolAllocation::automatic> ///< Allocation type of pool: automatic/onHeap recommended
+      class FixedPoolResource final : public std::pmr::memory_resource {
+      public:
+        using Type = FixedPoolResource<_BlockSize,_BlockCount,_Alloc>;
+        using block_type = typename std::aligned_storage<_BlockSize, alignof(std::max_align_t)>::type;
+        using pool_type = ObjectPool<block_type, _BlockCount, size_t{ 0 }, _Alloc, false>;
+
+        /// @brief Create pool resource (upstream: used for bigger allocations or when pool is full)
+        FixedPoolResource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) noexcept
+          : _upstream(upstream) {}
+        ~FixedPoolResource() noexcept override = default;
+
+        FixedPoolResource(const Type&) = delete;
+        FixedPoolResource(Type&&) = delete;
+        Type& operator=(const Type&) = delete;
+        Type& operator=(Type&&) = delete;
+
+        static constexpr inline size_t blockSize() noexcept { return _BlockSize; }   ///< Max size of allocations served by the pool
+        static constexpr inline size_t capacity() noexcept { return _BlockCount; }   ///< Number of pre-allocated blocks
+        inline size_t size() const noexcept { return this->_pool.size(); }           ///< Number of blocks currently allocated from the pool
+        inline std::pmr::memory_resource* upstream_resource() const noexcept { return this->_upstream; } ///< Resource used for other allocations
+
+      protected:
+        void* do_allocate(size_t bytes, size_t alignment) override {
+          if (bytes <= _BlockSize && alignment <= alignof(block_type)) {
+            void* block = this->_pool.allocate();
+            if (block != nullptr)
+              return block;
+          }
+          return this->_upstream->allocate(bytes, alignment);
+        }
+        void do_deallocate(void* block, size_t bytes, size_t alignment) override {
+          if (this->_pool.contains(block))
+            this->_pool.deallocate(block);
+          else
+            this->_upstream->deallocate(block, bytes, alignment);
+        }
+        bool do_is_equal(const std::pmr::memory_resource& rhs) const noexcept override { return (this == &rhs); }
+
+      private:
+        pool_type _pool;
+        std::pmr::memory_resource* _upstream = nullptr;
+      };
+
+      // ---
+
+      /// @class SynchronizedPoolResource
+      /// @brief Thread-safe memory resource for small objects, using a SlabAllocator (size classes + thread caches).
+      /// @description Allocations/releases may be done from any thread (ex: containers built by a thread and destroyed by another).
+      ///              Allocations above 1024 bytes use malloc, over-aligned allocations (above 16 bytes) use the upstream resource.
+      template <uint32_t _MagazineSize = 64u,                 ///< Max number of free blocks in each magazine (see SlabAllocator)
+                size_t _ChunkSize = size_t{ 1024u*1024u }>    ///< Size of chunks allocated from the system (see SlabAllocator)
+      class SynchronizedPoolResource final : public std::pmr::memory_resource {
+      public:
+        using Type = SynchronizedPoolResource<_MagazineSize,_ChunkSize>;
+        using allocator_type = SlabAllocator<_MagazineSize,_ChunkSize>;
+
+        /// @brief Create pool resource (upstream: used for over-aligned allocations)
+        SynchronizedPoolResource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+          : _upstream(upstream) {}
+        ~SynchronizedPoolResource() noexcept override = default;
+
+        SynchronizedPoolResource(const Type&) = delete;
+        SynchronizedPoolResource(Type&&) = delete;
+        Type& operator=(const Type&) = delete;
+        Type& operator=(Type&&) = delete;
+
+        inline SlabAllocatorStats stats() const { return this->_allocator.stats(); } ///< Get statistics of allocator
+        inline std::pmr::memory_resource* upstream_resource() const noexcept { return this->_upstream; } ///< Resource used for over-aligned allocations
+
+      protected:
+        void* do_allocate(size_t bytes, size_t alignment) override {
+          if (alignment > _maxAlignment)
+            return this->_upstream->allocate(bytes, alignment);
+          return this->_allocator.allocate(_getAlignedSize(bytes, alignment));
+        }
+        void do_deallocate(void* block, size_t bytes, size_t alignment) override {
+          if (alignment > _maxAlignment)
+            this->_upstream->deallocate(block, bytes, alignment);
+          else
+            this->_allocator.deallocate(block, _getAlignedSize(bytes, alignment));
+        }
+        bool do_is_equal(const std::pmr::memory_resource& rhs) const noexcept override { return (this == &rhs); }
+
+      private:
+        static constexpr size_t _maxAlignment = 16u; // alignment of slab blocks (and malloc)
+        // 8-byte blocks are only aligned on 8 bytes -> use 16-byte blocks for 16-byte alignment
+        static constexpr inline size_t _getAlignedSize(size_t bytes, size_t alignment) noexcept {
+          return (bytes == 0) ? 1u : ((alignment > 8u && bytes < alignment) ? alignment : bytes);
+        }
+
+      private:
+        allocator_type _allocator;
+        std::pmr::memory_resource* _upstream = nullptr;
+      };
+    }
+  }
+#endif
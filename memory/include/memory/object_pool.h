@@ -0,0 +1,267 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <cstring>
+#include <array>
+#include <new>
+#include <type_traits>
+#include "./memory_pool.h"
+
+namespace pandora {
+  namespace memory {
+    /// @class ObjectPool
+    /// @brief Fixed-block allocator for objects of one type, built over a MemoryPool (stack or heap, pre-allocated).
+    /// @description Allocation/release of a block in O(1), with an intrusive free list (index of next free block stored in each free block).
+    ///              No dynamic allocation after construction: appropriate for real-time processing (ex: message handling).
+    ///              Optional tracking mode (_TrackObjects): bitmap of live objects, to iterate on them (forEach),
+    ///              to detect invalid releases (debug) and to destroy remaining objects automatically.
+    /// @remarks - Guard bands (_GuardBandSize > 0): each block is surrounded by guard bands (filled with a known pattern),
+    ///            verified when a block is released (debug assertion) or on demand (verifyGuardBands), to detect buffer overflows.
+    ///          - Not thread-safe: use one pool per thread, or external locking.
+    /// @warning Without tracking mode, objects still allocated when the pool is destroyed/cleared are NOT destroyed.
+    template <typename _DataType,
+              size_t _Capacity,                    ///< Max number of objects in pool
+              size_t _GuardBandSize = size_t{ 0 }, ///< Size of each security guard band (before/after each block)
+              MemoryPoolAllocation _Alloc = MemoryPoolAllocation::automatic, ///< Allocation type: automatic/onHeap recommended
+              bool _TrackObjects = false>          ///< Bitmap of live objects (for iteration/verification)
+    class ObjectPool final {
+    public:
+      using value_type = _DataType;
+      using size_type = size_t;
+      using Type = ObjectPool<_DataType,_Capacity,_GuardBandSize,_Alloc,_TrackObjects>;
+      static_assert(_Capacity > 0u, "ObjectPool: _Capacity must be above 0.");
+      static_assert(_Capacity < size_t{ 0xFFFFFFFFu }, "ObjectPool: _Capacity must be below UINT32_MAX.");
+      static_assert(alignof(_DataType) <= alignof(std::max_align_t), "ObjectPool: over-aligned types not supported.");
+
+    private:
+      static constexpr size_t _AlignedGuardSize = ((_GuardBandSize + alignof(_DataType) - 1u) / alignof(_DataType)) * alignof(_DataType);
+      static constexpr size_t _AlignedObjectSize = (((sizeof(_DataType) >= sizeof(uint32_t)) ? sizeof(_DataType) : sizeof(uint32_t))
+                                                    + alignof(_DataType) - 1u) / alignof(_DataType) * alignof(_DataType);
+    public:
+      using pool_type = MemoryPool<_Capacity*(_AlignedGuardSize + _AlignedObjectSize) + _AlignedGuardSize, // + guard band after last block
+                                   size_t{ 0 }, _Alloc, false>;
+
+      static constexpr inline size_t guardSize() noexcept { return _AlignedGuardSize; }   ///< Size of each guard band (aligned)
+      static constexpr inline size_t objectSize() noexcept { return _AlignedObjectSize; } ///< Size of each object slot (at least size of a free list index)
+      static constexpr inline size_t blockSize() noexcept { return _AlignedGuardSize + _AlignedObjectSize; } ///< Size of each block (guard band + object)
+      static constexpr uint8_t guardPattern = 0xFDu; ///< Value of guard band bytes
+
+      /// @brief Create pool: all blocks are free
+      ObjectPool() { _reset(); }
+      /// @brief Destroy pool (and remaining objects in tracking mode)
+      ~ObjectPool() noexcept { _destroyTrackedObjects(); }
+
+      ObjectPool(const Type&) = delete;
+      ObjectPool(Type&&) = delete; // not movable: allocated objects are referenced by address
+      Type& operator=(const Type&) = delete;
+      Type& operator=(Type&&) = delete;
+
+      // -- pool metadata --
+
+      static constexpr inline size_t capacity() noexcept { return _Capacity; } ///< Max number of objects
+      static constexpr inline MemoryPoolAllocation allocationType() noexcept { return pool_type::allocationType(); } ///< Actual allocation type
+      static constexpr inline bool isTracking() noexcept { return _TrackObjects; } ///< Bitmap of live objects available
+
+      inline size_t size() const noexcept { return this->_size; }                  ///< Number of allocated blocks
+      inline bool empty() const noexcept { return (this->_size == 0); }            ///< No allocated block
+      inline bool full() const noexcept { return (this->_freeHead == _endIndex()); } ///< No free block left
+
+      /// @brief Verify if an address is the beginning of a block of current pool
+      bool contains(const void* block) const noexcept {
+        const uint8_t* position = static_cast<const uint8_t*>(block);
+        const uint8_t* first = this->_pool.get() + guardSize();
+        return (position >= first && position < first + _Capacity*blockSize() && (size_t)(position - first) % blockSize() == 0);
+      }
+      /// @brief Get index of a block of current pool
+      inline size_t indexOf(const void* block) const noexcept {
+        assert(contains(block));
+        return (size_t)(static_cast<const uint8_t*>(block) - (this->_pool.get() + guardSize())) / blockSize();
+      }
+
+      // -- allocation --
+
+      /// @brief Reserve a free block (uninitialized memory of size 'objectSize()')
+      /// @returns Address of block (or nullptr if the pool is full)
+      void* allocate() noexcept {
+        if (this->_freeHead == _endIndex())
+          return nullptr;
+
+        uint32_t index = this->_freeHead;
+        void* block = _blockAt(index);
+        memcpy((void*)&(this->_freeHead), block, sizeof(uint32_t)); // pop from free list
+        _trackBlock(index, true);
+        ++(this->_size);
+        return block;
+      }
+      /// @brief Release a block reserved with 'allocate' (no destructor called)
+      /// @warning The block must belong to the pool (see 'contains') and must not already be free.
+      void deallocate(void* block) noexcept {
+        assert(block != nullptr && contains(block));
+        uint32_t index = static_cast<uint32_t>(indexOf(block));
+        assert(_isBlockTracked(index)); // debug: detect double release (tracking mode)
+        assert(_verifyBlockGuardBands(index)); // debug: detect overflows (guard bands)
+
+        memcpy(block, (const void*)&(this->_freeHead), sizeof(uint32_t)); // push to free list
+        this->_freeHead = index;
+        _trackBlock(index, false);
+        --(this->_size);
+      }
+
+      /// @brief Allocate and construct an object in place
+      /// @returns Address of new object (or nullptr if the pool is full)
+      template <typename ... _Args>
+      _DataType* create(_Args&&... args) {
+        void* block = allocate();
+        if (block != nullptr) {
+          try {
+            return new(block) _DataType(std::forward<_Args>(args)...);
+          }
+          catch (...) { deallocate(block); throw; }
+        }
+        return nullptr;
+      }
+      /// @brief Destroy and release an object created with 'create'
+      inline void destroy(_DataType* object) noexcept {
+        if (object != nullptr) {
+          object->~_DataType();
+          deallocate((void*)object);
+        }
+      }
+
+      /// @brief Release all blocks (objects destroyed in tracking mode)
+      /// @warning Without tracking mode, the destructors of remaining objects are NOT called.
+      inline void clear() noexcept {
+        _destroyTrackedObjects();
+        _reset();
+      }
+
+      // -- tracking mode --
+
+      /// @brief Verify if a block is currently allocated (tracking mode only)
+      template <bool _Tracking = _TrackObjects, typename std::enable_if<_Tracking,int>::type = 0>
+      inline bool isAllocated(size_t index) const noexcept {
+        return (index < _Capacity && (this->_liveBlocks[index >> 6] & (uint64_t{ 1u } << (index & 0x3Fu))) != 0);
+      }
+      /// @brief Call an operation for each live object, in block order (tracking mode only)
+      /// @remarks The operation may destroy the current object, but must not create new ones.
+      template <typename _Operation, bool _Tracking = _TrackObjects, typename std::enable_if<_Tracking,int>::type = 0>
+      void forEach(_Operation&& operation) {
+        for (size_t w = 0; w < this->_liveBlocks.size(); ++w) {
+          for (uint64_t word = this->_liveBlocks[w]; word != 0; word &= (word - 1u)) { // clear lowest bit after each object
+            size_t index = (w << 6) + _lowestBitIndex(word);
+            operation(*static_cast<_DataType*>(_blockAt(static_cast<uint32_t>(index))));
+          }
+        }
+      }
+
+      // -- guard bands --
+
+      /// @brief Verify that all guard bands are intact (always true if _GuardBandSize is 0)
+      bool verifyGuardBands() const noexcept {
+        for (uint32_t index = 0; index < static_cast<uint32_t>(_Capacity); ++index) {
+          if (!_verifyBlockGuardBands(index))
+            return false;
+        }
+        return true;
+      }
+      /// @brief Verify that the guard bands around a block are intact (always true if _GuardBandSize is 0)
+      inline bool verifyGuardBands(const void* block) const noexcept {
+        return (contains(block) && _verifyBlockGuardBands(static_cast<uint32_t>(indexOf(block))));
+      }
+
+    private:
+      static constexpr inline uint32_t _endIndex() noexcept { return static_cast<uint32_t>(_Capacity); }
+      static inline uint32_t _lowestBitIndex(uint64_t word) noexcept {
+        uint32_t index = 0;
+        for (; (word & 0xFFu) == 0; word >>= 8)
+          index += 8u;
+        for (; (word & 0x1u) == 0; word >>= 1)
+          ++index;
+        return index;
+      }
+
+      inline void* _blockAt(uint32_t index) noexcept { return (void*)(this->_pool.get() + (size_t)index*blockSize() + guardSize()); }
+      inline const void* _blockAt(uint32_t index) const noexcept { return (const void*)(this->_pool.get() + (size_t)index*blockSize() + guardSize()); }
+
+      // build free list (ascending order) + fill guard bands
+      void _reset() noexcept {
+        for (uint32_t index = 0; index < static_cast<uint32_t>(_Capacity); ++index) {
+          uint32_t next = index + 1u;
+          memcpy(_blockAt(index), (const void*)&next, sizeof(uint32_t));
+        }
+        this->_freeHead = 0;
+        this->_size = 0;
+        _resetTracking();
+
+        if (guardSize() > 0u) {
+          for (size_t index = 0; index <= _Capacity; ++index) // one guard band before each block + one after last block
+            memset((void*)(this->_pool.get() + index*blockSize()), guardPattern, guardSize());
+        }
+      }
+
+      bool _verifyBlockGuardBands(uint32_t index) const noexcept {
+        if (guardSize() > 0u) {
+          const uint8_t* before = this->_pool.get() + (size_t)index*blockSize();
+          const uint8_t* after = before + blockSize();
+          for (size_t i = 0; i < guardSize(); ++i) {
+            if (before[i] != guardPattern || after[i] != guardPattern)
+              return false;
+          }
+        }
+        return true;
+      }
+
+      // -- tracking bitmap --
+
+      inline void _resetTracking() noexcept {
+        for (auto& word : this->_liveBlocks)
+          word = 0;
+      }
+      inline void _trackBlock(uint32_t index, bool isAllocated) noexcept {
+        if (_TrackObjects) {
+          if (isAllocated)
+            this->_liveBlocks[index >> 6] |= (uint64_t{ 1u } << (index & 0x3Fu));
+          else
+            this->_liveBlocks[index >> 6] &= ~(uint64_t{ 1u } << (index & 0x3Fu));
+        }
+      }
+      inline bool _isBlockTracked(uint32_t index) const noexcept {
+        return (!_TrackObjects || (this->_liveBlocks[index >> 6] & (uint64_t{ 1u } << (index & 0x3Fu))) != 0);
+      }
+      inline void _destroyTrackedObjects() noexcept {
+        if (_TrackObjects && !std::is_trivially_destructible<_DataType>::value) {
+          for (size_t w = 0; w < this->_liveBlocks.size(); ++w) {
+            for (uint64_t word = this->_liveBlocks[w]; word != 0; word &= (word - 1u))
+              static_cast<_DataType*>(_blockAt(static_cast<uint32_t>((w << 6) + _lowestBitIndex(word))))->~_DataType();
+          }
+        }
+      }
+
+    private:
+      alignas(std::max_align_t) pool_type _pool; // stack pool: no guard band before data -> aligned blocks
+      uint32_t _freeHead = 0; // index of first free block (_Capacity: no free block)
+      size_t _size = 0;
+      std::array<uint64_t, (_TrackObjects ? (_Capacity + 63u)/64u : 0u)> _liveBlocks;
+    };
+  }
+}
@@ -0,0 +1,551 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cassert>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+#include "./memory_pool.h"
+
+namespace pandora {
+  namespace memory {
+    /// @brief Statistics of a slab allocator (snapshot)
+    struct SlabAllocatorStats final {
+      uint64_t allocations = 0;      ///< Number of small block allocations (since creation)
+      uint64_t cacheHits = 0;        ///< Number of small block allocations served by a thread cache (no lock)
+      uint64_t largeAllocations = 0; ///< Number of allocations above max block size (forwarded to malloc)
+      uint64_t bytesInUse = 0;       ///< Size of small blocks currently allocated (bytes)
+      uint64_t bytesReserved = 0;    ///< Size of memory chunks reserved by the allocator (bytes)
+      uint64_t uncachedReleases = 0; ///< Number of small block releases without thread cache/magazine (out of memory, thread exit): stored in depot free list
+
+      /// @brief Ratio of small block allocations served by a thread cache (0.0 - 1.0)
+      inline double cacheHitRate() const noexcept {
+        return (this->allocations > 0) ? static_cast<double>(this->cacheHits) / static_cast<double>(this->allocations) : 0.0;
+      }
+      /// @brief Ratio of reserved memory not used by allocated blocks (0.0 - 1.0): cached blocks, unused slab space, rounding to size classes
+      inline double fragmentation() const noexcept {
+        return (this->bytesReserved > 0 && this->bytesInUse <= this->bytesReserved)
+               ? 1.0 - static_cast<double>(this->bytesInUse) / static_cast<double>(this->bytesReserved) : 0.0;
+      }
+    };
+
+    // ---
+
+    /// @class SlabAllocator
+    /// @brief General-purpose thread-safe allocator for small objects (8 - 1024 bytes), optimized for multithreaded churn.
+    /// @description - Size classes: requested sizes are rounded up to one of 21 block sizes (8, 16-128 by 16, then 4 classes per power of 2).
+    ///              - Slabs: blocks of a size class are carved from slabs (64 KB), themselves carved from large pre-allocated chunks (MemoryPool).
+    ///              - Thread caches: each thread owns 2 magazines (arrays of free blocks) per size class: allocations/releases
+    ///                are served by the cache of the current thread without any lock (cache hit).
+    ///              - Depot: full/empty magazines are exchanged with a global depot (per size class), one magazine at a time
+    ///                (batched transfer of '_MagazineSize' blocks).
+    ///              Blocks may be released by any thread (ex: producer/consumer): they're stored in the cache of the releasing
+    ///              thread, and full magazines are pushed to the depot with lock-free stacks (release path: no lock).
+    ///              Loading a full magazine or carving new blocks (allocation cache miss) locks the depot of the size class.
+    /// @remarks - Blocks of 16 bytes or more are aligned on 16 bytes (8-byte blocks: aligned on 8 bytes).
+    ///          - Sized release: 'deallocate' must receive the size used for allocation (similar to std::allocator).
+    ///          - Memory is never returned to the system before the allocator is destroyed (and the caches of all threads that used it too).
+    ///          - Thread caches are released when their thread exits (or with 'flushThreadCache').
+    ///            Allocations/releases without thread cache (during thread exit, or if the cache can't be created) use the depot directly.
+    template <uint32_t _MagazineSize = 64u,              ///< Max number of free blocks in each magazine
+              size_t _ChunkSize = size_t{ 1024u*1024u }> ///< Size of chunks allocated from the system (bytes)
+    class SlabAllocator final {
+    public:
+      using Type = SlabAllocator<_MagazineSize,_ChunkSize>;
+      using chunk_type = MemoryPool<_ChunkSize, size_t{ 0 }, MemoryPoolAllocation::onHeap, false>;
+
+    private:
+      static constexpr size_t _MaxBlockSize = 1024u;
+      static constexpr size_t _SizeClassCount = 21u;
+      static constexpr size_t _SlabSize = 64u*1024u;
+    public:
+      static_assert(_MagazineSize > 0u, "SlabAllocator: _MagazineSize must be above 0.");
+      static_assert(_ChunkSize >= _SlabSize && (_ChunkSize % _SlabSize) == 0, "SlabAllocator: _ChunkSize must be a multiple of 64 KB.");
+
+      static constexpr inline size_t maxBlockSize() noexcept { return _MaxBlockSize; }     ///< Max size of blocks managed by size classes (bigger: malloc)
+      static constexpr inline size_t sizeClassCount() noexcept { return _SizeClassCount; } ///< Number of size classes
+      static constexpr inline size_t slabSize() noexcept { return _SlabSize; }             ///< Size of each slab (carved from chunks)
+
+      SlabAllocator() : _state(std::make_shared<_SharedState>()) {}
+      ~SlabAllocator() = default; // memory released when all thread caches of the allocator are released
+
+      SlabAllocator(const Type&) = delete;
+      SlabAllocator(Type&&) = delete;
+      Type& operator=(const Type&) = delete;
+      Type& operator=(Type&&) = delete;
+
+      // -- size classes --
+
+      /// @brief Get index of the size class used for a size (size must be in range 1 - _MaxBlockSize)
+      static inline size_t sizeClass(size_t size) noexcept {
+        assert(size > 0 && size <= _MaxBlockSize);
+        if (size <= 128u)
+          return (size <= 8u) ? 0 : (size + 15u) >> 4; // 8, 16, 32, 48, ... 128
+        size_t highBit = 7u;
+        while (((size - 1u) >> (highBit + 1u)) != 0)
+          ++highBit;
+        return 9u + (highBit - 7u)*4u + (((size - 1u) - (size_t{ 1u } << highBit)) >> (highBit - 2u)); // 4 classes per power of 2
+      }
+      /// @brief Get size of the blocks of a size class
+      static inline size_t blockSize(size_t sizeClassIndex) noexcept {
+        assert(sizeClassIndex < _SizeClassCount);
+        if (sizeClassIndex <= 8u)
+          return (sizeClassIndex == 0) ? 8u : sizeClassIndex*16u;
+        size_t base = size_t{ 128u } << ((sizeClassIndex - 9u) / 4u);
+        return base + (((sizeClassIndex - 9u) % 4u) + 1u)*(base / 4u);
+      }
+
+      // -- allocation --
+
+      /// @brief Allocate a memory block of (at least) 'size' bytes
+      /// @returns Address of block (or nullptr if 'size' is 0)
+      /// @throws std::bad_alloc if the system is out of memory
+      void* allocate(size_t size) {
+        if (size == 0)
+          return nullptr;
+        _ThreadCache* cache = _threadCache();
+        if (size > _MaxBlockSize) {
+          void* block = malloc(size);
+          if (block == nullptr)
+            throw std::bad_alloc{};
+          if (cache != nullptr)
+            _increment(cache->largeAllocations, 1u);
+          else
+            this->_state->uncachedLargeAllocations.fetch_add(1u, std::memory_order_relaxed);
+          return block;
+        }
+
+        size_t classIndex = sizeClass(size);
+        if (cache == nullptr) // no thread cache (thread exit / out of memory) -> depot
+          return this->_state->allocateUncached(classIndex);
+        _ClassCache& classCache = cache->classes[classIndex];
+        if (classCache.loaded == nullptr || classCache.loaded->count == 0) {
+          if (classCache.previous != nullptr && classCache.previous->count > 0)
+            std::swap(classCache.loaded, classCache.previous);
+          else { // cache miss -> depot/slab
+            this->_state->refill(classIndex, classCache);
+            _increment(classCache.misses, 1u);
+          }
+        }
+        _increment(classCache.allocations, 1u);
+        return classCache.loaded->blocks[--(classCache.loaded->count)];
+      }
+
+      /// @brief Release a memory block (from any thread)
+      /// @warning 'size' must be the value used for allocation.
+      void deallocate(void* block, size_t size) noexcept {
+        if (block == nullptr)
+          return;
+        if (size > _MaxBlockSize) {
+          free(block);
+          return;
+        }
+
+        size_t classIndex = sizeClass(size);
+        _ThreadCache* cache = _threadCache();
+        if (cache == nullptr) { // no thread cache (thread exit / out of memory) -> depot free list
+          this->_state->releaseUncached(classIndex, block);
+          return;
+        }
+        _ClassCache& classCache = cache->classes[classIndex];
+        if (classCache.loaded == nullptr || classCache.loaded->count >= _MagazineSize) {
+          if (classCache.previous != nullptr && classCache.previous->count < _MagazineSize)
+            std::swap(classCache.loaded, classCache.previous);
+          else if (!this->_state->exchangeFull(classIndex, classCache)) { // full magazines -> depot
+            this->_state->releaseUncached(classIndex, block); // out of memory for new magazine: block kept in depot free list
+            return;
+          }
+        }
+        classCache.loaded->blocks[(classCache.loaded->count)++] = block;
+        _increment(classCache.releases, 1u);
+      }
+
+      /// @brief Return the cached blocks of current thread to the depot (to make them available to other threads)
+      inline void flushThreadCache() noexcept {
+        _ThreadCache* cache = _threadCache();
+        if (cache != nullptr)
+          cache->flush();
+      }
+
+      // -- statistics --
+
+      /// @brief Get current statistics (all threads)
+      SlabAllocatorStats stats() const {
+        SlabAllocatorStats result;
+        {
+          std::lock_guard<std::mutex> guard(this->_state->registryLock);
+          result.largeAllocations = this->_state->retiredLargeAllocations
+                                  + this->_state->uncachedLargeAllocations.load(std::memory_order_relaxed);
+          for (const _ThreadCache* cache : this->_state->caches)
+            result.largeAllocations += cache->largeAllocations.load(std::memory_order_relaxed);
+
+          for (size_t classIndex = 0; classIndex < _SizeClassCount; ++classIndex) {
+            _ClassCounters total;
+            _addCounters(this->_state->retiredCounters[classIndex], total);
+            for (const _ThreadCache* cache : this->_state->caches)
+              _addCounters(cache->classes[classIndex], total);
+
+            const _Depot& depot = this->_state->depots[classIndex];
+            uint64_t uncachedAllocations = depot.uncachedAllocations.load(std::memory_order_relaxed);
+            uint64_t uncachedReleases = depot.uncachedReleases.load(std::memory_order_relaxed);
+            uint64_t allocations = total.allocations.load(std::memory_order_relaxed);
+            result.allocations += allocations + uncachedAllocations;
+            result.cacheHits += allocations - total.misses.load(std::memory_order_relaxed);
+            result.uncachedReleases += uncachedReleases;
+            result.bytesInUse += (allocations + uncachedAllocations                         // blocks may be released by other threads:
+                                  - total.releases.load(std::memory_order_relaxed) - uncachedReleases) // only the total is meaningful
+                               * static_cast<uint64_t>(blockSize(classIndex));
+          }
+        }
+        {
+          std::lock_guard<std::mutex> guard(this->_state->chunkLock);
+          result.bytesReserved = static_cast<uint64_t>(this->_state->chunks.size()) * _ChunkSize;
+        }
+        return result;
+      }
+
+    private:
+      struct _Magazine final {
+        _Magazine* next = nullptr; // next magazine in depot stack
+        uint32_t count = 0;
+        void* blocks[_MagazineSize];
+      };
+      struct _ClassCounters { // only modified by owner thread (relaxed atomics: readable by 'stats')
+        std::atomic<uint64_t> allocations{ 0 };
+        std::atomic<uint64_t> releases{ 0 };
+        std::atomic<uint64_t> misses{ 0 }; // allocations not served by thread cache
+      };
+      struct _ClassCache final : public _ClassCounters { // counters stored with magazines (same cache line)
+        _Magazine* loaded = nullptr;   // current magazine
+        _Magazine* previous = nullptr; // spare magazine (avoids depot exchanges when alternating allocations/releases)
+      };
+      static inline void _increment(std::atomic<uint64_t>& counter, uint64_t value) noexcept {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed); // single writer: no RMW
+      }
+      static inline void _addCounters(const _ClassCounters& source, _ClassCounters& out) noexcept {
+        _increment(out.allocations, source.allocations.load(std::memory_order_relaxed));
+        _increment(out.releases, source.releases.load(std::memory_order_relaxed));
+        _increment(out.misses, source.misses.load(std::memory_order_relaxed));
+      }
+
+      // lock-free stack of magazines (Treiber stack): push from any thread.
+      // ABA-safe removal, one method per stack: 'popLocked' if callers are serialized (a magazine can't be pushed back during a pop),
+      // or 'takeAny' (atomic exchange: the list taken can't be modified by other threads).
+      class _MagazineStack final {
+      public:
+        ~_MagazineStack() noexcept {
+          for (_Magazine* magazine = this->_top.load(std::memory_order_acquire); magazine != nullptr;) {
+            _Magazine* next = magazine->next;
+            delete magazine;
+            magazine = next;
+          }
+        }
+        // push a list of linked magazines
+        void push(_Magazine* first, _Magazine* last) noexcept {
+          _Magazine* top = this->_top.load(std::memory_order_relaxed);
+          do {
+            last->next = top;
+          } while (!this->_top.compare_exchange_weak(top, first, std::memory_order_release, std::memory_order_relaxed));
+        }
+        inline void push(_Magazine* magazine) noexcept { push(magazine, magazine); }
+
+        // remove top magazine - callers must be serialized
+        _Magazine* popLocked() noexcept {
+          _Magazine* top = this->_top.load(std::memory_order_acquire);
+          while (top != nullptr
+              && !this->_top.compare_exchange_weak(top, top->next, std::memory_order_acquire, std::memory_order_acquire)) {}
+          return top;
+        }
+        // remove any magazine (lock-free): take whole list, push remaining magazines back
+        _Magazine* takeAny() noexcept {
+          _Magazine* first = this->_top.exchange(nullptr, std::memory_order_acquire);
+          if (first != nullptr && first->next != nullptr) {
+            _Magazine* last = first->next;
+            while (last->next != nullptr)
+              last = last->next;
+            push(first->next, last);
+          }
+          return first;
+        }
+      private:
+        std::atomic<_Magazine*> _top{ nullptr };
+      };
+
+      struct _ThreadCache;
+
+      // depot of magazines for a size class
+      struct _Depot final {
+        std::mutex lock; // full magazine removal + free blocks + slab carving
+        _MagazineStack fullMagazines;  // non-empty magazines (push: lock-free / popLocked: depot locked)
+        _MagazineStack emptyMagazines; // push/takeAny: lock-free
+        std::atomic<void*> releasedBlocks{ nullptr }; // blocks released without magazine (lock-free intrusive stack: next block stored in each block)
+        void* freeBlocks = nullptr;      // released blocks moved to depot (depot locked)
+        uint8_t* slabPosition = nullptr; // remaining space in current slab
+        uint8_t* slabEnd = nullptr;
+        std::atomic<uint64_t> uncachedAllocations{ 0 };
+        std::atomic<uint64_t> uncachedReleases{ 0 };
+      };
+
+      // state shared by allocator and thread caches (kept alive by thread caches after allocator destruction)
+      struct _SharedState final {
+        _SharedState() = default;
+        _SharedState(const _SharedState&) = delete;
+        _SharedState& operator=(const _SharedState&) = delete;
+        ~_SharedState() noexcept = default; // magazines released by depot stacks
+
+        // cache miss: load a full magazine from the depot, or fill current magazine with new blocks
+        void refill(size_t classIndex, _ClassCache& classCache) {
+          _Depot& depot = this->depots[classIndex];
+          std::lock_guard<std::mutex> guard(depot.lock);
+          _Magazine* fullMagazine = depot.fullMagazines.popLocked();
+          if (fullMagazine != nullptr) {
+            if (classCache.previous != nullptr)
+              depot.emptyMagazines.push(classCache.previous);
+            classCache.previous = classCache.loaded;
+            classCache.loaded = fullMagazine;
+            return;
+          }
+
+          if (classCache.loaded == nullptr)
+            classCache.loaded = _takeEmptyMagazine(depot);
+          const size_t size = blockSize(classIndex);
+          _Magazine& magazine = *(classCache.loaded);
+          while (magazine.count < _MagazineSize) {
+            void* block = _takeFreeBlock(depot); // reuse blocks released without magazine first
+            if (block == nullptr) {
+              if (magazine.count > 0 && !_hasSlabSpace(depot, size))
+                break; // avoid reserving a new slab if some blocks are available
+              block = _carveBlock(depot, size);
+            }
+            magazine.blocks[(magazine.count)++] = block;
+          }
+        }
+        // no thread cache: allocate a block from the depot
+        void* allocateUncached(size_t classIndex) {
+          _Depot& depot = this->depots[classIndex];
+          std::lock_guard<std::mutex> guard(depot.lock);
+          void* block = _takeFreeBlock(depot);
+          if (block == nullptr) {
+            _Magazine* fullMagazine = depot.fullMagazines.popLocked();
+            if (fullMagazine != nullptr) {
+              block = fullMagazine->blocks[--(fullMagazine->count)];
+              if (fullMagazine->count > 0)
+                depot.fullMagazines.push(fullMagazine);
+              else
+                depot.emptyMagazines.push(fullMagazine);
+            }
+            else
+              block = _carveBlock(depot, blockSize(classIndex));
+          }
+          depot.uncachedAllocations.fetch_add(1u, std::memory_order_relaxed);
+          return block;
+        }
+        // current magazines full: store a full magazine in the depot, load an empty magazine (lock-free)
+        bool exchangeFull(size_t classIndex, _ClassCache& classCache) noexcept {
+          _Depot& depot = this->depots[classIndex];
+          _Magazine* emptyMagazine = depot.emptyMagazines.takeAny();
+          if (emptyMagazine == nullptr) {
+            emptyMagazine = new (std::nothrow) _Magazine();
+            if (emptyMagazine == nullptr)
+              return false;
+          }
+          if (classCache.previous != nullptr)
+            depot.fullMagazines.push(classCache.previous);
+          classCache.previous = classCache.loaded;
+          classCache.loaded = emptyMagazine;
+          return true;
+        }
+        // store a released block in the depot (when no magazine is available) - lock-free
+        void releaseUncached(size_t classIndex, void* block) noexcept {
+          _Depot& depot = this->depots[classIndex];
+          void* top = depot.releasedBlocks.load(std::memory_order_relaxed);
+          do {
+            *static_cast<void**>(block) = top; // blocks of all size classes can store a pointer (8 bytes min)
+          } while (!depot.releasedBlocks.compare_exchange_weak(top, block, std::memory_order_release, std::memory_order_relaxed));
+          depot.uncachedReleases.fetch_add(1u, std::memory_order_relaxed);
+        }
+        // return magazines of a thread cache to the depot
+        void returnMagazine(size_t classIndex, _Magazine* magazine) noexcept {
+          if (magazine != nullptr) {
+            _Depot& depot = this->depots[classIndex];
+            if (magazine->count > 0)
+              depot.fullMagazines.push(magazine);
+            else
+              depot.emptyMagazines.push(magazine);
+          }
+        }
+
+        _Depot depots[_SizeClassCount];
+        mutable std::mutex chunkLock;
+        std::vector<chunk_type> chunks;
+        size_t chunkPosition = _ChunkSize; // offset of next slab in last chunk (no chunk yet: full)
+
+        mutable std::mutex registryLock;
+        std::vector<_ThreadCache*> caches; // caches of running threads
+        _ClassCounters retiredCounters[_SizeClassCount]; // counters of exited threads
+        uint64_t retiredLargeAllocations = 0;
+        std::atomic<uint64_t> uncachedLargeAllocations{ 0 };
+
+      private:
+        // get empty magazine from depot (or create it)
+        static _Magazine* _takeEmptyMagazine(_Depot& depot) {
+          _Magazine* magazine = depot.emptyMagazines.takeAny();
+          return (magazine != nullptr) ? magazine : new _Magazine();
+        }
+        // get block released without magazine (or nullptr) - depot must be locked
+        static void* _takeFreeBlock(_Depot& depot) noexcept {
+          if (depot.freeBlocks == nullptr) {
+            if (depot.releasedBlocks.load(std::memory_order_relaxed) == nullptr)
+              return nullptr;
+            depot.freeBlocks = depot.releasedBlocks.exchange(nullptr, std::memory_order_acquire);
+          }
+          void* block = depot.freeBlocks;
+          depot.freeBlocks = *static_cast<void**>(block);
+          return block;
+        }
+        static inline bool _hasSlabSpace(const _Depot& depot, size_t size) noexcept {
+          return (depot.slabPosition != nullptr && size <= static_cast<size_t>(depot.slabEnd - depot.slabPosition));
+        }
+        // carve block from current slab (or new slab) - depot must be locked
+        void* _carveBlock(_Depot& depot, size_t size) {
+          if (!_hasSlabSpace(depot, size)) {
+            depot.slabPosition = _allocateSlab();
+            depot.slabEnd = depot.slabPosition + _SlabSize;
+          }
+          void* block = depot.slabPosition;
+          depot.slabPosition += size;
+          return block;
+        }
+        // carve new slab from current chunk (or new chunk)
+        uint8_t* _allocateSlab() {
+          std::lock_guard<std::mutex> guard(this->chunkLock);
+          if (this->chunkPosition + _SlabSize > _ChunkSize) {
+            this->chunks.emplace_back();
+            this->chunkPosition = 0;
+          }
+          uint8_t* slab = this->chunks.back().get() + this->chunkPosition;
+          this->chunkPosition += _SlabSize;
+          return slab;
+        }
+      };
+
+      // magazines of current thread for an allocator
+      struct _ThreadCache final {
+        _ThreadCache(std::shared_ptr<_SharedState> state) noexcept : state(std::move(state)) {}
+        ~_ThreadCache() noexcept {
+          flush();
+          std::lock_guard<std::mutex> guard(this->state->registryLock);
+          for (auto it = this->state->caches.begin(); it != this->state->caches.end(); ++it) {
+            if (*it == this) {
+              this->state->caches.erase(it);
+              break;
+            }
+          }
+          for (size_t i = 0; i < _SizeClassCount; ++i)
+            _addCounters(this->classes[i], this->state->retiredCounters[i]);
+          this->state->retiredLargeAllocations += this->largeAllocations.load(std::memory_order_relaxed);
+        }
+        // add cache to registry of shared state (for statistics)
+        bool registerCache() noexcept {
+          std::lock_guard<std::mutex> guard(this->state->registryLock);
+          try {
+            this->state->caches.push_back(this);
+            return true;
+          }
+          catch (...) { return false; }
+        }
+        void flush() noexcept {
+          for (size_t i = 0; i < _SizeClassCount; ++i) {
+            this->state->returnMagazine(i, this->classes[i].loaded);
+            this->state->returnMagazine(i, this->classes[i].previous);
+            this->classes[i].loaded = this->classes[i].previous = nullptr;
+          }
+        }
+
+        std::shared_ptr<_SharedState> state;
+        _ClassCache classes[_SizeClassCount];
+        std::atomic<uint64_t> largeAllocations{ 0 };
+      };
+
+      // caches of current thread (one per allocator used by the thread)
+      struct _LastThreadCache;
+      struct _ThreadCacheTable final {
+        ~_ThreadCacheTable() noexcept { _lastThreadCache() = _LastThreadCache{ nullptr, nullptr, true }; } // later calls (other thread_local destructors): no cache
+        std::vector<std::unique_ptr<_ThreadCache> > caches;
+      };
+      struct _LastThreadCache final { // last allocator used by current thread (fast path: trivial thread_local, no init guard)
+        const _SharedState* state;
+        _ThreadCache* cache;
+        bool isTableDestroyed;
+      };
+      static inline _LastThreadCache& _lastThreadCache() noexcept {
+        static thread_local _LastThreadCache lastCache{ nullptr, nullptr, false };
+        return lastCache;
+      }
+
+      // get cache of current thread (or nullptr if unavailable: thread exit / out of memory)
+      inline _ThreadCache* _threadCache() noexcept {
+        _LastThreadCache& lastCache = _lastThreadCache();
+        return (lastCache.state == this->_state.get()) ? lastCache.cache : _findThreadCache(lastCache);
+      }
+      _ThreadCache* _findThreadCache(_LastThreadCache& lastCache) noexcept {
+        if (lastCache.isTableDestroyed)
+          return nullptr; // don't access (or re-create) table during thread exit
+        thread_local _ThreadCacheTable table;
+        _ThreadCache* result = nullptr;
+        for (auto& cache : table.caches) {
+          if (cache->state.get() == this->_state.get()) {
+            result = cache.get();
+            break;
+          }
+        }
+        if (result == nullptr) {
+          // release caches of destroyed allocators (only referenced by current thread)
+          for (auto it = table.caches.begin(); it != table.caches.end();) {
+            if ((*it)->state.use_count() == 1)
+              it = table.caches.erase(it);
+            else
+              ++it;
+          }
+          try {
+            table.caches.reserve(table.caches.size() + 1u);
+          }
+          catch (...) { return nullptr; }
+          std::unique_ptr<_ThreadCache> cache(new (std::nothrow) _ThreadCache(this->_state));
+          if (cache == nullptr || !cache->registerCache())
+            return nullptr;
+          result = cache.get();
+          table.caches.push_back(std::move(cache)); // no throw: capacity reserved
+        }
+        lastCache.state = this->_state.get();
+        lastCache.cache = result;
+        return result;
+      }
+
+    private:
+      std::shared_ptr<_SharedState> _state;
+    };
+  }
+}
@@ -26,9 +26,41 @@ using namespace pandora::memory;
 
 // -- LightString -- -----------------------------------------------------------
 
-LightString::LightString(size_t length, char repeated) noexcept
- : _value(length ? (char*)malloc((length + 1)*sizeof(char)) : nullptr) {
-  if (_value != nullptr) {
+// allocate buffer for 'length' characters + ending zero (NULL on failure)
+char* LightString::_allocate(size_t length) noexcept {
+# ifdef __P_HAS_MEMORY_RESOURCE
+    if (this->_resource != nullptr) {
+      try { return (char*)this->_resource->allocate((length + 1u)*sizeof(char), alignof(char)); }
+      catch (...) { return nullptr; }
+    }
+# endif
+  return (char*)malloc((length + 1u)*sizeof(char));
+}
+// release current buffer + use new buffer (or NULL)
+void LightString::_replaceValue(char* value, size_t allocLength) noexcept {
+  if (this->_value != nullptr) {
+#   ifdef __P_HAS_MEMORY_RESOURCE
+      if (this->_resource != nullptr)
+        this->_resource->deallocate((void*)this->_value, (this->_allocLength + 1u)*sizeof(char), alignof(char));
+      else
+        free(this->_value);
+#   else
+      free(this->_value);
+#   endif
+  }
+  this->_value = value;
+# ifdef __P_HAS_MEMORY_RESOURCE
+    this->_allocLength = allocLength;
+# else
+    (void)allocLength;
+# endif
+}
+
+// Create string with repeated char
+void LightString::_fill(size_t length, char repeated) noexcept {
+  char* value = (length) ? _allocate(length) : nullptr;
+  if (value != nullptr) {
+    _replaceValue(value, length);
     this->_size = length;
     memset((void*)this->_value, repeated, length*sizeof(char));
     this->_value[length] = '\0';
@@ -38,8 +70,7 @@ LightString::LightString(size_t length, char repeated) noexcept
 }
 void LightString::clear() noexcept {
   if (this->_value != nullptr) {
-    free(this->_value);
-    this->_value = nullptr;
+    _replaceValue(nullptr, 0);
     this->_size = 0;
   }
 }
@@ -58,7 +89,7 @@ bool LightString::assign(const char* value, size_t length) noexcept {
   char* newValue = nullptr;
   if (length) {
     if (length > this->_size) {
-      newValue = (char*)malloc((length + 1u)*sizeof(char));
+      newValue = _allocate(length);
       if (newValue == nullptr)
         return false;
       memcpy((void*)newValue, (void*)value, length*sizeof(char));
@@ -72,9 +103,7 @@ bool LightString::assign(const char* value, size_t length) noexcept {
     }
   }
 
-  if (this->_value != nullptr)
-    free(this->_value);
-  this->_value = newValue;
+  _replaceValue(newValue, length);
   this->_size = length;
   return true;
 }
@@ -83,17 +112,15 @@ bool LightString::assign(const char* value) noexcept { return assign(value, (val
 // Append another string/substring
 bool LightString::append(const char* suffix, size_t length) noexcept {
   if (length != size_t{0}) {
-    char* newValue = (char*)malloc((length + this->_size + 1u)*sizeof(char));
+    char* newValue = _allocate(length + this->_size);
     if (newValue == nullptr)
       return false;
     
-    if (this->_value != nullptr) {
+    if (this->_value != nullptr)
       memcpy((void*)newValue, (void*)this->_value, this->_size*sizeof(char));
-      free(this->_value);
-    }
-    memcpy((void*)(newValue + this->_size), (void*)suffix, length*sizeof(char));
+    memcpy((void*)(newValue + this->_size), (void*)suffix, length*sizeof(char)); // before release (suffix may be part of current value)
     
-    this->_value = newValue;
+    _replaceValue(newValue, length + this->_size);
     this->_size += length;
     this->_value[this->_size] = '\0';
   }
@@ -104,9 +131,41 @@ bool LightString::append(const char* suffix) noexcept { return (suffix != nullpt
 
 // -- LightWString -- ----------------------------------------------------------
 
-LightWString::LightWString(size_t length, wchar_t repeated) noexcept 
-  : _value(length ? (wchar_t*)malloc((length + 1)*sizeof(wchar_t)) : nullptr) {
-  if (_value != nullptr) {
+// allocate buffer for 'length' characters + ending zero (NULL on failure)
+wchar_t* LightWString::_allocate(size_t length) noexcept {
+# ifdef __P_HAS_MEMORY_RESOURCE
+    if (this->_resource != nullptr) {
+      try { return (wchar_t*)this->_resource->allocate((length + 1u)*sizeof(wchar_t), alignof(wchar_t)); }
+      catch (...) { return nullptr; }
+    }
+# endif
+  return (wchar_t*)malloc((length + 1u)*sizeof(wchar_t));
+}
+// release current buffer + use new buffer (or NULL)
+void LightWString::_replaceValue(wchar_t* value, size_t allocLength) noexcept {
+  if (this->_value != nullptr) {
+#   ifdef __P_HAS_MEMORY_RESOURCE
+      if (this->_resource != nullptr)
+        this->_resource->deallocate((void*)this->_value, (this->_allocLength + 1u)*sizeof(wchar_t), alignof(wchar_t));
+      else
+        free(this->_value);
+#   else
+      free(this->_value);
+#   endif
+  }
+  this->_value = value;
+# ifdef __P_HAS_MEMORY_RESOURCE
+    this->_allocLength = allocLength;
+# else
+    (void)allocLength;
+# endif
+}
+
+// Create string with repeated char
+void LightWString::_fill(size_t length, wchar_t repeated) noexcept {
+  wchar_t* value = (length) ? _allocate(length) : nullptr;
+  if (value != nullptr) {
+    _replaceValue(value, length);
     this->_size = length;
     wmemset(this->_value, repeated, length);
     this->_value[length] = L'\0';
@@ -116,8 +175,7 @@ LightWString::LightWString(size_t length, wchar_t repeated) noexcept
 }
 void LightWString::clear() noexcept {
   if (this->_value != nullptr) {
-    free(this->_value);
-    this->_value = nullptr;
+    _replaceValue(nullptr, 0);
     this->_size = 0;
   }
 }
@@ -136,7 +194,7 @@ bool LightWString::assign(const wchar_t* value, size_t length) noexcept {
   wchar_t* newValue = nullptr;
   if (length) {
     if (length > this->_size) {
-      newValue = (wchar_t*)malloc((length + 1u)*sizeof(wchar_t));
+      newValue = _allocate(length);
       if (newValue == nullptr)
         return false;
       memcpy((void*)newValue, (void*)value, length*sizeof(wchar_t));
@@ -150,9 +208,7 @@ bool LightWString::assign(const wchar_t* value, size_t length) noexcept {
     }
   }
 
-  if (this->_value != nullptr)
-    free(this->_value);
-  this->_value = newValue;
+  _replaceValue(newValue, length);
   this->_size = length;
   return true;
 }
@@ -161,17 +217,15 @@ bool LightWString::assign(const wchar_t* value) noexcept { return assign(value,
 // Append another string/substring
 bool LightWString::append(const wchar_t* suffix, size_t length) noexcept {
   if (length != size_t{0}) {
-    wchar_t* newValue = (wchar_t*)malloc((length + this->_size + 1u)*sizeof(wchar_t));
+    wchar_t* newValue = _allocate(length + this->_size);
     if (newValue == nullptr)
       return false;
     
-    if (this->_value != nullptr) {
+    if (this->_value != nullptr)
       memcpy((void*)newValue, (void*)this->_value, this->_size*sizeof(wchar_t));
-      free(this->_value);
-    }
-    memcpy((void*)(newValue + this->_size), (void*)suffix, length*sizeof(wchar_t));
+    memcpy((void*)(newValue + this->_size), (void*)suffix, length*sizeof(wchar_t)); // before release (suffix may be part of current value)
     
-    this->_value = newValue;
+    _replaceValue(newValue, length + this->_size);
     this->_size += length;
     this->_value[this->_size] = L'\0';
   }
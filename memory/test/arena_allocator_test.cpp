@@ -0,0 +1,225 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include <gtest/gtest.h>
+#include <cstring>
+#include <thread>
+#include <memory/arena_allocator.h>
+
+using namespace pandora::memory;
+
+class ArenaAllocatorTest : public testing::Test {
+public:
+protected:
+  //static void SetUpTestCase() {}
+  //static void TearDownTestCase() {}
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+
+// -- helpers --
+
+struct _ArenaItem final {
+  _ArenaItem(int id, double value) : id(id), value(value) {}
+  int id;
+  double value;
+};
+struct alignas(64) _OverAlignedItem final {
+  uint8_t data[64];
+};
+
+
+// -- allocation --
+
+TEST_F(ArenaAllocatorTest, emptyArena) {
+  ArenaAllocator<> arena;
+  EXPECT_EQ(size_t{ 64u*1024u }, arena.chunkSize());
+  EXPECT_EQ(size_t{ 0 }, arena.size());
+  EXPECT_EQ(size_t{ 0 }, arena.peakSize());
+  EXPECT_EQ(size_t{ 0 }, arena.capacity());
+  EXPECT_EQ(size_t{ 0 }, arena.chunkCount());
+  arena.reset();
+  arena.rollback(arena.mark());
+  arena.release();
+  EXPECT_EQ(size_t{ 0 }, arena.chunkCount());
+
+  void* block = arena.allocate(0); // zero-size allocation -> valid address
+  EXPECT_TRUE(block != nullptr);
+  EXPECT_EQ(size_t{ 1u }, arena.chunkCount());
+}
+
+TEST_F(ArenaAllocatorTest, allocateAligned) {
+  ArenaAllocator<1024> arena;
+  uint8_t* bytes = arena.alloc<uint8_t>(3u);
+  ASSERT_TRUE(bytes != nullptr);
+  memset(bytes, 0xAB, 3u);
+
+  double* values = arena.alloc<double>(4u);
+  EXPECT_EQ(size_t{ 0 }, reinterpret_cast<uintptr_t>(values) % alignof(double));
+  EXPECT_TRUE(reinterpret_cast<uint8_t*>(values) >= bytes + 3);
+  _OverAlignedItem* overAligned = arena.alloc<_OverAlignedItem>();
+  EXPECT_EQ(size_t{ 0 }, reinterpret_cast<uintptr_t>(overAligned) % 64u);
+  void* aligned = arena.allocate(10u, 16u);
+  EXPECT_EQ(size_t{ 0 }, reinterpret_cast<uintptr_t>(aligned) % 16u);
+
+  _ArenaItem* item = arena.create<_ArenaItem>(5, 2.5);
+  EXPECT_EQ(5, item->id);
+  EXPECT_EQ(2.5, item->value);
+  EXPECT_EQ(0xAB, bytes[2]); // previous allocations not overwritten
+  EXPECT_EQ(size_t{ 1u }, arena.chunkCount());
+  EXPECT_TRUE(arena.size() >= 3u + 4u*sizeof(double) + sizeof(_OverAlignedItem) + 10u + sizeof(_ArenaItem));
+
+  EXPECT_THROW(arena.alloc<double>(static_cast<size_t>(-1) / 4u), std::bad_alloc);
+}
+
+TEST_F(ArenaAllocatorTest, growInChunks) {
+  ArenaAllocator<1024> arena;
+  for (int i = 0; i < 100; ++i) {
+    int* values = arena.alloc<int>(16u);
+    for (int v = 0; v < 16; ++v)
+      values[v] = i;
+  }
+  EXPECT_TRUE(arena.chunkCount() >= 7u);
+  EXPECT_EQ(size_t{ 100u*16u*sizeof(int) }, arena.size());
+
+  size_t capacity = arena.capacity();
+  uint8_t* big = arena.alloc<uint8_t>(5000u); // bigger than chunk size -> dedicated chunk
+  memset(big, 1, 5000u);
+  EXPECT_TRUE(arena.capacity() >= capacity + 5000u);
+}
+
+// -- reclaim memory --
+
+TEST_F(ArenaAllocatorTest, resetKeepsChunks) {
+  ArenaAllocator<1024> arena;
+  void* first = arena.allocate(100u);
+  for (int i = 0; i < 20; ++i)
+    arena.allocate(200u);
+  size_t chunkCount = arena.chunkCount();
+  size_t capacity = arena.capacity();
+  size_t usage = arena.size();
+
+  for (int request = 0; request < 5; ++request) {
+    arena.reset();
+    EXPECT_EQ(size_t{ 0 }, arena.size());
+    EXPECT_EQ(first, arena.allocate(100u)); // same memory reused
+    for (int i = 0; i < 20; ++i)
+      arena.allocate(200u);
+    EXPECT_EQ(chunkCount, arena.chunkCount()); // no new chunk
+    EXPECT_EQ(capacity, arena.capacity());
+  }
+  EXPECT_EQ(usage, arena.peakSize());
+
+  arena.release();
+  EXPECT_EQ(size_t{ 0 }, arena.chunkCount());
+  EXPECT_EQ(size_t{ 0 }, arena.capacity());
+  EXPECT_EQ(usage, arena.peakSize());
+}
+
+TEST_F(ArenaAllocatorTest, markerRollback) {
+  ArenaAllocator<512> arena;
+  ArenaAllocator<512>::Marker empty = arena.mark();
+  EXPECT_EQ(size_t{ 0 }, empty.size());
+  arena.allocate(64u);
+
+  ArenaAllocator<512>::Marker checkpoint = arena.mark();
+  EXPECT_EQ(size_t{ 64u }, checkpoint.size());
+  void* next = arena.allocate(32u);
+  for (int i = 0; i < 30; ++i) // multiple chunks
+    arena.allocate(100u);
+  size_t chunkCount = arena.chunkCount();
+  EXPECT_TRUE(chunkCount > 2u);
+
+  arena.rollback(checkpoint);
+  EXPECT_EQ(size_t{ 64u }, arena.size());
+  EXPECT_EQ(next, arena.allocate(32u));
+  for (int i = 0; i < 30; ++i)
+    arena.allocate(100u);
+  EXPECT_EQ(chunkCount, arena.chunkCount()); // chunks reused
+
+  arena.rollback(empty); // marker of empty arena -> reset
+  EXPECT_EQ(size_t{ 0 }, arena.size());
+  EXPECT_EQ(chunkCount, arena.chunkCount());
+}
+
+TEST_F(ArenaAllocatorTest, scopedRollback) {
+  ArenaAllocator<> arena;
+  arena.allocate(16u);
+  {
+    ArenaAllocator<>::Scope scope(arena);
+    arena.allocate(1000u);
+    {
+      ArenaAllocator<>::Scope nestedScope(arena);
+      arena.allocate(100000u);
+      EXPECT_TRUE(arena.size() >= 101016u);
+    }
+    EXPECT_EQ(size_t{ 1016u }, arena.size());
+  }
+  EXPECT_EQ(size_t{ 16u }, arena.size());
+  EXPECT_TRUE(arena.peakSize() >= 101016u);
+
+  arena.resetPeakSize();
+  EXPECT_EQ(size_t{ 16u }, arena.peakSize());
+}
+
+// -- initial pool --
+
+TEST_F(ArenaAllocatorTest, initialPool) {
+  MemoryPool<2048, 0, MemoryPoolAllocation::onStack, false> pool;
+  {
+    ArenaAllocator<1024> arena(pool);
+    EXPECT_EQ(size_t{ 1u }, arena.chunkCount());
+    EXPECT_TRUE(arena.capacity() > 1900u && arena.capacity() < 2048u);
+
+    uint8_t* block = arena.alloc<uint8_t>(1000u);
+    EXPECT_TRUE(block >= pool.get() && block + 1000 <= pool.get() + 2048);
+    EXPECT_EQ(size_t{ 1u }, arena.chunkCount()); // no system allocation
+
+    arena.alloc<uint8_t>(3000u); // too big -> additional chunk
+    EXPECT_EQ(size_t{ 2u }, arena.chunkCount());
+    arena.release(); // initial pool kept
+    EXPECT_EQ(size_t{ 1u }, arena.chunkCount());
+    EXPECT_EQ(block, arena.alloc<uint8_t>(1000u));
+
+    ArenaAllocator<1024> moved(std::move(arena));
+    EXPECT_EQ(size_t{ 0 }, arena.chunkCount());
+    EXPECT_EQ(size_t{ 1u }, moved.chunkCount());
+    EXPECT_EQ(size_t{ 1000u }, moved.size());
+  }
+}
+
+// -- thread-local arena --
+
+TEST_F(ArenaAllocatorTest, threadLocalArena) {
+  ArenaAllocator<>& arena = ArenaAllocator<>::threadLocalArena();
+  EXPECT_EQ(&arena, &ArenaAllocator<>::threadLocalArena());
+  ArenaAllocator<>::Scope scope(arena);
+  int* value = arena.create<int>(42);
+
+  ArenaAllocator<>* otherArena = nullptr;
+  std::thread worker([&otherArena]() {
+    ArenaAllocator<>& workerArena = ArenaAllocator<>::threadLocalArena();
+    otherArena = &workerArena;
+    workerArena.create<int>(7);
+    EXPECT_EQ(sizeof(int), workerArena.size());
+  });
+  worker.join();
+  EXPECT_NE(&arena, otherArena);
+  EXPECT_EQ(42, *value);
+}
@@ -18,6 +18,12 @@ IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 *******************************************************************************/
 #include <gtest/gtest.h>
 #include <mutex>
+#include <memory>
+#include <string>
+#include <stdexcept>
+#include <list>
+#include <sstream>
+#include <iterator>
 #include <unordered_set>
 #include <memory/light_vector.h>
 
@@ -96,6 +102,25 @@ struct _LightVectorData final {
   bool isUserConstructed = false;
 };
 
+// -- Helper - Object with a move constructor that may throw --
+
+struct _LightVectorThrowingMove final {
+  _LightVectorThrowingMove(int value_) : value(value_) {}
+  _LightVectorThrowingMove(const _LightVectorThrowingMove& rhs) : value(rhs.value) {
+    if (isCopyFailing)
+      throw std::runtime_error("copy failure");
+  }
+  _LightVectorThrowingMove(_LightVectorThrowingMove&& rhs) noexcept(false) : value(rhs.value) { ++moveCounter; }
+  _LightVectorThrowingMove& operator=(const _LightVectorThrowingMove&) = default;
+  _LightVectorThrowingMove& operator=(_LightVectorThrowingMove&&) = default;
+
+  int value = 0;
+  static bool isCopyFailing;
+  static int32_t moveCounter;
+};
+bool _LightVectorThrowingMove::isCopyFailing = false;
+int32_t _LightVectorThrowingMove::moveCounter = 0;
+
 
 // -- LightVector --
 
@@ -1121,3 +1146,151 @@ TEST_F(LightVectorTest, vectorPopObject) {
   }
   CheckObjectRegistrar(true, true);
 }
+
+// -- growth / reserve / emplace / append --
+
+TEST_F(LightVectorTest, vectorReserveShrinkInt) {
+  LightVector<int> data;
+  data.reserve(100u);
+  EXPECT_TRUE(data.empty());
+  EXPECT_EQ(size_t{ 100u }, data.capacity());
+  const int* buffer = data.data();
+  for (int i = 0; i < 100; ++i)
+    data.push_back(i);
+  EXPECT_EQ(buffer, data.data()); // no reallocation
+  data.reserve(10u);
+  EXPECT_EQ(size_t{ 100u }, data.capacity());
+
+  data.push_back(100);
+  EXPECT_EQ(size_t{ 200u }, data.capacity()); // geometric growth
+  data.shrink_to_fit();
+  EXPECT_EQ(size_t{ 101u }, data.capacity());
+  for (int i = 0; i <= 100; ++i)
+    EXPECT_EQ(i, data[i]);
+
+  LightVector<int, 150u> data150;
+  size_t reallocCount = 0;
+  size_t lastCapacity = 0;
+  for (int i = 0; i < 100000; ++i) {
+    data150.push_back(i);
+    if (data150.capacity() != lastCapacity) {
+      EXPECT_TRUE(data150.capacity() >= lastCapacity + lastCapacity / 2u);
+      lastCapacity = data150.capacity();
+      ++reallocCount;
+    }
+  }
+  EXPECT_TRUE(reallocCount < 40u); // logarithmic number of reallocations
+  EXPECT_EQ(99999, data150.back());
+
+  data150.clear();
+  data150.shrink_to_fit();
+  EXPECT_EQ(size_t{ 0 }, data150.capacity());
+  EXPECT_TRUE(data150.data() == nullptr);
+}
+
+TEST_F(LightVectorTest, vectorReserveShrinkObject) {
+  {
+    LightVector<_LightVectorData> data;
+    data.reserve(8u);
+    EXPECT_EQ(size_t{ 8u }, data.capacity());
+    CheckObjectRegistrar(true, false);
+    for (int i = 0; i < 20; ++i)
+      data.push_back(_LightVectorData(i, i * 2));
+    EXPECT_EQ(size_t{ 32u }, data.capacity());
+    data.shrink_to_fit();
+    EXPECT_EQ(size_t{ 20u }, data.capacity());
+    for (int i = 0; i < 20; ++i) {
+      EXPECT_EQ(i, data[i].a);
+      EXPECT_EQ(i * 2, data[i].b);
+    }
+    CheckObjectRegistrar(false, true);
+  }
+  CheckObjectRegistrar(true, true);
+}
+
+TEST_F(LightVectorTest, vectorEmplaceBack) {
+  LightVector<std::string> texts;
+  EXPECT_EQ(std::string("aaa"), texts.emplace_back(3u, 'a'));
+  texts.emplace_back("bc");
+  for (int i = 0; i < 50; ++i)
+    texts.emplace_back(texts[0]); // argument stored in vector during reallocation
+  ASSERT_EQ(size_t{ 52u }, texts.size());
+  EXPECT_EQ(std::string("bc"), texts[1]);
+  EXPECT_EQ(std::string("aaa"), texts.back());
+
+  LightVector<std::unique_ptr<int> > pointers; // move-only type
+  for (int i = 0; i < 20; ++i)
+    pointers.emplace_back(new int(i));
+  pointers.push_back(std::unique_ptr<int>(new int(20)));
+  ASSERT_EQ(size_t{ 21u }, pointers.size());
+  for (int i = 0; i <= 20; ++i)
+    EXPECT_EQ(i, *pointers[i]);
+  pointers.insert(0, std::unique_ptr<int>(new int(-1)));
+  EXPECT_EQ(-1, *pointers.front());
+  EXPECT_EQ(20, *pointers.back());
+
+  LightVector<int> values;
+  for (int i = 0; i < 9; ++i)
+    values.push_back(i);
+  values.push_back(values[0]); // argument stored in vector during reallocation (realloc)
+  values.insert(0, values[8]);
+  ASSERT_EQ(size_t{ 11u }, values.size());
+  EXPECT_EQ(8, values[0]);
+  EXPECT_EQ(0, values[10]);
+}
+
+TEST_F(LightVectorTest, vectorThrowingMoveGrowth) {
+  _LightVectorThrowingMove::isCopyFailing = false;
+  _LightVectorThrowingMove::moveCounter = 0;
+  LightVector<_LightVectorThrowingMove> values;
+  for (int i = 0; i < 20; ++i)
+    values.emplace_back(i);
+  values.reserve(64u);
+  values.shrink_to_fit();
+  EXPECT_EQ(0, _LightVectorThrowingMove::moveCounter); // relocated with copies (move may throw)
+
+  _LightVectorThrowingMove::isCopyFailing = true; // relocation failure -> vector unchanged
+  size_t capacity = values.capacity();
+  EXPECT_THROW(values.reserve(capacity*2u), std::runtime_error);
+  EXPECT_THROW(values.emplace_back(20), std::runtime_error);
+  EXPECT_THROW(values.insert(0, _LightVectorThrowingMove(-1)), std::runtime_error);
+  EXPECT_EQ(capacity, values.capacity());
+  ASSERT_EQ(size_t{ 20u }, values.size());
+  for (int i = 0; i < 20; ++i)
+    EXPECT_EQ(i, values[i].value);
+
+  _LightVectorThrowingMove::isCopyFailing = false;
+  values.insert(0, _LightVectorThrowingMove(-1));
+  ASSERT_EQ(size_t{ 21u }, values.size());
+  EXPECT_EQ(-1, values[0].value);
+  EXPECT_EQ(19, values.back().value);
+}
+
+TEST_F(LightVectorTest, vectorAppendRange) {
+  LightVector<int> values;
+  const int source[] = { 1, 2, 3, 4, 5 };
+  values.append(source, 5u);
+  values.append(source, source + 2);
+  ASSERT_EQ(size_t{ 7u }, values.size());
+  EXPECT_EQ(5, values[4]);
+  EXPECT_EQ(2, values[6]);
+  values.append(values.begin(), values.end()); // self-append
+  ASSERT_EQ(size_t{ 14u }, values.size());
+  EXPECT_EQ(1, values[7]);
+  EXPECT_EQ(2, values[13]);
+
+  std::list<std::string> textList{ "a", "b", "c" };
+  LightVector<std::string> texts;
+  texts.append(textList.begin(), textList.end());
+  texts.append(texts.data(), texts.size());
+  ASSERT_EQ(size_t{ 6u }, texts.size());
+  EXPECT_EQ(std::string("c"), texts[5]);
+
+  std::istringstream stream("10 20 30");
+  LightVector<int> parsed; // input iterators
+  parsed.append(std::istream_iterator<int>(stream), std::istream_iterator<int>());
+  ASSERT_EQ(size_t{ 3u }, parsed.size());
+  EXPECT_EQ(30, parsed[2]);
+  parsed.append(source, 0);
+  EXPECT_EQ(size_t{ 3u }, parsed.size());
+}
@@ -0,0 +1,318 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include <gtest/gtest.h>
+#include <memory/memory_resource.h>
+#include <memory/light_vector.h>
+#include <memory/dynamic_array.h>
+#include <memory/light_string.h>
+
+#ifdef __P_HAS_MEMORY_RESOURCE
+# include <map>
+# include <memory>
+# include <string>
+# include <thread>
+# include <vector>
+
+  using namespace pandora::memory;
+
+  class MemoryResourceTest : public testing::Test {
+  public:
+  protected:
+    //static void SetUpTestCase() {}
+    //static void TearDownTestCase() {}
+    void SetUp() override {}
+    void TearDown() override {}
+  };
+
+
+  // -- helpers --
+
+  // upstream resource: count allocations + verify that sizes/alignments of releases match allocations
+  class _CountingResource final : public std::pmr::memory_resource {
+  public:
+    ~_CountingResource() noexcept override { EXPECT_TRUE(blocks.empty()); }
+
+    std::map<void*, std::pair<size_t,size_t> > blocks;
+    size_t allocations = 0;
+    size_t invalidReleases = 0;
+
+  protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+      void* block = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+      blocks[block] = std::pair<size_t,size_t>(bytes, alignment);
+      ++allocations;
+      return block;
+    }
+    void do_deallocate(void* block, size_t bytes, size_t alignment) override {
+      auto it = blocks.find(block);
+      if (it == blocks.end() || it->second.first != bytes || it->second.second != alignment)
+        ++invalidReleases;
+      else
+        blocks.erase(it);
+      std::pmr::new_delete_resource()->deallocate(block, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& rhs) const noexcept override { return (this == &rhs); }
+  };
+
+  class _ResourceItem final {
+  public:
+    _ResourceItem() = default;
+    _ResourceItem(int value) : value(std::make_shared<int>(value)) {}
+    _ResourceItem(const _ResourceItem&) = default;
+    _ResourceItem(_ResourceItem&&) noexcept = default;
+    _ResourceItem& operator=(const _ResourceItem&) = default;
+    _ResourceItem& operator=(_ResourceItem&&) noexcept = default;
+    std::shared_ptr<int> value;
+  };
+
+
+  // -- resources --
+
+  TEST_F(MemoryResourceTest, monotonicPoolResource) {
+    _CountingResource upstream;
+    {
+      MonotonicPoolResource<1024> arena(&upstream);
+      EXPECT_EQ(size_t{ 1024u }, arena.capacity());
+      EXPECT_EQ(&upstream, arena.upstream_resource());
+      EXPECT_TRUE(arena.is_equal(arena));
+
+      void* first = arena.allocate(256, 16);
+      void* second = arena.allocate(256, 16);
+      ASSERT_TRUE(first != nullptr && second != nullptr);
+      EXPECT_EQ(size_t{ 0 }, reinterpret_cast<uintptr_t>(first) % 16u);
+      EXPECT_TRUE(first != second);
+      arena.deallocate(first, 256, 16); // no effect
+      EXPECT_EQ(size_t{ 0 }, upstream.allocations);
+
+      void* overflow = arena.allocate(2048, 8); // pool full -> upstream
+      EXPECT_TRUE(overflow != nullptr);
+      EXPECT_NE(size_t{ 0 }, upstream.allocations);
+
+      arena.release();
+      EXPECT_TRUE(upstream.blocks.empty());
+      void* reused = arena.allocate(256, 16);
+      EXPECT_EQ(first, reused);
+
+      std::pmr::vector<int> values(&arena);
+      for (int i = 0; i < 1000; ++i)
+        values.push_back(i);
+      EXPECT_EQ(999, values.back());
+    }
+    EXPECT_EQ(size_t{ 0 }, upstream.invalidReleases);
+  }
+
+  TEST_F(MemoryResourceTest, arenaResource) {
+    ArenaAllocator<1024> arena;
+    ArenaResource<1024> resource(arena);
+    EXPECT_EQ(&arena, &(resource.arena()));
+    EXPECT_TRUE(resource.is_equal(resource));
+    {
+      ArenaAllocator<1024>::Scope scope(arena);
+      std::pmr::vector<int> values(&resource);
+      for (int i = 0; i < 1000; ++i)
+        values.push_back(i);
+      LightString text("per-request text", &resource);
+      EXPECT_EQ(999, values.back());
+      EXPECT_TRUE(text == "per-request text");
+      EXPECT_TRUE(arena.size() >= 1000u*sizeof(int));
+    }
+    EXPECT_EQ(size_t{ 0 }, arena.size());
+    EXPECT_TRUE(arena.peakSize() >= 1000u*sizeof(int));
+  }
+
+  TEST_F(MemoryResourceTest, fixedPoolResource) {
+    _CountingResource upstream;
+    {
+      FixedPoolResource<32, 4> pool(&upstream);
+      EXPECT_EQ(size_t{ 32u }, pool.blockSize());
+      EXPECT_EQ(size_t{ 4u }, pool.capacity());
+      EXPECT_EQ(size_t{ 0 }, pool.size());
+
+      void* blocks[4];
+      for (int i = 0; i < 4; ++i) {
+        blocks[i] = pool.allocate(24, 8);
+        ASSERT_TRUE(blocks[i] != nullptr);
+      }
+      EXPECT_EQ(size_t{ 4u }, pool.size());
+      EXPECT_EQ(size_t{ 0 }, upstream.allocations);
+
+      void* overflow = pool.allocate(24, 8); // pool full -> upstream
+      void* big = pool.allocate(64, 8);      // too big -> upstream
+      EXPECT_EQ(size_t{ 2u }, upstream.allocations);
+      pool.deallocate(overflow, 24, 8);
+      pool.deallocate(big, 64, 8);
+      EXPECT_TRUE(upstream.blocks.empty());
+
+      pool.deallocate(blocks[1], 24, 8);
+      EXPECT_EQ(size_t{ 3u }, pool.size());
+      EXPECT_EQ(blocks[1], pool.allocate(16, 8)); // released block reused
+      for (int i = 0; i < 4; ++i)
+        pool.deallocate(blocks[i], 24, 8);
+      EXPECT_EQ(size_t{ 0 }, pool.size());
+
+      std::pmr::map<int,int> nodes(&pool);
+      for (int i = 0; i < 10; ++i) // some nodes in pool, others from upstream
+        nodes[i] = i;
+      EXPECT_EQ(size_t{ 10u }, nodes.size());
+    }
+    EXPECT_EQ(size_t{ 0 }, upstream.invalidReleases);
+  }
+
+  TEST_F(MemoryResourceTest, synchronizedPoolResource) {
+    _CountingResource upstream;
+    {
+      SynchronizedPoolResource<> pool(&upstream);
+      void* empty = pool.allocate(0, 1);
+      void* aligned = pool.allocate(8, 16);
+      void* overAligned = pool.allocate(64, 64);
+      EXPECT_EQ(size_t{ 0 }, reinterpret_cast<uintptr_t>(aligned) % 16u);
+      EXPECT_EQ(size_t{ 0 }, reinterpret_cast<uintptr_t>(overAligned) % 64u);
+      EXPECT_EQ(size_t{ 1u }, upstream.allocations);
+      pool.deallocate(empty, 0, 1);
+      pool.deallocate(aligned, 8, 16);
+      pool.deallocate(overAligned, 64, 64);
+
+      std::pmr::vector<std::pmr::string> strings(&pool);
+      std::thread producer([&strings]() {
+        for (int i = 0; i < 100; ++i)
+          strings.emplace_back(std::to_string(i) + " - some text that does not fit in SSO buffer");
+      });
+      producer.join();
+      EXPECT_EQ(size_t{ 100u }, strings.size());
+      strings.clear(); // released from another thread
+      strings.shrink_to_fit();
+      EXPECT_EQ(size_t{ 0 }, pool.stats().bytesInUse);
+    }
+    EXPECT_EQ(size_t{ 0 }, upstream.invalidReleases);
+  }
+
+
+  // -- containers --
+
+  TEST_F(MemoryResourceTest, lightVectorWithResource) {
+    _CountingResource resource;
+    {
+      LightVector<int> values(&resource);
+      EXPECT_EQ(&resource, values.resource());
+      for (int i = 0; i < 100; ++i)
+        values.push_back(i);
+      values.insert(0, -1);
+      values.reserve(500);
+      values.shrink_to_fit();
+      EXPECT_EQ(size_t{ 101u }, values.size());
+      EXPECT_EQ(-1, values[0]);
+      EXPECT_EQ(99, values[100]);
+      EXPECT_NE(size_t{ 0 }, resource.allocations);
+
+      LightVector<int> copy(values); // copy: default allocation
+      EXPECT_TRUE(copy.resource() == nullptr);
+      LightVector<int> copyWithResource(values, &resource);
+      EXPECT_EQ(&resource, copyWithResource.resource());
+      ASSERT_EQ(copy.size(), copyWithResource.size());
+      EXPECT_EQ(copy[100], copyWithResource[100]);
+
+      LightVector<int> moved(std::move(values)); // move: resource propagated
+      EXPECT_EQ(&resource, moved.resource());
+      EXPECT_EQ(size_t{ 101u }, moved.size());
+
+      LightVector<_ResourceItem> items(size_t{ 3u }, &resource);
+      for (int i = 0; i < 50; ++i)
+        items.emplace_back(i);
+      items.append(items.data(), size_t{ 10u }); // self-referencing range
+      items.insert(1, _ResourceItem(42));
+      EXPECT_EQ(size_t{ 64u }, items.size());
+      EXPECT_EQ(42, *(items[1].value));
+      EXPECT_EQ(6, *(items[63].value)); // 3 default items + 0..6
+      items.clear();
+      items.shrink_to_fit();
+    }
+    EXPECT_EQ(size_t{ 0 }, resource.invalidReleases);
+  }
+
+  TEST_F(MemoryResourceTest, dynamicArrayWithResource) {
+    _CountingResource resource;
+    {
+      DynamicArray<_ResourceItem> items(size_t{ 8u }, &resource);
+      EXPECT_EQ(&resource, items.resource());
+      EXPECT_EQ(size_t{ 8u }, items.size());
+      EXPECT_EQ(size_t{ 1u }, resource.allocations);
+      items[2] = _ResourceItem(5);
+
+      DynamicArray<_ResourceItem> copy(items, &resource);
+      EXPECT_EQ(5, *(copy[2].value));
+      DynamicArray<_ResourceItem> moved(std::move(items));
+      EXPECT_EQ(&resource, moved.resource());
+      EXPECT_EQ(5, *(moved[2].value));
+      copy = moved; // copy-assign: keeps own resource
+      EXPECT_EQ(&resource, copy.resource());
+
+      int raw[] = { 1, 2, 3 };
+      DynamicArray<int> values(raw, size_t{ 3u }, &resource);
+      EXPECT_EQ(3, values[2]);
+      values.clear();
+      EXPECT_EQ(size_t{ 0 }, values.size());
+    }
+    EXPECT_EQ(size_t{ 0 }, resource.invalidReleases);
+  }
+
+  TEST_F(MemoryResourceTest, lightStringWithResource) {
+    _CountingResource resource;
+    {
+      LightString text("abc", &resource);
+      EXPECT_EQ(&resource, text.resource());
+      EXPECT_TRUE(text == "abc");
+      text.append("def");
+      text.assign("x"); // shorter: buffer kept
+      text.append("yz");
+      text += text; // self-append
+      EXPECT_TRUE(text == "xyzxyz");
+
+      LightString filled(size_t{ 4u }, 'a', &resource);
+      EXPECT_TRUE(filled == "aaaa");
+      LightString moved(std::move(filled));
+      EXPECT_EQ(&resource, moved.resource());
+      moved = std::move(text);
+      EXPECT_TRUE(moved == "xyzxyz");
+      LightString copy(moved, &resource);
+      EXPECT_TRUE(copy == moved);
+
+      LightWString wtext(L"abc", &resource);
+      wtext.append(L"def");
+      wtext += wtext;
+      EXPECT_TRUE(wtext == L"abcdefabcdef");
+      LightWString wfilled(size_t{ 2u }, L'b', &resource);
+      EXPECT_TRUE(wfilled == L"bb");
+      wfilled.clear();
+      EXPECT_TRUE(wfilled.empty());
+    }
+    EXPECT_EQ(size_t{ 0 }, resource.invalidReleases);
+  }
+
+  TEST_F(MemoryResourceTest, containersInArena) {
+    MonotonicPoolResource<4096> arena;
+    {
+      LightVector<LightString> strings(&arena);
+      for (int i = 0; i < 20; ++i)
+        strings.emplace_back(std::to_string(i).c_str(), &arena);
+      EXPECT_TRUE(strings[19] == "19");
+    }
+    arena.release();
+  }
+
+#endif
@@ -0,0 +1,214 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include <gtest/gtest.h>
+#include <vector>
+#include <memory/object_pool.h>
+
+using namespace pandora::memory;
+
+class ObjectPoolTest : public testing::Test {
+public:
+protected:
+  //static void SetUpTestCase() {}
+  //static void TearDownTestCase() {}
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+
+// -- helpers --
+
+class _PoolMessage final {
+public:
+  _PoolMessage(int id, double value) : id(id), value(value) { ++counter; }
+  _PoolMessage(const _PoolMessage& rhs) : id(rhs.id), value(rhs.value) { ++counter; }
+  ~_PoolMessage() { --counter; }
+
+  int id;
+  double value;
+  static int counter;
+};
+int _PoolMessage::counter = 0;
+
+struct _ThrowingType {
+  _ThrowingType(bool isThrowing) { if (isThrowing) throw std::runtime_error("ctor"); }
+};
+
+
+// -- metadata accessors --
+
+TEST_F(ObjectPoolTest, ctorAccessors) {
+  ObjectPool<uint64_t, 16u, 0, MemoryPoolAllocation::onStack> stackPool;
+  EXPECT_EQ(MemoryPoolAllocation::onStack, stackPool.allocationType());
+  EXPECT_EQ(size_t{ 16u }, stackPool.capacity());
+  EXPECT_EQ(size_t{ 0 }, stackPool.size());
+  EXPECT_TRUE(stackPool.empty());
+  EXPECT_FALSE(stackPool.full());
+  EXPECT_FALSE(stackPool.isTracking());
+  EXPECT_EQ(size_t{ 0 }, stackPool.guardSize());
+  EXPECT_EQ(sizeof(uint64_t), stackPool.objectSize());
+  EXPECT_EQ(sizeof(uint64_t), stackPool.blockSize());
+
+  ObjectPool<char, 1000u, 6u, MemoryPoolAllocation::onHeap, true> heapPool;
+  EXPECT_EQ(MemoryPoolAllocation::onHeap, heapPool.allocationType());
+  EXPECT_EQ(size_t{ 1000u }, heapPool.capacity());
+  EXPECT_TRUE(heapPool.isTracking());
+  EXPECT_EQ(size_t{ 6u }, heapPool.guardSize());
+  EXPECT_EQ(sizeof(uint32_t), heapPool.objectSize()); // room for free list index
+  EXPECT_EQ(size_t{ 10u }, heapPool.blockSize());
+  EXPECT_TRUE(heapPool.verifyGuardBands());
+}
+
+// -- allocation --
+
+TEST_F(ObjectPoolTest, allocateDeallocate) {
+  ObjectPool<uint32_t, 4u> pool;
+  std::vector<void*> blocks;
+  for (int i = 0; i < 4; ++i) {
+    void* block = pool.allocate();
+    ASSERT_NE(nullptr, block);
+    EXPECT_TRUE(pool.contains(block));
+    EXPECT_EQ(size_t(i), pool.indexOf(block));
+    *static_cast<uint32_t*>(block) = 42u + i;
+    blocks.push_back(block);
+  }
+  EXPECT_EQ(size_t{ 4u }, pool.size());
+  EXPECT_TRUE(pool.full());
+  EXPECT_EQ(nullptr, pool.allocate());
+
+  uint32_t outsider = 0;
+  EXPECT_FALSE(pool.contains(&outsider));
+  EXPECT_FALSE(pool.contains(static_cast<uint8_t*>(blocks[0]) + 1));
+
+  pool.deallocate(blocks[2]);
+  pool.deallocate(blocks[0]);
+  EXPECT_EQ(size_t{ 2u }, pool.size());
+  EXPECT_FALSE(pool.full());
+  EXPECT_EQ(blocks[0], pool.allocate()); // LIFO reuse (hot block)
+  EXPECT_EQ(blocks[2], pool.allocate());
+  EXPECT_EQ(nullptr, pool.allocate());
+  EXPECT_EQ(43u, *static_cast<uint32_t*>(blocks[1]));
+  EXPECT_EQ(45u, *static_cast<uint32_t*>(blocks[3]));
+
+  pool.clear();
+  EXPECT_TRUE(pool.empty());
+  EXPECT_EQ(blocks[0], pool.allocate());
+}
+
+TEST_F(ObjectPoolTest, createDestroyObjects) {
+  _PoolMessage::counter = 0;
+  {
+    ObjectPool<_PoolMessage, 600u> pool; // automatic -> heap (above 8000 bytes)
+    EXPECT_EQ(MemoryPoolAllocation::onHeap, pool.allocationType());
+    std::vector<_PoolMessage*> messages;
+    for (int i = 0; i < 600; ++i) {
+      _PoolMessage* msg = pool.create(i, 0.5*i);
+      ASSERT_NE(nullptr, msg);
+      EXPECT_EQ(0u, (uintptr_t)msg % alignof(_PoolMessage));
+      messages.push_back(msg);
+    }
+    EXPECT_EQ(nullptr, pool.create(-1, 0.0));
+    EXPECT_EQ(600, _PoolMessage::counter);
+
+    for (size_t i = 0; i < messages.size(); i += 2)
+      pool.destroy(messages[i]);
+    pool.destroy(nullptr);
+    EXPECT_EQ(300, _PoolMessage::counter);
+    EXPECT_EQ(size_t{ 300u }, pool.size());
+    for (size_t i = 1; i < messages.size(); i += 2) {
+      EXPECT_EQ((int)i, messages[i]->id);
+      EXPECT_EQ(0.5*(int)i, messages[i]->value);
+      pool.destroy(messages[i]);
+    }
+    EXPECT_EQ(0, _PoolMessage::counter);
+    EXPECT_TRUE(pool.empty());
+  }
+  EXPECT_EQ(0, _PoolMessage::counter);
+}
+
+TEST_F(ObjectPoolTest, createThrowing) {
+  ObjectPool<_ThrowingType, 2u> pool;
+  EXPECT_THROW(pool.create(true), std::runtime_error);
+  EXPECT_TRUE(pool.empty());
+  EXPECT_NE(nullptr, pool.create(false));
+  EXPECT_NE(nullptr, pool.create(false));
+  EXPECT_TRUE(pool.full());
+}
+
+// -- tracking mode --
+
+TEST_F(ObjectPoolTest, trackingIteration) {
+  _PoolMessage::counter = 0;
+  {
+    ObjectPool<_PoolMessage, 130u, 0, MemoryPoolAllocation::automatic, true> pool;
+    std::vector<_PoolMessage*> messages;
+    for (int i = 0; i < 130; ++i)
+      messages.push_back(pool.create(i, 1.0));
+    for (size_t i = 0; i < messages.size(); ++i) {
+      if (i % 3u != 0)
+        pool.destroy(messages[i]);
+    }
+    EXPECT_TRUE(pool.isAllocated(0));
+    EXPECT_FALSE(pool.isAllocated(1));
+    EXPECT_TRUE(pool.isAllocated(129));
+    EXPECT_FALSE(pool.isAllocated(130));
+
+    std::vector<int> ids;
+    pool.forEach([&ids](_PoolMessage& msg) { ids.push_back(msg.id); });
+    ASSERT_EQ(size_t{ 44u }, ids.size());
+    for (size_t i = 0; i < ids.size(); ++i)
+      EXPECT_EQ((int)i*3, ids[i]);
+
+    pool.forEach([&pool](_PoolMessage& msg) { if (msg.id >= 66) pool.destroy(&msg); });
+    EXPECT_EQ(size_t{ 22u }, pool.size());
+    EXPECT_EQ(22, _PoolMessage::counter);
+  } // remaining objects destroyed with pool
+  EXPECT_EQ(0, _PoolMessage::counter);
+
+  ObjectPool<_PoolMessage, 8u, 0, MemoryPoolAllocation::onStack, true> pool;
+  pool.create(1, 1.0);
+  pool.create(2, 2.0);
+  EXPECT_EQ(2, _PoolMessage::counter);
+  pool.clear();
+  EXPECT_EQ(0, _PoolMessage::counter);
+  EXPECT_TRUE(pool.empty());
+}
+
+// -- guard bands --
+
+TEST_F(ObjectPoolTest, guardBandVerification) {
+  ObjectPool<uint32_t, 8u, 8u, MemoryPoolAllocation::onStack> pool;
+  EXPECT_EQ(size_t{ 8u }, pool.guardSize());
+  EXPECT_EQ(size_t{ 12u }, pool.blockSize());
+
+  uint32_t* first = pool.create(1u);
+  uint32_t* second = pool.create(2u);
+  EXPECT_TRUE(pool.verifyGuardBands());
+  EXPECT_TRUE(pool.verifyGuardBands(first));
+  EXPECT_FALSE(pool.verifyGuardBands(&first[1])); // not a block
+
+  first[1] = 0xDEADu; // overflow -> write in guard band between blocks
+  EXPECT_FALSE(pool.verifyGuardBands());
+  EXPECT_FALSE(pool.verifyGuardBands(first));
+  EXPECT_FALSE(pool.verifyGuardBands(second));
+  EXPECT_TRUE(pool.verifyGuardBands(pool.create(3u)));
+
+  pool.clear(); // restore guard bands
+  EXPECT_TRUE(pool.verifyGuardBands());
+}
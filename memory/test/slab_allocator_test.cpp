@@ -0,0 +1,288 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include <gtest/gtest.h>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <memory/slab_allocator.h>
+
+using namespace pandora::memory;
+
+class SlabAllocatorTest : public testing::Test {
+public:
+protected:
+  //static void SetUpTestCase() {}
+  //static void TearDownTestCase() {}
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+using _TestSlabAllocator = SlabAllocator<16u, size_t{ 256u*1024u }>;
+
+
+// -- size classes --
+
+TEST_F(SlabAllocatorTest, sizeClasses) {
+  EXPECT_EQ(size_t{ 0 }, _TestSlabAllocator::sizeClass(1u));
+  EXPECT_EQ(size_t{ 0 }, _TestSlabAllocator::sizeClass(8u));
+  EXPECT_EQ(size_t{ 1u }, _TestSlabAllocator::sizeClass(9u));
+  EXPECT_EQ(size_t{ 8u }, _TestSlabAllocator::sizeClass(128u));
+  EXPECT_EQ(size_t{ 9u }, _TestSlabAllocator::sizeClass(129u));
+  EXPECT_EQ(size_t{ 20u }, _TestSlabAllocator::sizeClass(1024u));
+  EXPECT_EQ(size_t{ 8u }, _TestSlabAllocator::blockSize(0));
+  EXPECT_EQ(size_t{ 160u }, _TestSlabAllocator::blockSize(9u));
+  EXPECT_EQ(size_t{ 1024u }, _TestSlabAllocator::blockSize(_TestSlabAllocator::sizeClassCount() - 1u));
+
+  for (size_t size = 1u; size <= _TestSlabAllocator::maxBlockSize(); ++size) {
+    size_t index = _TestSlabAllocator::sizeClass(size);
+    ASSERT_LT(index, _TestSlabAllocator::sizeClassCount());
+    EXPECT_GE(_TestSlabAllocator::blockSize(index), size);
+    if (index > 0) {
+      EXPECT_LT(_TestSlabAllocator::blockSize(index - 1u), size); // smallest class
+    }
+  }
+}
+
+// -- allocation --
+
+TEST_F(SlabAllocatorTest, allocateRelease) {
+  _TestSlabAllocator allocator;
+  EXPECT_EQ(nullptr, allocator.allocate(0));
+  allocator.deallocate(nullptr, 8u);
+
+  std::vector<std::pair<uint8_t*,size_t> > blocks;
+  for (size_t i = 0; i < 2000u; ++i) {
+    size_t size = 1u + (i*37u) % _TestSlabAllocator::maxBlockSize();
+    uint8_t* block = static_cast<uint8_t*>(allocator.allocate(size));
+    ASSERT_NE(nullptr, block);
+    EXPECT_EQ(0u, (uintptr_t)block % ((size > 8u) ? 16u : 8u));
+    memset(block, (int)(i & 0xFFu), size);
+    blocks.emplace_back(block, size);
+  }
+  for (size_t i = 0; i < blocks.size(); ++i) { // no overlap
+    for (size_t b = 0; b < blocks[i].second; ++b)
+      ASSERT_EQ((uint8_t)(i & 0xFFu), blocks[i].first[b]);
+  }
+
+  SlabAllocatorStats stats = allocator.stats();
+  EXPECT_EQ(uint64_t{ 2000u }, stats.allocations);
+  EXPECT_EQ(uint64_t{ 0 }, stats.largeAllocations);
+  EXPECT_GT(stats.bytesInUse, uint64_t{ 0 });
+  EXPECT_GE(stats.bytesReserved, stats.bytesInUse);
+  EXPECT_EQ(uint64_t{ 0 }, stats.bytesReserved % (256u*1024u));
+  EXPECT_GE(stats.fragmentation(), 0.0);
+  EXPECT_LT(stats.fragmentation(), 1.0);
+
+  for (auto& block : blocks)
+    allocator.deallocate(block.first, block.second);
+  stats = allocator.stats();
+  EXPECT_EQ(uint64_t{ 0 }, stats.bytesInUse);
+  EXPECT_EQ(uint64_t{ 0 }, stats.uncachedReleases);
+  EXPECT_EQ(1.0, stats.fragmentation());
+}
+
+TEST_F(SlabAllocatorTest, cacheReuse) {
+  _TestSlabAllocator allocator;
+  void* first = allocator.allocate(24u);
+  allocator.deallocate(first, 24u);
+  EXPECT_EQ(first, allocator.allocate(32u)); // same size class -> same block (LIFO)
+  allocator.deallocate(first, 32u);
+
+  for (int i = 0; i < 1000; ++i) {
+    void* blocks[4] = { allocator.allocate(100u), allocator.allocate(100u), allocator.allocate(100u), allocator.allocate(100u) };
+    for (auto* block : blocks)
+      allocator.deallocate(block, 100u);
+  }
+  SlabAllocatorStats stats = allocator.stats();
+  EXPECT_EQ(uint64_t{ 4002u }, stats.allocations);
+  EXPECT_GT(stats.cacheHitRate(), 0.99);
+  EXPECT_EQ(uint64_t{ 0 }, stats.bytesInUse);
+
+  allocator.flushThreadCache(); // blocks available from depot
+  void* block = allocator.allocate(100u);
+  EXPECT_NE(nullptr, block);
+  allocator.deallocate(block, 100u);
+}
+
+TEST_F(SlabAllocatorTest, largeAllocations) {
+  _TestSlabAllocator allocator;
+  uint8_t* block = static_cast<uint8_t*>(allocator.allocate(5000u));
+  ASSERT_NE(nullptr, block);
+  memset(block, 1, 5000u);
+  allocator.deallocate(block, 5000u);
+  SlabAllocatorStats stats = allocator.stats();
+  EXPECT_EQ(uint64_t{ 1u }, stats.largeAllocations);
+  EXPECT_EQ(uint64_t{ 0 }, stats.allocations);
+  EXPECT_EQ(uint64_t{ 0 }, stats.bytesReserved);
+}
+
+// -- multithreading --
+
+TEST_F(SlabAllocatorTest, producerConsumerRelease) {
+  _TestSlabAllocator allocator;
+  std::mutex lock;
+  std::condition_variable condition;
+  std::deque<std::vector<uint32_t*> > batches;
+  bool isDone = false;
+  const uint32_t batchCount = 200u, batchSize = 64u;
+
+  std::thread consumer([&]() {
+    uint32_t received = 0;
+    while (true) {
+      std::vector<uint32_t*> batch;
+      {
+        std::unique_lock<std::mutex> guard(lock);
+        condition.wait(guard, [&]() { return !batches.empty() || isDone; });
+        if (batches.empty())
+          break;
+        batch = std::move(batches.front());
+        batches.pop_front();
+      }
+      for (auto* message : batch) {
+        EXPECT_EQ(received++, *message);
+        allocator.deallocate(message, 48u); // released by other thread
+      }
+    }
+    EXPECT_EQ(batchCount*batchSize, received);
+  });
+  std::thread producer([&]() {
+    uint32_t sent = 0;
+    for (uint32_t b = 0; b < batchCount; ++b) {
+      std::vector<uint32_t*> batch;
+      for (uint32_t i = 0; i < batchSize; ++i) {
+        uint32_t* message = static_cast<uint32_t*>(allocator.allocate(48u));
+        *message = sent++;
+        batch.push_back(message);
+      }
+      std::lock_guard<std::mutex> guard(lock);
+      batches.push_back(std::move(batch));
+      condition.notify_one();
+    }
+    std::lock_guard<std::mutex> guard(lock);
+    isDone = true;
+    condition.notify_one();
+  });
+  producer.join();
+  consumer.join();
+
+  SlabAllocatorStats stats = allocator.stats(); // thread caches returned to depot
+  EXPECT_EQ(uint64_t{ batchCount*batchSize }, stats.allocations);
+  EXPECT_EQ(uint64_t{ 0 }, stats.bytesInUse);
+  EXPECT_GT(stats.bytesReserved, uint64_t{ 0 });
+}
+
+TEST_F(SlabAllocatorTest, releaseOnlyThread) {
+  _TestSlabAllocator allocator;
+  std::vector<void*> blocks;
+  for (int i = 0; i < 100; ++i)
+    blocks.push_back(allocator.allocate(64u));
+
+  std::thread([&allocator, &blocks]() { // first call of thread: release (cache created by deallocate)
+    for (auto* block : blocks)
+      allocator.deallocate(block, 64u);
+  }).join();
+
+  SlabAllocatorStats stats = allocator.stats();
+  EXPECT_EQ(uint64_t{ 100u }, stats.allocations);
+  EXPECT_EQ(uint64_t{ 0 }, stats.bytesInUse);
+  EXPECT_EQ(uint64_t{ 0 }, stats.uncachedReleases);
+}
+
+struct _ThreadExitRelease final { // thread_local constructed before the thread caches -> destroyed after them
+  _TestSlabAllocator* allocator = nullptr;
+  void* block = nullptr;
+  ~_ThreadExitRelease() {
+    if (allocator != nullptr) {
+      allocator->deallocate(block, 24u);
+      void* other = allocator->allocate(24u); // no thread cache anymore -> depot
+      EXPECT_NE(nullptr, other);
+      allocator->deallocate(other, 24u);
+    }
+  }
+};
+
+TEST_F(SlabAllocatorTest, releaseAtThreadExit) {
+  _TestSlabAllocator allocator;
+  std::thread([&allocator]() {
+    static thread_local _ThreadExitRelease exitRelease;
+    exitRelease.allocator = &allocator;
+    exitRelease.block = allocator.allocate(24u);
+  }).join();
+
+  SlabAllocatorStats stats = allocator.stats();
+  EXPECT_EQ(uint64_t{ 2u }, stats.allocations);
+  EXPECT_EQ(uint64_t{ 0 }, stats.cacheHits); // first allocation: cache miss, second: no cache
+  EXPECT_EQ(uint64_t{ 2u }, stats.uncachedReleases);
+  EXPECT_EQ(uint64_t{ 0 }, stats.bytesInUse);
+
+  void* block = allocator.allocate(24u); // blocks of depot free list reused
+  EXPECT_NE(nullptr, block);
+  allocator.deallocate(block, 24u);
+  EXPECT_EQ(uint64_t{ 0 }, allocator.stats().bytesInUse);
+}
+
+TEST_F(SlabAllocatorTest, parallelChurn) {
+  _TestSlabAllocator allocator;
+  std::vector<std::thread> threads;
+  for (uint32_t t = 0; t < 4u; ++t) {
+    threads.emplace_back([&allocator, t]() {
+      std::vector<std::pair<uint8_t*,size_t> > blocks;
+      uint32_t seed = 12345u + t;
+      for (int i = 0; i < 20000; ++i) {
+        seed = seed*1103515245u + 12345u;
+        if (blocks.size() < 64u && (seed & 0x10000u) != 0) {
+          size_t size = 1u + (seed >> 8) % 600u;
+          uint8_t* block = static_cast<uint8_t*>(allocator.allocate(size));
+          memset(block, (int)t, size);
+          blocks.emplace_back(block, size);
+        }
+        else if (!blocks.empty()) {
+          auto block = blocks.back();
+          blocks.pop_back();
+          for (size_t b = 0; b < block.second; ++b)
+            ASSERT_EQ((uint8_t)t, block.first[b]);
+          allocator.deallocate(block.first, block.second);
+        }
+      }
+      for (auto& block : blocks)
+        allocator.deallocate(block.first, block.second);
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  EXPECT_EQ(uint64_t{ 0 }, allocator.stats().bytesInUse);
+}
+
+TEST_F(SlabAllocatorTest, allocatorLifetime) {
+  for (int i = 0; i < 3; ++i) { // caches of destroyed allocators released by next allocator
+    auto* allocator = new _TestSlabAllocator();
+    void* block = allocator->allocate(64u);
+    allocator->deallocate(block, 64u);
+    delete allocator;
+  }
+  _TestSlabAllocator allocator;
+  std::thread([&allocator]() {
+    void* block = allocator.allocate(200u);
+    allocator.deallocate(block, 200u);
+  }).join();
+  EXPECT_EQ(uint64_t{ 1u }, allocator.stats().allocations);
+}
@@ -0,0 +1,176 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+--------------------------------------------------------------------------------
+Description : measure allocation/release patterns with different allocators for benchmark utility
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <memory/slab_allocator.h>
+#include <memory/arena_allocator.h>
+
+// system allocator (same interface as SlabAllocator)
+struct MallocAllocator final {
+  inline void* allocate(size_t size) { return malloc(size); }
+  inline void deallocate(void* block, size_t) noexcept { free(block); }
+};
+
+// per-request allocator: global new/delete (each block released individually)
+struct NewDeleteRequestAllocator final {
+  inline void* allocate(size_t size) { return ::operator new(size); }
+  inline void deallocate(void* block, size_t) noexcept { ::operator delete(block); }
+  inline void endRequest() noexcept {}
+};
+// per-request allocator: arena (blocks reclaimed at once at the end of the request)
+struct ArenaRequestAllocator final {
+  inline void* allocate(size_t size) { return arena.allocate(size); }
+  inline void deallocate(void*, size_t) noexcept {}
+  inline void endRequest() noexcept { arena.reset(); }
+  pandora::memory::ArenaAllocator<> arena;
+};
+
+// ---
+
+// local churn: each thread allocates/releases blocks of random sizes (16 - 512 bytes) in a working set
+// -> average duration of an allocation + release pair, for one thread (nanoseconds)
+template <typename _Allocator>
+inline double benchmarkLocalChurn(_Allocator& allocator, uint32_t threadCount, uint32_t pairsPerThread) {
+  auto start = std::chrono::high_resolution_clock::now();
+  std::vector<std::thread> threads;
+  for (uint32_t t = 0; t < threadCount; ++t) {
+    threads.emplace_back([&allocator, pairsPerThread, t]() {
+      const size_t workingSetSize = 256u;
+      std::vector<std::pair<void*,size_t> > blocks(workingSetSize, std::pair<void*,size_t>(nullptr, 0));
+      uint32_t seed = 0x5EEDu + t;
+      for (uint32_t i = 0; i < pairsPerThread; ++i) {
+        seed = seed*1103515245u + 12345u;
+        auto& slot = blocks[(seed >> 4) % workingSetSize];
+        if (slot.first != nullptr)
+          allocator.deallocate(slot.first, slot.second);
+        slot.second = 16u + (seed >> 16) % 497u;
+        slot.first = allocator.allocate(slot.second);
+        *static_cast<uint8_t*>(slot.first) = static_cast<uint8_t>(i); // touch memory
+      }
+      for (auto& slot : blocks) {
+        if (slot.first != nullptr)
+          allocator.deallocate(slot.first, slot.second);
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  auto end = std::chrono::high_resolution_clock::now();
+  return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count())
+       / static_cast<double>(pairsPerThread);
+}
+
+// producer/consumer: messages allocated by producer threads, released by consumer threads (cross-thread release)
+// -> average duration per message, for one producer/consumer pair (nanoseconds)
+template <typename _Allocator>
+inline double benchmarkProducerConsumer(_Allocator& allocator, uint32_t pairCount, uint32_t messagesPerPair) {
+  const uint32_t batchSize = 64u; // messages transferred in batches (reduce queue overhead)
+  const size_t messageSize = 96u;
+  struct Channel final {
+    std::mutex lock;
+    std::condition_variable condition;
+    std::deque<std::vector<void*> > batches;
+    bool isDone = false;
+  };
+  std::vector<std::unique_ptr<Channel> > channels;
+  for (uint32_t p = 0; p < pairCount; ++p)
+    channels.emplace_back(new Channel());
+
+  auto start = std::chrono::high_resolution_clock::now();
+  std::vector<std::thread> threads;
+  for (uint32_t p = 0; p < pairCount; ++p) {
+    Channel& channel = *channels[p];
+    threads.emplace_back([&allocator, &channel, messagesPerPair, batchSize, messageSize]() { // producer
+      std::vector<void*> batch;
+      for (uint32_t i = 0; i < messagesPerPair; ++i) {
+        void* message = allocator.allocate(messageSize);
+        *static_cast<uint32_t*>(message) = i;
+        batch.push_back(message);
+        if (batch.size() >= batchSize || i + 1u == messagesPerPair) {
+          std::lock_guard<std::mutex> guard(channel.lock);
+          channel.batches.push_back(std::move(batch));
+          batch = std::vector<void*>{};
+          channel.condition.notify_one();
+        }
+      }
+      std::lock_guard<std::mutex> guard(channel.lock);
+      channel.isDone = true;
+      channel.condition.notify_one();
+    });
+    threads.emplace_back([&allocator, &channel, messageSize]() { // consumer
+      while (true) {
+        std::vector<void*> batch;
+        {
+          std::unique_lock<std::mutex> guard(channel.lock);
+          channel.condition.wait(guard, [&channel]() { return (!channel.batches.empty() || channel.isDone); });
+          if (channel.batches.empty())
+            break;
+          batch = std::move(channel.batches.front());
+          channel.batches.pop_front();
+        }
+        for (auto* message : batch)
+          allocator.deallocate(message, messageSize);
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  auto end = std::chrono::high_resolution_clock::now();
+  return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count())
+       / static_cast<double>(messagesPerPair);
+}
+
+// request workload: each request allocates blocks of random sizes (16 - 256 bytes), used until the end of the request
+// -> average duration of an allocation (including its release at the end of the request) (nanoseconds)
+template <typename _Allocator>
+inline double benchmarkRequests(_Allocator& allocator, uint32_t allocationsPerRequest, uint32_t totalAllocations) {
+  std::vector<std::pair<void*,size_t> > blocks;
+  blocks.reserve(allocationsPerRequest);
+  uint32_t requestCount = (totalAllocations + allocationsPerRequest - 1u) / allocationsPerRequest;
+  uint32_t seed = 0x5EEDu;
+
+  auto start = std::chrono::high_resolution_clock::now();
+  for (uint32_t r = 0; r < requestCount; ++r) {
+    for (uint32_t i = 0; i < allocationsPerRequest; ++i) {
+      seed = seed*1103515245u + 12345u;
+      size_t size = 16u + (seed >> 16) % 241u;
+      void* block = allocator.allocate(size);
+      *static_cast<uint8_t*>(block) = static_cast<uint8_t>(i); // touch memory
+      blocks.emplace_back(block, size);
+    }
+    for (auto& block : blocks)
+      allocator.deallocate(block.first, block.second);
+    blocks.clear();
+    allocator.endRequest();
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count())
+       / static_cast<double>(requestCount * allocationsPerRequest);
+}
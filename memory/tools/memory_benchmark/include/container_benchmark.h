@@ -0,0 +1,72 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+--------------------------------------------------------------------------------
+Description : measure append operations in vector containers for benchmark utility
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+#include <vector>
+#include <memory/light_vector.h>
+
+// item type with non-trivial copy/move (can't be relocated with memcpy/realloc)
+struct BenchmarkObject final {
+  BenchmarkObject(uint64_t value) noexcept : a(value), b(value + 1u) {}
+  BenchmarkObject(const BenchmarkObject& rhs) noexcept : a(rhs.a), b(rhs.b) {}
+  BenchmarkObject(BenchmarkObject&& rhs) noexcept : a(rhs.a), b(rhs.b) { rhs.b = 0; }
+  BenchmarkObject& operator=(const BenchmarkObject& rhs) noexcept { a = rhs.a; b = rhs.b; return *this; }
+  BenchmarkObject& operator=(BenchmarkObject&& rhs) noexcept { a = rhs.a; b = rhs.b; rhs.b = 0; return *this; }
+  ~BenchmarkObject() noexcept {}
+  uint64_t a;
+  uint64_t b;
+};
+
+// ---
+
+template <typename _ItemType>
+using StdVector = std::vector<_ItemType>;
+template <typename _ItemType>
+using LightVectorX2 = pandora::memory::LightVector<_ItemType, 200u>;
+template <typename _ItemType>
+using LightVectorX15 = pandora::memory::LightVector<_ItemType, 150u>;
+
+// create vector with 'itemCount' items (one by one) -> average duration per append (nanoseconds)
+// - same total number of appends for all item counts (small vectors are created many times)
+template <template <typename> class _Vector, typename _ItemType, bool _IsReserved>
+inline double benchmarkVectorAppends(uint32_t itemCount, uint32_t totalAppends) {
+  uint32_t rounds = (itemCount < totalAppends) ? totalAppends / itemCount : 1u;
+  uint64_t checksum = 0;
+
+  auto start = std::chrono::high_resolution_clock::now();
+  for (uint32_t round = 0; round < rounds; ++round) {
+    _Vector<_ItemType> vec;
+    if (_IsReserved)
+      vec.reserve(itemCount);
+    for (uint32_t i = 0; i < itemCount; ++i)
+      vec.emplace_back(static_cast<uint64_t>(i));
+    checksum += static_cast<uint64_t>(vec.size());
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+
+  if (checksum != static_cast<uint64_t>(rounds) * itemCount) // use result (avoid optimizing loop away)
+    return -1.0;
+  return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count())
+       / (static_cast<double>(rounds) * static_cast<double>(itemCount));
+}
@@ -0,0 +1,158 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+--------------------------------------------------------------------------------
+Benchmark utility to compare the efficiency of memory containers and allocators.
+*******************************************************************************/
+#ifdef _MSC_VER
+# define _CRT_SECURE_NO_WARNINGS
+#endif
+#if defined(__ANDROID__)
+# include <system/api/android_app.h>
+#endif
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "container_benchmark.h"
+#include "allocator_benchmark.h"
+#include "display.h"
+
+#define _TOTAL_APPENDS 10000000u
+#define _ALLOC_PAIRS_PER_THREAD 2000000u
+#define _MESSAGES_PER_PAIR 1000000u
+#define _REQUEST_ALLOCATIONS 10000000u
+
+// -- container benchmarks --
+
+// benchmark - append items one by one (average duration per append, for each vector size)
+template <typename _ItemType>
+void measurePrintVectorAppendBenchmarks(const char* itemLabel, uint32_t maxItemCount) {
+  std::vector<uint32_t> itemCounts;
+  for (uint32_t count = 1000u; count <= maxItemCount; count *= 10u)
+    itemCounts.emplace_back(count);
+
+  std::vector<double> stdResults, lightResults, light15Results, stdReservedResults, lightReservedResults;
+  for (auto count : itemCounts) {
+    stdResults.emplace_back(benchmarkVectorAppends<StdVector, _ItemType, false>(count, _TOTAL_APPENDS));
+    lightResults.emplace_back(benchmarkVectorAppends<LightVectorX2, _ItemType, false>(count, _TOTAL_APPENDS));
+    light15Results.emplace_back(benchmarkVectorAppends<LightVectorX15, _ItemType, false>(count, _TOTAL_APPENDS));
+    stdReservedResults.emplace_back(benchmarkVectorAppends<StdVector, _ItemType, true>(count, _TOTAL_APPENDS));
+    lightReservedResults.emplace_back(benchmarkVectorAppends<LightVectorX2, _ItemType, true>(count, _TOTAL_APPENDS));
+  }
+
+  printf("%s:\n", itemLabel);
+  printResultHeader("Container (items)", itemCounts.data(), itemCounts.size());
+  printResultLine("std::vector", stdResults.data(), stdResults.size());
+  printResultLine("LightVector (x2)", lightResults.data(), lightResults.size());
+  printResultLine("LightVector (x1.5)", light15Results.data(), light15Results.size());
+  printResultLine("std::vector + reserve", stdReservedResults.data(), stdReservedResults.size());
+  printResultLine("LightVector + reserve", lightReservedResults.data(), lightReservedResults.size());
+  printf("\n");
+}
+
+// -- allocator benchmarks --
+
+// benchmark - small object allocations with system allocator vs slab allocator (for each thread count)
+void measurePrintAllocatorBenchmarks() {
+  const uint32_t threadCounts[] = { 1u, 2u, 4u, 8u };
+  const size_t threadCountsLength = sizeof(threadCounts)/sizeof(*threadCounts);
+  MallocAllocator mallocAllocator;
+  pandora::memory::SlabAllocator<> slabAllocator;
+
+  double mallocResults[threadCountsLength], slabResults[threadCountsLength];
+  for (size_t i = 0; i < threadCountsLength; ++i) {
+    mallocResults[i] = benchmarkLocalChurn(mallocAllocator, threadCounts[i], _ALLOC_PAIRS_PER_THREAD);
+    slabResults[i] = benchmarkLocalChurn(slabAllocator, threadCounts[i], _ALLOC_PAIRS_PER_THREAD);
+  }
+  printf("Local churn (alloc + release, 16-512 bytes):\n");
+  printResultHeader("Allocator (threads)", threadCounts, threadCountsLength);
+  printResultLine("malloc/free", mallocResults, threadCountsLength);
+  printResultLine("SlabAllocator", slabResults, threadCountsLength);
+  printf("\n");
+
+  for (size_t i = 0; i < threadCountsLength; ++i) {
+    mallocResults[i] = benchmarkProducerConsumer(mallocAllocator, threadCounts[i], _MESSAGES_PER_PAIR);
+    slabResults[i] = benchmarkProducerConsumer(slabAllocator, threadCounts[i], _MESSAGES_PER_PAIR);
+  }
+  printf("Producer/consumer (released by other thread, 96 bytes):\n");
+  printResultHeader("Allocator (thread pairs)", threadCounts, threadCountsLength);
+  printResultLine("malloc/free", mallocResults, threadCountsLength);
+  printResultLine("SlabAllocator", slabResults, threadCountsLength);
+  printf("\n");
+
+  pandora::memory::SlabAllocatorStats stats = slabAllocator.stats();
+  printf("SlabAllocator: cache hit rate %.2f%%, reserved %llu KB\n\n",
+         stats.cacheHitRate()*100.0, (unsigned long long)(stats.bytesReserved / 1024u));
+}
+
+// benchmark - per-request scratch allocations with new/delete vs arena (for each number of allocations per request)
+void measurePrintArenaBenchmarks() {
+  const uint32_t allocationCounts[] = { 10u, 100u, 1000u, 10000u };
+  const size_t allocationCountsLength = sizeof(allocationCounts)/sizeof(*allocationCounts);
+  NewDeleteRequestAllocator newDeleteAllocator;
+  ArenaRequestAllocator arenaAllocator;
+
+  double newDeleteResults[allocationCountsLength], arenaResults[allocationCountsLength];
+  for (size_t i = 0; i < allocationCountsLength; ++i) {
+    newDeleteResults[i] = benchmarkRequests(newDeleteAllocator, allocationCounts[i], _REQUEST_ALLOCATIONS);
+    arenaResults[i] = benchmarkRequests(arenaAllocator, allocationCounts[i], _REQUEST_ALLOCATIONS);
+  }
+  printf("Request workload (allocations released at end of request, 16-256 bytes):\n");
+  printResultHeader("Allocator (allocs/request)", allocationCounts, allocationCountsLength);
+  printResultLine("new/delete", newDeleteResults, allocationCountsLength);
+  printResultLine("ArenaAllocator", arenaResults, allocationCountsLength);
+  printf("\n");
+
+  printf("ArenaAllocator: peak usage %llu KB, %llu chunks (%llu KB)\n\n",
+         (unsigned long long)(arenaAllocator.arena.peakSize() / 1024u),
+         (unsigned long long)arenaAllocator.arena.chunkCount(),
+         (unsigned long long)(arenaAllocator.arena.capacity() / 1024u));
+}
+
+// ---
+
+// Main execution of benchmark utility
+void runBenchmarks() {
+  printTitle("Benchmark utility: vector appends (average duration per append)");
+  measurePrintVectorAppendBenchmarks<uint64_t>("Trivial items (uint64_t)", 10000000u);
+  measurePrintVectorAppendBenchmarks<BenchmarkObject>("Non-trivial items (16 bytes)", 1000000u);
+
+  printTitle("Benchmark utility: small object allocators (average duration per thread)");
+  measurePrintAllocatorBenchmarks();
+
+  printTitle("Benchmark utility: scratch memory per request (average duration per allocation)");
+  measurePrintArenaBenchmarks();
+}
+
+// ---
+
+#if defined(__ANDROID__)
+  void android_main(struct android_app* state) {
+    pandora::system::AndroidApp::instance().init(state);
+    runBenchmarks();
+  }
+#else
+  int main(int argc, char** argv) {
+    if (argc > 1) {
+      printf("Usage: %s\n", argv[0]);
+      return (strcmp(argv[1], "--help") == 0) ? 0 : 1;
+    }
+    runBenchmarks();
+    return 0;
+  }
+#endif
@@ -19,6 +19,7 @@ IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 #include <mutex>
+#include <shared_mutex>
 #include <memory>
 
 namespace pandora {
@@ -84,5 +85,62 @@ namespace pandora {
       _DataType* _data;
     };
 
+    // -- shared (read-only) access --
+
+    /// @class SharedLocked
+    /// @brief Locked shared pointer of an object, for read-only access with a shared lock (std::shared_mutex, thread::SharedSpinLock...)
+    /// @remarks Multiple readers can access the object simultaneously (use Locked for exclusive/write access).
+    template <typename _DataType, typename _LockType>
+    class SharedLocked final {
+    public:
+      /// @brief Create a pointer access that is locked (shared mode) until its destruction
+      SharedLocked(std::shared_ptr<const _DataType> data, _LockType& lock) noexcept
+        : _data(std::move(data)), _lock(lock) {}
+      /// @brief Create a pointer access that is locked (shared mode) until its destruction - already locked
+      SharedLocked(std::shared_ptr<const _DataType> data, std::shared_lock<_LockType>&& lock) noexcept
+        : _data(std::move(data)), _lock(std::move(lock)) {}
+      SharedLocked(const SharedLocked<_DataType, _LockType>&) = delete;
+      SharedLocked(SharedLocked<_DataType, _LockType>&&) = default;
+      SharedLocked<_DataType, _LockType>& operator=(const SharedLocked<_DataType, _LockType>&) = delete;
+      SharedLocked<_DataType, _LockType>& operator=(SharedLocked<_DataType, _LockType>&&) = default;
+      ~SharedLocked() = default;
+
+      inline const _DataType& value() const noexcept { assert(this->_data != nullptr); return *(this->_data); }
+      inline const _DataType& operator*() const noexcept { assert(this->_data != nullptr); return *(this->_data); }
+      inline const _DataType* operator->() const noexcept { assert(this->_data != nullptr); return this->_data.get(); }
+
+    private:
+      std::shared_ptr<const _DataType> _data;
+      std::shared_lock<_LockType> _lock;
+    };
+
+    /// @class SharedLockedRef
+    /// @brief Reference of an object, for read-only access with a shared lock (std::shared_mutex, thread::SharedSpinLock...)
+    /// @remarks Multiple readers can access the object simultaneously (use LockedRef for exclusive/write access).
+    /// @warning The lifetime of the referenced object is not guaranteed by the SharedLockedRef.
+    template <typename _DataType, typename _LockType>
+    class SharedLockedRef final {
+    public:
+      /// @brief Create a reference access that is locked (shared mode) until its destruction
+      SharedLockedRef(const _DataType& data, _LockType& lock) noexcept
+        : _lock(lock), _data(&data) {}
+      /// @brief Create a reference access that is locked (shared mode) until its destruction - already locked
+      SharedLockedRef(const _DataType& data, std::shared_lock<_LockType>&& lock) noexcept
+        : _lock(std::move(lock)), _data(&data) {}
+      SharedLockedRef(const SharedLockedRef<_DataType, _LockType>&) = delete;
+      SharedLockedRef(SharedLockedRef<_DataType, _LockType>&&) = default;
+      SharedLockedRef<_DataType, _LockType>& operator=(const SharedLockedRef<_DataType, _LockType>&) = delete;
+      SharedLockedRef<_DataType, _LockType>& operator=(SharedLockedRef<_DataType, _LockType>&&) = default;
+      ~SharedLockedRef() = default;
+
+      inline const _DataType& value() const noexcept { assert(this->_data != nullptr); return *(this->_data); }
+      inline const _DataType& operator*() const noexcept { assert(this->_data != nullptr); return *(this->_data); }
+      inline const _DataType* operator->() const noexcept { assert(this->_data != nullptr); return this->_data; }
+
+    private:
+      std::shared_lock<_LockType> _lock;
+      const _DataType* _data;
+    };
+
   }
 }
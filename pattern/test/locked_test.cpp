@@ -17,7 +17,9 @@ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
 IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 *******************************************************************************/
 #include <gtest/gtest.h>
+#include <thread>
 #include <mutex>
+#include <shared_mutex>
 #include <future>
 #include <pattern/locked.h>
 
@@ -167,4 +169,48 @@ TEST_F(LockedTest, concurrentRefAccess) {
   LockedRef<ObjectMock, std::mutex> locked(dummy, lock);
   EXPECT_TRUE(locked->x == 7);
   promise.get();
-}
\ No newline at end of file
+}
+// -- shared locked access --
+
+TEST_F(LockedTest, sharedLockedAccessors) {
+  auto dummy = std::make_shared<ObjectMock>(5, 6);
+  std::shared_timed_mutex lock;
+
+  SharedLocked<ObjectMock, std::shared_timed_mutex> locked(dummy, lock);
+  EXPECT_TRUE(locked.value().x == 5);
+  EXPECT_TRUE(*locked == ObjectMock(5, 6));
+  EXPECT_TRUE(locked->y == 6);
+  { // other readers allowed, writers blocked
+    SharedLocked<ObjectMock, std::shared_timed_mutex> otherReader(dummy, lock);
+    EXPECT_TRUE(otherReader->x == 5);
+    EXPECT_FALSE(lock.try_lock());
+  }
+
+  dummy = nullptr; // shared locked -> kept alive
+  SharedLocked<ObjectMock, std::shared_timed_mutex> lockedMoved(std::move(locked));
+  EXPECT_TRUE(lockedMoved->x == 5);
+  locked = std::move(lockedMoved);
+  EXPECT_TRUE(locked->x == 5);
+}
+
+TEST_F(LockedTest, sharedLockedRefAccessors) {
+  ObjectMock dummy(5, 6);
+  std::shared_timed_mutex lock;
+
+  std::shared_lock<std::shared_timed_mutex> guard(lock);
+  SharedLockedRef<ObjectMock, std::shared_timed_mutex> locked(dummy, std::move(guard));
+  EXPECT_TRUE(locked.value().x == 5);
+  EXPECT_TRUE(*locked == ObjectMock(5, 6));
+  EXPECT_TRUE(locked->y == 6);
+  {
+    SharedLockedRef<ObjectMock, std::shared_timed_mutex> otherReader(dummy, lock);
+    EXPECT_TRUE(otherReader->y == 6);
+    EXPECT_FALSE(lock.try_lock());
+  }
+
+  SharedLockedRef<ObjectMock, std::shared_timed_mutex> lockedMoved(std::move(locked));
+  EXPECT_TRUE(lockedMoved->x == 5);
+  EXPECT_FALSE(lock.try_lock());
+  locked = std::move(lockedMoved);
+  EXPECT_TRUE(locked->x == 5);
+}
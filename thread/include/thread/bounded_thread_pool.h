@@ -0,0 +1,332 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <stdexcept>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <utility>
+#include <type_traits>
+#include <system/trace.h>
+#include "./lock_free_queue.h"
+#include "./thread_pool.h"
+
+namespace pandora {
+  namespace thread {
+    /// @brief Behavior of job insertion when the job queue of a bounded pool is full
+    enum class FullQueueHandling : uint32_t {
+      reject = 0, ///< Job insertion fails immediately (addJob returns false)
+      wait = 1    ///< Job insertion blocks until a job is extracted from the queue (or until the pool is stopped)
+    };
+
+    /// @class BoundedThreadPool
+    /// @brief Fixed-size pool of threads with a fixed-capacity lock-free job queue.
+    /// @description Alternative to ThreadPool for very high job rates: jobs are stored in a pre-allocated lock-free queue,
+    ///              so producers don't serialize on a lock, and no memory is allocated when inserting a job.
+    ///              Threads only sleep (condition variable) when the queue is empty.
+    ///              When the queue is full, producers are rejected or blocked (see FullQueueHandling), to create backpressure.
+    ///              The tasks will be started by any thread in the pool in the order of their arrival.
+    template <typename _JobParamType,                        // Type of data container to process (must be movable)
+              ThreadRunnerMode _Mode = ThreadRunnerMode::single, // one function passed on construction / one per job
+              TaskRunnerType _FunctionType = TaskRunnerType::functionPointer, // function pointer / lambda
+              FullQueueHandling _FullQueue = FullQueueHandling::reject> // insertion behavior when queue is full
+    class BoundedThreadPool final {
+    public:
+      using Type = BoundedThreadPool<_JobParamType,_Mode,_FunctionType,_FullQueue>;
+      using size_type = size_t;
+      using task_runner_type = typename std::conditional<_FunctionType == TaskRunnerType::lambda, std::function<void(_JobParamType&)>, void (*)(_JobParamType&)>::type;
+      using task_runner_move = typename std::conditional<_FunctionType == TaskRunnerType::lambda, task_runner_type&&, task_runner_type>::type;
+    protected:
+      template<bool cond, typename _T>
+      using EnableIf = typename std::enable_if<cond, _T>::type;
+
+      using job_param_move = typename std::conditional<std::is_class<_JobParamType>::value, _JobParamType&&, _JobParamType>::type;
+      struct JobParamWithRunner { // Job data in 'perJob' mode (parameter + custom runner)
+        _JobParamType param;
+        task_runner_type runner;
+        JobParamWithRunner(job_param_move param) : param(std::move(param)), runner(nullptr) {}
+        JobParamWithRunner(job_param_move param, task_runner_move runner) : param(std::move(param)), runner(std::move(runner)) {}
+      };
+      using job_item = typename std::conditional<(_Mode == ThreadRunnerMode::perJob), JobParamWithRunner, _JobParamType>::type;
+
+      struct SharedPoolData { // Synchronization & jobs data - shared with child threads
+        std::atomic<bool> isRunning{ false };
+        std::atomic<size_t> busyThreads{ 0 };
+        std::atomic<size_t> sleepingThreads{ 0 };
+        std::atomic<size_t> waitingProducers{ 0 };
+        std::unique_ptr<LockFreeQueue<job_item> > jobs;
+        std::mutex sleepLock;
+        std::condition_variable condition;         // signal for sleeping threads (new job)
+        std::condition_variable producerCondition; // signal for blocked producers (job extracted)
+      };
+
+    public:
+      /// @brief Create empty thread pool - not running
+      inline BoundedThreadPool() : _poolData(std::make_shared<SharedPoolData>()) {}
+      /// @brief Create and start a thread pool - mode: no common runner -> provide a task runner for each job
+      /// @param queueCapacity  Max number of pending jobs (rounded up to next power of 2).
+      /// @warning in 'single' runner mode, jobs will not be processed!
+      inline BoundedThreadPool(size_t threadCount, size_t queueCapacity) : _poolData(std::make_shared<SharedPoolData>()) {
+        task_runner_type emptyRunner = nullptr;
+        _startThreads(threadCount, queueCapacity, emptyRunner);
+      }
+      /// @brief Create and start a thread pool - mode: common task runner provided in constructor
+      /// @param queueCapacity  Max number of pending jobs (rounded up to next power of 2).
+      /// @warning Required for standard use of 'single' runner mode, optional to have a default runner in 'perJob' mode.
+      inline BoundedThreadPool(size_t threadCount, size_t queueCapacity, task_runner_type commonRunner) : _poolData(std::make_shared<SharedPoolData>()) {
+        _startThreads(threadCount, queueCapacity, commonRunner);
+      }
+
+      /// @brief Stop thread pool and wait for each thread to stop running
+      ~BoundedThreadPool() noexcept { _stopThreads(); }
+
+      BoundedThreadPool(const Type&) = delete;
+      Type& operator=(const Type&) = delete;
+      inline BoundedThreadPool(Type&& rhs) noexcept : _poolData(std::move(rhs._poolData)) {
+        std::swap(this->_threads, rhs._threads);
+        rhs._poolData = std::make_shared<SharedPoolData>();
+      }
+      inline Type& operator=(Type&& rhs) noexcept {
+        _stopThreads();
+        std::swap(this->_threads, rhs._threads);
+        this->_poolData = std::move(rhs._poolData);
+        rhs._poolData = std::make_shared<SharedPoolData>();
+        return *this;
+      }
+
+      // -- thread pool size --
+
+      inline size_type size() const noexcept { return this->_threads.size(); } ///< Total number of threads in the pool
+      /// @brief Number of active threads in the pool (currently processing a job)
+      inline size_type busyThreads() const noexcept { return this->_poolData->busyThreads.load(std::memory_order_acquire); }
+      /// @brief Number of threads waiting in the pool (ready for new jobs)
+      inline size_type freeThreads() const noexcept { return size() - busyThreads(); }
+      /// @brief Max number of pending jobs in the queue
+      inline size_type capacity() const noexcept { return (this->_poolData->jobs != nullptr) ? this->_poolData->jobs->capacity() : 0; }
+      /// @brief Number of jobs waiting to be processed (approximation, if jobs are being inserted/started simultaneously)
+      inline size_type pendingJobs() const noexcept { return (this->_poolData->jobs != nullptr) ? this->_poolData->jobs->size() : 0; }
+
+      // -- job management --
+
+      /// @brief Insert a new job to process (copied) - custom task runner for each job (not available in 'single' runner mode)
+      /// @returns True on success, false if the pool isn't running (or if the queue is full, in 'reject' mode)
+      template<typename J = _JobParamType, ThreadRunnerMode M = _Mode>
+      inline EnableIf<(!std::is_class<J>::value || std::is_copy_constructible<J>::value) && M == ThreadRunnerMode::perJob,
+                      bool> addJob(const _JobParamType& param, task_runner_move runner) {
+        return _pushJob(_JobParamType(param), std::move(runner));
+      }
+      /// @brief Insert a new job to process (moved) - custom task runner for each job (not available in 'single' runner mode)
+      /// @returns True on success, false if the pool isn't running (or if the queue is full, in 'reject' mode)
+      template<ThreadRunnerMode M = _Mode>
+      inline EnableIf<M==ThreadRunnerMode::perJob,
+                      bool> addJob(_JobParamType&& param, task_runner_move runner) {
+        return _pushJob(std::move(param), std::move(runner));
+      }
+
+      /// @brief Insert a new job to process (copied) - use common task runner provided in constructor
+      /// @returns True on success, false if the pool isn't running (or if the queue is full, in 'reject' mode)
+      template<typename J = _JobParamType>
+      inline EnableIf<!std::is_class<J>::value || std::is_copy_constructible<J>::value,
+                      bool> addJob(const _JobParamType& param) {
+        return _pushJob(_JobParamType(param));
+      }
+      /// @brief Insert a new job to process (moved) - use common task runner provided in constructor
+      /// @returns True on success, false if the pool isn't running (or if the queue is full, in 'reject' mode)
+      inline bool addJob(_JobParamType&& param) {
+        return _pushJob(std::move(param));
+      }
+
+      /// @brief Cancel all jobs that haven't already been started
+      inline uint32_t cancelPendingJobs() noexcept {
+        SharedPoolData& sync = *(this->_poolData);
+        if (sync.jobs == nullptr)
+          return 0;
+
+        size_t jobCount = sync.jobs->clear();
+        _notifyProducers(sync);
+        return static_cast<uint32_t>(jobCount);
+      }
+
+    protected:
+      // -- job insertion --
+
+      // insert job in queue (or wait/reject if full)
+      template <typename ... _Args>
+      bool _pushJob(_Args&&... args) {
+        SharedPoolData& sync = *(this->_poolData);
+        if (!sync.isRunning.load(std::memory_order_acquire) || sync.jobs == nullptr)
+          return false;
+
+        if (!sync.jobs->emplace(std::forward<_Args>(args)...)) { // full queue (args not consumed)
+          if (_FullQueue == FullQueueHandling::reject || !_waitForSlot(sync, std::forward<_Args>(args)...))
+            return false;
+        }
+
+        std::atomic_thread_fence(std::memory_order_seq_cst); // insertion visible before reading sleeping threads (see _runThread)
+        if (sync.sleepingThreads.load(std::memory_order_relaxed) > 0) {
+          { std::lock_guard<std::mutex> guard(sync.sleepLock); } // ensure that sleeping candidate is already waiting
+          sync.condition.notify_one();
+        }
+        return true;
+      }
+      // wait for available slot in queue, then insert job
+      template <typename ... _Args>
+      bool _waitForSlot(SharedPoolData& sync, _Args&&... args) {
+        std::unique_lock<std::mutex> guard(sync.sleepLock);
+        sync.waitingProducers.fetch_add(1u, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst); // waiting producer visible before retrying (see _notifyProducers)
+
+        bool isSuccess = false;
+        while (sync.isRunning.load(std::memory_order_acquire)) {
+          if (sync.jobs->emplace(std::forward<_Args>(args)...)) {
+            isSuccess = true;
+            break;
+          }
+          sync.producerCondition.wait(guard);
+        }
+        sync.waitingProducers.fetch_sub(1u, std::memory_order_relaxed);
+        return isSuccess;
+      }
+      // awake blocked producers after extracting job(s)
+      static inline void _notifyProducers(SharedPoolData& sync) noexcept {
+        if (_FullQueue == FullQueueHandling::wait) {
+          std::atomic_thread_fence(std::memory_order_seq_cst); // extraction visible before reading waiting producers
+          if (sync.waitingProducers.load(std::memory_order_relaxed) > 0) {
+            { std::lock_guard<std::mutex> guard(sync.sleepLock); }
+            sync.producerCondition.notify_all();
+          }
+        }
+      }
+
+      // -- thread management --
+
+      // launch thread pool
+      void _startThreads(size_t threadCount, size_t queueCapacity, task_runner_type& runner) {
+        SharedPoolData& sync = *(this->_poolData);
+        sync.jobs.reset(new LockFreeQueue<job_item>(queueCapacity));
+        sync.isRunning = true;
+        sync.busyThreads = 0u;
+        this->_threads.reserve(threadCount);
+        for (uint32_t index = 0; index < threadCount; ++index)
+          this->_threads.emplace_back(&Type::_runThread, this->_poolData, index, runner);
+      }
+
+      // stop all threads
+      void _stopThreads() noexcept {
+        SharedPoolData& sync = *(this->_poolData);
+        std::unique_lock<std::mutex> guard(sync.sleepLock);
+        sync.isRunning = false;
+        guard.unlock();
+        if (sync.jobs != nullptr)
+          sync.jobs->clear();
+
+        sync.condition.notify_all();
+        sync.producerCondition.notify_all();
+        for (auto& item : this->_threads) {
+          if (item.joinable()) {
+            try {
+              item.join();
+            }
+            catch (const std::exception& __DEBUG_ARG__(exc)) {
+              TRACE_N("BoundedThreadPool: thread join exception: %s", exc.what());
+              try { item.detach(); } catch (const std::exception&) {}
+            }
+          }
+        }
+        this->_threads.clear();
+      }
+
+      // -- thread execution --
+
+      // main thread execution loop
+      static void _runThread(std::shared_ptr<SharedPoolData> shared, uint32_t __DEBUG_ARG__(index), task_runner_type commonRunner) noexcept {
+        TRACE_N("BoundedThreadPool: thread %u started", index);
+        assert(shared != nullptr);
+        SharedPoolData& sync = *shared;
+        LockFreeQueue<job_item>& jobs = *(sync.jobs);
+        if (commonRunner == nullptr)
+          commonRunner = &Type::_defaultRunner;
+
+        typename std::aligned_storage<sizeof(job_item), alignof(job_item)>::type jobStorage; // job_item may not be default-constructible
+        job_item* jobData = reinterpret_cast<job_item*>(&jobStorage);
+        while (sync.isRunning.load(std::memory_order_acquire)) {
+          bool isFound = false;
+          try {
+            isFound = jobs.consume([jobData, &sync](job_item&& item) {
+              new (jobData) job_item(std::move(item));
+              sync.busyThreads.fetch_add(1u, std::memory_order_acq_rel); // before releasing queue slot: pending job + busy thread never both at 0
+            });
+          }
+          catch (...) { TRACE("BoundedThreadPool: job extraction failure"); }
+
+          if (isFound) {
+            _notifyProducers(sync);
+            try {
+              _callRunner(*jobData, commonRunner);
+            }
+            catch (const std::exception& __DEBUG_ARG__(exc)) { TRACE_N("BoundedThreadPool: exception: %s", exc.what()); }
+            catch (...) { TRACE("BoundedThreadPool: unknown exception type thrown"); }
+            jobData->~job_item();
+            sync.busyThreads.fetch_sub(1u, std::memory_order_acq_rel);
+          }
+          else if (!jobs.empty()) { // job reserved but not published yet -> retry
+            std::this_thread::yield();
+          }
+          else { // no job left -> sleep until next insertion
+            std::unique_lock<std::mutex> guard(sync.sleepLock);
+            sync.sleepingThreads.fetch_add(1u, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst); // sleeping thread visible before checking queue (see _pushJob)
+            while (sync.isRunning.load(std::memory_order_acquire) && jobs.empty())
+              sync.condition.wait(guard);
+            sync.sleepingThreads.fetch_sub(1u, std::memory_order_relaxed);
+          }
+        }
+        TRACE_N("BoundedThreadPool: thread %u stopped", index);
+      }
+
+      // specialized calls to task runner
+      static inline void _callRunner(JobParamWithRunner& jobData, task_runner_type& defaultRunner) {
+        if (jobData.runner != nullptr)
+          jobData.runner(jobData.param);
+        else
+          defaultRunner(jobData.param);
+      }
+      static inline void _callRunner(_JobParamType& param, task_runner_type& defaultRunner) {
+        defaultRunner(param);
+      }
+      // default task runner, if none provided
+      static inline void _defaultRunner(_JobParamType&) {
+        TRACE("BoundedThreadPool: no common runner provided.");
+      }
+
+    private:
+      std::vector<std::thread> _threads;
+      std::shared_ptr<SharedPoolData> _poolData;
+    };
+
+  }
+}
@@ -0,0 +1,536 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+// C++20 coroutines required (CWORK_CPP_REVISION=20) -> otherwise, nothing is defined
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+# define __P_THREAD_COROUTINES 1
+
+# include <cstddef>
+# include <cstdint>
+# include <exception>
+# include <new>
+# include <optional>
+# include <chrono>
+# include <mutex>
+# include <condition_variable>
+# include <coroutine>
+# include <utility>
+# include <type_traits>
+# include "./thread_pool.h"
+# include "./timer_wheel.h"
+
+  namespace pandora {
+    namespace thread {
+      /// @class CoroutineFrameArena
+      /// @brief Allocator of coroutine frames (used by Task): recycled blocks stored in thread-local free lists (by size class).
+      /// @description Frames of short-lived coroutines have the same few sizes: once a frame is destroyed, its block is kept
+      ///              in the cache of the current thread and reused for the next frame of the same size class (no heap access).
+      ///              Frames bigger than 'maxBlockSize' (or exceeding the cache capacity) are allocated/freed with the global operators.
+      /// @remarks A frame destroyed by another thread than the one that created it is cached by the destroying thread.
+      class CoroutineFrameArena final {
+      public:
+        static constexpr size_t blockGranularity = 64u; ///< Size classes: multiples of 64 bytes
+        static constexpr size_t maxBlockSize = 2048u;   ///< Bigger frames are not cached
+        static constexpr uint32_t maxCachedBlocks = 64u;///< Max number of free blocks cached per size class (per thread)
+
+        /// @brief Allocate a frame block (of at least 'size' bytes)
+        static void* allocate(size_t size) {
+          if (size == 0 || size > maxBlockSize)
+            return ::operator new(size);
+          const size_t sizeClass = (size - 1u) / blockGranularity;
+          LocalCache& cache = _localCache();
+          FreeBlock* block = cache.heads[sizeClass];
+          if (block != nullptr) {
+            cache.heads[sizeClass] = block->next;
+            --(cache.counts[sizeClass]);
+            return static_cast<void*>(block);
+          }
+          return ::operator new((sizeClass + 1u) * blockGranularity);
+        }
+        /// @brief Release a frame block ('size' must be the value used for allocation)
+        static void deallocate(void* block, size_t size) noexcept {
+          if (size == 0 || size > maxBlockSize) {
+            ::operator delete(block);
+            return;
+          }
+          const size_t sizeClass = (size - 1u) / blockGranularity;
+          LocalCache& cache = _localCache();
+          if (cache.counts[sizeClass] < maxCachedBlocks) {
+            FreeBlock* freeBlock = static_cast<FreeBlock*>(block);
+            freeBlock->next = cache.heads[sizeClass];
+            cache.heads[sizeClass] = freeBlock;
+            ++(cache.counts[sizeClass]);
+          }
+          else
+            ::operator delete(block);
+        }
+
+      private:
+        static constexpr size_t _sizeClassCount = maxBlockSize / blockGranularity;
+        struct FreeBlock final {
+          FreeBlock* next;
+        };
+        struct LocalCache final { // free blocks of current thread
+          FreeBlock* heads[_sizeClassCount]{};
+          uint32_t counts[_sizeClassCount]{};
+          ~LocalCache() noexcept {
+            for (auto& head : heads) {
+              while (head != nullptr) {
+                FreeBlock* next = head->next;
+                ::operator delete(static_cast<void*>(head));
+                head = next;
+              }
+            }
+          }
+        };
+        static inline LocalCache& _localCache() noexcept {
+          thread_local LocalCache cache;
+          return cache;
+        }
+      };
+
+      // ---
+
+      template <typename _ResultType = void>
+      class Task;
+
+      /// @brief Common promise data of Task coroutines (frame allocation, continuation, exception)
+      class TaskPromiseBase {
+      public:
+        /// @brief Final suspension: resume the awaiting coroutine (symmetric transfer: no stack growth)
+        struct FinalAwaiter final {
+          constexpr inline bool await_ready() const noexcept { return false; }
+          template <typename _PromiseType>
+          inline std::coroutine_handle<> await_suspend(std::coroutine_handle<_PromiseType> handle) noexcept {
+            std::coroutine_handle<> continuation = handle.promise()._continuation;
+            return continuation ? continuation : std::noop_coroutine();
+          }
+          constexpr inline void await_resume() const noexcept {}
+        };
+
+        static inline void* operator new(size_t size) { return CoroutineFrameArena::allocate(size); }
+        static inline void operator delete(void* frame, size_t size) noexcept { CoroutineFrameArena::deallocate(frame, size); }
+
+        constexpr inline std::suspend_always initial_suspend() const noexcept { return {}; } // lazy start (when awaited)
+        constexpr inline FinalAwaiter final_suspend() const noexcept { return {}; }
+        inline void unhandled_exception() noexcept { this->_exception = std::current_exception(); }
+
+        inline void _setContinuation(std::coroutine_handle<> continuation) noexcept { this->_continuation = continuation; }
+      protected:
+        inline void _rethrowException() const {
+          if (this->_exception)
+            std::rethrow_exception(this->_exception);
+        }
+      private:
+        std::coroutine_handle<> _continuation = nullptr;
+        std::exception_ptr _exception = nullptr;
+      };
+
+      /// @brief Promise of Task coroutines returning a value
+      template <typename _ResultType>
+      class TaskPromise final : public TaskPromiseBase {
+      public:
+        static_assert(!std::is_reference<_ResultType>::value, "TaskPromise: reference result types not supported");
+        inline Task<_ResultType> get_return_object() noexcept;
+
+        template <typename _ValueType, typename = typename std::enable_if<std::is_convertible<_ValueType&&, _ResultType>::value>::type>
+        inline void return_value(_ValueType&& value) noexcept(std::is_nothrow_constructible<_ResultType, _ValueType&&>::value) {
+          this->_result.emplace(std::forward<_ValueType>(value));
+        }
+        inline _ResultType& result() & { _rethrowException(); return *(this->_result); }
+        inline _ResultType&& result() && { _rethrowException(); return std::move(*(this->_result)); }
+      private:
+        std::optional<_ResultType> _result;
+      };
+      /// @brief Promise of Task coroutines without result
+      template <>
+      class TaskPromise<void> final : public TaskPromiseBase {
+      public:
+        inline Task<void> get_return_object() noexcept;
+        constexpr inline void return_void() const noexcept {}
+        inline void result() const { _rethrowException(); }
+      };
+
+      /// @class Task
+      /// @brief Lazy coroutine with an optional result: 'Task<int> compute() { ... co_return value; }'
+      /// @description The coroutine is started when the Task is awaited ('co_await task' from another coroutine),
+      ///              or when 'syncWait' is called (from a normal function). The awaiting coroutine is resumed once the task is finished,
+      ///              on the thread that finished it (to continue on a pool worker: 'co_await scheduleOn(pool)' in the task).
+      ///              Exceptions thrown in the coroutine are rethrown to the awaiting code.
+      /// @remarks Coroutine frames are allocated with CoroutineFrameArena (recycled per thread).
+      /// @warning A Task can only be awaited once (the frame is destroyed with the Task instance).
+      template <typename _ResultType>
+      class Task final {
+      public:
+        using promise_type = TaskPromise<_ResultType>;
+        using handle_type = std::coroutine_handle<promise_type>;
+        using Type = Task<_ResultType>;
+
+        Task() noexcept = default;
+        explicit Task(handle_type handle) noexcept : _handle(handle) {}
+        Task(const Type&) = delete;
+        Type& operator=(const Type&) = delete;
+        inline Task(Type&& rhs) noexcept : _handle(rhs._handle) { rhs._handle = nullptr; }
+        inline Type& operator=(Type&& rhs) noexcept {
+          if (this != &rhs) {
+            if (this->_handle)
+              this->_handle.destroy();
+            this->_handle = rhs._handle;
+            rhs._handle = nullptr;
+          }
+          return *this;
+        }
+        ~Task() noexcept {
+          if (this->_handle)
+            this->_handle.destroy();
+        }
+
+        inline bool isValid() const noexcept { return static_cast<bool>(this->_handle); } ///< Task attached to a coroutine
+        inline bool isReady() const noexcept { return (!this->_handle || this->_handle.done()); } ///< Coroutine finished (or no coroutine)
+
+        // -- awaitable --
+
+        struct Awaiter {
+          handle_type handle;
+          inline bool await_ready() const noexcept { return (!handle || handle.done()); }
+          inline std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaitingCoroutine) noexcept {
+            handle.promise()._setContinuation(awaitingCoroutine);
+            return handle; // start task (symmetric transfer)
+          }
+        };
+        /// @brief Start task and wait for its result (reference to the result stored in the Task)
+        inline auto operator co_await() & noexcept {
+          struct LvalueAwaiter final : Awaiter {
+            inline decltype(auto) await_resume() { return this->handle.promise().result(); }
+          };
+          return LvalueAwaiter{ { this->_handle } };
+        }
+        /// @brief Start task and wait for its result (result moved)
+        inline auto operator co_await() && noexcept {
+          struct RvalueAwaiter final : Awaiter {
+            inline decltype(auto) await_resume() { return std::move(this->handle.promise()).result(); }
+          };
+          return RvalueAwaiter{ { this->_handle } };
+        }
+
+      private:
+        handle_type _handle = nullptr;
+      };
+
+      template <typename _ResultType>
+      inline Task<_ResultType> TaskPromise<_ResultType>::get_return_object() noexcept {
+        return Task<_ResultType>(std::coroutine_handle<TaskPromise<_ResultType> >::from_promise(*this));
+      }
+      inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+        return Task<void>(std::coroutine_handle<TaskPromise<void> >::from_promise(*this));
+      }
+
+      // -- synchronous wait --
+
+      /// @brief Coroutine used to wait for a Task from a normal function (not for direct use)
+      class SyncWaitTask final {
+      public:
+        class Event final {
+        public:
+          inline void set() noexcept {
+            std::lock_guard<std::mutex> guard(this->_lock);
+            this->_isSet = true;
+            this->_condition.notify_all();
+          }
+          inline void wait() noexcept {
+            std::unique_lock<std::mutex> guard(this->_lock);
+            this->_condition.wait(guard, [this]() { return this->_isSet; });
+          }
+        private:
+          std::mutex _lock;
+          std::condition_variable _condition;
+          bool _isSet = false;
+        };
+
+        struct promise_type final {
+          Event* event = nullptr;
+          std::exception_ptr exception = nullptr;
+
+          struct FinalAwaiter final {
+            constexpr inline bool await_ready() const noexcept { return false; }
+            inline void await_suspend(std::coroutine_handle<promise_type> handle) noexcept { handle.promise().event->set(); }
+            constexpr inline void await_resume() const noexcept {}
+          };
+          inline SyncWaitTask get_return_object() noexcept { return SyncWaitTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+          constexpr inline std::suspend_always initial_suspend() const noexcept { return {}; }
+          constexpr inline FinalAwaiter final_suspend() const noexcept { return {}; }
+          constexpr inline void return_void() const noexcept {}
+          inline void unhandled_exception() noexcept { this->exception = std::current_exception(); }
+        };
+
+        explicit SyncWaitTask(std::coroutine_handle<promise_type> handle) noexcept : _handle(handle) {}
+        SyncWaitTask(const SyncWaitTask&) = delete;
+        SyncWaitTask& operator=(const SyncWaitTask&) = delete;
+        ~SyncWaitTask() noexcept { this->_handle.destroy(); }
+
+        /// @brief Run coroutine and block current thread until it's finished (rethrow its exception, if any)
+        inline void run() {
+          Event event;
+          this->_handle.promise().event = &event;
+          this->_handle.resume();
+          event.wait();
+          if (this->_handle.promise().exception)
+            std::rethrow_exception(this->_handle.promise().exception);
+        }
+      private:
+        std::coroutine_handle<promise_type> _handle;
+      };
+
+      template <typename _ResultType>
+      inline SyncWaitTask _syncWaitCoroutine(Task<_ResultType>& task, std::optional<_ResultType>& outResult) {
+        outResult.emplace(co_await std::move(task));
+      }
+      inline SyncWaitTask _syncWaitCoroutine(Task<void>& task) {
+        co_await std::move(task);
+      }
+
+      /// @brief Start a Task and block current thread until it's finished (from a normal function, not from a coroutine)
+      /// @returns Result of the task
+      /// @throws Exception thrown by the task
+      template <typename _ResultType>
+      inline _ResultType syncWait(Task<_ResultType>&& task) {
+        std::optional<_ResultType> result;
+        _syncWaitCoroutine(task, result).run();
+        return std::move(*result);
+      }
+      inline void syncWait(Task<void>&& task) {
+        _syncWaitCoroutine(task).run();
+      }
+
+      // -- executors --
+
+      /// @brief Thread pool resuming coroutines: 'CoroutineThreadPool pool(threadCount, &resumeCoroutine);'
+      using CoroutineThreadPool = ThreadPool<std::coroutine_handle<> >;
+      /// @brief Task runner of coroutine thread pools
+      inline void resumeCoroutine(std::coroutine_handle<>& coroutine) { coroutine.resume(); }
+
+      /// @brief Awaitable that resumes the current coroutine on a thread pool worker
+      template <typename _PoolType>
+      class ScheduleOnAwaiter final {
+      public:
+        explicit ScheduleOnAwaiter(_PoolType& pool) noexcept : _pool(pool) {}
+
+        constexpr inline bool await_ready() const noexcept { return false; }
+        inline bool await_suspend(std::coroutine_handle<> coroutine) {
+          this->_isScheduled = true; // set before insertion: the coroutine may be resumed (by a worker) before 'addJob' returns
+          if (!this->_pool.addJob(std::coroutine_handle<>(coroutine))) {
+            this->_isScheduled = false;
+            return false; // not inserted -> continue on current thread
+          }
+          return true;
+        }
+        inline bool await_resume() const noexcept { return this->_isScheduled; }
+      private:
+        _PoolType& _pool;
+        bool _isScheduled = false;
+      };
+      /// @brief Resume the current coroutine on a worker of a thread pool: 'co_await scheduleOn(pool);'
+      /// @param pool  Any pool with a common runner resuming std::coroutine_handle<> jobs (see CoroutineThreadPool/resumeCoroutine).
+      /// @returns Awaitable (result: false if the pool isn't running -> the coroutine continues on the current thread)
+      template <typename _PoolType>
+      inline ScheduleOnAwaiter<_PoolType> scheduleOn(_PoolType& pool) noexcept { return ScheduleOnAwaiter<_PoolType>(pool); }
+
+      // -- timers --
+
+      /// @brief Timer scheduler resuming coroutines on a thread pool (see 'sleepFor' / 'sleepUntil')
+      template <typename _PoolType = CoroutineThreadPool>
+      using CoroutineTimerWheel = TimerWheel<std::coroutine_handle<>, _PoolType>;
+
+      /// @brief Awaitable that suspends the current coroutine until a timer expires (no thread blocked)
+      template <typename _PoolType>
+      class SleepAwaiter final {
+      public:
+        SleepAwaiter(CoroutineTimerWheel<_PoolType>& timers, typename CoroutineTimerWheel<_PoolType>::time_point wakeUpTime) noexcept
+          : _timers(timers), _wakeUpTime(wakeUpTime) {}
+
+        inline bool await_ready() const noexcept { return (this->_wakeUpTime <= CoroutineTimerWheel<_PoolType>::clock_type::now()); }
+        inline bool await_suspend(std::coroutine_handle<> coroutine) {
+          return this->_timers.scheduleAt(this->_wakeUpTime, coroutine).isValid(); // timer not scheduled -> resume now
+        }
+        constexpr inline void await_resume() const noexcept {}
+      private:
+        CoroutineTimerWheel<_PoolType>& _timers;
+        typename CoroutineTimerWheel<_PoolType>::time_point _wakeUpTime;
+      };
+
+      /// @brief Suspend the current coroutine for a duration: 'co_await sleepFor(timers, std::chrono::milliseconds(10));'
+      /// @remarks The coroutine is resumed on a worker of the pool of the timer scheduler (timer resolution: its tick duration).
+      template <typename _PoolType, typename _RepetitionType, typename _PeriodType>
+      inline SleepAwaiter<_PoolType> sleepFor(CoroutineTimerWheel<_PoolType>& timers, const std::chrono::duration<_RepetitionType,_PeriodType>& delay) {
+        using clock_type = typename CoroutineTimerWheel<_PoolType>::clock_type;
+        return SleepAwaiter<_PoolType>(timers, clock_type::now() + std::chrono::duration_cast<typename clock_type::duration>(delay));
+      }
+      /// @brief Suspend the current coroutine until a time point of any clock (std::chrono or pandora::time clocks)
+      /// @remarks The remaining duration is measured with '_ClockType', then scheduled with the timer scheduler.
+      template <typename _PoolType, typename _ClockType, typename _DurationType>
+      inline SleepAwaiter<_PoolType> sleepUntil(CoroutineTimerWheel<_PoolType>& timers, const std::chrono::time_point<_ClockType,_DurationType>& wakeUpTime) {
+        return sleepFor(timers, wakeUpTime - _ClockType::now());
+      }
+
+      // -- synchronization --
+
+      /// @class AsyncSemaphore
+      /// @brief Semaphore for coroutines: 'co_await semaphore.wait()' suspends the coroutine (instead of blocking its thread) until notified.
+      /// @description Waiting coroutines are resumed in FIFO order, directly by the thread calling 'notify'
+      ///              (use 'co_await scheduleOn(pool)' after waiting to continue on a pool worker).
+      class AsyncSemaphore final {
+      public:
+        /// @brief Awaitable returned by 'wait()'
+        class Awaiter final {
+        public:
+          explicit Awaiter(AsyncSemaphore& semaphore) noexcept : _semaphore(semaphore) {}
+
+          inline bool await_ready() noexcept { return this->_semaphore.tryWait(); }
+          inline bool await_suspend(std::coroutine_handle<> coroutine) noexcept {
+            this->_coroutine = coroutine;
+            std::lock_guard<std::mutex> guard(this->_semaphore._lock);
+            if (this->_semaphore._count > 0) { // notified since 'await_ready'
+              --(this->_semaphore._count);
+              return false;
+            }
+            if (this->_semaphore._lastWaiter != nullptr)
+              this->_semaphore._lastWaiter->_next = this;
+            else
+              this->_semaphore._firstWaiter = this;
+            this->_semaphore._lastWaiter = this;
+            return true;
+          }
+          constexpr inline void await_resume() const noexcept {}
+        private:
+          friend class AsyncSemaphore;
+          AsyncSemaphore& _semaphore;
+          std::coroutine_handle<> _coroutine = nullptr;
+          Awaiter* _next = nullptr;
+        };
+
+        /// @brief Create instance with a custom initial count
+        explicit AsyncSemaphore(uint32_t initialCount = 0) noexcept : _count(initialCount) {}
+        AsyncSemaphore(const AsyncSemaphore&) = delete;
+        AsyncSemaphore& operator=(const AsyncSemaphore&) = delete;
+
+        /// @brief Current counter value
+        inline uint32_t count() const noexcept { std::lock_guard<std::mutex> guard(this->_lock); return this->_count; }
+
+        /// @brief Wait for counter to be greater than 0, then decrement it: 'co_await semaphore.wait();'
+        inline Awaiter wait() noexcept { return Awaiter(*this); }
+        /// @brief Decrement counter if greater than 0 (without waiting)
+        /// @returns True if the counter was decremented
+        inline bool tryWait() noexcept {
+          std::lock_guard<std::mutex> guard(this->_lock);
+          if (this->_count > 0) {
+            --(this->_count);
+            return true;
+          }
+          return false;
+        }
+        /// @brief Resume first waiting coroutine (or increment counter if no coroutine is waiting)
+        inline void notify() {
+          std::unique_lock<std::mutex> guard(this->_lock);
+          Awaiter* waiter = this->_firstWaiter;
+          if (waiter != nullptr) {
+            this->_firstWaiter = waiter->_next;
+            if (this->_firstWaiter == nullptr)
+              this->_lastWaiter = nullptr;
+            guard.unlock();
+            waiter->_coroutine.resume();
+          }
+          else
+            ++(this->_count);
+        }
+        /// @brief Resume waiting coroutines / increment counter, multiple times
+        inline void notify(uint32_t unitCount) {
+          for (uint32_t i = 0; i < unitCount; ++i)
+            notify();
+        }
+
+      private:
+        mutable std::mutex _lock;
+        Awaiter* _firstWaiter = nullptr;
+        Awaiter* _lastWaiter = nullptr;
+        uint32_t _count = 0;
+      };
+
+      // ---
+
+      class AsyncLock;
+      /// @brief Guard unlocking an AsyncLock on destruction (obtained with 'co_await lock.scopedLock()')
+      class AsyncLockGuard final {
+      public:
+        explicit AsyncLockGuard(AsyncLock& lock) noexcept : _lock(&lock) {}
+        AsyncLockGuard(const AsyncLockGuard&) = delete;
+        AsyncLockGuard& operator=(const AsyncLockGuard&) = delete;
+        inline AsyncLockGuard(AsyncLockGuard&& rhs) noexcept : _lock(rhs._lock) { rhs._lock = nullptr; }
+        inline AsyncLockGuard& operator=(AsyncLockGuard&& rhs) noexcept {
+          if (this != &rhs) { unlock(); this->_lock = rhs._lock; rhs._lock = nullptr; }
+          return *this;
+        }
+        ~AsyncLockGuard() noexcept { unlock(); }
+
+        /// @brief Unlock before the end of the scope
+        inline void unlock() noexcept;
+      private:
+        AsyncLock* _lock;
+      };
+
+      /// @class AsyncLock
+      /// @brief Mutual exclusion for coroutines: 'co_await lock.lock()' suspends the coroutine (instead of blocking its thread) until the lock is available.
+      /// @description Waiting coroutines are resumed in FIFO order, directly by the thread calling 'unlock'.
+      class AsyncLock final {
+      public:
+        AsyncLock() noexcept : _semaphore(1u) {}
+        AsyncLock(const AsyncLock&) = delete;
+        AsyncLock& operator=(const AsyncLock&) = delete;
+
+        /// @brief Wait for lock: 'co_await lock.lock();'
+        inline AsyncSemaphore::Awaiter lock() noexcept { return this->_semaphore.wait(); }
+        /// @brief Take lock if available (without waiting)
+        inline bool tryLock() noexcept { return this->_semaphore.tryWait(); }
+        /// @brief Release lock (resume next waiting coroutine, if any)
+        inline void unlock() { this->_semaphore.notify(); }
+
+        /// @brief Wait for lock and get a guard to release it: 'auto guard = co_await lock.scopedLock();'
+        inline auto scopedLock() noexcept {
+          struct ScopedLockAwaiter final {
+            AsyncSemaphore::Awaiter awaiter;
+            AsyncLock& lock;
+            inline bool await_ready() noexcept { return awaiter.await_ready(); }
+            inline bool await_suspend(std::coroutine_handle<> coroutine) noexcept { return awaiter.await_suspend(coroutine); }
+            inline AsyncLockGuard await_resume() const noexcept { return AsyncLockGuard(lock); }
+          };
+          return ScopedLockAwaiter{ this->_semaphore.wait(), *this };
+        }
+      private:
+        AsyncSemaphore _semaphore;
+      };
+
+      inline void AsyncLockGuard::unlock() noexcept {
+        if (this->_lock != nullptr) {
+          this->_lock->unlock();
+          this->_lock = nullptr;
+        }
+      }
+    }
+  }
+#endif
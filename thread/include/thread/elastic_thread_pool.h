@@ -0,0 +1,519 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <vector>
+#include <deque>
+#include <list>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <type_traits>
+#include <system/trace.h>
+#include "./thread_pool.h"
+
+namespace pandora {
+  namespace thread {
+    /// @brief Size limits and growth/retirement thresholds of an ElasticThreadPool
+    struct ElasticPoolParams final {
+      size_t minThreads = 1u;  ///< Threads kept alive even when idle (started on construction)
+      size_t maxThreads = 0u;  ///< Maximum number of threads (0: number of logical CPUs)
+      std::chrono::microseconds growthLatency{ 2000 }; ///< Queue latency (time waited by oldest job) above which a thread is added
+      std::chrono::milliseconds idleTimeout{ 30000 };  ///< Idle duration after which a thread is retired (if more than minThreads)
+    };
+
+    // ---
+
+    /// @class ElasticThreadPool
+    /// @brief Pool of threads with a variable size: threads are added when jobs wait too long, and retired when they stay idle.
+    /// @description Alternative to ThreadPool for irregular loads (peaks / idle periods):
+    ///              - the pool starts with 'minThreads' threads;
+    ///              - when no thread is idle and the oldest pending job has waited more than 'growthLatency', a thread is added
+    ///                (up to 'maxThreads'). The latency is verified when jobs are inserted, when workers extract a job,
+    ///                and by a monitoring thread while jobs are pending (to grow even if all workers are stuck in long jobs);
+    ///              - a thread waiting for jobs during 'idleTimeout' is retired (down to 'minThreads');
+    ///              - resize() sets the number of threads explicitly: pending jobs are never dropped when the pool shrinks
+    ///                (busy threads are retired after finishing their current job).
+    ///              Threads are created and joined by the pool itself (retired threads are joined on next insertion/resize).
+    template <typename _JobParamType,                        // Type of data container to process (must be movable)
+              ThreadRunnerMode _Mode = ThreadRunnerMode::single, // one function passed on construction / one per job
+              TaskRunnerType _FunctionType = TaskRunnerType::functionPointer> // function pointer / lambda
+    class ElasticThreadPool final {
+    public:
+      using Type = ElasticThreadPool<_JobParamType,_Mode,_FunctionType>;
+      using size_type = size_t;
+      using clock_type = std::chrono::steady_clock;
+      using task_runner_type = typename std::conditional<_FunctionType == TaskRunnerType::lambda, std::function<void(_JobParamType&)>, void (*)(_JobParamType&)>::type;
+      using task_runner_move = typename std::conditional<_FunctionType == TaskRunnerType::lambda, task_runner_type&&, task_runner_type>::type;
+    protected:
+      template<bool cond, typename _T>
+      using EnableIf = typename std::enable_if<cond, _T>::type;
+
+      using job_param_move = typename std::conditional<std::is_class<_JobParamType>::value, _JobParamType&&, _JobParamType>::type;
+      struct JobParamWithRunner { // Job data in 'perJob' mode (parameter + custom runner)
+        _JobParamType param;
+        task_runner_type runner;
+        JobParamWithRunner(job_param_move param) : param(std::move(param)), runner(nullptr) {}
+        JobParamWithRunner(job_param_move param, task_runner_move runner) : param(std::move(param)), runner(std::move(runner)) {}
+      };
+      using job_item = typename std::conditional<(_Mode == ThreadRunnerMode::perJob), JobParamWithRunner, _JobParamType>::type;
+
+      struct QueuedJob { // Job data + insertion time (queue latency)
+        job_item item;
+        clock_type::time_point enqueueTime;
+        template <typename ... _Args>
+        QueuedJob(clock_type::time_point enqueueTime, _Args&&... args)
+          : item(std::forward<_Args>(args)...), enqueueTime(enqueueTime) {}
+      };
+
+      struct SharedPoolData : public std::enable_shared_from_this<SharedPoolData> { // Synchronization, jobs & threads data - shared with child threads
+        bool isRunning = false;
+        ElasticPoolParams params;
+        task_runner_type commonRunner = nullptr;
+        std::deque<QueuedJob> jobs;
+        std::list<std::thread> threads;          // active threads
+        std::vector<std::thread> finishedThreads; // retired threads, not joined yet
+        size_t threadCount = 0;      // active threads (not retired)
+        size_t busyThreads = 0;
+        size_t sleepingThreads = 0;
+        size_t startingThreads = 0;  // created threads that haven't started waiting for jobs yet
+        size_t retireRequests = 0;   // threads to retire (resize)
+        size_t spawnedThreads = 0;   // counters since creation
+        size_t retiredThreads = 0;
+        std::thread monitor;         // queue latency verification while all threads are busy
+        bool isMonitorIdle = false;  // monitor waiting without timeout (must be notified)
+        mutable std::mutex lock;
+        std::condition_variable condition;
+        std::condition_variable monitorCondition;
+      };
+
+    public:
+      /// @brief Create empty thread pool - not running
+      inline ElasticThreadPool() : _poolData(std::make_shared<SharedPoolData>()) {}
+      /// @brief Create and start a thread pool - mode: no common runner -> provide a task runner for each job
+      /// @warning in 'single' runner mode, jobs will not be processed!
+      inline ElasticThreadPool(const ElasticPoolParams& params) : _poolData(std::make_shared<SharedPoolData>()) {
+        task_runner_type emptyRunner = nullptr;
+        _startThreads(params, emptyRunner);
+      }
+      /// @brief Create and start a thread pool - mode: common task runner provided in constructor
+      /// @warning Required for standard use of 'single' runner mode, optional to have a default runner in 'perJob' mode.
+      inline ElasticThreadPool(const ElasticPoolParams& params, task_runner_type commonRunner) : _poolData(std::make_shared<SharedPoolData>()) {
+        _startThreads(params, commonRunner);
+      }
+
+      /// @brief Stop thread pool and wait for each thread to stop running
+      ~ElasticThreadPool() noexcept { _stopThreads(); }
+
+      ElasticThreadPool(const Type&) = delete;
+      Type& operator=(const Type&) = delete;
+      inline ElasticThreadPool(Type&& rhs) noexcept : _poolData(std::move(rhs._poolData)) {
+        rhs._poolData = std::make_shared<SharedPoolData>();
+      }
+      inline Type& operator=(Type&& rhs) noexcept {
+        _stopThreads();
+        this->_poolData = std::move(rhs._poolData);
+        rhs._poolData = std::make_shared<SharedPoolData>();
+        return *this;
+      }
+
+      // -- thread pool size --
+
+      /// @brief Current number of threads in the pool
+      inline size_type size() const noexcept { std::lock_guard<std::mutex> guard(this->_poolData->lock); return this->_poolData->threadCount; }
+      inline size_type minThreads() const noexcept { std::lock_guard<std::mutex> guard(this->_poolData->lock); return this->_poolData->params.minThreads; }
+      inline size_type maxThreads() const noexcept { std::lock_guard<std::mutex> guard(this->_poolData->lock); return this->_poolData->params.maxThreads; }
+      /// @brief Number of active threads in the pool (currently processing a job)
+      inline size_type busyThreads() const noexcept { std::lock_guard<std::mutex> guard(this->_poolData->lock); return this->_poolData->busyThreads; }
+      /// @brief Number of threads waiting in the pool (ready for new jobs)
+      inline size_type freeThreads() const noexcept {
+        std::lock_guard<std::mutex> guard(this->_poolData->lock);
+        return (this->_poolData->threadCount > this->_poolData->busyThreads) ? this->_poolData->threadCount - this->_poolData->busyThreads : 0;
+      }
+      /// @brief Number of jobs waiting to be processed
+      inline size_type pendingJobs() const noexcept { std::lock_guard<std::mutex> guard(this->_poolData->lock); return this->_poolData->jobs.size(); }
+
+      /// @brief Total number of threads created since the pool was started (to tune growth/retirement thresholds)
+      inline size_type spawnedThreads() const noexcept { std::lock_guard<std::mutex> guard(this->_poolData->lock); return this->_poolData->spawnedThreads; }
+      /// @brief Total number of threads retired since the pool was started (idle timeout or resize)
+      inline size_type retiredThreads() const noexcept { std::lock_guard<std::mutex> guard(this->_poolData->lock); return this->_poolData->retiredThreads; }
+
+      /// @brief Set the number of threads of the pool (min/max limits are extended if necessary).
+      /// @remarks Pending jobs are kept: when the pool shrinks, idle threads are retired first, busy threads after their current job.
+      ///          With a size of 0, the last thread is only retired once all pending jobs have been processed.
+      ///          The size may change again later, depending on load (growth/retirement).
+      /// @returns False if the pool is not running
+      bool resize(size_t threadCount) {
+        SharedPoolData& sync = *(this->_poolData);
+        std::unique_lock<std::mutex> guard(sync.lock);
+        if (!sync.isRunning)
+          return false;
+        if (sync.params.minThreads > threadCount)
+          sync.params.minThreads = threadCount;
+        if (sync.params.maxThreads < threadCount)
+          sync.params.maxThreads = threadCount;
+
+        const size_t remainingThreads = sync.threadCount - sync.retireRequests; // threads not about to be retired
+        if (threadCount > remainingThreads) {
+          size_t missingThreads = threadCount - remainingThreads;
+          size_t cancelledRetirements = (sync.retireRequests < missingThreads) ? sync.retireRequests : missingThreads;
+          sync.retireRequests -= cancelledRetirements;
+          for (missingThreads -= cancelledRetirements; missingThreads > 0u && _spawnThread(sync); --missingThreads) {}
+        }
+        else
+          sync.retireRequests += remainingThreads - threadCount;
+        bool isMonitorNotified = sync.isMonitorIdle; // max size may have changed
+        std::vector<std::thread> finishedThreads;
+        std::swap(finishedThreads, sync.finishedThreads);
+        guard.unlock();
+
+        sync.condition.notify_all();
+        if (isMonitorNotified)
+          sync.monitorCondition.notify_one();
+        _joinThreads(finishedThreads);
+        return true;
+      }
+
+      // -- job management --
+
+      /// @brief Insert a new job to process (copied) - custom task runner for each job (not available in 'single' runner mode)
+      template<typename J = _JobParamType, ThreadRunnerMode M = _Mode>
+      inline EnableIf<(!std::is_class<J>::value || std::is_copy_constructible<J>::value) && M == ThreadRunnerMode::perJob,
+                      bool> addJob(const _JobParamType& param, task_runner_move runner) {
+        return _pushJob(_JobParamType(param), std::move(runner));
+      }
+      /// @brief Insert a new job to process (moved) - custom task runner for each job (not available in 'single' runner mode)
+      template<ThreadRunnerMode M = _Mode>
+      inline EnableIf<M==ThreadRunnerMode::perJob,
+                      bool> addJob(_JobParamType&& param, task_runner_move runner) {
+        return _pushJob(std::move(param), std::move(runner));
+      }
+
+      /// @brief Insert a new job to process (copied) - use common task runner provided in constructor
+      template<typename J = _JobParamType>
+      inline EnableIf<!std::is_class<J>::value || std::is_copy_constructible<J>::value,
+                      bool> addJob(const _JobParamType& param) {
+        return _pushJob(_JobParamType(param));
+      }
+      /// @brief Insert a new job to process (moved) - use common task runner provided in constructor
+      inline bool addJob(_JobParamType&& param) {
+        return _pushJob(std::move(param));
+      }
+
+      /// @brief Insert multiple jobs to process (copied/moved from iterator range) - use common task runner provided in constructor
+      /// @remarks Jobs are all inserted with one lock, and only the required number of threads is awakened.
+      ///          To move the values instead of copying them, use std::make_move_iterator.
+      /// @returns False if the pool is not running (no job inserted)
+      template<typename _Iterator>
+      inline bool addJobs(_Iterator first, _Iterator last) {
+        SharedPoolData& sync = *(this->_poolData);
+        std::unique_lock<std::mutex> guard(sync.lock);
+        if (!sync.isRunning)
+          return false;
+        const clock_type::time_point now = clock_type::now();
+        size_t jobCount = 0;
+        try {
+          for (; first != last; ++first, ++jobCount)
+            sync.jobs.emplace_back(now, _JobParamType(*first));
+        }
+        catch (...) { // keep jobs already inserted
+          guard.unlock();
+          sync.condition.notify_all();
+          throw;
+        }
+        _onJobsInserted(guard, (jobCount < sync.sleepingThreads) ? jobCount : sync.sleepingThreads);
+        return true;
+      }
+      /// @brief Insert multiple jobs to process (moved) - use common task runner provided in constructor
+      /// @returns False if the pool is not running (no job inserted)
+      inline bool addJobs(std::vector<_JobParamType>&& params) {
+        bool isSuccess = addJobs(std::make_move_iterator(params.begin()), std::make_move_iterator(params.end()));
+        if (isSuccess)
+          params.clear();
+        return isSuccess;
+      }
+
+      /// @brief Cancel all jobs that haven't already been started
+      inline uint32_t cancelPendingJobs() noexcept {
+        std::lock_guard<std::mutex> guard(this->_poolData->lock);
+        size_t jobCount = this->_poolData->jobs.size();
+        this->_poolData->jobs.clear();
+        return static_cast<uint32_t>(jobCount);
+      }
+
+    protected:
+      // -- job management --
+
+      // insert job + awake/create a thread to process it
+      template <typename ... _Args>
+      bool _pushJob(_Args&&... args) {
+        SharedPoolData& sync = *(this->_poolData);
+        std::unique_lock<std::mutex> guard(sync.lock);
+        if (!sync.isRunning)
+          return false;
+
+        sync.jobs.emplace_back(clock_type::now(), std::forward<_Args>(args)...);
+        _onJobsInserted(guard, (sync.sleepingThreads > 0u) ? 1u : 0u);
+        return true;
+      }
+
+      // verify queue latency after insertion + awake threads + join retired threads (lock must be held by caller, then released)
+      void _onJobsInserted(std::unique_lock<std::mutex>& guard, size_t awakenedThreads) {
+        SharedPoolData& sync = *(this->_poolData);
+        bool isMonitorNotified = false;
+        if (sync.sleepingThreads == 0u && !sync.jobs.empty()) {
+          if (_isGrowthRequired(sync, sync.jobs.front().enqueueTime))
+            _spawnThread(sync);
+          isMonitorNotified = sync.isMonitorIdle; // start verifying queue latency
+        }
+
+        std::vector<std::thread> finishedThreads;
+        if (!sync.finishedThreads.empty())
+          std::swap(finishedThreads, sync.finishedThreads);
+        guard.unlock();
+
+        if (awakenedThreads >= 2u)
+          sync.condition.notify_all();
+        else if (awakenedThreads == 1u)
+          sync.condition.notify_one();
+        if (isMonitorNotified)
+          sync.monitorCondition.notify_one();
+        _joinThreads(finishedThreads);
+      }
+
+      // verify if a thread should be added (lock must be held by caller)
+      static inline bool _isGrowthRequired(const SharedPoolData& sync, clock_type::time_point oldestJobTime) noexcept {
+        if (sync.startingThreads > 0u || sync.threadCount - sync.retireRequests >= sync.params.maxThreads)
+          return false;
+        return (sync.threadCount == 0u // no thread able to process jobs (last retiring thread only stops when the queue is empty)
+             || clock_type::now() - oldestJobTime >= sync.params.growthLatency);
+      }
+
+      // -- thread management --
+
+      // launch thread pool
+      void _startThreads(const ElasticPoolParams& params, task_runner_type& runner) {
+        SharedPoolData& sync = *(this->_poolData);
+        std::lock_guard<std::mutex> guard(sync.lock);
+        sync.params = params;
+        if (sync.params.maxThreads == 0u) {
+          sync.params.maxThreads = std::thread::hardware_concurrency();
+          if (sync.params.maxThreads == 0u)
+            sync.params.maxThreads = 1u;
+        }
+        if (sync.params.maxThreads < sync.params.minThreads)
+          sync.params.maxThreads = sync.params.minThreads;
+        sync.commonRunner = runner;
+        sync.isRunning = true;
+
+        for (size_t i = 0; i < sync.params.minThreads; ++i)
+          _spawnThread(sync);
+        try {
+          sync.monitor = std::thread(&Type::_runMonitor, sync.shared_from_this());
+        }
+        catch (const std::exception& __DEBUG_ARG__(exc)) { // pool still usable (latency only verified on insertion/extraction)
+          TRACE_N("ElasticThreadPool: monitor creation failure: %s", exc.what());
+        }
+      }
+
+      // create a new thread (lock must be held by caller: the new thread waits until it's released)
+      static bool _spawnThread(SharedPoolData& sync) noexcept {
+        try {
+          sync.threads.emplace_back(&Type::_runThread, sync.shared_from_this(), static_cast<uint32_t>(sync.spawnedThreads));
+          ++(sync.threadCount);
+          ++(sync.startingThreads);
+          ++(sync.spawnedThreads);
+          return true;
+        }
+        catch (const std::exception& __DEBUG_ARG__(exc)) {
+          TRACE_N("ElasticThreadPool: thread creation failure: %s", exc.what());
+          return false;
+        }
+      }
+
+      // stop all threads
+      void _stopThreads() noexcept {
+        SharedPoolData& sync = *(this->_poolData);
+        std::list<std::thread> threads;
+        std::vector<std::thread> finishedThreads;
+        std::thread monitor;
+        std::unique_lock<std::mutex> guard(sync.lock);
+        sync.isRunning = false;
+        sync.jobs.clear();
+        std::swap(threads, sync.threads);
+        std::swap(finishedThreads, sync.finishedThreads);
+        std::swap(monitor, sync.monitor);
+        guard.unlock();
+
+        sync.condition.notify_all();
+        sync.monitorCondition.notify_all();
+        _joinThreads(threads);
+        _joinThreads(finishedThreads);
+        if (monitor.joinable()) {
+          try {
+            monitor.join();
+          }
+          catch (const std::exception& __DEBUG_ARG__(exc)) {
+            TRACE_N("ElasticThreadPool: monitor join exception: %s", exc.what());
+            try { monitor.detach(); } catch (const std::exception&) {}
+          }
+        }
+      }
+
+      // wait for the end of stopped/retired threads
+      template <typename _Collection>
+      static void _joinThreads(_Collection& threads) noexcept {
+        for (auto& item : threads) {
+          if (item.joinable()) {
+            try {
+              item.join();
+            }
+            catch (const std::exception& __DEBUG_ARG__(exc)) {
+              TRACE_N("ElasticThreadPool: thread join exception: %s", exc.what());
+              try { item.detach(); } catch (const std::exception&) {}
+            }
+          }
+        }
+        threads.clear();
+      }
+
+      // -- thread execution --
+
+      // main thread execution loop
+      static void _runThread(std::shared_ptr<SharedPoolData> shared, uint32_t __DEBUG_ARG__(index)) noexcept {
+        TRACE_N("ElasticThreadPool: thread %u started", index);
+        assert(shared != nullptr);
+        SharedPoolData& sync = *shared;
+        std::deque<QueuedJob>& jobs = sync.jobs;
+        bool isRetired = false;
+
+        std::unique_lock<std::mutex> guard(sync.lock);
+        task_runner_type commonRunner = (sync.commonRunner != nullptr) ? sync.commonRunner : task_runner_type(&Type::_defaultRunner);
+        --(sync.startingThreads);
+        while (sync.isRunning) {
+          if (sync.retireRequests > 0u && (jobs.empty() || sync.threadCount > 1u)) { // resize (last thread kept until queue is empty)
+            --(sync.retireRequests);
+            isRetired = true;
+            break;
+          }
+          if (jobs.empty()) {
+            ++(sync.sleepingThreads);
+            bool isTimeout = (sync.condition.wait_for(guard, sync.params.idleTimeout) == std::cv_status::timeout);
+            --(sync.sleepingThreads);
+            if (isTimeout && jobs.empty() && sync.isRunning && sync.threadCount - sync.retireRequests > sync.params.minThreads) {
+              isRetired = true;
+              break;
+            }
+            continue;
+          }
+
+          TRACE_N("ElasticThreadPool: thread %u - job started", index);
+          ++(sync.busyThreads);
+          try {
+            const clock_type::time_point enqueueTime = jobs.front().enqueueTime;
+            job_item jobData(std::move(jobs.front().item));
+            jobs.pop_front();
+            if (!jobs.empty() && sync.sleepingThreads == 0u && _isGrowthRequired(sync, enqueueTime))
+              _spawnThread(sync);
+            guard.unlock();
+
+            _callRunner(jobData, commonRunner);
+          }
+          catch (const std::exception& __DEBUG_ARG__(exc)) { TRACE_N("ElasticThreadPool: exception: %s", exc.what()); }
+          catch (...) { TRACE("ElasticThreadPool: unknown exception type thrown"); }
+
+          if (!guard.owns_lock())
+            guard.lock();
+          --(sync.busyThreads);
+        }
+
+        if (isRetired) { // move own thread handle to retired threads (joined later by the pool)
+          --(sync.threadCount);
+          ++(sync.retiredThreads);
+          for (auto it = sync.threads.begin(); it != sync.threads.end(); ++it) {
+            if (it->get_id() == std::this_thread::get_id()) {
+              sync.finishedThreads.emplace_back(std::move(*it));
+              sync.threads.erase(it);
+              break;
+            }
+          }
+          TRACE_N("ElasticThreadPool: thread %u retired", index);
+        }
+        bool isMonitorNotified = (isRetired && sync.isMonitorIdle); // pool size below max again
+        guard.unlock();
+        if (isMonitorNotified)
+          sync.monitorCondition.notify_one();
+        TRACE_N("ElasticThreadPool: thread %u stopped", index);
+      }
+
+      // queue latency monitoring: add a thread when jobs wait too long, even if no job is inserted/extracted (all threads busy)
+      static void _runMonitor(std::shared_ptr<SharedPoolData> shared) noexcept {
+        assert(shared != nullptr);
+        SharedPoolData& sync = *shared;
+        std::unique_lock<std::mutex> guard(sync.lock);
+        while (sync.isRunning) {
+          if (sync.jobs.empty() || sync.threadCount - sync.retireRequests >= sync.params.maxThreads) {
+            sync.isMonitorIdle = true; // no pending job / max size: wait for insertion, retirement or resize
+            sync.monitorCondition.wait(guard);
+            sync.isMonitorIdle = false;
+            continue;
+          }
+          const clock_type::time_point oldestJobTime = sync.jobs.front().enqueueTime;
+          if (sync.sleepingThreads == 0u && _isGrowthRequired(sync, oldestJobTime) && _spawnThread(sync))
+            continue;
+
+          const clock_type::time_point now = clock_type::now();
+          clock_type::time_point nextCheck = oldestJobTime + sync.params.growthLatency;
+          if (nextCheck <= now) { // thread starting / idle thread not awakened yet / creation failure -> verify again later
+            nextCheck = now + ((sync.params.growthLatency > std::chrono::microseconds(100))
+                               ? sync.params.growthLatency : std::chrono::microseconds(100));
+          }
+          sync.monitorCondition.wait_until(guard, nextCheck);
+        }
+      }
+
+      // specialized calls to task runner
+      static inline void _callRunner(JobParamWithRunner& jobData, task_runner_type& defaultRunner) {
+        if (jobData.runner != nullptr)
+          jobData.runner(jobData.param);
+        else
+          defaultRunner(jobData.param);
+      }
+      static inline void _callRunner(_JobParamType& param, task_runner_type& defaultRunner) {
+        defaultRunner(param);
+      }
+      // default task runner, if none provided
+      static inline void _defaultRunner(_JobParamType&) {
+        TRACE("ElasticThreadPool: no common runner provided.");
+      }
+
+    private:
+      std::shared_ptr<SharedPoolData> _poolData;
+    };
+
+  }
+}
@@ -0,0 +1,132 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <system/cpu_arch.h>
+#include <system/operating_system.h>
+
+#if _SYSTEM_OPERATING_SYSTEM == _SYSTEM_OS_LINUX || _SYSTEM_OPERATING_SYSTEM == _SYSTEM_OS_ANDROID
+# define __P_FUTEX_SYSCALL 1
+# include <cerrno>
+# include <climits>
+# include <ctime>
+# include <unistd.h>
+# include <sys/syscall.h>
+# include <linux/futex.h>
+#else
+# include <mutex>
+# include <condition_variable>
+#endif
+#if _SYSTEM_CPU_ARCH == _SYSTEM_CPU_ARCH_X86
+# if defined(_MSC_VER)
+#   include <intrin.h>
+# else
+#   include <immintrin.h>
+# endif
+#endif
+
+namespace pandora {
+  namespace thread {
+    /// @brief Tell the CPU that the current thread is busy-waiting (x86: 'pause', ARM: 'yield'):
+    ///        reduces power usage and memory-order pipeline flushes when the awaited value changes. No system call.
+    inline void cpuRelax() noexcept {
+#     if _SYSTEM_CPU_ARCH == _SYSTEM_CPU_ARCH_X86
+        _mm_pause();
+#     elif _SYSTEM_CPU_ARCH == _SYSTEM_CPU_ARCH_ARM && defined(_MSC_VER)
+        __yield();
+#     elif _SYSTEM_CPU_ARCH == _SYSTEM_CPU_ARCH_ARM
+        __asm__ __volatile__("yield");
+#     endif
+    }
+
+    // -- futex --
+
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex: atomic 32-bit word required");
+
+#   if defined(__P_FUTEX_SYSCALL)
+      // futex system call on an atomic word (process-private)
+      inline long _futexCall(std::atomic<uint32_t>& word, int operation, uint32_t value, const struct timespec* timeout) noexcept {
+        return syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), operation, value, timeout, nullptr, 0);
+      }
+#   else
+      // emulation: waiters parked on condition variables, shared by hashed word addresses
+      struct _FutexBucket final {
+        std::mutex lock;
+        std::condition_variable condition;
+      };
+      inline _FutexBucket& _futexBucket(const void* address) noexcept {
+        static _FutexBucket buckets[64];
+        return buckets[(reinterpret_cast<uintptr_t>(address) >> 4) & 63u];
+      }
+#   endif
+
+    /// @brief Block current thread while the value of an atomic word equals 'expectedValue' (until woken up by 'futexWake')
+    /// @remarks Can return spuriously: the caller must verify the value of the word and wait again if needed.
+    ///          Uses futex system calls on linux/android (emulated with condition variables on other systems).
+    inline void futexWait(std::atomic<uint32_t>& word, uint32_t expectedValue) noexcept {
+#     if defined(__P_FUTEX_SYSCALL)
+        _futexCall(word, FUTEX_WAIT_PRIVATE, expectedValue, nullptr);
+#     else
+        _FutexBucket& bucket = _futexBucket(&word);
+        std::unique_lock<std::mutex> guard(bucket.lock);
+        if (word.load(std::memory_order_relaxed) == expectedValue)
+          bucket.condition.wait(guard);
+#     endif
+    }
+    /// @brief Block current thread while the value of an atomic word equals 'expectedValue' (until woken up, or until timeout)
+    /// @returns False if the timeout was reached
+    template <typename _RepetitionType, typename _PeriodType>
+    inline bool futexWaitFor(std::atomic<uint32_t>& word, uint32_t expectedValue, const std::chrono::duration<_RepetitionType,_PeriodType>& timeout) noexcept {
+      if (timeout <= std::chrono::duration<_RepetitionType,_PeriodType>::zero())
+        return false;
+#     if defined(__P_FUTEX_SYSCALL)
+        auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count();
+        struct timespec timeoutSpec;
+        timeoutSpec.tv_sec = static_cast<time_t>(nanoseconds / 1000000000LL);
+        timeoutSpec.tv_nsec = static_cast<long>(nanoseconds % 1000000000LL);
+        return (_futexCall(word, FUTEX_WAIT_PRIVATE, expectedValue, &timeoutSpec) == 0 || errno != ETIMEDOUT);
+#     else
+        _FutexBucket& bucket = _futexBucket(&word);
+        std::unique_lock<std::mutex> guard(bucket.lock);
+        if (word.load(std::memory_order_relaxed) == expectedValue)
+          return (bucket.condition.wait_for(guard, timeout) == std::cv_status::no_timeout);
+        return true;
+#     endif
+    }
+
+    /// @brief Wake up threads blocked by 'futexWait' on an atomic word (at most 'count' threads)
+    /// @warning The word should be modified before the call (otherwise, woken threads may wait again).
+    inline void futexWake(std::atomic<uint32_t>& word, uint32_t count) noexcept {
+#     if defined(__P_FUTEX_SYSCALL)
+        _futexCall(word, FUTEX_WAKE_PRIVATE, (count < static_cast<uint32_t>(INT_MAX)) ? count : static_cast<uint32_t>(INT_MAX), nullptr);
+#     else
+        _FutexBucket& bucket = _futexBucket(&word);
+        { std::lock_guard<std::mutex> guard(bucket.lock); } // waiter between value check and wait -> wait for it to be blocked
+        (void)count; // bucket shared between words: a single notified thread could be unrelated -> wake all (they verify their word)
+        bucket.condition.notify_all();
+#     endif
+    }
+    /// @brief Wake up all threads blocked by 'futexWait' on an atomic word
+    inline void futexWakeAll(std::atomic<uint32_t>& word) noexcept { futexWake(word, 0xFFFFFFFFu); }
+  }
+}
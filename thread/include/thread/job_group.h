@@ -0,0 +1,232 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <utility>
+
+namespace pandora {
+  namespace thread {
+    /// @class JobGroupState
+    /// @brief Shared state of a group of jobs: cancellation flag + job counters (referenced by JobGroup, CancellationToken and queued jobs).
+    /// @description - queued jobs: inserted in a pool, not started yet (and not dropped by a cancellation);
+    ///              - remaining jobs: queued jobs + running jobs (the group is done when it reaches zero).
+    /// @warning Internal type: only used through JobGroup, CancellationToken and thread pools.
+    class JobGroupState final {
+    public:
+      JobGroupState() noexcept = default;
+      JobGroupState(const JobGroupState&) = delete;
+      JobGroupState(JobGroupState&&) = delete;
+      JobGroupState& operator=(const JobGroupState&) = delete;
+      JobGroupState& operator=(JobGroupState&&) = delete;
+
+      inline void addRef() noexcept { this->_refCount.fetch_add(1u, std::memory_order_relaxed); }
+      inline void release() noexcept {
+        if (this->_refCount.fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+          delete this;
+      }
+
+      // -- getters --
+
+      inline bool isCancelled() const noexcept { return this->_isCancelled.load(std::memory_order_relaxed); }
+      inline uint32_t remainingJobs() const noexcept { return this->_remainingJobs.load(std::memory_order_acquire); }
+
+      // -- pool side operations --
+
+      /// @brief Register a job before inserting it in a pool queue
+      /// @returns False if the group is cancelled (job must not be inserted)
+      inline bool registerJob() noexcept {
+        if (this->_isCancelled.load(std::memory_order_acquire))
+          return false;
+        this->_remainingJobs.fetch_add(1u, std::memory_order_relaxed);
+        this->_queuedJobs.fetch_add(1u, std::memory_order_release);
+        return true;
+      }
+      /// @brief Claim a dequeued job before running it
+      /// @returns True if the job can be run, false if it was dropped by a cancellation (job must be discarded)
+      inline bool claimJob() noexcept {
+        if (!_takeQueuedJob())
+          return false; // already dropped by cancel()
+        if (this->_isCancelled.load(std::memory_order_acquire)) { // cancelled meanwhile
+          _finishJobs(1u);
+          return false;
+        }
+        return true;
+      }
+      /// @brief Remove a job that will never be run (insertion failure, cancelled by pool, pool stopped)
+      inline void dropQueuedJob() noexcept {
+        if (_takeQueuedJob())
+          _finishJobs(1u);
+      }
+      /// @brief Mark a claimed job as finished
+      inline void completeJob() noexcept { _finishJobs(1u); }
+
+      // -- group side operations --
+
+      /// @brief Set cancellation flag and drop all queued jobs (O(1): they're discarded by the pool when dequeued)
+      /// @returns Number of queued jobs dropped
+      inline uint32_t cancel() noexcept {
+        this->_isCancelled.store(true, std::memory_order_seq_cst);
+        uint32_t droppedJobs = this->_queuedJobs.exchange(0, std::memory_order_acq_rel);
+        if (droppedJobs != 0)
+          _finishJobs(droppedJobs);
+        return droppedJobs;
+      }
+
+      /// @brief Wait until all jobs of the group are done (or dropped), or until a time-point
+      /// @returns True if done, false if timeout
+      template <typename _ClockType, typename _DurationType>
+      inline bool waitUntil(const std::chrono::time_point<_ClockType, _DurationType>& timeoutTimePoint) noexcept {
+        if (this->_remainingJobs.load(std::memory_order_acquire) == 0)
+          return true;
+        std::unique_lock<std::mutex> guard(this->_lock);
+        return this->_condition.wait_until(guard, timeoutTimePoint, [this]() { return (this->_remainingJobs.load(std::memory_order_acquire) == 0); });
+      }
+      inline void wait() noexcept {
+        if (this->_remainingJobs.load(std::memory_order_acquire) != 0) {
+          std::unique_lock<std::mutex> guard(this->_lock);
+          this->_condition.wait(guard, [this]() { return (this->_remainingJobs.load(std::memory_order_acquire) == 0); });
+        }
+      }
+
+    private:
+      // take one job from queued counter (if not already dropped)
+      inline bool _takeQueuedJob() noexcept {
+        uint32_t queuedJobs = this->_queuedJobs.load(std::memory_order_acquire);
+        while (queuedJobs != 0 && !this->_queuedJobs.compare_exchange_weak(queuedJobs, queuedJobs - 1u, std::memory_order_acq_rel,
+                                                                                                           std::memory_order_acquire)) {}
+        return (queuedJobs != 0);
+      }
+      // decrease remaining jobs -> awake waiting threads if group is done
+      inline void _finishJobs(uint32_t jobCount) noexcept {
+        if (this->_remainingJobs.fetch_sub(jobCount, std::memory_order_acq_rel) == jobCount) {
+          std::lock_guard<std::mutex> guard(this->_lock); // no lost wake-up: waiters check counter with lock
+          this->_condition.notify_all();
+        }
+      }
+
+    private:
+      std::atomic<uint32_t> _refCount{ 1u };
+      std::atomic<bool> _isCancelled{ false };
+      std::atomic<uint32_t> _queuedJobs{ 0 };
+      std::atomic<uint32_t> _remainingJobs{ 0 };
+      std::mutex _lock;
+      std::condition_variable _condition;
+    };
+
+    // ---
+
+    /// @class CancellationToken
+    /// @brief Read-only view of the cancellation flag of a JobGroup, to poll from running jobs (cooperative cancellation).
+    /// @description Copy the token in the job parameter (or capture it in the job lambda), and poll it in long jobs:
+    ///              'if (token.isCancelled()) return;' (one relaxed atomic load).
+    ///              A default-constructed token is never cancelled.
+    class CancellationToken final {
+    public:
+      /// @brief Create token never cancelled
+      CancellationToken() noexcept = default;
+      /// @brief Create token associated with the state of a group (adds a reference to the state)
+      explicit CancellationToken(JobGroupState* state) noexcept : _state(state) { if (state) state->addRef(); }
+
+      CancellationToken(const CancellationToken& rhs) noexcept : _state(rhs._state) { if (_state) _state->addRef(); }
+      CancellationToken(CancellationToken&& rhs) noexcept : _state(rhs._state) { rhs._state = nullptr; }
+      CancellationToken& operator=(const CancellationToken& rhs) noexcept { CancellationToken copy(rhs); std::swap(this->_state, copy._state); return *this; }
+      CancellationToken& operator=(CancellationToken&& rhs) noexcept { std::swap(this->_state, rhs._state); return *this; }
+      ~CancellationToken() noexcept { if (this->_state) this->_state->release(); }
+
+      /// @brief Verify if the associated group has been cancelled (cheap: can be polled frequently)
+      inline bool isCancelled() const noexcept { return (this->_state != nullptr && this->_state->isCancelled()); }
+      /// @brief Verify if the token is associated with a group (if not, it can't be cancelled)
+      inline bool isCancellable() const noexcept { return (this->_state != nullptr); }
+
+    private:
+      JobGroupState* _state = nullptr;
+    };
+
+    // ---
+
+    /// @class JobGroup
+    /// @brief Group of asynchronous jobs that can be awaited or cancelled together (handle: copies refer to the same group).
+    /// @description Insert jobs with 'pool.addJob(group, ...)' / 'pool.addJobs(group, ...)', then:
+    ///              - wait until all jobs of the group are done: 'group.wait()';
+    ///              - cancel the group: queued jobs are dropped (never run) and the cancellation token is set,
+    ///                so that running jobs can stop early (cooperative: they need to poll 'token.isCancelled()').
+    ///              Typical use: abort a fan-out request after the first failure (failing job calls 'group.cancel()').
+    /// @remarks - Cancellation doesn't touch the pool queue: dropped jobs are only counted as done, and discarded when dequeued
+    ///            (no queue rebuild, no impact on the jobs of other groups).
+    ///          - A cancelled group rejects new jobs (addJob returns false).
+    ///          - A group can be used with multiple pools, and can be destroyed before its jobs are done.
+    class JobGroup final {
+    public:
+      /// @brief Create new empty group
+      JobGroup() : _state(new JobGroupState()) {}
+
+      JobGroup(const JobGroup& rhs) noexcept : _state(rhs._state) { if (_state) _state->addRef(); }
+      JobGroup(JobGroup&& rhs) noexcept : _state(rhs._state) { rhs._state = nullptr; }
+      JobGroup& operator=(const JobGroup& rhs) noexcept { JobGroup copy(rhs); std::swap(this->_state, copy._state); return *this; }
+      JobGroup& operator=(JobGroup&& rhs) noexcept { std::swap(this->_state, rhs._state); return *this; }
+      ~JobGroup() noexcept { if (this->_state) this->_state->release(); }
+
+      // -- status --
+
+      /// @brief Get cancellation token of the group (to poll from running jobs)
+      inline CancellationToken token() const noexcept { return CancellationToken(this->_state); }
+      /// @brief Verify if the group has been cancelled
+      inline bool isCancelled() const noexcept { return (this->_state == nullptr || this->_state->isCancelled()); }
+      /// @brief Get number of jobs of the group not done yet (queued or running)
+      inline uint32_t pendingJobs() const noexcept { return (this->_state != nullptr) ? this->_state->remainingJobs() : 0; }
+
+      /// @brief Cancel all jobs of the group: drop queued jobs + set cancellation token (for running jobs)
+      /// @returns Number of queued jobs dropped
+      inline uint32_t cancel() noexcept { return (this->_state != nullptr) ? this->_state->cancel() : 0; }
+
+      // -- wait for completion --
+
+      /// @brief Wait until all jobs of the group are done (completed or dropped)
+      inline void wait() const noexcept {
+        if (this->_state != nullptr)
+          this->_state->wait();
+      }
+      /// @brief Only wait for a specific period for the jobs of the group to be done
+      /// @returns True if done, false if timeout
+      template <typename _RepetitionType, typename _PeriodType>
+      inline bool tryWait(const std::chrono::duration<_RepetitionType, _PeriodType>& retryDuration) const noexcept {
+        return tryWaitUntil(std::chrono::steady_clock::now() + retryDuration);
+      }
+      /// @brief Only wait until a specific time-point for the jobs of the group to be done
+      /// @returns True if done, false if timeout
+      template <typename _ClockType, typename _DurationType>
+      inline bool tryWaitUntil(const std::chrono::time_point<_ClockType, _DurationType>& timeoutTimePoint) const noexcept {
+        return (this->_state == nullptr || this->_state->waitUntil(timeoutTimePoint));
+      }
+
+      /// @brief Access shared state (used by thread pools)
+      inline JobGroupState* state() const noexcept { return this->_state; }
+
+    private:
+      JobGroupState* _state = nullptr; // null after move
+    };
+
+  }
+}
@@ -0,0 +1,384 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <stdexcept>
+#include <exception>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <new>
+#include <utility>
+#include <type_traits>
+#include <system/trace.h>
+#include "./spin_lock.h"
+
+#define __P_JOB_RESULT_STORAGE_SIZE 64u
+#define __P_JOB_RESULT_CHUNK_SIZE   64u
+
+namespace pandora {
+  namespace thread {
+    class JobResultSlab;
+
+    /// @brief Status of an asynchronous job result
+    enum class JobStatus : uint32_t {
+      pending = 0,   ///< Job not processed yet (or still running)
+      completed = 1, ///< Job processed successfully (result available)
+      failed = 2,    ///< Job processing has thrown an exception (rethrown when reading the result)
+      cancelled = 3  ///< Job cancelled before being started
+    };
+
+    /// @class JobResultSlot
+    /// @brief Storage of the result/status of one asynchronous job (allocated by a JobResultSlab, referenced by JobHandle instances).
+    /// @warning Internal type: only used through JobHandle and thread pools.
+    class JobResultSlot final {
+    public:
+      JobResultSlot() noexcept = default;
+      JobResultSlot(const JobResultSlot&) = delete;
+      JobResultSlot(JobResultSlot&&) = delete;
+      JobResultSlot& operator=(const JobResultSlot&) = delete;
+      JobResultSlot& operator=(JobResultSlot&&) = delete;
+      ~JobResultSlot() noexcept { _destroyValue(); }
+
+      // -- getters --
+
+      inline JobStatus status() const noexcept { return static_cast<JobStatus>(this->_status.load(std::memory_order_acquire)); }
+      inline bool isDone() const noexcept { return (this->_flags.load(std::memory_order_acquire) & _doneFlag) != 0; }
+      inline JobResultSlab* owner() const noexcept { return this->_owner; }
+
+      template <typename _ResultType>
+      inline _ResultType& value() noexcept { return *reinterpret_cast<_ResultType*>(&(this->_storage)); }
+      inline const std::exception_ptr& error() const noexcept { return this->_error; }
+
+      // -- job side operations --
+
+      /// @brief Store job result value (before calling complete)
+      template <typename _ResultType, typename ... _Args>
+      inline void emplaceValue(_Args&&... args) {
+        static_assert(sizeof(_ResultType) <= __P_JOB_RESULT_STORAGE_SIZE, "JobResultSlot: result type too big: return a pointer type instead");
+        static_assert(alignof(_ResultType) <= alignof(std::max_align_t), "JobResultSlot: over-aligned result types not supported");
+        _destroyValue();
+        new (&(this->_storage)) _ResultType(std::forward<_Args>(args)...);
+        this->_valueDestructor = [](void* value) noexcept { reinterpret_cast<_ResultType*>(value)->~_ResultType(); };
+      }
+      /// @brief Mark job as completed: run continuation (if any) and awake waiting threads
+      inline void complete() noexcept { _finish(JobStatus::completed); }
+      /// @brief Mark job as failed (exception thrown by job)
+      inline void fail(std::exception_ptr error) noexcept { this->_error = std::move(error); _finish(JobStatus::failed); }
+      /// @brief Mark job as cancelled (removed from queue)
+      inline void cancel() noexcept { _finish(JobStatus::cancelled); }
+
+      // -- handle side operations --
+
+      /// @brief Set continuation to run after completion (run immediately, by current thread, if already completed)
+      /// @returns False if a continuation was already set
+      bool setContinuation(std::function<void(JobResultSlot&)>&& continuation);
+
+      inline void addRef() noexcept { this->_refCount.fetch_add(1u, std::memory_order_relaxed); }
+      inline void release() noexcept;
+
+    private:
+      friend class JobResultSlab;
+      static constexpr uint32_t _doneFlag = 0x1u;
+      static constexpr uint32_t _continuationFlag = 0x2u; // continuation published (readable by completing thread)
+      static constexpr uint32_t _settingFlag = 0x4u;      // continuation claimed by a handle (being written)
+
+      inline void _destroyValue() noexcept {
+        if (this->_valueDestructor != nullptr) {
+          this->_valueDestructor(&(this->_storage));
+          this->_valueDestructor = nullptr;
+        }
+      }
+      inline void _finish(JobStatus status) noexcept;
+      inline void _runContinuation() noexcept {
+        try {
+          this->_continuation(*this);
+        }
+        catch (const std::exception& __DEBUG_ARG__(exc)) { TRACE_N("JobResultSlot: continuation exception: %s", exc.what()); }
+        catch (...) { TRACE("JobResultSlot: unknown exception type thrown by continuation"); }
+        this->_continuation = nullptr;
+      }
+
+    private:
+      std::atomic<uint32_t> _status{ 0 };
+      std::atomic<uint32_t> _flags{ 0 };
+      std::atomic<uint32_t> _refCount{ 0 };
+      JobResultSlab* _owner = nullptr;
+      typename std::aligned_storage<__P_JOB_RESULT_STORAGE_SIZE, alignof(std::max_align_t)>::type _storage;
+      void (*_valueDestructor)(void*) = nullptr;
+      std::exception_ptr _error;
+      std::function<void(JobResultSlot&)> _continuation;
+    };
+
+    // ---
+
+    /// @class JobResultSlab
+    /// @brief Pool-owned storage for job results: slots are allocated by chunks and recycled (no allocation per job).
+    ///              The slab is destroyed once its owner has released it AND all its slots have been recycled
+    ///              (so job handles remain valid after the destruction of the thread pool).
+    /// @warning Internal type: created and owned by thread pools.
+    class JobResultSlab final {
+    public:
+      /// @brief Create slab (owner reference: call releaseOwner() instead of deleting it)
+      static inline JobResultSlab* create() { return new JobResultSlab(); }
+      /// @brief Release owner reference (slab destroyed as soon as no slot is used anymore)
+      inline void releaseOwner() noexcept { _releaseReference(); }
+
+      JobResultSlab(const JobResultSlab&) = delete;
+      JobResultSlab(JobResultSlab&&) = delete;
+      JobResultSlab& operator=(const JobResultSlab&) = delete;
+      JobResultSlab& operator=(JobResultSlab&&) = delete;
+
+      /// @brief Get total number of slots allocated (used or free)
+      inline size_t capacity() const noexcept { std::lock_guard<SpinLock> guard(this->_lock); return this->_chunks.size() * __P_JOB_RESULT_CHUNK_SIZE; }
+
+      /// @brief Get a free slot, with 'refCount' references (allocate new chunk if none available)
+      JobResultSlot* acquire(uint32_t refCount) {
+        JobResultSlot* slot;
+        std::lock_guard<SpinLock> guard(this->_lock);
+        if (this->_freeSlots.empty()) {
+          std::unique_ptr<JobResultSlot[]> chunk(new JobResultSlot[__P_JOB_RESULT_CHUNK_SIZE]);
+          this->_freeSlots.reserve((this->_chunks.size() + 1u) * __P_JOB_RESULT_CHUNK_SIZE);
+          this->_chunks.reserve(this->_chunks.size() + 1u);
+          for (size_t i = __P_JOB_RESULT_CHUNK_SIZE - 1u; i > 0; --i) {
+            chunk[i]._owner = this;
+            this->_freeSlots.emplace_back(&chunk[i]);
+          }
+          chunk[0]._owner = this;
+          slot = &chunk[0];
+          this->_chunks.emplace_back(std::move(chunk));
+        }
+        else {
+          slot = this->_freeSlots.back();
+          this->_freeSlots.pop_back();
+        }
+        slot->_refCount.store(refCount, std::memory_order_relaxed);
+        this->_references.fetch_add(1u, std::memory_order_relaxed);
+        return slot;
+      }
+
+      /// @brief Reset slot and make it available again
+      void recycle(JobResultSlot& slot) noexcept {
+        slot._destroyValue();
+        slot._error = nullptr;
+        slot._continuation = nullptr;
+        slot._status.store(0u, std::memory_order_relaxed);
+        slot._flags.store(0u, std::memory_order_relaxed);
+
+        {
+          std::lock_guard<SpinLock> guard(this->_lock);
+          this->_freeSlots.emplace_back(&slot); // capacity reserved for all slots of existing chunks -> no allocation
+        }
+        _releaseReference();
+      }
+
+      // -- waiting threads --
+
+      /// @brief Wait for a slot to be done (active polling for a short time, then sleep)
+      template <typename _ClockType, typename _DurationType>
+      bool waitUntil(const JobResultSlot& slot, const std::chrono::time_point<_ClockType, _DurationType>& timeoutTimePoint) noexcept {
+        for (int retry = 0; retry < 64; ++retry) {
+          if (slot.isDone())
+            return true;
+          std::this_thread::yield();
+        }
+
+        std::unique_lock<std::mutex> guard(this->_waitLock);
+        this->_waiters.fetch_add(1u, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst); // done flag must be read after registering as waiter
+        while (!slot.isDone() && this->_condition.wait_until(guard, timeoutTimePoint) != std::cv_status::timeout);
+        this->_waiters.fetch_sub(1u, std::memory_order_relaxed);
+        return slot.isDone();
+      }
+      /// @brief Awake waiting threads (after completion of a slot)
+      inline void notifyWaiters() noexcept {
+        if (this->_waiters.load(std::memory_order_seq_cst) > 0) {
+          { std::lock_guard<std::mutex> guard(this->_waitLock); } // ensure that waiting candidate is already waiting
+          this->_condition.notify_all();
+        }
+      }
+
+    private:
+      JobResultSlab() = default;
+      ~JobResultSlab() noexcept = default;
+
+      inline void _releaseReference() noexcept {
+        if (this->_references.fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+          delete this;
+      }
+
+    private:
+      std::vector<std::unique_ptr<JobResultSlot[]> > _chunks;
+      std::vector<JobResultSlot*> _freeSlots;
+      mutable SpinLock _lock;
+
+      std::atomic<size_t> _references{ 1u }; // owner + used slots
+      std::atomic<uint32_t> _waiters{ 0 };
+      std::mutex _waitLock;
+      std::condition_variable _condition;
+    };
+
+    // -- JobResultSlot (deferred implementations) --
+
+    inline bool JobResultSlot::setContinuation(std::function<void(JobResultSlot&)>&& continuation) {
+      // claim continuation storage (only one handle may write it)
+      uint32_t flags = this->_flags.load(std::memory_order_relaxed);
+      do {
+        if (flags & (_settingFlag | _continuationFlag))
+          return false;
+      } while (!this->_flags.compare_exchange_weak(flags, flags | _settingFlag, std::memory_order_acquire, std::memory_order_relaxed));
+      this->_continuation = std::move(continuation);
+
+      // publish continuation: the completing thread only runs it if this flag is set before its own 'done' flag (and vice versa)
+      uint32_t previousFlags = this->_flags.fetch_or(_continuationFlag, std::memory_order_acq_rel);
+      if (previousFlags & _doneFlag) // already completed -> run continuation now
+        _runContinuation();
+      return true;
+    }
+
+    inline void JobResultSlot::_finish(JobStatus status) noexcept {
+      this->_status.store(static_cast<uint32_t>(status), std::memory_order_release);
+      uint32_t previousFlags = this->_flags.fetch_or(_doneFlag, std::memory_order_seq_cst);
+      if (previousFlags & _continuationFlag) // continuation already set -> run it inline (by completing thread)
+        _runContinuation();
+      this->_owner->notifyWaiters();
+    }
+
+    inline void JobResultSlot::release() noexcept {
+      if (this->_refCount.fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+        this->_owner->recycle(*this);
+    }
+
+    // ---
+
+    /// @class JobHandle
+    /// @brief Handle to the result of an asynchronous job (returned by thread pool 'submit' methods).
+    /// @description The handle can be used to check the job status (poll), to wait for its completion,
+    ///              to read its result, or to attach a continuation (run by the thread that completes the job).
+    template <typename _ResultType>
+    class JobHandle final {
+    public:
+      using Type = JobHandle<_ResultType>;
+      using result_type = _ResultType;
+
+      /// @brief Create empty handle (not associated with any job)
+      JobHandle() noexcept = default;
+      /// @brief Create handle associated with a result slot (adds a reference to the slot)
+      explicit JobHandle(JobResultSlot* slot) noexcept : _slot(slot) { if (slot) slot->addRef(); }
+      /// @brief Create handle associated with a result slot (adopts one existing reference)
+      static inline Type adopt(JobResultSlot* slot) noexcept { Type handle; handle._slot = slot; return handle; }
+
+      JobHandle(const Type& rhs) noexcept : _slot(rhs._slot) { if (_slot) _slot->addRef(); }
+      JobHandle(Type&& rhs) noexcept : _slot(rhs._slot) { rhs._slot = nullptr; }
+      Type& operator=(const Type& rhs) noexcept { Type copy(rhs); std::swap(this->_slot, copy._slot); return *this; }
+      Type& operator=(Type&& rhs) noexcept { std::swap(this->_slot, rhs._slot); return *this; }
+      ~JobHandle() noexcept { if (this->_slot) this->_slot->release(); }
+
+      // -- status --
+
+      /// @brief Verify if the handle is associated with a job
+      inline bool isValid() const noexcept { return (this->_slot != nullptr); }
+      inline operator bool() const noexcept { return isValid(); }
+
+      /// @brief Check if the job is done (completed/failed/cancelled) - no wait (poll)
+      inline bool isReady() const noexcept { return (this->_slot != nullptr && this->_slot->isDone()); }
+      /// @brief Get current job status
+      inline JobStatus status() const noexcept { return (this->_slot != nullptr) ? this->_slot->status() : JobStatus::cancelled; }
+
+      // -- wait for completion --
+
+      /// @brief Wait until the job is done (completed/failed/cancelled)
+      inline void wait() const noexcept {
+        if (this->_slot != nullptr) {
+          while (!this->_slot->owner()->waitUntil(*(this->_slot), std::chrono::steady_clock::now() + std::chrono::seconds(1)));
+        }
+      }
+      /// @brief Only wait for a specific period for the job to be done
+      /// @returns True if done, false if timeout
+      template <typename _RepetitionType, typename _PeriodType>
+      inline bool tryWait(const std::chrono::duration<_RepetitionType, _PeriodType>& retryDuration) const noexcept {
+        return tryWaitUntil(std::chrono::steady_clock::now() + retryDuration);
+      }
+      /// @brief Only wait until a specific time-point for the job to be done
+      /// @returns True if done, false if timeout
+      template <typename _ClockType, typename _DurationType>
+      inline bool tryWaitUntil(const std::chrono::time_point<_ClockType, _DurationType>& timeoutTimePoint) const noexcept {
+        return (this->_slot != nullptr && this->_slot->owner()->waitUntil(*(this->_slot), timeoutTimePoint));
+      }
+
+      // -- result --
+
+      /// @brief Wait until the job is done, then get its result
+      /// @throws - exception thrown by the job (if any);
+      ///         - std::logic_error if the handle is empty or if the job was cancelled.
+      template <typename R = _ResultType>
+      inline typename std::enable_if<!std::is_void<R>::value, R&>::type get() {
+        _waitAndVerify();
+        return this->_slot->template value<R>();
+      }
+      /// @brief Wait until the job is done (no result for 'void' jobs)
+      /// @throws - exception thrown by the job (if any);
+      ///         - std::logic_error if the handle is empty or if the job was cancelled.
+      template <typename R = _ResultType>
+      inline typename std::enable_if<std::is_void<R>::value>::type get() {
+        _waitAndVerify();
+      }
+
+      // -- continuation --
+
+      /// @brief Set operation to run when the job is done: 'void operation(JobHandle<_ResultType>&)'
+      /// @remarks - The continuation is run inline by the thread that completes the job (or by the current thread, if the job is already done).
+      ///          - Only one continuation per job. Use get() in continuation to read the result (or to rethrow job exception).
+      /// @returns False if the handle is empty or if a continuation was already set
+      template <typename _Operation>
+      bool then(_Operation&& operation) {
+        if (this->_slot == nullptr)
+          return false;
+        return this->_slot->setContinuation([operation](JobResultSlot& slot) mutable {
+          Type handle(&slot);
+          operation(handle);
+        });
+      }
+
+    private:
+      void _waitAndVerify() {
+        if (this->_slot == nullptr)
+          throw std::logic_error("JobHandle: empty handle");
+        wait();
+        switch (this->_slot->status()) {
+          case JobStatus::failed: std::rethrow_exception(this->_slot->error()); break;
+          case JobStatus::cancelled: throw std::logic_error("JobHandle: job cancelled");
+          default: break;
+        }
+      }
+
+    private:
+      JobResultSlot* _slot = nullptr;
+    };
+
+  }
+}
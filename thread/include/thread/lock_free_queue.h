@@ -0,0 +1,223 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <memory>
+#include <atomic>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+#ifndef __P_CACHE_LINE_SIZE
+# define __P_CACHE_LINE_SIZE 64
+#endif
+
+namespace pandora {
+  namespace thread {
+    /// @class LockFreeQueue
+    /// @brief Fixed-capacity lock-free queue (FIFO) for multiple producers and multiple consumers.
+    /// @description Bounded ring buffer where each cell holds a sequence number:
+    ///              producers and consumers reserve a cell with one atomic compare-exchange, then publish it by updating its sequence.
+    ///              No lock and no allocation after construction: push() fails when the queue is full, pop() fails when it's empty.
+    /// @remarks The capacity is rounded up to the next power of 2.
+    template <typename _DataType>
+    class LockFreeQueue final {
+    public:
+      using value_type = _DataType;
+      using size_type = size_t;
+      using Type = LockFreeQueue<_DataType>;
+
+      /// @brief Create empty queue (capacity rounded up to next power of 2)
+      explicit LockFreeQueue(size_t capacity)
+        : _mask(_toPowerOfTwo(capacity) - 1u),
+          _cells(new Cell[_mask + 1u]) {
+        for (size_t i = 0; i <= this->_mask; ++i)
+          this->_cells[i].sequence.store(i, std::memory_order_relaxed);
+      }
+      /// @brief Destroy queue and all remaining items
+      ~LockFreeQueue() noexcept {
+        if (this->_cells != nullptr) {
+          for (size_t pos = this->_popPosition.load(std::memory_order_relaxed); pos != this->_pushPosition.load(std::memory_order_relaxed); ++pos) {
+            Cell& cell = this->_cells[pos & this->_mask];
+            if (cell.isValid)
+              cell.value()->~_DataType();
+          }
+        }
+      }
+
+      LockFreeQueue(const Type&) = delete;
+      LockFreeQueue(Type&&) = delete;
+      Type& operator=(const Type&) = delete;
+      Type& operator=(Type&&) = delete;
+
+      // -- getters --
+
+      constexpr inline size_t capacity() const noexcept { return this->_mask + 1u; } ///< Get maximum capacity of the queue
+      /// @brief Get approximate number of items currently stored in queue (may already be obsolete if other threads push/pop)
+      inline size_t size() const noexcept {
+        size_t popPosition = this->_popPosition.load(std::memory_order_acquire);
+        size_t pushPosition = this->_pushPosition.load(std::memory_order_acquire);
+        return (pushPosition > popPosition) ? (pushPosition - popPosition) : 0;
+      }
+      inline bool empty() const noexcept { return (size() == 0); } ///< Check if any item is present in the queue (approximation)
+
+      // -- operations --
+
+      /// @brief Insert an item at the end of the queue (copy)
+      /// @returns True on success, false if the queue is full
+      template <typename T = _DataType>
+      inline typename std::enable_if<std::is_copy_constructible<T>::value, bool>::type push(const _DataType& value) { return emplace(value); }
+      /// @brief Insert an item at the end of the queue (move)
+      /// @returns True on success, false if the queue is full
+      inline bool push(_DataType&& value) { return emplace(std::move(value)); }
+
+      /// @brief Create an item at the end of the queue
+      /// @returns True on success, false if the queue is full
+      template <typename ... _Args>
+      bool emplace(_Args&&... args) {
+        Cell* cell;
+        size_t position = this->_pushPosition.load(std::memory_order_relaxed);
+        for (;;) {
+          cell = &(this->_cells[position & this->_mask]);
+          intptr_t diff = static_cast<intptr_t>(cell->sequence.load(std::memory_order_acquire)) - static_cast<intptr_t>(position);
+          if (diff == 0) { // free cell -> reserve it
+            if (this->_pushPosition.compare_exchange_weak(position, position + 1u, std::memory_order_relaxed))
+              break;
+          }
+          else if (diff < 0) // cell not consumed yet -> full
+            return false;
+          else // other producer already reserved it
+            position = this->_pushPosition.load(std::memory_order_relaxed);
+        }
+
+        try {
+          new (cell->storage()) _DataType(std::forward<_Args>(args)...);
+        }
+        catch (...) { // cell already reserved -> publish it as invalid (skipped by consumers)
+          cell->isValid = false;
+          cell->sequence.store(position + 1u, std::memory_order_release);
+          throw;
+        }
+        cell->isValid = true;
+        cell->sequence.store(position + 1u, std::memory_order_release);
+        return true;
+      }
+
+      /// @brief Extract first item of the queue
+      /// @returns True on success, false if the queue is empty
+      bool pop(_DataType& outValue) {
+        size_t position;
+        Cell* cell = _reserveFront(position);
+        if (cell == nullptr)
+          return false;
+
+        _DataType* value = cell->value();
+        try {
+          outValue = std::move(*value);
+        }
+        catch (...) { _releaseFront(cell, position); throw; }
+        _releaseFront(cell, position);
+        return true;
+      }
+      /// @brief Extract first item of the queue and provide it to an operation (rvalue reference): 'void operation(_DataType&&)'
+      /// @remarks Useful for types that can't be default-constructed or assigned
+      /// @returns True on success, false if the queue is empty
+      template <typename _Operation>
+      bool consume(_Operation&& operation) {
+        size_t position;
+        Cell* cell = _reserveFront(position);
+        if (cell == nullptr)
+          return false;
+
+        try {
+          operation(std::move(*(cell->value())));
+        }
+        catch (...) { _releaseFront(cell, position); throw; }
+        _releaseFront(cell, position);
+        return true;
+      }
+
+      /// @brief Remove all items currently stored in the queue
+      /// @returns Number of items removed
+      size_t clear() noexcept {
+        size_t count = 0;
+        size_t position;
+        for (Cell* cell = _reserveFront(position); cell != nullptr; cell = _reserveFront(position), ++count)
+          _releaseFront(cell, position);
+        return count;
+      }
+
+    private:
+      struct Cell {
+        std::atomic<size_t> sequence{ 0 };
+        bool isValid = false;
+        typename std::aligned_storage<sizeof(_DataType), alignof(_DataType)>::type data;
+
+        inline void* storage() noexcept { return static_cast<void*>(&data); }
+        inline _DataType* value() noexcept { return reinterpret_cast<_DataType*>(&data); }
+      };
+
+      // reserve first published cell (skip failed insertions) - returns nullptr if empty
+      Cell* _reserveFront(size_t& outPosition) noexcept {
+        Cell* cell;
+        size_t position = this->_popPosition.load(std::memory_order_relaxed);
+        for (;;) {
+          cell = &(this->_cells[position & this->_mask]);
+          intptr_t diff = static_cast<intptr_t>(cell->sequence.load(std::memory_order_acquire)) - static_cast<intptr_t>(position + 1u);
+          if (diff == 0) { // published cell -> reserve it
+            if (this->_popPosition.compare_exchange_weak(position, position + 1u, std::memory_order_relaxed)) {
+              if (cell->isValid) {
+                outPosition = position;
+                return cell;
+              }
+              cell->sequence.store(position + this->_mask + 1u, std::memory_order_release); // failed insertion -> skip cell
+              position = this->_popPosition.load(std::memory_order_relaxed);
+            }
+          }
+          else if (diff < 0) // cell not published yet -> empty
+            return nullptr;
+          else // other consumer already reserved it
+            position = this->_popPosition.load(std::memory_order_relaxed);
+        }
+      }
+      // destroy value of a reserved cell + make it available for producers
+      inline void _releaseFront(Cell* cell, size_t position) noexcept {
+        cell->value()->~_DataType();
+        cell->sequence.store(position + this->_mask + 1u, std::memory_order_release);
+      }
+
+      static inline size_t _toPowerOfTwo(size_t capacity) noexcept {
+        size_t result = 2u;
+        while (result < capacity)
+          result <<= 1;
+        return result;
+      }
+
+    private:
+      const size_t _mask;
+      std::unique_ptr<Cell[]> _cells;
+      alignas(__P_CACHE_LINE_SIZE) std::atomic<size_t> _pushPosition{ 0 }; // separate cache lines: avoid false sharing between producers and consumers
+      alignas(__P_CACHE_LINE_SIZE) std::atomic<size_t> _popPosition{ 0 };
+    };
+
+  }
+}
@@ -0,0 +1,401 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <utility>
+#include <type_traits>
+#include <system/trace.h>
+#include "./thread_pool.h"
+
+namespace pandora {
+  namespace thread {
+    /// @brief Node hint value for jobs that may be processed on any node
+    constexpr uint32_t anyNumaNode() noexcept { return 0xFFFFFFFFu; }
+
+    /// @brief Placement of a worker thread in a NumaThreadPool
+    struct WorkerPlacement final {
+      uint32_t node = 0;          ///< Index of the memory node (NUMA node) of the worker (0 to nodeCount-1)
+      int32_t cpuMask = 0;        ///< CPU affinity bitmask of the worker (bit 0-31: CPU 0-31) - 0: not pinned
+      std::vector<uint32_t> cpus; ///< Indexes of the logical CPUs of the worker (any index: for systems with more than 32 CPUs) - empty: only use cpuMask
+    };
+    /// @brief Function used to pin a worker thread to CPU(s) with its 'cpuMask' (compatible with 'hardware::setThreadAffinity')
+    using ThreadAffinitySetter = bool (*)(std::thread&, int32_t);
+    /// @brief Function used to pin a worker thread to CPU(s) with its whole placement: 'cpus' + 'cpuMask' (compatible with 'hardware::setWorkerAffinity')
+    using WorkerAffinitySetter = bool (*)(std::thread&, const WorkerPlacement&);
+
+    /// @brief Distribute worker threads across memory nodes (round-robin) without CPU pinning
+    inline std::vector<WorkerPlacement> unpinnedWorkerPlacement(size_t threadCount, uint32_t nodeCount) {
+      std::vector<WorkerPlacement> placements(threadCount);
+      if (nodeCount == 0)
+        nodeCount = 1u;
+      for (size_t i = 0; i < threadCount; ++i)
+        placements[i].node = static_cast<uint32_t>(i % nodeCount);
+      return placements;
+    }
+
+    // ---
+
+    /// @class NumaThreadPool
+    /// @brief Fixed-size pool of threads placed on memory nodes (NUMA), with node hints for jobs.
+    /// @description Alternative to ThreadPool for multi-socket / multi-node systems, when jobs mostly access memory allocated on a specific node.
+    ///              Each worker belongs to a node and can be pinned to CPU(s) of that node (see WorkerPlacement + WorkerAffinitySetter):
+    ///              - jobs inserted with a node hint are only processed by the workers of that node (memory-local work stays on its node);
+    ///              - jobs inserted without hint (anyNumaNode()) are processed by any worker (after the jobs of its own node);
+    ///              - jobs with a hint for a node without workers are processed by any worker.
+    ///              The placement of the workers is usually computed from the detected CPU topology (see 'hardware/thread_placement.h').
+    template <typename _JobParamType,                        // Type of data container to process (must be movable)
+              ThreadRunnerMode _Mode = ThreadRunnerMode::single, // one function passed on construction / one per job
+              TaskRunnerType _FunctionType = TaskRunnerType::functionPointer> // function pointer / lambda
+    class NumaThreadPool final {
+    public:
+      using Type = NumaThreadPool<_JobParamType,_Mode,_FunctionType>;
+      using size_type = size_t;
+      using task_runner_type = typename std::conditional<_FunctionType == TaskRunnerType::lambda, std::function<void(_JobParamType&)>, void (*)(_JobParamType&)>::type;
+      using task_runner_move = typename std::conditional<_FunctionType == TaskRunnerType::lambda, task_runner_type&&, task_runner_type>::type;
+    protected:
+      template<bool cond, typename _T>
+      using EnableIf = typename std::enable_if<cond, _T>::type;
+
+      using job_param_move = typename std::conditional<std::is_class<_JobParamType>::value, _JobParamType&&, _JobParamType>::type;
+      struct JobParamWithRunner { // Job data in 'perJob' mode (parameter + custom runner)
+        _JobParamType param;
+        task_runner_type runner;
+        JobParamWithRunner(job_param_move param) : param(std::move(param)), runner(nullptr) {}
+        JobParamWithRunner(job_param_move param, task_runner_move runner) : param(std::move(param)), runner(std::move(runner)) {}
+      };
+      using job_item = typename std::conditional<(_Mode == ThreadRunnerMode::perJob), JobParamWithRunner, _JobParamType>::type;
+
+      struct Node { // Jobs + workers of a memory node
+        std::deque<job_item> jobs;
+        size_t threads = 0;
+        size_t busyThreads = 0;
+        size_t sleepingThreads = 0;
+        std::condition_variable condition;
+      };
+      struct SharedPoolData { // Synchronization & jobs data - shared with child threads
+        bool isRunning = false;
+        std::unique_ptr<Node[]> nodes;
+        uint32_t nodeCount = 0;
+        uint32_t nextWakeUpNode = 0;   // round-robin wake-up for jobs without node
+        std::deque<job_item> anyNodeJobs;
+        mutable std::mutex lock;
+      };
+
+    public:
+      /// @brief Create empty thread pool - not running
+      inline NumaThreadPool() : _poolData(std::make_shared<SharedPoolData>()) {}
+      /// @brief Create and start a thread pool - mode: no common runner -> provide a task runner for each job
+      /// @param placements  Node (and optional CPU affinity) of each worker thread (one entry per thread)
+      /// @warning in 'single' runner mode, jobs will not be processed!
+      inline NumaThreadPool(const std::vector<WorkerPlacement>& placements) : _poolData(std::make_shared<SharedPoolData>()) {
+        task_runner_type emptyRunner = nullptr;
+        _startThreads(placements, emptyRunner, nullptr, nullptr);
+      }
+      /// @brief Create and start a thread pool - mode: common task runner provided in constructor
+      /// @param placements   Node (and optional CPU affinity) of each worker thread (one entry per thread)
+      /// @param setAffinity  Function used to pin workers with a 'cpuMask' (ex: '&hardware::setThreadAffinity') - nullptr: workers not pinned
+      /// @warning Required for standard use of 'single' runner mode, optional to have a default runner in 'perJob' mode.
+      inline NumaThreadPool(const std::vector<WorkerPlacement>& placements, task_runner_type commonRunner, ThreadAffinitySetter setAffinity = nullptr)
+        : _poolData(std::make_shared<SharedPoolData>()) {
+        _startThreads(placements, commonRunner, setAffinity, nullptr);
+      }
+      /// @brief Create and start a thread pool - mode: common task runner provided in constructor
+      /// @param placements   Node (and optional CPU affinity) of each worker thread (one entry per thread)
+      /// @param setAffinity  Function used to pin workers with their 'cpus' and/or 'cpuMask' (ex: '&hardware::setWorkerAffinity'): no limit on CPU indexes
+      /// @warning Required for standard use of 'single' runner mode, optional to have a default runner in 'perJob' mode.
+      inline NumaThreadPool(const std::vector<WorkerPlacement>& placements, task_runner_type commonRunner, WorkerAffinitySetter setAffinity)
+        : _poolData(std::make_shared<SharedPoolData>()) {
+        _startThreads(placements, commonRunner, nullptr, setAffinity);
+      }
+
+      /// @brief Stop thread pool and wait for each thread to stop running
+      ~NumaThreadPool() noexcept { _stopThreads(); }
+
+      NumaThreadPool(const Type&) = delete;
+      Type& operator=(const Type&) = delete;
+      inline NumaThreadPool(Type&& rhs) noexcept : _poolData(std::move(rhs._poolData)), _pinnedThreads(rhs._pinnedThreads) {
+        std::swap(this->_threads, rhs._threads);
+        rhs._poolData = std::make_shared<SharedPoolData>();
+        rhs._pinnedThreads = 0;
+      }
+      inline Type& operator=(Type&& rhs) noexcept {
+        _stopThreads();
+        std::swap(this->_threads, rhs._threads);
+        this->_poolData = std::move(rhs._poolData);
+        this->_pinnedThreads = rhs._pinnedThreads;
+        rhs._poolData = std::make_shared<SharedPoolData>();
+        rhs._pinnedThreads = 0;
+        return *this;
+      }
+
+      // -- thread pool size --
+
+      inline size_type size() const noexcept { return this->_threads.size(); } ///< Total number of threads in the pool
+      inline uint32_t nodeCount() const noexcept { return this->_poolData->nodeCount; } ///< Number of memory nodes used by the pool
+      inline size_type pinnedThreads() const noexcept { return this->_pinnedThreads; } ///< Number of threads successfully pinned to CPU(s)
+      /// @brief Number of threads placed on a memory node
+      inline size_type size(uint32_t node) const noexcept {
+        return (node < this->_poolData->nodeCount) ? this->_poolData->nodes[node].threads : 0;
+      }
+
+      /// @brief Number of active threads in the pool (currently processing a job)
+      inline size_type busyThreads() const noexcept {
+        std::lock_guard<std::mutex> guard(this->_poolData->lock);
+        size_t busyCount = 0;
+        for (uint32_t i = 0; i < this->_poolData->nodeCount; ++i)
+          busyCount += this->_poolData->nodes[i].busyThreads;
+        return busyCount;
+      }
+      /// @brief Number of active threads of a memory node
+      inline size_type busyThreads(uint32_t node) const noexcept {
+        std::lock_guard<std::mutex> guard(this->_poolData->lock);
+        return (node < this->_poolData->nodeCount) ? this->_poolData->nodes[node].busyThreads : 0;
+      }
+      /// @brief Number of threads waiting in the pool (ready for new jobs)
+      inline size_type freeThreads() const noexcept { return size() - busyThreads(); }
+
+      /// @brief Number of jobs waiting to be processed (all nodes)
+      inline size_type pendingJobs() const noexcept {
+        std::lock_guard<std::mutex> guard(this->_poolData->lock);
+        size_t jobCount = this->_poolData->anyNodeJobs.size();
+        for (uint32_t i = 0; i < this->_poolData->nodeCount; ++i)
+          jobCount += this->_poolData->nodes[i].jobs.size();
+        return jobCount;
+      }
+      /// @brief Number of jobs waiting to be processed on a specific node (anyNumaNode(): jobs without node)
+      inline size_type pendingJobs(uint32_t node) const noexcept {
+        std::lock_guard<std::mutex> guard(this->_poolData->lock);
+        return (node < this->_poolData->nodeCount) ? this->_poolData->nodes[node].jobs.size() : this->_poolData->anyNodeJobs.size();
+      }
+
+      // -- job management --
+
+      /// @brief Insert a new job to process (copied) - custom task runner for each job (not available in 'single' runner mode)
+      /// @param nodeHint  Memory node of the workers allowed to process the job (anyNumaNode(): any worker)
+      template<typename J = _JobParamType, ThreadRunnerMode M = _Mode>
+      inline EnableIf<(!std::is_class<J>::value || std::is_copy_constructible<J>::value) && M == ThreadRunnerMode::perJob,
+                      bool> addJob(const _JobParamType& param, task_runner_move runner, uint32_t nodeHint = anyNumaNode()) {
+        return _pushJob(nodeHint, _JobParamType(param), std::move(runner));
+      }
+      /// @brief Insert a new job to process (moved) - custom task runner for each job (not available in 'single' runner mode)
+      /// @param nodeHint  Memory node of the workers allowed to process the job (anyNumaNode(): any worker)
+      template<ThreadRunnerMode M = _Mode>
+      inline EnableIf<M==ThreadRunnerMode::perJob,
+                      bool> addJob(_JobParamType&& param, task_runner_move runner, uint32_t nodeHint = anyNumaNode()) {
+        return _pushJob(nodeHint, std::move(param), std::move(runner));
+      }
+
+      /// @brief Insert a new job to process (copied) - use common task runner provided in constructor
+      /// @param nodeHint  Memory node of the workers allowed to process the job (anyNumaNode(): any worker)
+      template<typename J = _JobParamType>
+      inline EnableIf<!std::is_class<J>::value || std::is_copy_constructible<J>::value,
+                      bool> addJob(const _JobParamType& param, uint32_t nodeHint = anyNumaNode()) {
+        return _pushJob(nodeHint, _JobParamType(param));
+      }
+      /// @brief Insert a new job to process (moved) - use common task runner provided in constructor
+      /// @param nodeHint  Memory node of the workers allowed to process the job (anyNumaNode(): any worker)
+      inline bool addJob(_JobParamType&& param, uint32_t nodeHint = anyNumaNode()) {
+        return _pushJob(nodeHint, std::move(param));
+      }
+
+      /// @brief Cancel all jobs that haven't already been started
+      inline uint32_t cancelPendingJobs() noexcept {
+        std::lock_guard<std::mutex> guard(this->_poolData->lock);
+        return static_cast<uint32_t>(_clearJobs(*(this->_poolData)));
+      }
+
+    protected:
+      static size_t _clearJobs(SharedPoolData& sync) noexcept {
+        size_t jobCount = sync.anyNodeJobs.size();
+        sync.anyNodeJobs.clear();
+        for (uint32_t i = 0; i < sync.nodeCount; ++i) {
+          jobCount += sync.nodes[i].jobs.size();
+          sync.nodes[i].jobs.clear();
+        }
+        return jobCount;
+      }
+
+      // -- job management --
+
+      // insert job in node queue (or in common queue) + awake a thread able to process it
+      template <typename ... _Args>
+      bool _pushJob(uint32_t nodeHint, _Args&&... args) {
+        SharedPoolData& sync = *(this->_poolData);
+        std::unique_lock<std::mutex> guard(sync.lock);
+        if (!sync.isRunning)
+          return false;
+
+        Node* target = nullptr;
+        if (nodeHint < sync.nodeCount && sync.nodes[nodeHint].threads > 0u) { // node-local job
+          sync.nodes[nodeHint].jobs.emplace_back(std::forward<_Args>(args)...);
+          if (sync.nodes[nodeHint].sleepingThreads > 0u)
+            target = &(sync.nodes[nodeHint]);
+        }
+        else { // job for any node -> awake a sleeping thread (round-robin between nodes)
+          sync.anyNodeJobs.emplace_back(std::forward<_Args>(args)...);
+          for (uint32_t i = 0; i < sync.nodeCount; ++i) {
+            Node& node = sync.nodes[(sync.nextWakeUpNode + i) % sync.nodeCount];
+            if (node.sleepingThreads > 0u) {
+              target = &node;
+              sync.nextWakeUpNode = (sync.nextWakeUpNode + i + 1u) % sync.nodeCount;
+              break;
+            }
+          }
+        }
+        guard.unlock();
+
+        if (target != nullptr)
+          target->condition.notify_one();
+        return true;
+      }
+
+      // -- thread management --
+
+      // launch thread pool
+      void _startThreads(const std::vector<WorkerPlacement>& placements, task_runner_type& runner,
+                         ThreadAffinitySetter setMaskAffinity, WorkerAffinitySetter setWorkerAffinity) {
+        SharedPoolData& sync = *(this->_poolData);
+        uint32_t nodeCount = 1u;
+        for (const auto& placement : placements) {
+          if (placement.node >= nodeCount)
+            nodeCount = placement.node + 1u;
+        }
+        sync.nodes.reset(new Node[nodeCount]);
+        sync.nodeCount = nodeCount;
+        for (const auto& placement : placements)
+          ++(sync.nodes[placement.node].threads);
+        sync.isRunning = true;
+
+        this->_threads.reserve(placements.size());
+        uint32_t index = 0;
+        for (const auto& placement : placements) {
+          this->_threads.emplace_back(&Type::_runThread, this->_poolData, index, placement.node, runner);
+          if (setWorkerAffinity != nullptr ? (placement.cpuMask != 0 || !placement.cpus.empty())
+                                           : (setMaskAffinity != nullptr && placement.cpuMask != 0)) {
+            bool isPinned = (setWorkerAffinity != nullptr) ? setWorkerAffinity(this->_threads.back(), placement)
+                                                           : setMaskAffinity(this->_threads.back(), placement.cpuMask);
+            if (isPinned)
+              ++(this->_pinnedThreads);
+            else { TRACE_N("NumaThreadPool: thread %u - failed to set CPU affinity", index); }
+          }
+          ++index;
+        }
+      }
+
+      // stop all threads
+      void _stopThreads() noexcept {
+        SharedPoolData& sync = *(this->_poolData);
+        std::unique_lock<std::mutex> guard(sync.lock);
+        sync.isRunning = false;
+        _clearJobs(sync);
+        guard.unlock();
+
+        for (uint32_t i = 0; i < sync.nodeCount; ++i)
+          sync.nodes[i].condition.notify_all();
+        for (auto& item : this->_threads) {
+          if (item.joinable()) {
+            try {
+              item.join();
+            }
+            catch (const std::exception& __DEBUG_ARG__(exc)) {
+              TRACE_N("NumaThreadPool: thread join exception: %s", exc.what());
+              try { item.detach(); } catch (const std::exception&) {}
+            }
+          }
+        }
+        this->_threads.clear();
+        this->_pinnedThreads = 0;
+      }
+
+      // -- thread execution --
+
+      // main thread execution loop
+      static void _runThread(std::shared_ptr<SharedPoolData> shared, uint32_t __DEBUG_ARG__(index), uint32_t nodeIndex, task_runner_type commonRunner) noexcept {
+        TRACE_N("NumaThreadPool: thread %u started (node %u)", index, nodeIndex);
+        assert(shared != nullptr && nodeIndex < shared->nodeCount);
+        SharedPoolData& sync = *shared;
+        Node& node = sync.nodes[nodeIndex];
+        if (commonRunner == nullptr)
+          commonRunner = &Type::_defaultRunner;
+
+        std::unique_lock<std::mutex> guard(sync.lock);
+        while (sync.isRunning) {
+          while (sync.isRunning && node.jobs.empty() && sync.anyNodeJobs.empty()) {
+            ++(node.sleepingThreads);
+            node.condition.wait(guard);
+            --(node.sleepingThreads);
+          }
+
+          if (sync.isRunning) {
+            TRACE_N("NumaThreadPool: thread %u - job started", index);
+            ++(node.busyThreads);
+            try {
+              std::deque<job_item>& source = (!node.jobs.empty()) ? node.jobs : sync.anyNodeJobs; // local jobs first
+              job_item jobData(std::move(source.front()));
+              source.pop_front();
+              guard.unlock();
+              _callRunner(jobData, commonRunner);
+            }
+            catch (const std::exception& __DEBUG_ARG__(exc)) { TRACE_N("NumaThreadPool: exception: %s", exc.what()); }
+            catch (...) { TRACE("NumaThreadPool: unknown exception type thrown"); }
+
+            if (!guard.owns_lock())
+              guard.lock();
+            --(node.busyThreads);
+          }
+        }
+
+        guard.unlock();
+        node.condition.notify_one();
+        TRACE_N("NumaThreadPool: thread %u stopped", index);
+      }
+
+      // specialized calls to task runner
+      static inline void _callRunner(JobParamWithRunner& jobData, task_runner_type& defaultRunner) {
+        if (jobData.runner != nullptr)
+          jobData.runner(jobData.param);
+        else
+          defaultRunner(jobData.param);
+      }
+      static inline void _callRunner(_JobParamType& param, task_runner_type& defaultRunner) {
+        defaultRunner(param);
+      }
+      // default task runner, if none provided
+      static inline void _defaultRunner(_JobParamType&) {
+        TRACE("NumaThreadPool: no common runner provided.");
+      }
+
+    private:
+      std::vector<std::thread> _threads;
+      std::shared_ptr<SharedPoolData> _poolData;
+      size_t _pinnedThreads = 0;
+    };
+
+  }
+}
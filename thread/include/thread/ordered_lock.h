@@ -28,6 +28,7 @@ namespace pandora {
     /// @brief Synchronization primitive to protect data from being simultaneously accessed, with guaranteed FIFO order.
     /// @description Synchronization primitive to protect data from being simultaneously accessed by multiple threads.
     ///              Acts like a standard mutex, except that the order of lock is guaranteed (FIFO).
+    /// @remarks Each waiter allocates its own condition variable (and the queue is protected by a mutex): for highly contended locks, prefer TicketLock (same API).
     class OrderedLock final {
       using InternalTicket = std::condition_variable*;
     public:
@@ -0,0 +1,331 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+--------------------------------------------------------------------------------
+Description : data-parallel helpers over index ranges, executed by a thread pool
+              - parallelFor:       call operation for each index of a range
+              - parallelReduce:    map each index to a value, then combine all values
+              - parallelTransform: write transformed input values in output range
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <iterator>
+#include <algorithm>
+#include <utility>
+#include <system/trace.h>
+#include "./thread_pool.h"
+
+#define __P_PARALLEL_MAX_DEPTH  8u
+#define __P_PARALLEL_MAX_CHUNKS (1u << __P_PARALLEL_MAX_DEPTH)
+
+namespace pandora {
+  namespace thread {
+    class ParallelContext;
+
+    /// @brief Job parameter used to dispatch parallel ranges to a thread pool
+    struct ParallelJob final {
+      ParallelContext* context = nullptr;
+      uint32_t chunk = 0;
+    };
+    /// @brief Thread pool type for parallel helpers (parallelFor, parallelReduce, parallelTransform)
+    /// @remarks Other pools with a 'bool addJob(ParallelJob)' method and a common runner set to 'processParallelJob' can also be used.
+    using ParallelPool = ThreadPool<ParallelJob, ThreadRunnerMode::single, TaskRunnerType::functionPointer>;
+
+    /// @brief Common task runner to use in thread pools running parallel helpers
+    inline void processParallelJob(ParallelJob& job) noexcept;
+
+    // ---
+
+    /// @class ParallelContext
+    /// @brief Shared state of a parallel operation: chunks of the index range, dispatched to pool workers and to the calling thread.
+    /// @description Adaptive chunking: each chunk is split recursively in halves (the right half is dispatched to the pool),
+    ///              until its size is below the grain size or until the maximum depth is reached (based on the number of threads).
+    ///              Workers that receive a chunk split it again, so that idle threads always find work.
+    ///              The calling thread processes the first chunk, then claims the dispatched chunks that haven't been started yet.
+    /// @warning Internal type: only used through parallelFor/parallelReduce/parallelTransform.
+    class ParallelContext final {
+    public:
+      using range_runner = void (*)(void* operation, size_t begin, size_t end, uint32_t chunk);
+      using dispatcher = bool (*)(void* pool, ParallelJob job);
+
+      ParallelContext(void* operation, range_runner runner, void* pool, dispatcher dispatch, size_t threadCount, size_t grainSize) noexcept
+        : _operation(operation), _runner(runner), _pool(pool), _dispatch(dispatch), _grainSize(grainSize ? grainSize : 1u) {
+        this->_maxDepth = 2u; // ~4 chunks per participating thread
+        for (size_t participants = threadCount + 1u; participants > 1u && this->_maxDepth < __P_PARALLEL_MAX_DEPTH; participants = (participants + 1u) >> 1)
+          ++(this->_maxDepth);
+      }
+      ParallelContext(const ParallelContext&) = delete;
+      ParallelContext(ParallelContext&&) = delete;
+      ParallelContext& operator=(const ParallelContext&) = delete;
+      ParallelContext& operator=(ParallelContext&&) = delete;
+      ~ParallelContext() noexcept = default;
+
+      /// @brief Maximum number of chunks (for per-chunk partial results)
+      inline uint32_t maxChunks() const noexcept { return (1u << this->_maxDepth); }
+      /// @brief Number of chunks used by last execution
+      inline uint32_t chunkCount() const noexcept {
+        uint32_t count = this->_chunkCount.load(std::memory_order_acquire);
+        return (count <= maxChunks()) ? count : maxChunks();
+      }
+      /// @brief First index of a chunk
+      inline size_t chunkBegin(uint32_t chunk) const noexcept { return this->_chunks[chunk].begin; }
+
+      // -- execution --
+
+      /// @brief Process range in calling thread + pool workers, wait until the whole range is processed
+      /// @throws First exception thrown by the operation
+      void run(size_t begin, size_t end) {
+        Chunk& first = this->_chunks[0];
+        first.begin = begin;
+        first.end = end;
+        first.depth = 0;
+        first.isClaimed.store(true, std::memory_order_relaxed);
+        first.isReady.store(true, std::memory_order_relaxed);
+        this->_chunkCount.store(1u, std::memory_order_relaxed);
+        processChunk(0);
+
+        // join: process chunks not started yet
+        bool hasClaimed = true;
+        while (hasClaimed) {
+          hasClaimed = false;
+          uint32_t count = chunkCount();
+          for (uint32_t i = 1; i < count; ++i) {
+            if (claimChunk(i)) {
+              processChunk(i);
+              hasClaimed = true;
+            }
+          }
+        }
+
+        // wait for chunks processed by workers (and for jobs to be released)
+        std::unique_lock<std::mutex> guard(this->_lock);
+        while (this->_pendingJobs != 0u)
+          this->_condition.wait(guard);
+        guard.unlock();
+        if (this->_error)
+          std::rethrow_exception(this->_error);
+      }
+
+      /// @brief Try to reserve a dispatched chunk (can only succeed once per chunk)
+      inline bool claimChunk(uint32_t chunk) noexcept {
+        Chunk& data = this->_chunks[chunk];
+        return (data.isReady.load(std::memory_order_acquire) && !data.isClaimed.load(std::memory_order_relaxed)
+             && !data.isClaimed.exchange(true, std::memory_order_acq_rel));
+      }
+
+      /// @brief Process a claimed chunk: split it while possible (dispatch right halves), then process remaining left part
+      void processChunk(uint32_t chunk) noexcept {
+        Chunk& data = this->_chunks[chunk];
+        size_t begin = data.begin;
+        size_t end = data.end;
+        uint32_t depth = data.depth;
+
+        while (end - begin > this->_grainSize && depth < this->_maxDepth) {
+          uint32_t rightIndex = this->_chunkCount.fetch_add(1u, std::memory_order_acq_rel);
+          if (rightIndex >= maxChunks())
+            break;
+          size_t middle = begin + ((end - begin) >> 1);
+          ++depth;
+          Chunk& right = this->_chunks[rightIndex];
+          right.begin = middle;
+          right.end = end;
+          right.depth = depth;
+          right.isReady.store(true, std::memory_order_release);
+          end = middle;
+
+          { std::lock_guard<std::mutex> guard(this->_lock); ++(this->_pendingJobs); }
+          if (!this->_dispatch(this->_pool, ParallelJob{ this, rightIndex })) { // pool not running -> keep range
+            releaseJob();
+            if (claimChunk(rightIndex)) {
+              end = right.end;
+              right.end = right.begin; // empty chunk
+            }
+            break;
+          }
+        }
+        data.end = end;
+
+        if (!this->_hasFailed.load(std::memory_order_acquire)) {
+          try {
+            this->_runner(this->_operation, begin, end, chunk);
+          }
+          catch (...) {
+            std::lock_guard<std::mutex> guard(this->_lock);
+            if (!this->_error)
+              this->_error = std::current_exception();
+            this->_hasFailed.store(true, std::memory_order_release);
+          }
+        }
+      }
+
+      /// @brief Signal that a dispatched job has been processed (last access to the context by a worker)
+      inline void releaseJob() noexcept {
+        std::lock_guard<std::mutex> guard(this->_lock);
+        if (--(this->_pendingJobs) == 0u)
+          this->_condition.notify_all();
+      }
+
+    private:
+      struct Chunk final {
+        size_t begin = 0;
+        size_t end = 0;
+        uint32_t depth = 0;
+        std::atomic<bool> isReady{ false };
+        std::atomic<bool> isClaimed{ false };
+      };
+
+      Chunk _chunks[__P_PARALLEL_MAX_CHUNKS];
+      std::atomic<uint32_t> _chunkCount{ 0 };
+      uint32_t _maxDepth = 2u;
+
+      void* _operation;
+      range_runner _runner;
+      void* _pool;
+      dispatcher _dispatch;
+      size_t _grainSize;
+
+      std::atomic<bool> _hasFailed{ false };
+      std::exception_ptr _error;
+      uint32_t _pendingJobs = 0;
+      std::mutex _lock;
+      std::condition_variable _condition;
+    };
+
+    inline void processParallelJob(ParallelJob& job) noexcept {
+      if (job.context->claimChunk(job.chunk))
+        job.context->processChunk(job.chunk);
+      job.context->releaseJob();
+    }
+
+    // -- parallel helpers --
+
+    namespace _parallel {
+      template <typename _PoolType>
+      inline bool dispatchToPool(void* pool, ParallelJob job) {
+        return static_cast<_PoolType*>(pool)->addJob(job);
+      }
+
+      template <typename _Operation>
+      inline void runForRange(void* operation, size_t begin, size_t end, uint32_t) {
+        _Operation& op = *static_cast<_Operation*>(operation);
+        for (size_t index = begin; index < end; ++index)
+          op(index);
+      }
+
+      template <typename _ValueType, typename _Operation, typename _Reduction>
+      struct ReduceOperation final {
+        _Operation& operation;
+        _Reduction& reduction;
+        std::vector<_ValueType>& partialResults;
+
+        static void runRange(void* reduceOp, size_t begin, size_t end, uint32_t chunk) {
+          ReduceOperation& op = *static_cast<ReduceOperation*>(reduceOp);
+          _ValueType result = std::move(op.partialResults[chunk]);
+          for (size_t index = begin; index < end; ++index)
+            result = op.reduction(std::move(result), op.operation(index));
+          op.partialResults[chunk] = std::move(result);
+        }
+      };
+    }
+
+    /// @brief Call 'operation(index)' for each index in [begin; end[, using pool workers and current thread
+    /// @param grainSize  Minimum number of indexes per chunk (ranges smaller than this value are processed serially)
+    /// @remarks The order in which indexes are processed is not guaranteed.
+    ///          If the pool isn't running, the whole range is processed by current thread.
+    /// @throws First exception thrown by 'operation' (other chunks are skipped)
+    /// @warning Must not be called by a worker of the same pool, unless the pool has other free threads.
+    template <typename _PoolType, typename _Operation>
+    inline void parallelFor(_PoolType& pool, size_t begin, size_t end, _Operation&& operation, size_t grainSize = 1u) {
+      if (end <= begin)
+        return;
+      if (end - begin <= grainSize || pool.size() == 0) { // serial
+        for (size_t index = begin; index < end; ++index)
+          operation(index);
+        return;
+      }
+
+      using operation_type = typename std::remove_reference<_Operation>::type;
+      ParallelContext context(const_cast<void*>(static_cast<const void*>(&operation)), &_parallel::runForRange<operation_type>,
+                              static_cast<void*>(&pool), &_parallel::dispatchToPool<_PoolType>, pool.size(), grainSize);
+      context.run(begin, end);
+    }
+
+    /// @brief Compute 'operation(index)' for each index in [begin; end[ and combine results: 'reduction(reduction(identity, op(begin)), ...)'
+    /// @param identity   Initial value of each partial result (neutral value for 'reduction', ex: 0 for a sum)
+    /// @param grainSize  Minimum number of indexes per chunk (ranges smaller than this value are processed serially)
+    /// @remarks 'reduction' must be associative (not necessarily commutative: partial results are combined in index order).
+    /// @throws First exception thrown by 'operation' or 'reduction'
+    template <typename _PoolType, typename _ValueType, typename _Operation, typename _Reduction>
+    inline _ValueType parallelReduce(_PoolType& pool, size_t begin, size_t end, _ValueType identity,
+                                     _Operation&& operation, _Reduction&& reduction, size_t grainSize = 1u) {
+      if (end <= begin)
+        return identity;
+      if (end - begin <= grainSize || pool.size() == 0) { // serial
+        _ValueType result = std::move(identity);
+        for (size_t index = begin; index < end; ++index)
+          result = reduction(std::move(result), operation(index));
+        return result;
+      }
+
+      using operation_type = typename std::remove_reference<_Operation>::type;
+      using reduction_type = typename std::remove_reference<_Reduction>::type;
+      using reduce_type = _parallel::ReduceOperation<_ValueType, operation_type, reduction_type>;
+      std::vector<_ValueType> partialResults;
+      reduce_type reduceOp{ operation, reduction, partialResults };
+      ParallelContext context(static_cast<void*>(&reduceOp), &reduce_type::runRange,
+                              static_cast<void*>(&pool), &_parallel::dispatchToPool<_PoolType>, pool.size(), grainSize);
+      partialResults.assign(context.maxChunks(), identity);
+      context.run(begin, end);
+
+      // combine partial results in index order
+      uint32_t chunkCount = context.chunkCount();
+      uint32_t chunkOrder[__P_PARALLEL_MAX_CHUNKS];
+      for (uint32_t i = 0; i < chunkCount; ++i)
+        chunkOrder[i] = i;
+      std::sort(&chunkOrder[0], &chunkOrder[chunkCount], [&context](uint32_t lhs, uint32_t rhs) {
+        return context.chunkBegin(lhs) < context.chunkBegin(rhs);
+      });
+      _ValueType result = std::move(identity);
+      for (uint32_t i = 0; i < chunkCount; ++i)
+        result = reduction(std::move(result), std::move(partialResults[chunkOrder[i]]));
+      return result;
+    }
+
+    /// @brief Write 'operation(*it)' in output range for each value of input range [first; last[
+    /// @remarks Input/output iterators must be random-access iterators. Output range must be big enough (no insertion).
+    /// @returns Output iterator after last written value
+    /// @throws First exception thrown by 'operation'
+    template <typename _PoolType, typename _InputIterator, typename _OutputIterator, typename _Operation>
+    inline _OutputIterator parallelTransform(_PoolType& pool, _InputIterator first, _InputIterator last,
+                                             _OutputIterator outFirst, _Operation&& operation, size_t grainSize = 1u) {
+      size_t length = static_cast<size_t>(std::distance(first, last));
+      parallelFor(pool, 0, length, [&first, &outFirst, &operation](size_t index) {
+        outFirst[index] = operation(first[index]);
+      }, grainSize);
+      return outFirst + length;
+    }
+
+  }
+}
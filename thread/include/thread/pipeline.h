@@ -0,0 +1,748 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <type_traits>
+#include <system/trace.h>
+#include "./lock_free_queue.h"
+
+namespace pandora {
+  namespace thread {
+    /// @brief Order of the items received by the output function of a pipeline
+    enum class PipelineOrder : uint32_t {
+      unordered = 0, ///< Items are output as soon as they're processed by the last stage (fastest)
+      ordered = 1    ///< Items are output in the order of their insertion in the pipeline (reorder buffer before output)
+    };
+
+    /// @brief Settings of a pipeline (shared by all its stages)
+    struct PipelineOptions final {
+      size_t queueCapacity = 64u; ///< Max number of batches in each queue between stages (rounded up to next power of 2)
+      size_t batchSize = 16u;     ///< Max number of items processed together by a worker (and forwarded together to next stage)
+      PipelineOrder order = PipelineOrder::unordered; ///< Output order
+    };
+
+    /// @brief Metrics of a pipeline stage at a specific time (durations in nanoseconds)
+    struct PipelineStageMetrics final {
+      std::string name;          ///< Name of the stage (output stage: "output")
+      uint32_t parallelism = 0;  ///< Number of worker threads of the stage
+      uint64_t itemCount = 0;    ///< Number of items processed
+      uint64_t errorCount = 0;   ///< Number of items dropped because the stage function threw an exception
+      uint64_t busyTime = 0;     ///< Time spent processing items (sum of all workers)
+      uint64_t blockedTime = 0;  ///< Time spent waiting for space in the queue of the next stage (backpressure from downstream)
+      uint64_t elapsedTime = 0;  ///< Time since pipeline start
+      size_t queueDepth = 0;     ///< Number of items currently waiting in the input queue of the stage
+      size_t queueHighWater = 0; ///< Highest number of items waiting in the input queue of the stage
+
+      /// @brief Processed items per second
+      inline double throughput() const noexcept {
+        return (this->elapsedTime != 0) ? static_cast<double>(this->itemCount) * 1000000000.0 / static_cast<double>(this->elapsedTime) : 0.0;
+      }
+      /// @brief Busy time / available worker time (0.0 - 1.0): stage with the highest value is the bottleneck
+      inline double utilization() const noexcept {
+        return (this->elapsedTime != 0 && this->parallelism != 0)
+              ? static_cast<double>(this->busyTime) / (static_cast<double>(this->elapsedTime) * static_cast<double>(this->parallelism))
+              : 0.0;
+      }
+    };
+
+    // ---
+
+    /// @brief Group of items transferred between pipeline stages
+    /// @warning Internal type: only used by Pipeline.
+    template <typename _ItemType>
+    struct PipelineBatch final {
+      std::vector<_ItemType> items;
+      std::vector<uint64_t> sequences; ///< Insertion order of each item ('ordered' mode only)
+      std::vector<uint64_t> skipped;   ///< Insertion order of dropped items ('ordered' mode only: gaps for the reorder buffer)
+
+      inline bool empty() const noexcept { return (this->items.empty() && this->skipped.empty()); }
+      /// @brief Move all items of another batch at the end of current batch
+      void append(PipelineBatch& rhs) {
+        this->items.insert(this->items.end(), std::make_move_iterator(rhs.items.begin()), std::make_move_iterator(rhs.items.end()));
+        this->sequences.insert(this->sequences.end(), rhs.sequences.begin(), rhs.sequences.end());
+        this->skipped.insert(this->skipped.end(), rhs.skipped.begin(), rhs.skipped.end());
+      }
+    };
+
+    /// @class PipelineChannel
+    /// @brief Bounded queue of batches between two pipeline stages (lock-free queue + sleeping consumers/blocked producers).
+    /// @description - Producers are blocked when the queue is full (backpressure).
+    ///              - Consumers sleep when the queue is empty, until new batches are inserted or until the channel is closed.
+    /// @warning Internal type: only used by Pipeline.
+    template <typename _ItemType>
+    class PipelineChannel final {
+    public:
+      using Batch = PipelineBatch<_ItemType>;
+
+      explicit PipelineChannel(size_t capacity) : _queue(capacity) {}
+      PipelineChannel(const PipelineChannel&) = delete;
+      PipelineChannel(PipelineChannel&&) = delete;
+      PipelineChannel& operator=(const PipelineChannel&) = delete;
+      PipelineChannel& operator=(PipelineChannel&&) = delete;
+
+      inline size_t depth() const noexcept { return this->_depth.load(std::memory_order_relaxed); } ///< Number of items in queue
+      inline size_t highWater() const noexcept { return this->_highWater.load(std::memory_order_relaxed); } ///< Highest number of items
+      inline bool isClosed() const noexcept { return this->_isClosed.load(std::memory_order_acquire); }
+
+      // -- producer side --
+
+      /// @brief Insert a batch (if not full)
+      /// @returns True on success, false if full, closed or cancelled (batch not consumed)
+      bool tryPush(Batch&& batch) {
+        if (this->_isClosed.load(std::memory_order_acquire) || !_insert(batch))
+          return false;
+        _notifyConsumers();
+        return true;
+      }
+      /// @brief Insert a batch (wait while the queue is full)
+      /// @param outBlockedTime  Incremented with the waiting duration (nanoseconds) if the queue is full.
+      /// @returns True on success, false if closed or cancelled (batch not consumed)
+      bool push(Batch&& batch, uint64_t& outBlockedTime) {
+        if (this->_isClosed.load(std::memory_order_acquire))
+          return false;
+        if (!_insert(batch)) { // full queue -> wait for consumers
+          auto waitStart = std::chrono::steady_clock::now();
+          std::unique_lock<std::mutex> guard(this->_lock);
+          this->_waitingProducers.fetch_add(1u, std::memory_order_relaxed);
+          std::atomic_thread_fence(std::memory_order_seq_cst); // waiting producer visible before retrying (see _notifyProducers)
+
+          bool isSuccess = false;
+          while (!this->_isClosed.load(std::memory_order_acquire)) {
+            if (_insert(batch)) {
+              isSuccess = true;
+              break;
+            }
+            this->_producerCondition.wait(guard);
+          }
+          this->_waitingProducers.fetch_sub(1u, std::memory_order_relaxed);
+          guard.unlock();
+          outBlockedTime += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - waitStart).count());
+          if (!isSuccess)
+            return false;
+        }
+        _notifyConsumers();
+        return true;
+      }
+      /// @brief Close channel (no more insertions): consumers stop when the remaining batches have been extracted
+      void close() noexcept {
+        { std::lock_guard<std::mutex> guard(this->_lock);
+          this->_isClosed.store(true, std::memory_order_release); }
+        this->_condition.notify_all();
+        this->_producerCondition.notify_all();
+      }
+      /// @brief Close channel and remove all remaining batches
+      void cancel() noexcept {
+        { std::lock_guard<std::mutex> guard(this->_lock);
+          this->_isClosed.store(true, std::memory_order_release);
+          this->_isCancelled.store(true, std::memory_order_release); }
+        this->_queue.clear();
+        this->_depth.store(0, std::memory_order_relaxed);
+        this->_condition.notify_all();
+        this->_producerCondition.notify_all();
+      }
+
+      // -- consumer side --
+
+      /// @brief Extract a batch (if not empty)
+      bool tryPop(Batch& outBatch) {
+        if (this->_isCancelled.load(std::memory_order_acquire)
+        || !this->_queue.consume([&outBatch](Batch&& batch) { outBatch = std::move(batch); }))
+          return false;
+        this->_depth.fetch_sub(outBatch.items.size(), std::memory_order_relaxed);
+        _notifyProducers();
+        return true;
+      }
+      /// @brief Extract a batch (wait while the queue is empty)
+      /// @returns True on success, false if the channel is closed and empty (or cancelled)
+      bool pop(Batch& outBatch) {
+        for (;;) {
+          if (tryPop(outBatch))
+            return true;
+          if (this->_isCancelled.load(std::memory_order_acquire))
+            return false;
+          if (!this->_queue.empty()) { // batch reserved but not published yet -> retry
+            std::this_thread::yield();
+            continue;
+          }
+
+          std::unique_lock<std::mutex> guard(this->_lock);
+          this->_sleepingConsumers.fetch_add(1u, std::memory_order_relaxed);
+          std::atomic_thread_fence(std::memory_order_seq_cst); // sleeping consumer visible before checking queue (see _notifyConsumers)
+          while (!this->_isClosed.load(std::memory_order_acquire) && this->_queue.empty())
+            this->_condition.wait(guard);
+          this->_sleepingConsumers.fetch_sub(1u, std::memory_order_relaxed);
+          if (this->_isClosed.load(std::memory_order_acquire) && this->_queue.empty())
+            return false;
+        }
+      }
+
+    private:
+      // insert batch in queue + update depth
+      bool _insert(Batch& batch) {
+        size_t itemCount = batch.items.size();
+        size_t depth = this->_depth.fetch_add(itemCount, std::memory_order_relaxed) + itemCount;
+        if (!this->_queue.push(std::move(batch))) {
+          this->_depth.fetch_sub(itemCount, std::memory_order_relaxed);
+          return false;
+        }
+        size_t highWater = this->_highWater.load(std::memory_order_relaxed);
+        while (depth > highWater && !this->_highWater.compare_exchange_weak(highWater, depth, std::memory_order_relaxed)) {}
+        return true;
+      }
+      // awake a sleeping consumer after inserting a batch
+      inline void _notifyConsumers() noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst); // insertion visible before reading sleeping consumers (see pop)
+        if (this->_sleepingConsumers.load(std::memory_order_relaxed) > 0) {
+          { std::lock_guard<std::mutex> guard(this->_lock); } // ensure that sleeping candidate is already waiting
+          this->_condition.notify_one();
+        }
+      }
+      // awake blocked producers after extracting a batch
+      inline void _notifyProducers() noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst); // extraction visible before reading waiting producers (see push)
+        if (this->_waitingProducers.load(std::memory_order_relaxed) > 0) {
+          { std::lock_guard<std::mutex> guard(this->_lock); }
+          this->_producerCondition.notify_all();
+        }
+      }
+
+    private:
+      LockFreeQueue<Batch> _queue;
+      std::atomic<size_t> _depth{ 0 };
+      std::atomic<size_t> _highWater{ 0 };
+      std::atomic<bool> _isClosed{ false };
+      std::atomic<bool> _isCancelled{ false };
+      std::atomic<uint32_t> _sleepingConsumers{ 0 };
+      std::atomic<uint32_t> _waitingProducers{ 0 };
+      std::mutex _lock;
+      std::condition_variable _condition;         // signal for sleeping consumers (new batch / closed)
+      std::condition_variable _producerCondition; // signal for blocked producers (batch extracted / closed)
+    };
+
+    // ---
+
+    /// @class PipelineStageBase
+    /// @brief Common part of pipeline stages: worker threads and metrics counters
+    /// @warning Internal type: only used by Pipeline.
+    class PipelineStageBase {
+    public:
+      PipelineStageBase(std::string name, uint32_t parallelism, const PipelineOptions& options)
+        : _name(std::move(name)), _parallelism((parallelism > 0) ? parallelism : 1u), _options(options) {}
+      virtual ~PipelineStageBase() noexcept = default;
+      PipelineStageBase(const PipelineStageBase&) = delete;
+      PipelineStageBase& operator=(const PipelineStageBase&) = delete;
+
+      /// @brief Start worker threads
+      void start(std::chrono::steady_clock::time_point startTime) {
+        this->_startTime = startTime;
+        this->_activeWorkers.store(this->_parallelism, std::memory_order_release);
+        this->_threads.reserve(this->_parallelism);
+        for (uint32_t i = 0; i < this->_parallelism; ++i)
+          this->_threads.emplace_back(&PipelineStageBase::_runWorker, this);
+      }
+      /// @brief Wait for worker threads to stop (after input closed or cancelled)
+      void join() noexcept {
+        for (auto& item : this->_threads) {
+          if (item.joinable()) {
+            try {
+              item.join();
+            }
+            catch (const std::exception& __DEBUG_ARG__(exc)) {
+              TRACE_N("Pipeline: thread join exception: %s", exc.what());
+              try { item.detach(); } catch (const std::exception&) {}
+            }
+          }
+        }
+        this->_threads.clear();
+      }
+      /// @brief Stop processing and drop queued items
+      virtual void cancel() noexcept = 0;
+
+      /// @brief Get current metrics of the stage
+      PipelineStageMetrics metrics() const {
+        PipelineStageMetrics result;
+        result.name = this->_name;
+        result.parallelism = this->_parallelism;
+        result.itemCount = this->_itemCount.load(std::memory_order_relaxed);
+        result.errorCount = this->_errorCount.load(std::memory_order_relaxed);
+        result.busyTime = this->_busyTime.load(std::memory_order_relaxed);
+        result.blockedTime = this->_blockedTime.load(std::memory_order_relaxed);
+        result.elapsedTime = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                   std::chrono::steady_clock::now() - this->_startTime).count());
+        _readQueueMetrics(result.queueDepth, result.queueHighWater);
+        return result;
+      }
+
+    protected:
+      virtual void _process() = 0; // worker loop (until input closed and empty)
+      virtual void _onWorkersStopped() noexcept {}
+      virtual void _readQueueMetrics(size_t& outDepth, size_t& outHighWater) const noexcept = 0;
+
+      inline void _addMetrics(size_t itemCount, std::chrono::steady_clock::time_point processingStart, uint64_t blockedTime) noexcept {
+        this->_itemCount.fetch_add(itemCount, std::memory_order_relaxed);
+        this->_busyTime.fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                  std::chrono::steady_clock::now() - processingStart).count()), std::memory_order_relaxed);
+        if (blockedTime != 0)
+          this->_blockedTime.fetch_add(blockedTime, std::memory_order_relaxed);
+      }
+      inline void _addError() noexcept { this->_errorCount.fetch_add(1u, std::memory_order_relaxed); }
+
+    private:
+      void _runWorker() noexcept {
+        TRACE_N("Pipeline: stage '%s' worker started", this->_name.c_str());
+        try {
+          _process();
+        }
+        catch (...) { TRACE("Pipeline: worker failure"); }
+        if (this->_activeWorkers.fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+          _onWorkersStopped(); // last worker -> close output
+        TRACE_N("Pipeline: stage '%s' worker stopped", this->_name.c_str());
+      }
+
+    protected:
+      const std::string _name;
+      const uint32_t _parallelism;
+      const PipelineOptions _options;
+    private:
+      std::vector<std::thread> _threads;
+      std::atomic<uint32_t> _activeWorkers{ 0 };
+      std::chrono::steady_clock::time_point _startTime;
+      std::atomic<uint64_t> _itemCount{ 0 };
+      std::atomic<uint64_t> _errorCount{ 0 };
+      std::atomic<uint64_t> _busyTime{ 0 };
+      std::atomic<uint64_t> _blockedTime{ 0 };
+    };
+
+    /// @class PipelineStage
+    /// @brief Pipeline stage: transforms items of its input queue, and forwards the results to its output queue
+    /// @warning Internal type: only used by Pipeline.
+    template <typename _InputType, typename _OutputType>
+    class PipelineStage final : public PipelineStageBase {
+    public:
+      using operation_type = std::function<_OutputType(_InputType&&)>;
+
+      PipelineStage(std::string name, uint32_t parallelism, operation_type operation,
+                    PipelineChannel<_InputType>& input, const PipelineOptions& options)
+        : PipelineStageBase(std::move(name), parallelism, options),
+          _operation(std::move(operation)), _input(input), _output(options.queueCapacity) {}
+
+      inline PipelineChannel<_OutputType>& output() noexcept { return this->_output; }
+
+      void cancel() noexcept override {
+        this->_input.cancel();
+        this->_output.cancel();
+      }
+
+    protected:
+      void _process() override {
+        const bool isOrdered = (this->_options.order == PipelineOrder::ordered);
+        PipelineBatch<_InputType> batch, nextBatch;
+        while (this->_input.pop(batch)) {
+          while (batch.items.size() < this->_options.batchSize && this->_input.tryPop(nextBatch)) // merge small batches
+            batch.append(nextBatch);
+
+          auto processingStart = std::chrono::steady_clock::now();
+          PipelineBatch<_OutputType> results;
+          results.items.reserve(batch.items.size());
+          results.skipped = std::move(batch.skipped);
+          if (isOrdered)
+            results.sequences.reserve(batch.items.size());
+
+          for (size_t i = 0; i < batch.items.size(); ++i) {
+            try {
+              results.items.emplace_back(this->_operation(std::move(batch.items[i])));
+              if (isOrdered)
+                results.sequences.emplace_back(batch.sequences[i]);
+            }
+            catch (const std::exception& __DEBUG_ARG__(exc)) {
+              TRACE_N("Pipeline: exception in stage '%s': %s", this->_name.c_str(), exc.what());
+              _onError(results, batch, i, isOrdered);
+            }
+            catch (...) {
+              TRACE_N("Pipeline: unknown exception type thrown in stage '%s'", this->_name.c_str());
+              _onError(results, batch, i, isOrdered);
+            }
+          }
+          size_t itemCount = batch.items.size();
+          batch.items.clear();
+          batch.sequences.clear();
+          batch.skipped.clear();
+
+          uint64_t blockedTime = 0;
+          if (!results.empty() && !this->_output.push(std::move(results), blockedTime)) {
+            _addMetrics(itemCount, processingStart, blockedTime);
+            break; // cancelled
+          }
+          _addMetrics(itemCount, processingStart, blockedTime);
+        }
+      }
+      void _onWorkersStopped() noexcept override { this->_output.close(); }
+      void _readQueueMetrics(size_t& outDepth, size_t& outHighWater) const noexcept override {
+        outDepth = this->_input.depth();
+        outHighWater = this->_input.highWater();
+      }
+
+    private:
+      inline void _onError(PipelineBatch<_OutputType>& results, const PipelineBatch<_InputType>& batch, size_t index, bool isOrdered) {
+        _addError();
+        if (isOrdered)
+          results.skipped.emplace_back(batch.sequences[index]); // gap for reorder buffer
+      }
+
+    private:
+      operation_type _operation;
+      PipelineChannel<_InputType>& _input;
+      PipelineChannel<_OutputType> _output;
+    };
+
+    /// @class PipelineOutputStage
+    /// @brief Last pipeline stage: provides processed items to the output function (single thread: calls are never concurrent)
+    /// @warning Internal type: only used by Pipeline.
+    template <typename _ItemType>
+    class PipelineOutputStage final : public PipelineStageBase {
+    public:
+      using output_type = std::function<void(_ItemType&&)>;
+
+      PipelineOutputStage(output_type output, PipelineChannel<_ItemType>& input, const PipelineOptions& options)
+        : PipelineStageBase("output", 1u, options), _output(std::move(output)), _input(input) {}
+
+      void cancel() noexcept override { this->_input.cancel(); }
+
+    protected:
+      void _process() override {
+        const bool isOrdered = (this->_options.order == PipelineOrder::ordered);
+        PipelineBatch<_ItemType> batch;
+        while (this->_input.pop(batch)) {
+          auto processingStart = std::chrono::steady_clock::now();
+          if (isOrdered) {
+            for (auto sequence : batch.skipped)
+              this->_skipped.insert(sequence);
+            for (size_t i = 0; i < batch.items.size(); ++i) {
+              if (batch.sequences[i] == this->_nextSequence) { // expected item -> no buffering
+                _sendItem(std::move(batch.items[i]));
+                ++(this->_nextSequence);
+              }
+              else
+                this->_reorderBuffer.emplace(batch.sequences[i], std::move(batch.items[i]));
+            }
+            _flushReorderBuffer();
+          }
+          else {
+            for (auto& item : batch.items)
+              _sendItem(std::move(item));
+          }
+          _addMetrics(batch.items.size(), processingStart, 0);
+        }
+      }
+      void _readQueueMetrics(size_t& outDepth, size_t& outHighWater) const noexcept override {
+        outDepth = this->_input.depth();
+        outHighWater = this->_input.highWater();
+      }
+
+    private:
+      inline void _sendItem(_ItemType&& item) {
+        try {
+          this->_output(std::move(item));
+        }
+        catch (const std::exception& __DEBUG_ARG__(exc)) { _addError(); TRACE_N("Pipeline: exception in output: %s", exc.what()); }
+        catch (...) { _addError(); TRACE("Pipeline: unknown exception type thrown in output"); }
+      }
+      // send buffered items that are now in order
+      void _flushReorderBuffer() {
+        for (;;) {
+          auto skippedIt = this->_skipped.find(this->_nextSequence);
+          if (skippedIt != this->_skipped.end()) {
+            this->_skipped.erase(skippedIt);
+            ++(this->_nextSequence);
+            continue;
+          }
+          auto it = this->_reorderBuffer.find(this->_nextSequence);
+          if (it == this->_reorderBuffer.end())
+            break;
+          _sendItem(std::move(it->second));
+          this->_reorderBuffer.erase(it);
+          ++(this->_nextSequence);
+        }
+      }
+
+    private:
+      output_type _output;
+      PipelineChannel<_ItemType>& _input;
+      uint64_t _nextSequence = 0;                  // 'ordered' mode: next item to output
+      std::map<uint64_t, _ItemType> _reorderBuffer; // 'ordered' mode: items received before their predecessors
+      std::set<uint64_t> _skipped;                  // 'ordered' mode: dropped items
+    };
+
+    // ---
+
+    /// @class Pipeline
+    /// @brief Running streaming pipeline: items inserted with push() go through all stages, then to the output function.
+    /// @description Each stage has its own worker threads (parallelism) and its own bounded lock-free input queue:
+    ///              - when a queue is full, the previous stage (or push()) waits: backpressure, memory use stays bounded;
+    ///              - items are transferred in batches (see PipelineOptions::batchSize) to reduce queue operations and wake-ups;
+    ///              - in 'ordered' mode, outputs are reordered to match the insertion order (even with parallel stages).
+    ///              Per-stage metrics (throughput, utilization, queue depth) show the bottleneck stage.
+    ///              Created with PipelineBuilder:
+    ///              'auto pipeline = PipelineBuilder<Input>(options).addStage("decode", 2, decodeFunc).addStage("transform", 4, transformFunc).build(writeFunc);'
+    /// @remarks - If a stage function throws, the item is dropped (see PipelineStageMetrics::errorCount).
+    ///          - Destroying the pipeline closes its input and waits until all pending items are processed (use cancel() to drop them).
+    /// @warning - Stage functions may be called simultaneously by the workers of the stage (if parallelism > 1).
+    ///          - push() must not be called from a stage function or from the output function (deadlock if a queue is full).
+    template <typename _InputType>
+    class Pipeline final {
+    public:
+      using Type = Pipeline<_InputType>;
+      using input_type = _InputType;
+      using Batch = PipelineBatch<_InputType>;
+
+      /// @brief Create empty pipeline (not running)
+      Pipeline() = default;
+      /// @brief Close input and wait for all items to be processed
+      ~Pipeline() noexcept {
+        if (this->_input != nullptr) {
+          close();
+          join();
+        }
+      }
+      Pipeline(const Type&) = delete;
+      Type& operator=(const Type&) = delete;
+      Pipeline(Type&&) noexcept = default;
+      Type& operator=(Type&& rhs) noexcept {
+        if (this->_input != nullptr) {
+          close();
+          join();
+        }
+        this->_options = rhs._options;
+        this->_input = std::move(rhs._input);
+        this->_stages = std::move(rhs._stages);
+        this->_inputState = std::move(rhs._inputState);
+        return *this;
+      }
+
+      // -- getters --
+
+      inline bool isRunning() const noexcept { return (this->_input != nullptr && !this->_input->isClosed()); } ///< Input not closed
+      inline size_t stageCount() const noexcept { return this->_stages.size(); } ///< Number of stages (including output stage)
+      inline const PipelineOptions& options() const noexcept { return this->_options; }
+
+      /// @brief Get current metrics of all stages (last stage: output function)
+      std::vector<PipelineStageMetrics> metrics() const {
+        std::vector<PipelineStageMetrics> results;
+        results.reserve(this->_stages.size());
+        for (const auto& stage : this->_stages)
+          results.emplace_back(stage->metrics());
+        return results;
+      }
+      /// @brief Find the bottleneck: index of the stage with the highest utilization
+      size_t bottleneckStage() const {
+        size_t bottleneck = 0;
+        double maxUtilization = -1.0;
+        for (size_t i = 0; i < this->_stages.size(); ++i) {
+          double utilization = this->_stages[i]->metrics().utilization();
+          if (utilization > maxUtilization) {
+            maxUtilization = utilization;
+            bottleneck = i;
+          }
+        }
+        return bottleneck;
+      }
+
+      // -- operations --
+
+      /// @brief Insert an item (wait while the input queue is full)
+      /// @returns True on success, false if the pipeline input is closed (or if not running)
+      inline bool push(_InputType&& item) { return _pushBatch(_toBatch(std::move(item)), true); }
+      /// @brief Insert an item (copied) (wait while the input queue is full)
+      /// @returns True on success, false if the pipeline input is closed (or if not running)
+      inline bool push(const _InputType& item) { return _pushBatch(_toBatch(_InputType(item)), true); }
+      /// @brief Insert an item if the input queue isn't full
+      /// @returns True on success, false if the queue is full or if the pipeline input is closed
+      inline bool tryPush(_InputType&& item) { return _pushBatch(_toBatch(std::move(item)), false); }
+
+      /// @brief Insert multiple items (copied) - grouped in batches (wait while the input queue is full)
+      /// @returns Number of items inserted (less than the number of items if the pipeline input is closed)
+      template <typename _Iterator>
+      size_t push(_Iterator first, _Iterator last) {
+        size_t insertedCount = 0;
+        while (first != last) {
+          Batch batch;
+          batch.items.reserve(this->_options.batchSize);
+          for (; first != last && batch.items.size() < this->_options.batchSize; ++first)
+            batch.items.emplace_back(*first);
+          size_t batchSize = batch.items.size();
+          if (!_pushBatch(std::move(batch), true))
+            break;
+          insertedCount += batchSize;
+        }
+        return insertedCount;
+      }
+
+      /// @brief Close pipeline input (no more insertions): stages stop when all pending items have been processed
+      inline void close() noexcept {
+        if (this->_input != nullptr)
+          this->_input->close();
+      }
+      /// @brief Wait until all stages are stopped (input closed + all items processed, or cancelled)
+      /// @warning Blocks forever if the input is never closed. Must not be called from a stage/output function.
+      void join() noexcept {
+        for (auto& stage : this->_stages)
+          stage->join();
+      }
+      /// @brief Close input, drop all pending items and stop all stages (items currently being processed are completed)
+      void cancel() noexcept {
+        if (this->_input != nullptr)
+          this->_input->cancel();
+        for (auto& stage : this->_stages)
+          stage->cancel();
+        join();
+      }
+
+    private:
+      template <typename, typename> friend class PipelineBuilder;
+      struct InputState { // sequence numbers of inserted items ('ordered' mode)
+        std::mutex lock;
+        uint64_t nextSequence = 0;
+      };
+
+      Pipeline(const PipelineOptions& options, std::unique_ptr<PipelineChannel<_InputType> > input,
+               std::vector<std::unique_ptr<PipelineStageBase> > stages)
+        : _options(options), _input(std::move(input)), _stages(std::move(stages)), _inputState(new InputState()) {
+        auto startTime = std::chrono::steady_clock::now();
+        for (auto& stage : this->_stages)
+          stage->start(startTime);
+      }
+
+      static inline Batch _toBatch(_InputType&& item) {
+        Batch batch;
+        batch.items.emplace_back(std::move(item));
+        return batch;
+      }
+      bool _pushBatch(Batch&& batch, bool isWaiting) {
+        if (this->_input == nullptr)
+          return false;
+        uint64_t blockedTime = 0;
+        if (this->_options.order == PipelineOrder::ordered) { // only consume sequence numbers on success (no gap)
+          std::lock_guard<std::mutex> guard(this->_inputState->lock);
+          for (size_t i = 0; i < batch.items.size(); ++i)
+            batch.sequences.emplace_back(this->_inputState->nextSequence + i);
+          size_t itemCount = batch.items.size();
+          if (!(isWaiting ? this->_input->push(std::move(batch), blockedTime) : this->_input->tryPush(std::move(batch))))
+            return false;
+          this->_inputState->nextSequence += itemCount;
+          return true;
+        }
+        return isWaiting ? this->_input->push(std::move(batch), blockedTime) : this->_input->tryPush(std::move(batch));
+      }
+
+    private:
+      PipelineOptions _options;
+      std::unique_ptr<PipelineChannel<_InputType> > _input = nullptr;
+      std::vector<std::unique_ptr<PipelineStageBase> > _stages;
+      std::unique_ptr<InputState> _inputState = nullptr;
+    };
+
+    // ---
+
+    /// @class PipelineBuilder
+    /// @brief Typed builder of pipelines: each stage receives the output type of the previous stage
+    /// @description 'PipelineBuilder<In>(options).addStage("name", parallelism, [](In&& item) -> Out {...}).[...].build(outputFunction)'
+    ///              - addStage: add a stage with a transform function ('_Result operation(_CurrentType&&)') and a number of worker threads;
+    ///              - build: set output function ('void output(_CurrentType&&)') and start the pipeline.
+    /// @remarks The builder is consumed by each call (use it as a temporary, or with std::move).
+    template <typename _InputType, typename _CurrentType = _InputType>
+    class PipelineBuilder final {
+    public:
+      /// @brief Create builder with pipeline settings
+      explicit PipelineBuilder(const PipelineOptions& options = PipelineOptions{})
+        : _options(options),
+          _input(new PipelineChannel<_InputType>(options.queueCapacity)) {
+        if (this->_options.batchSize == 0)
+          this->_options.batchSize = 1u;
+        this->_tail = _inputChannel(this->_input.get());
+      }
+      PipelineBuilder(const PipelineBuilder&) = delete;
+      PipelineBuilder(PipelineBuilder&&) noexcept = default;
+      PipelineBuilder& operator=(const PipelineBuilder&) = delete;
+      PipelineBuilder& operator=(PipelineBuilder&&) noexcept = default;
+
+      /// @brief Add a processing stage: 'operation' called by 'parallelism' worker threads for each item
+      /// @returns Builder for the next stages (input type: result type of 'operation')
+      template <typename _Operation,
+                typename _ResultType = typename std::decay<decltype(std::declval<_Operation&>()(std::declval<_CurrentType&&>()))>::type>
+      PipelineBuilder<_InputType, _ResultType> addStage(std::string name, uint32_t parallelism, _Operation operation) && {
+        std::unique_ptr<PipelineStage<_CurrentType, _ResultType> > stage(new PipelineStage<_CurrentType, _ResultType>(
+            std::move(name), parallelism, std::move(operation), _tailChannel(), this->_options));
+
+        PipelineBuilder<_InputType, _ResultType> next(this->_options, std::move(this->_input), std::move(this->_stages));
+        next._tail = &(stage->output());
+        next._stages.emplace_back(std::move(stage));
+        return next;
+      }
+
+      /// @brief Set output function (called by a single thread for each processed item) and start pipeline
+      /// @throws std::logic_error if the builder has already been consumed
+      Pipeline<_InputType> build(std::function<void(_CurrentType&&)> output) && {
+        if (this->_input == nullptr)
+          throw std::logic_error("PipelineBuilder: builder already consumed");
+        this->_stages.emplace_back(new PipelineOutputStage<_CurrentType>(std::move(output), _tailChannel(), this->_options));
+        return Pipeline<_InputType>(this->_options, std::move(this->_input), std::move(this->_stages));
+      }
+
+    private:
+      template <typename, typename> friend class PipelineBuilder;
+      PipelineBuilder(const PipelineOptions& options, std::unique_ptr<PipelineChannel<_InputType> >&& input,
+                      std::vector<std::unique_ptr<PipelineStageBase> >&& stages)
+        : _options(options), _input(std::move(input)), _stages(std::move(stages)) {}
+
+      inline PipelineChannel<_CurrentType>& _tailChannel() {
+        if (this->_tail == nullptr || this->_input == nullptr)
+          throw std::logic_error("PipelineBuilder: builder already consumed");
+        return *(this->_tail);
+      }
+      // input channel = tail of builder without stages (only if types match)
+      static inline PipelineChannel<_CurrentType>* _inputChannel(PipelineChannel<_CurrentType>* input) noexcept { return input; }
+      template <typename _ChannelType>
+      static inline PipelineChannel<_CurrentType>* _inputChannel(_ChannelType*) noexcept { return nullptr; }
+
+    private:
+      PipelineOptions _options;
+      std::unique_ptr<PipelineChannel<_InputType> > _input = nullptr;
+      std::vector<std::unique_ptr<PipelineStageBase> > _stages;
+      PipelineChannel<_CurrentType>* _tail = nullptr; // output channel of last stage (or input channel if no stage)
+    };
+
+  }
+}
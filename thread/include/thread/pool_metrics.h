@@ -0,0 +1,330 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
+
+namespace pandora {
+  namespace thread {
+    /// @class HistogramSnapshot
+    /// @brief Copy of the values of a LatencyHistogram at a specific time (durations in nanoseconds)
+    class HistogramSnapshot final {
+    public:
+      static constexpr uint32_t subBucketBits = 4u;                   ///< Linear sub-buckets per power of 2: 2^4 -> max relative error: 1/16
+      static constexpr uint32_t subBucketCount = (1u << subBucketBits);
+      static constexpr uint32_t maxValueBits = 48u;                    ///< Values above 2^48 ns (~78 hours) are stored in the last bucket
+      static constexpr uint32_t bucketCount = (maxValueBits - subBucketBits + 1u) * subBucketCount;
+
+      HistogramSnapshot() noexcept { this->_buckets.fill(0); }
+      HistogramSnapshot(const HistogramSnapshot&) = default;
+      HistogramSnapshot& operator=(const HistogramSnapshot&) = default;
+
+      inline uint64_t count() const noexcept { return this->_count; } ///< Number of recorded values
+      inline uint64_t sum() const noexcept { return this->_sum; }     ///< Sum of recorded values
+      inline uint64_t minimum() const noexcept { return (this->_count != 0) ? this->_min : 0; } ///< Lowest recorded value (exact)
+      inline uint64_t maximum() const noexcept { return this->_max; }     ///< Highest recorded value (exact)
+      /// @brief Average recorded value
+      inline uint64_t mean() const noexcept { return (this->_count != 0) ? this->_sum / this->_count : 0; }
+
+      /// @brief Estimate value at a percentile (0.0 - 100.0): upper bound of the bucket that contains the percentile
+      uint64_t percentile(double percent) const noexcept {
+        if (this->_count == 0)
+          return 0;
+        if (percent >= 100.0)
+          return this->_max;
+        uint64_t targetCount = static_cast<uint64_t>(static_cast<double>(this->_count) * ((percent > 0.0) ? percent : 0.0) / 100.0) + 1u;
+        uint64_t cumulatedCount = 0;
+        for (uint32_t i = 0; i < bucketCount; ++i) {
+          cumulatedCount += this->_buckets[i];
+          if (cumulatedCount >= targetCount) {
+            uint64_t upperBound = bucketLowerBound(i + 1u) - 1u;
+            return (upperBound < this->_max) ? upperBound : this->_max;
+          }
+        }
+        return this->_max;
+      }
+      /// @brief Number of values recorded in a bucket
+      inline uint64_t bucketValue(uint32_t index) const noexcept { return this->_buckets[index]; }
+
+      // -- bucket indexes --
+
+      /// @brief Find bucket index of a value (logarithmic buckets, with linear sub-buckets)
+      static inline uint32_t bucketIndex(uint64_t value) noexcept {
+        if (value < subBucketCount)
+          return static_cast<uint32_t>(value);
+        uint32_t highestBit = _highestBit(value);
+        if (highestBit >= maxValueBits)
+          return bucketCount - 1u;
+        uint32_t shift = highestBit - subBucketBits;
+        return (shift + 1u)*subBucketCount + static_cast<uint32_t>((value >> shift) & (subBucketCount - 1u));
+      }
+      /// @brief Lowest value stored in a bucket
+      static inline uint64_t bucketLowerBound(uint32_t index) noexcept {
+        if (index < subBucketCount)
+          return index;
+        uint32_t shift = index/subBucketCount - 1u;
+        return (static_cast<uint64_t>(subBucketCount + (index & (subBucketCount - 1u))) << shift);
+      }
+
+    private:
+      static inline uint32_t _highestBit(uint64_t value) noexcept {
+        uint32_t bit = 0;
+        for (uint32_t shift = 32u; shift != 0; shift >>= 1) {
+          if (value >> shift) {
+            value >>= shift;
+            bit += shift;
+          }
+        }
+        return bit;
+      }
+      friend class LatencyHistogram;
+
+    private:
+      std::array<uint64_t, bucketCount> _buckets;
+      uint64_t _count = 0;
+      uint64_t _sum = 0;
+      uint64_t _min = 0;
+      uint64_t _max = 0;
+    };
+
+    /// @class LatencyHistogram
+    /// @brief Lock-free histogram of durations (HDR-style: logarithmic buckets with linear sub-buckets, max relative error 1/16).
+    /// @description Values can be recorded simultaneously by any number of threads (relaxed atomic increments, no lock, no allocation).
+    ///              Statistics (percentiles, mean, maximum...) are read from a snapshot.
+    /// @remarks The instance is large (~6 KB): it should be allocated once per pool/component, not per job.
+    class LatencyHistogram final {
+    public:
+      LatencyHistogram() noexcept { reset(); }
+      LatencyHistogram(const LatencyHistogram&) = delete;
+      LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+      /// @brief Record a value (nanoseconds)
+      inline void record(uint64_t value) noexcept {
+        this->_buckets[HistogramSnapshot::bucketIndex(value)].fetch_add(1u, std::memory_order_relaxed);
+        this->_count.fetch_add(1u, std::memory_order_relaxed);
+        this->_sum.fetch_add(value, std::memory_order_relaxed);
+
+        uint64_t current = this->_min.load(std::memory_order_relaxed);
+        while (value < current && !this->_min.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+        current = this->_max.load(std::memory_order_relaxed);
+        while (value > current && !this->_max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+      }
+      /// @brief Record a duration
+      template <typename _RepetitionType, typename _PeriodType>
+      inline void record(const std::chrono::duration<_RepetitionType,_PeriodType>& duration) noexcept {
+        auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        record((nanoseconds > 0) ? static_cast<uint64_t>(nanoseconds) : 0);
+      }
+
+      /// @brief Copy current values (not a global atomic copy: values recorded during the copy may be partially included)
+      HistogramSnapshot snapshot() const noexcept {
+        HistogramSnapshot result;
+        for (uint32_t i = 0; i < HistogramSnapshot::bucketCount; ++i)
+          result._buckets[i] = this->_buckets[i].load(std::memory_order_relaxed);
+        result._count = this->_count.load(std::memory_order_relaxed);
+        result._sum = this->_sum.load(std::memory_order_relaxed);
+        result._min = this->_min.load(std::memory_order_relaxed);
+        result._max = this->_max.load(std::memory_order_relaxed);
+        return result;
+      }
+      /// @brief Remove all recorded values
+      void reset() noexcept {
+        for (auto& bucket : this->_buckets)
+          bucket.store(0, std::memory_order_relaxed);
+        this->_count.store(0, std::memory_order_relaxed);
+        this->_sum.store(0, std::memory_order_relaxed);
+        this->_min.store(UINT64_MAX, std::memory_order_relaxed);
+        this->_max.store(0, std::memory_order_relaxed);
+      }
+
+    private:
+      std::atomic<uint64_t> _buckets[HistogramSnapshot::bucketCount];
+      std::atomic<uint64_t> _count;
+      std::atomic<uint64_t> _sum;
+      std::atomic<uint64_t> _min;
+      std::atomic<uint64_t> _max;
+    };
+
+    // ---
+
+    /// @brief Metrics of a worker thread of a pool
+    struct WorkerMetricsSnapshot final {
+      uint64_t jobCount = 0;   ///< Number of processed jobs
+      uint64_t stealCount = 0; ///< Number of jobs stolen from other workers (work-stealing pools)
+      uint64_t busyTime = 0;   ///< Time spent processing jobs (nanoseconds)
+      double busyRatio = 0.0;  ///< Busy time / elapsed time (0.0 - 1.0)
+    };
+    /// @brief Metrics of a thread pool at a specific time
+    struct PoolMetricsSnapshot final {
+      HistogramSnapshot queueLatency;  ///< Duration between job insertion and job start (nanoseconds)
+      HistogramSnapshot runTime;       ///< Job processing duration (nanoseconds)
+      size_t queueDepthHighWater = 0;  ///< Highest number of pending jobs
+      uint64_t elapsedTime = 0;        ///< Time since pool start / last reset (nanoseconds)
+      std::vector<WorkerMetricsSnapshot> workers;
+
+      /// @brief Average busy ratio of all workers (0.0 - 1.0)
+      inline double utilization() const noexcept {
+        double total = 0.0;
+        for (const auto& worker : this->workers)
+          total += worker.busyRatio;
+        return (!this->workers.empty()) ? total / static_cast<double>(this->workers.size()) : 0.0;
+      }
+    };
+
+    // ---
+
+    /// @class NoPoolMetrics
+    /// @brief Disabled thread pool instrumentation (default metrics policy of thread pools): no data, no time measurement.
+    /// @description All hooks are empty inline functions: after optimization, a pool using NoPoolMetrics has no overhead.
+    class NoPoolMetrics final {
+    public:
+      static constexpr bool isEnabled = false;
+      struct JobStamp {};   ///< Data stored with each job (empty: no size overhead, as base class of jobs)
+      struct StartTime {};  ///< Job start time (empty)
+
+      inline void init(size_t) {}
+      inline void onEnqueue(JobStamp&, size_t) noexcept {}
+      inline StartTime onStart(const JobStamp&, uint32_t) noexcept { return StartTime{}; }
+      inline void onFinish(const StartTime&, uint32_t) noexcept {}
+      inline void onSteal(uint32_t) noexcept {}
+
+      /// @brief Get metrics snapshot (always empty)
+      inline PoolMetricsSnapshot snapshot() const { return PoolMetricsSnapshot{}; }
+      inline void reset() noexcept {}
+    };
+
+    /// @class PoolMetrics
+    /// @brief Thread pool instrumentation policy (template argument of thread pools): records job queue latency, run time,
+    ///        queue depth high-water mark, and per-worker job count / busy ratio / steal count.
+    /// @description All measurements are lock-free (relaxed atomics, LatencyHistogram): one clock read at insertion, start and end of each job.
+    ///              Read metrics with 'pool.metrics().snapshot()'.
+    class PoolMetrics final {
+    public:
+      using Clock = std::chrono::steady_clock;
+      static constexpr bool isEnabled = true;
+      struct JobStamp { Clock::time_point enqueueTime; };
+      using StartTime = Clock::time_point;
+
+      PoolMetrics() noexcept : _startTime(Clock::now().time_since_epoch().count()) {}
+      PoolMetrics(const PoolMetrics&) = delete;
+      PoolMetrics& operator=(const PoolMetrics&) = delete;
+
+      // -- hooks (called by thread pools) --
+
+      /// @brief Allocate worker counters (before starting worker threads)
+      void init(size_t workerCount) {
+        this->_workers.reset(new WorkerCounters[workerCount ? workerCount : 1u]);
+        this->_workerCount = workerCount;
+        reset();
+      }
+      /// @brief Job inserted in a queue: store insertion time + update queue depth high-water mark
+      inline void onEnqueue(JobStamp& job, size_t queueDepth) noexcept {
+        job.enqueueTime = Clock::now();
+        size_t current = this->_queueDepthHighWater.load(std::memory_order_relaxed);
+        while (queueDepth > current && !this->_queueDepthHighWater.compare_exchange_weak(current, queueDepth, std::memory_order_relaxed)) {}
+      }
+      /// @brief Job extracted by a worker: record queue latency
+      inline StartTime onStart(const JobStamp& job, uint32_t) noexcept {
+        StartTime now = Clock::now();
+        this->_queueLatency.record(now - job.enqueueTime);
+        return now;
+      }
+      /// @brief Job processed by a worker: record run time
+      inline void onFinish(const StartTime& startTime, uint32_t workerIndex) noexcept {
+        auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - startTime).count();
+        uint64_t runTime = (duration > 0) ? static_cast<uint64_t>(duration) : 0;
+        this->_runTime.record(runTime);
+        if (workerIndex < this->_workerCount) {
+          WorkerCounters& worker = this->_workers[workerIndex];
+          worker.jobCount.fetch_add(1u, std::memory_order_relaxed);
+          worker.busyTime.fetch_add(runTime, std::memory_order_relaxed);
+        }
+      }
+      /// @brief Job stolen by a worker (work-stealing pools)
+      inline void onSteal(uint32_t workerIndex) noexcept {
+        if (workerIndex < this->_workerCount)
+          this->_workers[workerIndex].stealCount.fetch_add(1u, std::memory_order_relaxed);
+      }
+
+      // -- read metrics --
+
+      /// @brief Get current metrics
+      PoolMetricsSnapshot snapshot() const {
+        PoolMetricsSnapshot result;
+        result.queueLatency = this->_queueLatency.snapshot();
+        result.runTime = this->_runTime.snapshot();
+        result.queueDepthHighWater = this->_queueDepthHighWater.load(std::memory_order_relaxed);
+        auto elapsedTime = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - _loadStartTime()).count();
+        result.elapsedTime = (elapsedTime > 0) ? static_cast<uint64_t>(elapsedTime) : 1u;
+
+        result.workers.resize(this->_workerCount);
+        for (size_t i = 0; i < this->_workerCount; ++i) {
+          const WorkerCounters& counters = this->_workers[i];
+          WorkerMetricsSnapshot& worker = result.workers[i];
+          worker.jobCount = counters.jobCount.load(std::memory_order_relaxed);
+          worker.stealCount = counters.stealCount.load(std::memory_order_relaxed);
+          worker.busyTime = counters.busyTime.load(std::memory_order_relaxed);
+          worker.busyRatio = static_cast<double>(worker.busyTime) / static_cast<double>(result.elapsedTime);
+          if (worker.busyRatio > 1.0) // job started before reset
+            worker.busyRatio = 1.0;
+        }
+        return result;
+      }
+      /// @brief Reset all metrics (start new measurement period)
+      void reset() noexcept {
+        this->_queueLatency.reset();
+        this->_runTime.reset();
+        this->_queueDepthHighWater.store(0, std::memory_order_relaxed);
+        for (size_t i = 0; i < this->_workerCount; ++i) {
+          this->_workers[i].jobCount.store(0, std::memory_order_relaxed);
+          this->_workers[i].stealCount.store(0, std::memory_order_relaxed);
+          this->_workers[i].busyTime.store(0, std::memory_order_relaxed);
+        }
+        this->_startTime.store(Clock::now().time_since_epoch().count(), std::memory_order_release);
+      }
+
+    private:
+      inline Clock::time_point _loadStartTime() const noexcept {
+        return Clock::time_point(Clock::duration(this->_startTime.load(std::memory_order_acquire)));
+      }
+
+      struct WorkerCounters { // padded to a cache line per worker (no false sharing between workers - no over-aligned 'new' before C++17)
+        std::atomic<uint64_t> jobCount{ 0 };
+        std::atomic<uint64_t> stealCount{ 0 };
+        std::atomic<uint64_t> busyTime{ 0 };
+        char padding[64u - 3u*sizeof(std::atomic<uint64_t>)];
+      };
+
+    private:
+      LatencyHistogram _queueLatency;
+      LatencyHistogram _runTime;
+      std::atomic<size_t> _queueDepthHighWater{ 0 };
+      std::atomic<Clock::duration::rep> _startTime; // time since clock epoch (atomic: modified by 'reset')
+      std::unique_ptr<WorkerCounters[]> _workers;
+      size_t _workerCount = 0;
+    };
+
+  }
+}
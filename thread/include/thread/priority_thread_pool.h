@@ -0,0 +1,511 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <stdexcept>
+#include <array>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <type_traits>
+#include <system/trace.h>
+#include "./thread_priority.h"
+#include "./thread_pool.h"
+
+namespace pandora {
+  namespace thread {
+    /// @brief Priority lane of a job in a PriorityThreadPool
+    enum class JobPriority : uint32_t {
+      high = 0,   ///< Latency-critical jobs
+      normal = 1, ///< Standard jobs
+      low = 2     ///< Background jobs
+    };
+    /// @brief Number of priority lanes (JobPriority values)
+    constexpr size_t jobPriorityCount() noexcept { return 3u; }
+
+    /// @brief Default OS scheduler priority for the dedicated threads of a lane (high: higher, normal: normal, low: lower)
+    constexpr ThreadPriority toThreadPriority(JobPriority priority) noexcept {
+      return (priority == JobPriority::high) ? ThreadPriority::higher : ((priority == JobPriority::low) ? ThreadPriority::lower : ThreadPriority::normal);
+    }
+
+    /// @brief Worker configuration for a priority lane
+    struct PriorityLaneParams final {
+      uint32_t dedicatedThreads = 0;              ///< Additional threads that only process the jobs of this lane
+      bool isThreadPriorityUsed = false;          ///< Set OS scheduler priority of dedicated threads (warning: may require privileges)
+      ThreadPriority threadPriority = ThreadPriority::normal; ///< OS scheduler priority of dedicated threads (if isThreadPriorityUsed)
+    };
+
+    // ---
+
+    /// @class PriorityThreadPool
+    /// @brief Fixed-size pool of threads, with priority lanes and optional job deadlines.
+    /// @description Alternative to ThreadPool when latency-critical jobs must not wait behind background jobs.
+    ///              Each job is inserted in a lane (JobPriority): workers always take the job with the smallest key, with:
+    ///              - key = enqueue time + lane * agingDelay -> higher lanes are drained first, but a waiting job gets
+    ///                the same rank as a higher-lane job inserted 'agingDelay' later (aging: no starvation);
+    ///              - agingDelay == 0: strict priorities (lower lanes only processed when higher lanes are empty);
+    ///              - jobs with a deadline are processed before the other jobs of the same lane (earliest deadline first),
+    ///                and any job whose deadline has been reached is processed before all other jobs.
+    ///              Shared threads process jobs of all lanes. Optionally, each lane can have dedicated threads (only processing the lane),
+    ///              with a specific OS scheduler priority (see PriorityLaneParams).
+    template <typename _JobParamType,                        // Type of data container to process (must be movable)
+              ThreadRunnerMode _Mode = ThreadRunnerMode::single, // one function passed on construction / one per job
+              TaskRunnerType _FunctionType = TaskRunnerType::functionPointer> // function pointer / lambda
+    class PriorityThreadPool final {
+    public:
+      using Type = PriorityThreadPool<_JobParamType,_Mode,_FunctionType>;
+      using size_type = size_t;
+      using clock_type = std::chrono::steady_clock;
+      using time_point = clock_type::time_point;
+      using lane_params = std::array<PriorityLaneParams, jobPriorityCount()>;
+      using task_runner_type = typename std::conditional<_FunctionType == TaskRunnerType::lambda, std::function<void(_JobParamType&)>, void (*)(_JobParamType&)>::type;
+      using task_runner_move = typename std::conditional<_FunctionType == TaskRunnerType::lambda, task_runner_type&&, task_runner_type>::type;
+    protected:
+      template<bool cond, typename _T>
+      using EnableIf = typename std::enable_if<cond, _T>::type;
+
+      using job_param_move = typename std::conditional<std::is_class<_JobParamType>::value, _JobParamType&&, _JobParamType>::type;
+      struct JobParamWithRunner { // Job data in 'perJob' mode (parameter + custom runner)
+        _JobParamType param;
+        task_runner_type runner;
+        JobParamWithRunner(job_param_move param) : param(std::move(param)), runner(nullptr) {}
+        JobParamWithRunner(job_param_move param, task_runner_move runner) : param(std::move(param)), runner(std::move(runner)) {}
+      };
+      using job_item = typename std::conditional<(_Mode == ThreadRunnerMode::perJob), JobParamWithRunner, _JobParamType>::type;
+
+      struct PriorityJob { // Job data + scheduling info
+        job_item item;
+        time_point enqueueTime;
+        time_point deadline;
+        template <typename ... _Args>
+        PriorityJob(time_point enqueueTime, time_point deadline, _Args&&... args)
+          : item(std::forward<_Args>(args)...), enqueueTime(enqueueTime), deadline(deadline) {}
+      };
+      struct LaterDeadline { // heap order: earliest deadline on top
+        inline bool operator()(const PriorityJob& lhs, const PriorityJob& rhs) const noexcept { return (lhs.deadline > rhs.deadline); }
+      };
+      struct Lane { // Jobs of a priority level
+        std::deque<PriorityJob> jobs;            // FIFO
+        std::vector<PriorityJob> deadlineJobs;   // heap (earliest deadline first)
+        size_t busyThreads = 0;                  // threads processing a job of this lane
+        size_t dedicatedThreads = 0;             // threads only processing this lane
+        size_t busyDedicatedThreads = 0;
+        size_t sleepingDedicatedThreads = 0;
+        std::condition_variable dedicatedCondition;
+        inline size_t size() const noexcept { return jobs.size() + deadlineJobs.size(); }
+      };
+
+      struct SharedPoolData { // Synchronization & jobs data - shared with child threads
+        bool isRunning = false;
+        clock_type::duration agingDelay{ 0 };
+        Lane lanes[jobPriorityCount()];
+        size_t sharedThreads = 0;
+        size_t busySharedThreads = 0;
+        size_t sleepingSharedThreads = 0;
+        mutable std::mutex lock;
+        std::condition_variable condition; // signal for shared threads
+      };
+      static constexpr uint32_t _noLane = 0xFFFFFFFFu;
+
+    public:
+      /// @brief Create empty thread pool - not running
+      inline PriorityThreadPool() : _poolData(std::make_shared<SharedPoolData>()) {}
+      /// @brief Create and start a thread pool - mode: no common runner -> provide a task runner for each job
+      /// @warning in 'single' runner mode, jobs will not be processed!
+      inline PriorityThreadPool(size_t threadCount) : _poolData(std::make_shared<SharedPoolData>()) {
+        task_runner_type emptyRunner = nullptr;
+        _startThreads(threadCount, emptyRunner, std::chrono::milliseconds(100), lane_params{});
+      }
+      /// @brief Create and start a thread pool - mode: common task runner provided in constructor
+      /// @warning Required for standard use of 'single' runner mode, optional to have a default runner in 'perJob' mode.
+      inline PriorityThreadPool(size_t threadCount, task_runner_type commonRunner) : _poolData(std::make_shared<SharedPoolData>()) {
+        _startThreads(threadCount, commonRunner, std::chrono::milliseconds(100), lane_params{});
+      }
+      /// @brief Create and start a thread pool - custom aging delay (0: strict priorities) + dedicated threads per lane
+      /// @param threadCount  Number of shared threads (processing all lanes)
+      template <typename _RepetitionType, typename _PeriodType>
+      inline PriorityThreadPool(size_t threadCount, task_runner_type commonRunner,
+                                const std::chrono::duration<_RepetitionType, _PeriodType>& agingDelay, const lane_params& lanes = lane_params{})
+        : _poolData(std::make_shared<SharedPoolData>()) {
+        _startThreads(threadCount, commonRunner, std::chrono::duration_cast<clock_type::duration>(agingDelay), lanes);
+      }
+
+      /// @brief Stop thread pool and wait for each thread to stop running
+      ~PriorityThreadPool() noexcept { _stopThreads(); }
+
+      PriorityThreadPool(const Type&) = delete;
+      Type& operator=(const Type&) = delete;
+      inline PriorityThreadPool(Type&& rhs) noexcept : _poolData(std::move(rhs._poolData)) {
+        std::swap(this->_threads, rhs._threads);
+        rhs._poolData = std::make_shared<SharedPoolData>();
+      }
+      inline Type& operator=(Type&& rhs) noexcept {
+        _stopThreads();
+        std::swap(this->_threads, rhs._threads);
+        this->_poolData = std::move(rhs._poolData);
+        rhs._poolData = std::make_shared<SharedPoolData>();
+        return *this;
+      }
+
+      // -- thread pool size --
+
+      inline size_type size() const noexcept { return this->_threads.size(); } ///< Total number of threads in the pool (shared + dedicated)
+      /// @brief Number of active threads in the pool (currently processing a job)
+      inline size_type busyThreads() const noexcept {
+        std::lock_guard<std::mutex> guard(this->_poolData->lock);
+        size_t busyCount = 0;
+        for (const auto& lane : this->_poolData->lanes)
+          busyCount += lane.busyThreads;
+        return busyCount;
+      }
+      /// @brief Number of threads currently processing a job of a specific lane
+      inline size_type busyThreads(JobPriority priority) const noexcept {
+        std::lock_guard<std::mutex> guard(this->_poolData->lock);
+        return this->_poolData->lanes[_toLane(priority)].busyThreads;
+      }
+      /// @brief Number of threads waiting in the pool (ready for new jobs)
+      inline size_type freeThreads() const noexcept { return size() - busyThreads(); }
+      /// @brief Number of threads ready to process new jobs of a specific lane (free shared threads + free dedicated threads of the lane)
+      inline size_type freeThreads(JobPriority priority) const noexcept {
+        std::lock_guard<std::mutex> guard(this->_poolData->lock);
+        const Lane& lane = this->_poolData->lanes[_toLane(priority)];
+        return (this->_poolData->sharedThreads - this->_poolData->busySharedThreads) + (lane.dedicatedThreads - lane.busyDedicatedThreads);
+      }
+      /// @brief Number of jobs waiting to be processed (all lanes)
+      inline size_type pendingJobs() const noexcept {
+        std::lock_guard<std::mutex> guard(this->_poolData->lock);
+        size_t jobCount = 0;
+        for (const auto& lane : this->_poolData->lanes)
+          jobCount += lane.size();
+        return jobCount;
+      }
+      /// @brief Number of jobs of a specific lane waiting to be processed
+      inline size_type pendingJobs(JobPriority priority) const noexcept {
+        std::lock_guard<std::mutex> guard(this->_poolData->lock);
+        return this->_poolData->lanes[_toLane(priority)].size();
+      }
+
+      // -- job management --
+
+      /// @brief Insert a new job to process (copied) - custom task runner for each job (not available in 'single' runner mode)
+      template<typename J = _JobParamType, ThreadRunnerMode M = _Mode>
+      inline EnableIf<(!std::is_class<J>::value || std::is_copy_constructible<J>::value) && M == ThreadRunnerMode::perJob,
+                      bool> addJob(const _JobParamType& param, task_runner_move runner, JobPriority priority = JobPriority::normal) {
+        return _pushJob(_toLane(priority), time_point::max(), _JobParamType(param), std::move(runner));
+      }
+      /// @brief Insert a new job to process (moved) - custom task runner for each job (not available in 'single' runner mode)
+      template<ThreadRunnerMode M = _Mode>
+      inline EnableIf<M==ThreadRunnerMode::perJob,
+                      bool> addJob(_JobParamType&& param, task_runner_move runner, JobPriority priority = JobPriority::normal) {
+        return _pushJob(_toLane(priority), time_point::max(), std::move(param), std::move(runner));
+      }
+      /// @brief Insert a new job to process before a deadline (copied) - custom task runner for each job (not available in 'single' runner mode)
+      template<typename J = _JobParamType, ThreadRunnerMode M = _Mode>
+      inline EnableIf<(!std::is_class<J>::value || std::is_copy_constructible<J>::value) && M == ThreadRunnerMode::perJob,
+                      bool> addJob(const _JobParamType& param, task_runner_move runner, JobPriority priority, time_point deadline) {
+        return _pushJob(_toLane(priority), deadline, _JobParamType(param), std::move(runner));
+      }
+      /// @brief Insert a new job to process before a deadline (moved) - custom task runner for each job (not available in 'single' runner mode)
+      template<ThreadRunnerMode M = _Mode>
+      inline EnableIf<M==ThreadRunnerMode::perJob,
+                      bool> addJob(_JobParamType&& param, task_runner_move runner, JobPriority priority, time_point deadline) {
+        return _pushJob(_toLane(priority), deadline, std::move(param), std::move(runner));
+      }
+
+      /// @brief Insert a new job to process (copied) - use common task runner provided in constructor
+      template<typename J = _JobParamType>
+      inline EnableIf<!std::is_class<J>::value || std::is_copy_constructible<J>::value,
+                      bool> addJob(const _JobParamType& param, JobPriority priority = JobPriority::normal) {
+        return _pushJob(_toLane(priority), time_point::max(), _JobParamType(param));
+      }
+      /// @brief Insert a new job to process (moved) - use common task runner provided in constructor
+      inline bool addJob(_JobParamType&& param, JobPriority priority = JobPriority::normal) {
+        return _pushJob(_toLane(priority), time_point::max(), std::move(param));
+      }
+      /// @brief Insert a new job to process before a deadline (copied) - use common task runner provided in constructor
+      template<typename J = _JobParamType>
+      inline EnableIf<!std::is_class<J>::value || std::is_copy_constructible<J>::value,
+                      bool> addJob(const _JobParamType& param, JobPriority priority, time_point deadline) {
+        return _pushJob(_toLane(priority), deadline, _JobParamType(param));
+      }
+      /// @brief Insert a new job to process before a deadline (moved) - use common task runner provided in constructor
+      inline bool addJob(_JobParamType&& param, JobPriority priority, time_point deadline) {
+        return _pushJob(_toLane(priority), deadline, std::move(param));
+      }
+
+      /// @brief Cancel all jobs that haven't already been started
+      inline uint32_t cancelPendingJobs() noexcept {
+        std::lock_guard<std::mutex> guard(this->_poolData->lock);
+        size_t jobCount = 0;
+        for (auto& lane : this->_poolData->lanes)
+          jobCount += _clearLane(lane);
+        return static_cast<uint32_t>(jobCount);
+      }
+      /// @brief Cancel all jobs of a lane that haven't already been started
+      inline uint32_t cancelPendingJobs(JobPriority priority) noexcept {
+        std::lock_guard<std::mutex> guard(this->_poolData->lock);
+        return static_cast<uint32_t>(_clearLane(this->_poolData->lanes[_toLane(priority)]));
+      }
+
+    protected:
+      static inline uint32_t _toLane(JobPriority priority) noexcept {
+        return (static_cast<uint32_t>(priority) < jobPriorityCount()) ? static_cast<uint32_t>(priority) : static_cast<uint32_t>(jobPriorityCount() - 1u);
+      }
+      static inline size_t _clearLane(Lane& lane) noexcept {
+        size_t jobCount = lane.size();
+        lane.jobs.clear();
+        lane.deadlineJobs.clear();
+        return jobCount;
+      }
+
+      // -- job management --
+
+      // insert job in lane + awake a thread able to process it
+      template <typename ... _Args>
+      bool _pushJob(uint32_t laneIndex, time_point deadline, _Args&&... args) {
+        SharedPoolData& sync = *(this->_poolData);
+        std::unique_lock<std::mutex> guard(sync.lock);
+        if (!sync.isRunning)
+          return false;
+
+        Lane& lane = sync.lanes[laneIndex];
+        if (deadline == time_point::max()) {
+          lane.jobs.emplace_back(clock_type::now(), deadline, std::forward<_Args>(args)...);
+        }
+        else {
+          lane.deadlineJobs.emplace_back(clock_type::now(), deadline, std::forward<_Args>(args)...);
+          std::push_heap(lane.deadlineJobs.begin(), lane.deadlineJobs.end(), LaterDeadline{});
+        }
+
+        if (lane.sleepingDedicatedThreads > 0u) {
+          guard.unlock();
+          lane.dedicatedCondition.notify_one();
+        }
+        else {
+          guard.unlock();
+          sync.condition.notify_one();
+        }
+        return true;
+      }
+
+      // job selection (lock must be held by caller)
+      struct JobSelection {
+        uint32_t lane = _noLane;
+        bool isDeadlineJob = false;
+      };
+      static bool _selectJob(SharedPoolData& sync, uint32_t dedicatedLane, JobSelection& out) noexcept {
+        const uint32_t firstLane = (dedicatedLane == _noLane) ? 0 : dedicatedLane;
+        const uint32_t lastLane = (dedicatedLane == _noLane) ? static_cast<uint32_t>(jobPriorityCount() - 1u) : dedicatedLane;
+        out.lane = _noLane;
+
+        // jobs with reached deadline: earliest deadline first
+        bool hasDeadlineJobs = false;
+        for (uint32_t laneIndex = firstLane; laneIndex <= lastLane; ++laneIndex)
+          hasDeadlineJobs |= !sync.lanes[laneIndex].deadlineJobs.empty();
+        if (hasDeadlineJobs) {
+          time_point now = clock_type::now();
+          const PriorityJob* best = nullptr;
+          for (uint32_t laneIndex = firstLane; laneIndex <= lastLane; ++laneIndex) {
+            const auto& deadlineJobs = sync.lanes[laneIndex].deadlineJobs;
+            if (!deadlineJobs.empty() && deadlineJobs.front().deadline <= now && (best == nullptr || deadlineJobs.front().deadline < best->deadline)) {
+              best = &deadlineJobs.front();
+              out.lane = laneIndex;
+              out.isDeadlineJob = true;
+            }
+          }
+          if (best != nullptr)
+            return true;
+        }
+
+        // other jobs: smallest key (enqueue time + lane offset), or strict priorities (if no aging delay)
+        time_point bestKey = time_point::max();
+        for (uint32_t laneIndex = firstLane; laneIndex <= lastLane; ++laneIndex) {
+          const Lane& lane = sync.lanes[laneIndex];
+          if (lane.size() == 0u)
+            continue;
+          if (sync.agingDelay == clock_type::duration::zero()) { // strict priorities -> first non-empty lane
+            out.lane = laneIndex;
+            out.isDeadlineJob = !lane.deadlineJobs.empty();
+            return true;
+          }
+
+          const clock_type::duration laneOffset = sync.agingDelay * laneIndex;
+          if (!lane.deadlineJobs.empty() && lane.deadlineJobs.front().enqueueTime + laneOffset < bestKey) {
+            bestKey = lane.deadlineJobs.front().enqueueTime + laneOffset;
+            out.lane = laneIndex;
+            out.isDeadlineJob = true;
+          }
+          if (!lane.jobs.empty() && lane.jobs.front().enqueueTime + laneOffset < bestKey) {
+            bestKey = lane.jobs.front().enqueueTime + laneOffset;
+            out.lane = laneIndex;
+            out.isDeadlineJob = false;
+          }
+          if (out.lane == laneIndex && !lane.deadlineJobs.empty()) // deadline jobs before other jobs of same lane
+            out.isDeadlineJob = true;
+        }
+        return (out.lane != _noLane);
+      }
+
+      // extract selected job (lock must be held by caller)
+      static inline job_item _extractJob(Lane& lane, bool isDeadlineJob) {
+        if (isDeadlineJob) {
+          std::pop_heap(lane.deadlineJobs.begin(), lane.deadlineJobs.end(), LaterDeadline{});
+          job_item item(std::move(lane.deadlineJobs.back().item));
+          lane.deadlineJobs.pop_back();
+          return item;
+        }
+        job_item item(std::move(lane.jobs.front().item));
+        lane.jobs.pop_front();
+        return item;
+      }
+
+      // -- thread management --
+
+      // launch thread pool
+      void _startThreads(size_t threadCount, task_runner_type& runner, clock_type::duration agingDelay, const lane_params& lanes) {
+        SharedPoolData& sync = *(this->_poolData);
+        sync.isRunning = true;
+        sync.agingDelay = (agingDelay > clock_type::duration::zero()) ? agingDelay : clock_type::duration::zero();
+        sync.sharedThreads = threadCount;
+
+        size_t totalThreads = threadCount;
+        for (const auto& lane : lanes)
+          totalThreads += lane.dedicatedThreads;
+        this->_threads.reserve(totalThreads);
+
+        uint32_t index = 0;
+        for (; index < threadCount; ++index)
+          this->_threads.emplace_back(&Type::_runThread, this->_poolData, index, _noLane, ThreadPriority::normal, false, runner);
+        for (uint32_t laneIndex = 0; laneIndex < jobPriorityCount(); ++laneIndex) {
+          sync.lanes[laneIndex].dedicatedThreads = lanes[laneIndex].dedicatedThreads;
+          for (uint32_t i = 0; i < lanes[laneIndex].dedicatedThreads; ++i, ++index)
+            this->_threads.emplace_back(&Type::_runThread, this->_poolData, index, laneIndex,
+                                        lanes[laneIndex].threadPriority, lanes[laneIndex].isThreadPriorityUsed, runner);
+        }
+      }
+
+      // stop all threads
+      void _stopThreads() noexcept {
+        std::unique_lock<std::mutex> guard(this->_poolData->lock);
+        this->_poolData->isRunning = false;
+        for (auto& lane : this->_poolData->lanes)
+          _clearLane(lane);
+        guard.unlock();
+
+        this->_poolData->condition.notify_all();
+        for (auto& lane : this->_poolData->lanes)
+          lane.dedicatedCondition.notify_all();
+        for (auto& item : this->_threads) {
+          if (item.joinable()) {
+            try {
+              item.join();
+            }
+            catch (const std::exception& __DEBUG_ARG__(exc)) {
+              TRACE_N("PriorityThreadPool: thread join exception: %s", exc.what());
+              try { item.detach(); } catch (const std::exception&) {}
+            }
+          }
+        }
+        this->_threads.clear();
+      }
+
+      // -- thread execution --
+
+      // main thread execution loop
+      static void _runThread(std::shared_ptr<SharedPoolData> shared, uint32_t __DEBUG_ARG__(index), uint32_t dedicatedLane,
+                             ThreadPriority priority, bool isThreadPriorityUsed, task_runner_type commonRunner) noexcept {
+        TRACE_N("PriorityThreadPool: thread %u started", index);
+        assert(shared != nullptr);
+        SharedPoolData& sync = *shared;
+        if (commonRunner == nullptr)
+          commonRunner = &Type::_defaultRunner;
+        if (isThreadPriorityUsed && !setCurrentThreadPriority(priority)) {
+          TRACE_N("PriorityThreadPool: thread %u - failed to set thread priority", index);
+        }
+
+        size_t& busyGroupThreads = (dedicatedLane == _noLane) ? sync.busySharedThreads : sync.lanes[dedicatedLane].busyDedicatedThreads;
+        size_t& sleepingThreads = (dedicatedLane == _noLane) ? sync.sleepingSharedThreads : sync.lanes[dedicatedLane].sleepingDedicatedThreads;
+        std::condition_variable& condition = (dedicatedLane == _noLane) ? sync.condition : sync.lanes[dedicatedLane].dedicatedCondition;
+        JobSelection selection;
+
+        std::unique_lock<std::mutex> guard(sync.lock);
+        while (sync.isRunning) {
+          while (sync.isRunning && !_selectJob(sync, dedicatedLane, selection)) {
+            ++sleepingThreads;
+            condition.wait(guard);
+            --sleepingThreads;
+          }
+
+          if (sync.isRunning) {
+            TRACE_N("PriorityThreadPool: thread %u - job started", index);
+            Lane& lane = sync.lanes[selection.lane];
+            ++(lane.busyThreads);
+            ++busyGroupThreads;
+            try {
+              job_item jobData = _extractJob(lane, selection.isDeadlineJob);
+              guard.unlock();
+              _callRunner(jobData, commonRunner);
+            }
+            catch (const std::exception& __DEBUG_ARG__(exc)) { TRACE_N("PriorityThreadPool: exception: %s", exc.what()); }
+            catch (...) { TRACE("PriorityThreadPool: unknown exception type thrown"); }
+
+            if (!guard.owns_lock())
+              guard.lock();
+            --(lane.busyThreads);
+            --busyGroupThreads;
+          }
+        }
+
+        guard.unlock();
+        condition.notify_one();
+        TRACE_N("PriorityThreadPool: thread %u stopped", index);
+      }
+
+      // specialized calls to task runner
+      static inline void _callRunner(JobParamWithRunner& jobData, task_runner_type& defaultRunner) {
+        if (jobData.runner != nullptr)
+          jobData.runner(jobData.param);
+        else
+          defaultRunner(jobData.param);
+      }
+      static inline void _callRunner(_JobParamType& param, task_runner_type& defaultRunner) {
+        defaultRunner(param);
+      }
+      // default task runner, if none provided
+      static inline void _defaultRunner(_JobParamType&) {
+        TRACE("PriorityThreadPool: no common runner provided.");
+      }
+
+    private:
+      std::vector<std::thread> _threads;
+      std::shared_ptr<SharedPoolData> _poolData;
+    };
+
+  }
+}
@@ -23,6 +23,7 @@ IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <thread>
 #include <atomic>
 #include <chrono>
+#include "./spin_lock.h"
 
 namespace pandora {
   namespace thread {
@@ -145,6 +146,107 @@ namespace pandora {
       std::thread::id _lockingThreadId; // ID of thread that currently owns the lock (only modified by lock owner, and reading an int is atomic)
       std::atomic_flag _status = ATOMIC_FLAG_INIT;
     };
+
+    // ---
+
+    /// @class AdaptiveRecursiveSpinLock
+    /// @brief Synchronization primitive adapted to contention (see AdaptiveSpinLock), with recursive thread ownership
+    /// @description Same usage as RecursiveSpinLock: test-and-test-and-set with pause/backoff, then futex sleep after a spin budget.
+    ///              Recursive locks by the owner thread only increase a counter (no atomic read-modify-write operation).
+    class AdaptiveRecursiveSpinLock final {
+    public:
+      /// @brief Create an new unlocked instance
+      AdaptiveRecursiveSpinLock() noexcept {}
+      AdaptiveRecursiveSpinLock(const AdaptiveRecursiveSpinLock&) = delete;
+      AdaptiveRecursiveSpinLock(AdaptiveRecursiveSpinLock&&) = delete;
+      AdaptiveRecursiveSpinLock& operator=(const AdaptiveRecursiveSpinLock&) = delete;
+      AdaptiveRecursiveSpinLock& operator=(AdaptiveRecursiveSpinLock&&) = delete;
+
+      // -- simple lock management --
+
+      /// @brief Get the thread-ID of the thread currently owning the lock
+      inline std::thread::id owner() const noexcept { return this->_lockingThreadId.load(std::memory_order_relaxed); }
+
+      /// @brief Wait until object unlocked, then lock it (or increase counter, if same thread)
+      inline void lock() noexcept {
+        std::thread::id currentThreadId(std::this_thread::get_id());
+        if (currentThreadId == owner()) { // same thread -> increase lock count
+          ++(this->_lockCount);
+          return;
+        }
+        this->_lock.lock();
+        _setOwner(currentThreadId);
+      }
+
+      /// @brief Only lock the object if there's no need to wait (already unlocked)
+      /// @returns True on lock success, false if already locked by another owner
+      inline bool tryLock() noexcept {
+        std::thread::id currentThreadId(std::this_thread::get_id());
+        if (currentThreadId == owner()) { // same thread -> increase lock count
+          ++(this->_lockCount);
+          return true;
+        }
+        if (this->_lock.tryLock()) {
+          _setOwner(currentThreadId);
+          return true;
+        }
+        return false;
+      }
+      inline bool try_lock() noexcept { return tryLock(); } // STL-compliant version
+
+      /// @brief Unlock the object (or decrease counter, if multiple locks for current thread)
+      inline bool unlock() noexcept {
+        if (std::this_thread::get_id() != owner())
+          return false; // different thread or already unlocked
+
+        if (--(this->_lockCount) < 1) {
+          this->_lockingThreadId.store(std::thread::id(), std::memory_order_relaxed);
+          this->_lock.unlock();
+        }
+        return true;
+      }
+
+      // -- lock with timeout --
+
+      /// @brief Only wait for a specific period for the object to be unlocked.
+      /// @returns True on lock success, false if timeout
+      template <typename _RepetitionType, typename _PeriodType>
+      inline bool tryLock(const std::chrono::duration<_RepetitionType, _PeriodType>& retryDuration) noexcept {
+        return tryLockUntil(std::chrono::time_point<std::chrono::steady_clock>(std::chrono::steady_clock::now() + retryDuration));
+      }
+      template <typename _RepetitionType, typename _PeriodType>
+      inline bool try_lock_for(const std::chrono::duration<_RepetitionType, _PeriodType>& retryDuration) noexcept { return tryLock(retryDuration); } // STL-compliant version
+
+      /// @brief Only wait until a specific time-point for the object to be unlocked.
+      /// @returns True on lock success, false if timeout
+      template <typename _ClockType, typename _DurationType>
+      bool tryLockUntil(const std::chrono::time_point<_ClockType, _DurationType>& timeoutTimePoint) noexcept {
+        std::thread::id currentThreadId(std::this_thread::get_id());
+        if (currentThreadId == owner()) { // same thread -> increase lock count
+          ++(this->_lockCount);
+          return true;
+        }
+        if (this->_lock.tryLockUntil(timeoutTimePoint)) {
+          _setOwner(currentThreadId);
+          return true;
+        }
+        return false;
+      }
+      template <typename _ClockType, typename _DurationType>
+      inline bool try_lock_until(const std::chrono::time_point<_ClockType, _DurationType>& timeoutTimePoint) noexcept { return tryLockUntil(timeoutTimePoint); } // STL-compliant version
+
+    private:
+      // set locking thread ID (after locking)
+      inline void _setOwner(const std::thread::id& threadId) noexcept {
+        this->_lockCount = 1;
+        this->_lockingThreadId.store(threadId, std::memory_order_relaxed);
+      }
+
+    private:
+      uint32_t _lockCount{ 0 };                      // number of locks called by the locking thread (only modified by lock owner)
+      std::atomic<std::thread::id> _lockingThreadId; // ID of thread that currently owns the lock (only modified by lock owner)
+      AdaptiveSpinLock _lock;
+    };
     
   }
 }
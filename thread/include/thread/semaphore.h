@@ -24,9 +24,192 @@ IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <chrono>
 #include <mutex>
 #include <condition_variable>
+#include "./futex.h"
 
 namespace pandora {
   namespace thread {
+#   if defined(__P_FUTEX_SYSCALL)
+    /// @class Semaphore
+    /// @brief Synchronization primitive (for threads) with a counter, for producer/consumer patterns.
+    /// @details Semaphore for threads with an internal counter. Each call to wait() decrements it, and each call to notify() increments it.
+    ///          When the counter equals zero, any call to wait() will wait until notify() is called by another thread.
+    ///          Typically used for a producer/consumer pattern, or any other form of synchronization that requires a counter.
+    ///          When multiple threads are waiting for notifications, the order in which they'll awake is not guaranteed.
+    ///          Linux/android implementation: the counter is an atomic futex word -> uncontended wait/notify calls make no system call,
+    ///          only threads that really need to block sleep on the futex (and notify(n) only wakes up n threads).
+    /// @warning To avoid deadlocks, the calls to wait() and notify() should never be in the same thread (unless notify() is called before wait()).
+    class Semaphore final {
+    public:
+      /// @brief Create instance with an initial count of 0
+      Semaphore() = default;
+      /// @brief Create instance with a custom initial count
+      Semaphore(uint32_t initialCount) noexcept : _count(initialCount) {}
+
+      Semaphore(const Semaphore&) = delete;
+      Semaphore(Semaphore&& rhs) = delete;
+      Semaphore& operator=(const Semaphore&) = delete;
+      Semaphore& operator=(Semaphore&& rhs) = delete;
+      /// @brief Awake all waiters and destroy instance
+      ~Semaphore() noexcept {
+        this->_isClosing.store(true);
+        uint32_t waiters = this->_waiters.load();
+        while (waiters != 0) {
+          this->_count.fetch_add(waiters);
+          futexWakeAll(this->_count);
+          futexWaitFor(this->_waiters, waiters, std::chrono::milliseconds(1)); // woken up by waiters leaving (timeout: waiter not aware of closing yet, or woken before its decrement)
+          waiters = this->_waiters.load();
+        }
+      }
+
+      // -- semaphore operations --
+
+      /// @brief Wait until the counter has a value above 0, then consume 1 unit
+      inline void wait() noexcept {
+        if (!tryWait())
+          _wait(1u);
+      }
+      /// @brief Wait for the counter to reach a specific count, then consume that count
+      inline void wait(uint32_t reqCount) noexcept {
+        if (!tryWait(reqCount))
+          _wait(reqCount);
+      }
+
+      /// @brief Check if the counter has a value above 0, and consume 1 unit if it's the case
+      /// @returns True on success, false if nothing to consume
+      inline bool tryWait() noexcept { return tryWait(1u); }
+      /// @brief Check if the counter has at least a specific value, and consume that count if it's the case
+      /// @returns True on success, false if nothing to consume
+      inline bool tryWait(uint32_t reqCount) noexcept {
+        uint32_t count = this->_count.load(std::memory_order_relaxed);
+        while (count >= reqCount) {
+          if (this->_count.compare_exchange_weak(count, count - reqCount, std::memory_order_acquire, std::memory_order_relaxed))
+            return true;
+        }
+        return false;
+      }
+
+      /// @brief Increase the counter of 1 unit, then awake one waiting thread
+      inline void notify() noexcept { notify(1u); }
+      /// @brief Increase the counter of multiple units, then awake that number of waiting threads
+      inline void notify(uint32_t unitCount) noexcept {
+        this->_count.fetch_add(unitCount); // seq_cst: ordered with 'waiters' increment of waiting threads
+        _wake(unitCount);
+      }
+      /// @brief Increase the counter to awake each waiting threads
+      inline void notifyAll() noexcept {
+        uint32_t unitCount = this->_waiters.load();
+        if (unitCount != 0) {
+          this->_count.fetch_add(unitCount);
+          futexWakeAll(this->_count);
+        }
+      }
+
+      /// @brief Reset the counter to 0, and consume all units
+      /// @returns Value that the counter held before being reset
+      inline uint32_t reset() noexcept { return this->_count.exchange(0u, std::memory_order_acquire); }
+
+      // -- operations with timeout --
+
+      /// @brief Only wait until the counter has a value above 0 for a specific period of time
+      /// @returns True on success, false if timeout
+      template <typename _RepetitionType, typename _PeriodType>
+      inline bool tryWait(const std::chrono::duration<_RepetitionType, _PeriodType>& retryDuration) noexcept {
+        return tryWaitUntil(std::chrono::time_point<std::chrono::steady_clock>(std::chrono::steady_clock::now() + retryDuration));
+      }
+      /// @brief Only wait until the counter has reached a specific value for a specific period of time
+      /// @returns True on success, false if timeout
+      template <typename _RepetitionType, typename _PeriodType>
+      inline bool tryWait(uint32_t reqCount, const std::chrono::duration<_RepetitionType, _PeriodType>& retryDuration) noexcept {
+        return tryWaitUntil(reqCount, std::chrono::time_point<std::chrono::steady_clock>(std::chrono::steady_clock::now() + retryDuration));
+      }
+      template <typename _RepetitionType, typename _PeriodType>
+      inline bool try_wait_for(const std::chrono::duration<_RepetitionType, _PeriodType>& retryDuration) noexcept { return tryWait(retryDuration); } // STL-compliant version
+
+      /// @brief Wait until the counter has a value above 0, or until a specific time-point
+      /// @returns True on success, false if timeout
+      template <typename _ClockType, typename _DurationType>
+      inline bool tryWaitUntil(const std::chrono::time_point<_ClockType, _DurationType>& timeoutTimePoint) noexcept { return tryWaitUntil(1u, timeoutTimePoint); }
+      /// @brief Wait until the counter has reached a specific value, or until a specific time-point
+      /// @returns True on success, false if timeout
+      template <typename _ClockType, typename _DurationType>
+      bool tryWaitUntil(uint32_t reqCount, const std::chrono::time_point<_ClockType, _DurationType>& timeoutTimePoint) noexcept {
+        if (tryWait(reqCount))
+          return true;
+
+        _addWaiter(reqCount);
+        bool isSuccess = false;
+        uint32_t count = this->_count.load();
+        while (true) {
+          if (count >= reqCount) {
+            if (this->_count.compare_exchange_weak(count, count - reqCount, std::memory_order_acquire, std::memory_order_relaxed)) {
+              isSuccess = true;
+              break;
+            }
+            continue;
+          }
+          auto remainingTime = timeoutTimePoint - _ClockType::now();
+          if (remainingTime <= decltype(remainingTime)::zero())
+            break;
+          futexWaitFor(this->_count, count, remainingTime);
+          count = this->_count.load();
+        }
+        _removeWaiter(reqCount);
+        return isSuccess;
+      }
+      template <typename _ClockType, typename _DurationType>
+      inline bool try_wait_until(const std::chrono::time_point<_ClockType, _DurationType>& timeoutTimePoint) noexcept { return tryWaitUntil(timeoutTimePoint); } // STL-compliant version
+
+    private:
+      // blocking wait (slow path)
+      void _wait(uint32_t reqCount) noexcept {
+        _addWaiter(reqCount);
+        uint32_t count = this->_count.load();
+        while (true) {
+          if (count >= reqCount) {
+            if (this->_count.compare_exchange_weak(count, count - reqCount, std::memory_order_acquire, std::memory_order_relaxed))
+              break;
+          }
+          else {
+            futexWait(this->_count, count);
+            count = this->_count.load();
+          }
+        }
+        _removeWaiter(reqCount);
+      }
+
+      // register waiting thread (seq_cst: ordered with counter increments of notifiers)
+      inline void _addWaiter(uint32_t reqCount) noexcept {
+        if (reqCount > 1u)
+          this->_multiUnitWaiters.fetch_add(1u);
+        this->_waiters.fetch_add(reqCount);
+      }
+      inline void _removeWaiter(uint32_t reqCount) noexcept {
+        if (reqCount > 1u)
+          this->_multiUnitWaiters.fetch_sub(1u);
+        // closing: wake destructor before decrement (destruction allowed once waiters reach 0 -> decrement must be the last access to instance data).
+        // If the destructor starts waiting after the wake-up call, it'll see the decremented value (or time out).
+        if (this->_isClosing.load())
+          futexWakeAll(this->_waiters);
+        this->_waiters.fetch_sub(reqCount);
+      }
+      // wake up threads after counter increment (only if some threads are waiting)
+      inline void _wake(uint32_t unitCount) noexcept {
+        if (this->_waiters.load() != 0) {
+          if (this->_multiUnitWaiters.load() == 0)
+            futexWake(this->_count, unitCount); // 1 unit per waiter -> wake exactly 'unitCount' threads
+          else
+            futexWakeAll(this->_count); // waiters for multiple units: any of them might be satisfied
+        }
+      }
+
+    private:
+      std::atomic<uint32_t> _count{ 0u };   // futex word
+      std::atomic<uint32_t> _waiters{ 0u }; // number of units required by waiting threads
+      std::atomic<uint32_t> _multiUnitWaiters{ 0u };
+      std::atomic<bool> _isClosing{ false };
+    };
+
+#   else
     /// @class Semaphore
     /// @brief Synchronization primitive (for threads) with a counter, for producer/consumer patterns.
     /// @details Semaphore for threads with an internal counter. Each call to wait() decrements it, and each call to notify() increments it.
@@ -184,6 +367,7 @@ namespace pandora {
       uint32_t _count{ 0u };
       uint32_t _waiters{ 0u };
     };
+#   endif
     
   }
 }
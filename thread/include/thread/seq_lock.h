@@ -0,0 +1,149 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <atomic>
+#include <type_traits>
+#include "./futex.h"
+
+namespace pandora {
+  namespace thread {
+    /// @class SeqLock
+    /// @brief Sequence lock: container for a small POD value, read by copy without any write to shared memory.
+    /// @description Storage for data read very often and rarely modified (configuration, snapshots of counters...):
+    ///              - writers increment a sequence number before and after modifying the value (writers are mutually exclusive);
+    ///              - readers copy the value, then verify that the sequence number is even and unchanged (otherwise, they retry).
+    ///              Readers never write to shared memory: they don't invalidate each other's cache lines and can't block writers.
+    /// @remarks - The value is stored in atomic words (relaxed accesses): torn copies are detected and discarded, without undefined behavior.
+    ///          - Only efficient for small types (a few cache lines at most): readers copy the whole value, and retry while a writer is active.
+    /// @warning Readers can be starved by a continuous flow of writers: only use it for data written rarely.
+    template <typename _DataType>
+    class SeqLock final {
+    public:
+      static_assert(std::is_trivially_copyable<_DataType>::value, "SeqLock: data type must be trivially copyable");
+      static_assert(std::is_default_constructible<_DataType>::value, "SeqLock: data type must be default constructible");
+
+      /// @brief Create instance with default value
+      SeqLock() noexcept : SeqLock(_DataType{}) {}
+      /// @brief Create instance with initial value
+      explicit SeqLock(const _DataType& value) noexcept { _writeWords(value); }
+      SeqLock(const SeqLock&) = delete;
+      SeqLock(SeqLock&&) = delete;
+      SeqLock& operator=(const SeqLock&) = delete;
+      SeqLock& operator=(SeqLock&&) = delete;
+
+      // -- read --
+
+      /// @brief Read a consistent copy of the value (retry while a writer is modifying it)
+      inline _DataType load() const noexcept {
+        _DataType value;
+        uint32_t retryCount = 0;
+        while (!tryLoad(value)) {
+          if (++retryCount < _maxRelaxRetries)
+            cpuRelax();
+          else
+            std::this_thread::yield();
+        }
+        return value;
+      }
+      /// @brief Try to read a consistent copy of the value (only one attempt)
+      /// @returns True on success, false if a writer was modifying the value ('outValue' not modified)
+      inline bool tryLoad(_DataType& outValue) const noexcept {
+        uint32_t sequence = this->_sequence.load(std::memory_order_acquire);
+        if (sequence & 1u)
+          return false; // write in progress
+
+        size_t buffer[_wordCount];
+        for (size_t i = 0; i < _wordCount; ++i)
+          buffer[i] = this->_words[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire); // copy before sequence verification
+        if (this->_sequence.load(std::memory_order_relaxed) != sequence)
+          return false;
+
+        memcpy((void*)&outValue, (const void*)buffer, sizeof(_DataType));
+        return true;
+      }
+
+      /// @brief Get current version of the value (number of completed writes)
+      inline uint32_t version() const noexcept { return (this->_sequence.load(std::memory_order_acquire) >> 1); }
+
+      // -- write --
+
+      /// @brief Replace the value (wait for other writers, if any)
+      inline void store(const _DataType& value) noexcept {
+        uint32_t sequence = _lockWriter();
+        _writeWords(value);
+        this->_sequence.store(sequence + 2u, std::memory_order_release);
+      }
+      /// @brief Modify the value with a function (void(_DataType&)) - the function must not throw and must not access this SeqLock
+      template <typename _Modifier>
+      inline void update(_Modifier&& modifier) noexcept {
+        uint32_t sequence = _lockWriter();
+        _DataType value = _readWords();
+        modifier(value);
+        _writeWords(value);
+        this->_sequence.store(sequence + 2u, std::memory_order_release);
+      }
+
+    private:
+      // wait until no other writer, then make sequence odd (lock)
+      inline uint32_t _lockWriter() noexcept {
+        uint32_t retryCount = 0;
+        uint32_t sequence = this->_sequence.load(std::memory_order_relaxed);
+        while ((sequence & 1u) || !this->_sequence.compare_exchange_weak(sequence, sequence + 1u, std::memory_order_acquire, std::memory_order_relaxed)) {
+          if (++retryCount < _maxRelaxRetries)
+            cpuRelax();
+          else
+            std::this_thread::yield();
+          sequence = this->_sequence.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release); // odd sequence visible before value modifications
+        return sequence;
+      }
+
+      inline _DataType _readWords() const noexcept {
+        size_t buffer[_wordCount];
+        for (size_t i = 0; i < _wordCount; ++i)
+          buffer[i] = this->_words[i].load(std::memory_order_relaxed);
+        _DataType value;
+        memcpy((void*)&value, (const void*)buffer, sizeof(_DataType));
+        return value;
+      }
+      inline void _writeWords(const _DataType& value) noexcept {
+        size_t buffer[_wordCount];
+        buffer[_wordCount - 1u] = 0; // padding bytes
+        memcpy((void*)buffer, (const void*)&value, sizeof(_DataType));
+        for (size_t i = 0; i < _wordCount; ++i)
+          this->_words[i].store(buffer[i], std::memory_order_relaxed);
+      }
+
+    private:
+      static constexpr size_t _wordCount = (sizeof(_DataType) + sizeof(size_t) - 1u) / sizeof(size_t);
+      static constexpr uint32_t _maxRelaxRetries = 64u;
+
+      std::atomic<uint32_t> _sequence{ 0 }; // odd value: write in progress
+      std::atomic<size_t> _words[_wordCount];
+    };
+
+  }
+}
@@ -0,0 +1,372 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include "./futex.h"
+
+namespace pandora {
+  namespace thread {
+    // wait between two lock attempts: CPU pauses with exponential backoff, then yield to other threads
+    inline void _sharedLockBackoff(uint32_t& backoff) noexcept {
+      if (backoff <= 64u) {
+        for (uint32_t i = 0; i < backoff; ++i)
+          cpuRelax();
+        backoff <<= 1;
+      }
+      else
+        std::this_thread::yield();
+    }
+
+    /// @class SharedSpinLock
+    /// @brief Reader-writer spin-lock: multiple readers (shared lock) or one writer (exclusive lock), with writer preference.
+    /// @description Synchronization primitive for data read very often and rarely modified:
+    ///              - readers can own the lock simultaneously (lockShared/unlockShared): one atomic operation each, no system call;
+    ///              - a writer owns the lock exclusively (lock/unlock);
+    ///              - writer preference: when a writer is waiting, new readers wait too (writers can't be starved by readers).
+    ///              Compatible with std::unique_lock (exclusive) and std::shared_lock (shared).
+    /// @remarks All readers share one counter: with many cores and very short read sections, prefer StripedSharedSpinLock.
+    /// @warning Shared locks are not recursive: a reader must not call lockShared() again while owning it (deadlock if a writer is waiting).
+    class SharedSpinLock final {
+    public:
+      /// @brief Create an new unlocked instance
+      SharedSpinLock() noexcept {}
+      SharedSpinLock(const SharedSpinLock&) = delete;
+      SharedSpinLock(SharedSpinLock&&) = delete;
+      SharedSpinLock& operator=(const SharedSpinLock&) = delete;
+      SharedSpinLock& operator=(SharedSpinLock&&) = delete;
+
+      // -- exclusive lock (writer) --
+
+      /// @brief Wait until object unlocked (no reader, no writer), then lock it exclusively
+      inline void lock() noexcept {
+        if (!tryLock()) {
+          this->_pendingWriters.fetch_add(1u, std::memory_order_relaxed); // block new readers
+          uint32_t backoff = 1u;
+          while (!tryLock())
+            _sharedLockBackoff(backoff);
+          this->_pendingWriters.fetch_sub(1u, std::memory_order_relaxed);
+        }
+      }
+      /// @brief Only lock the object exclusively if there's no need to wait (no reader, no writer)
+      /// @returns True on lock success, false if already locked
+      inline bool tryLock() noexcept {
+        uint32_t expected = 0;
+        return (this->_status.load(std::memory_order_relaxed) == 0
+             && this->_status.compare_exchange_strong(expected, _writerBit, std::memory_order_acquire, std::memory_order_relaxed));
+      }
+      inline bool try_lock() noexcept { return tryLock(); } // STL-compliant version
+
+      /// @brief Unlock exclusive lock
+      /// @warning Should only be called after having called lock() (by the thread that currently owns the object).
+      inline void unlock() noexcept {
+        this->_status.store(0, std::memory_order_release);
+      }
+
+      /// @brief Only wait until a specific time-point for the object to be locked exclusively.
+      /// @returns True on lock success, false if timeout
+      template <typename _ClockType, typename _DurationType>
+      inline bool tryLockUntil(const std::chrono::time_point<_ClockType, _DurationType>& timeoutTimePoint) noexcept {
+        if (tryLock())
+          return true;
+        this->_pendingWriters.fetch_add(1u, std::memory_order_relaxed);
+        bool isLocked;
+        uint32_t backoff = 1u;
+        while (!(isLocked = tryLock()) && _ClockType::now() <= timeoutTimePoint)
+          _sharedLockBackoff(backoff);
+        this->_pendingWriters.fetch_sub(1u, std::memory_order_relaxed);
+        return isLocked;
+      }
+      template <typename _ClockType, typename _DurationType>
+      inline bool try_lock_until(const std::chrono::time_point<_ClockType, _DurationType>& timeoutTimePoint) noexcept { return tryLockUntil(timeoutTimePoint); } // STL-compliant version
+      /// @brief Only wait for a specific period for the object to be locked exclusively.
+      /// @returns True on lock success, false if timeout
+      template <typename _RepetitionType, typename _PeriodType>
+      inline bool tryLock(const std::chrono::duration<_RepetitionType, _PeriodType>& retryDuration) noexcept {
+        return tryLockUntil(std::chrono::steady_clock::now() + retryDuration);
+      }
+      template <typename _RepetitionType, typename _PeriodType>
+      inline bool try_lock_for(const std::chrono::duration<_RepetitionType, _PeriodType>& retryDuration) noexcept { return tryLock(retryDuration); } // STL-compliant version
+
+      // -- shared lock (reader) --
+
+      /// @brief Wait until no writer owns/waits for the object, then lock it in shared mode
+      inline void lockShared() noexcept {
+        uint32_t backoff = 1u;
+        while (!tryLockShared())
+          _sharedLockBackoff(backoff);
+      }
+      inline void lock_shared() noexcept { lockShared(); } // STL-compliant version
+
+      /// @brief Only lock the object in shared mode if there's no need to wait (no writer owning/waiting for the lock)
+      /// @returns True on lock success, false if a writer owns (or is waiting for) the object
+      inline bool tryLockShared() noexcept {
+        uint32_t status = this->_status.load(std::memory_order_relaxed);
+        while ((status & _writerBit) == 0 && this->_pendingWriters.load(std::memory_order_relaxed) == 0) {
+          if (this->_status.compare_exchange_weak(status, status + 1u, std::memory_order_acquire, std::memory_order_relaxed))
+            return true;
+        }
+        return false;
+      }
+      inline bool try_lock_shared() noexcept { return tryLockShared(); } // STL-compliant version
+
+      /// @brief Unlock shared lock
+      /// @warning Should only be called after having called lockShared() (by a thread that currently owns a shared lock).
+      inline void unlockShared() noexcept {
+        this->_status.fetch_sub(1u, std::memory_order_release);
+      }
+      inline void unlock_shared() noexcept { unlockShared(); } // STL-compliant version
+
+      /// @brief Only wait until a specific time-point for the object to be locked in shared mode.
+      /// @returns True on lock success, false if timeout
+      template <typename _ClockType, typename _DurationType>
+      inline bool tryLockSharedUntil(const std::chrono::time_point<_ClockType, _DurationType>& timeoutTimePoint) noexcept {
+        uint32_t backoff = 1u;
+        while (!tryLockShared()) {
+          if (_ClockType::now() > timeoutTimePoint)
+            return false;
+          _sharedLockBackoff(backoff);
+        }
+        return true;
+      }
+      template <typename _ClockType, typename _DurationType>
+      inline bool try_lock_shared_until(const std::chrono::time_point<_ClockType, _DurationType>& timeoutTimePoint) noexcept { return tryLockSharedUntil(timeoutTimePoint); } // STL-compliant version
+      /// @brief Only wait for a specific period for the object to be locked in shared mode.
+      /// @returns True on lock success, false if timeout
+      template <typename _RepetitionType, typename _PeriodType>
+      inline bool tryLockShared(const std::chrono::duration<_RepetitionType, _PeriodType>& retryDuration) noexcept {
+        return tryLockSharedUntil(std::chrono::steady_clock::now() + retryDuration);
+      }
+      template <typename _RepetitionType, typename _PeriodType>
+      inline bool try_lock_shared_for(const std::chrono::duration<_RepetitionType, _PeriodType>& retryDuration) noexcept { return tryLockShared(retryDuration); } // STL-compliant version
+
+      // -- lock status --
+
+      /// @brief Check whether the object is locked exclusively (writer)
+      inline bool isLocked() const noexcept { return (this->_status.load(std::memory_order_relaxed) == _writerBit); }
+      /// @brief Get number of readers currently owning a shared lock
+      inline uint32_t readerCount() const noexcept {
+        uint32_t status = this->_status.load(std::memory_order_relaxed);
+        return (status != _writerBit) ? status : 0;
+      }
+
+    private:
+      static constexpr uint32_t _writerBit = 0x80000000u; // exclusive lock (other bits: reader count)
+
+      std::atomic<uint32_t> _status{ 0 };
+      std::atomic<uint32_t> _pendingWriters{ 0 };
+    };
+
+    // ---
+
+    /// @class StripedSharedSpinLock
+    /// @brief Reader-writer spin-lock with reader counters distributed in multiple cache lines ('stripes'), with writer preference.
+    /// @description Same usage as SharedSpinLock, designed for data read millions of times per second from many cores:
+    ///              - each thread uses its own stripe counter (threads distributed round-robin among stripes):
+    ///                readers running on different cores don't invalidate a shared cache line on each lock/unlock;
+    ///              - a writer sets a flag (new readers back off), then waits until all stripe counters are empty.
+    ///              Compatible with std::unique_lock (exclusive) and std::shared_lock (shared).
+    /// @remarks Exclusive locks are more expensive (all stripes are checked), and the instance size is _StripeCount cache lines:
+    ///          only recommended for data that is rarely written.
+    /// @warning - A shared lock must be unlocked by the thread that locked it (the stripe depends on the calling thread).
+    ///          - Shared locks are not recursive (deadlock if a writer is waiting).
+    template <uint32_t _StripeCount = 16u>
+    class StripedSharedSpinLock final {
+    public:
+      static_assert(_StripeCount > 0u, "StripedSharedSpinLock: at least one stripe required");
+
+      /// @brief Create an new unlocked instance
+      StripedSharedSpinLock() noexcept {}
+      StripedSharedSpinLock(const StripedSharedSpinLock&) = delete;
+      StripedSharedSpinLock(StripedSharedSpinLock&&) = delete;
+      StripedSharedSpinLock& operator=(const StripedSharedSpinLock&) = delete;
+      StripedSharedSpinLock& operator=(StripedSharedSpinLock&&) = delete;
+
+      // -- exclusive lock (writer) --
+
+      /// @brief Wait until object unlocked (no reader, no writer), then lock it exclusively
+      inline void lock() noexcept {
+        uint32_t backoff = 1u;
+        while (!_setWriterFlag())
+          _sharedLockBackoff(backoff);
+        backoff = 1u;
+        while (!_isReaderFree())
+          _sharedLockBackoff(backoff);
+      }
+      /// @brief Only lock the object exclusively if there's no need to wait (no reader, no writer)
+      /// @returns True on lock success, false if already locked
+      inline bool tryLock() noexcept {
+        if (!_setWriterFlag())
+          return false;
+        if (_isReaderFree())
+          return true;
+        this->_writer.store(0, std::memory_order_release);
+        return false;
+      }
+      inline bool try_lock() noexcept { return tryLock(); } // STL-compliant version
+
+      /// @brief Unlock exclusive lock
+      /// @warning Should only be called after having called lock() (by the thread that currently owns the object).
+      inline void unlock() noexcept {
+        this->_writer.store(0, std::memory_order_release);
+      }
+
+      /// @brief Only wait until a specific time-point for the object to be locked exclusively.
+      /// @returns True on lock success, false if timeout
+      template <typename _ClockType, typename _DurationType>
+      inline bool tryLockUntil(const std::chrono::time_point<_ClockType, _DurationType>& timeoutTimePoint) noexcept {
+        uint32_t backoff = 1u;
+        while (!_setWriterFlag()) {
+          if (_ClockType::now() > timeoutTimePoint)
+            return false;
+          _sharedLockBackoff(backoff);
+        }
+        backoff = 1u;
+        while (!_isReaderFree()) {
+          if (_ClockType::now() > timeoutTimePoint) {
+            this->_writer.store(0, std::memory_order_release); // let readers continue
+            return false;
+          }
+          _sharedLockBackoff(backoff);
+        }
+        return true;
+      }
+      template <typename _ClockType, typename _DurationType>
+      inline bool try_lock_until(const std::chrono::time_point<_ClockType, _DurationType>& timeoutTimePoint) noexcept { return tryLockUntil(timeoutTimePoint); } // STL-compliant version
+      /// @brief Only wait for a specific period for the object to be locked exclusively.
+      /// @returns True on lock success, false if timeout
+      template <typename _RepetitionType, typename _PeriodType>
+      inline bool tryLock(const std::chrono::duration<_RepetitionType, _PeriodType>& retryDuration) noexcept {
+        return tryLockUntil(std::chrono::steady_clock::now() + retryDuration);
+      }
+      template <typename _RepetitionType, typename _PeriodType>
+      inline bool try_lock_for(const std::chrono::duration<_RepetitionType, _PeriodType>& retryDuration) noexcept { return tryLock(retryDuration); } // STL-compliant version
+
+      // -- shared lock (reader) --
+
+      /// @brief Wait until no writer owns/waits for the object, then lock it in shared mode
+      inline void lockShared() noexcept {
+        Stripe& stripe = this->_stripes[_currentStripe()];
+        while (!_tryLockStripe(stripe)) {
+          uint32_t backoff = 1u;
+          while (this->_writer.load(std::memory_order_relaxed) != 0)
+            _sharedLockBackoff(backoff);
+        }
+      }
+      inline void lock_shared() noexcept { lockShared(); } // STL-compliant version
+
+      /// @brief Only lock the object in shared mode if there's no need to wait (no writer owning/waiting for the lock)
+      /// @returns True on lock success, false if a writer owns (or is waiting for) the object
+      inline bool tryLockShared() noexcept {
+        return _tryLockStripe(this->_stripes[_currentStripe()]);
+      }
+      inline bool try_lock_shared() noexcept { return tryLockShared(); } // STL-compliant version
+
+      /// @brief Unlock shared lock
+      /// @warning Should only be called after having called lockShared() (by the same thread).
+      inline void unlockShared() noexcept {
+        this->_stripes[_currentStripe()].readers.fetch_sub(1u, std::memory_order_release);
+      }
+      inline void unlock_shared() noexcept { unlockShared(); } // STL-compliant version
+
+      /// @brief Only wait until a specific time-point for the object to be locked in shared mode.
+      /// @returns True on lock success, false if timeout
+      template <typename _ClockType, typename _DurationType>
+      inline bool tryLockSharedUntil(const std::chrono::time_point<_ClockType, _DurationType>& timeoutTimePoint) noexcept {
+        Stripe& stripe = this->_stripes[_currentStripe()];
+        uint32_t backoff = 1u;
+        while (!_tryLockStripe(stripe)) {
+          if (_ClockType::now() > timeoutTimePoint)
+            return false;
+          _sharedLockBackoff(backoff);
+        }
+        return true;
+      }
+      template <typename _ClockType, typename _DurationType>
+      inline bool try_lock_shared_until(const std::chrono::time_point<_ClockType, _DurationType>& timeoutTimePoint) noexcept { return tryLockSharedUntil(timeoutTimePoint); } // STL-compliant version
+      /// @brief Only wait for a specific period for the object to be locked in shared mode.
+      /// @returns True on lock success, false if timeout
+      template <typename _RepetitionType, typename _PeriodType>
+      inline bool tryLockShared(const std::chrono::duration<_RepetitionType, _PeriodType>& retryDuration) noexcept {
+        return tryLockSharedUntil(std::chrono::steady_clock::now() + retryDuration);
+      }
+      template <typename _RepetitionType, typename _PeriodType>
+      inline bool try_lock_shared_for(const std::chrono::duration<_RepetitionType, _PeriodType>& retryDuration) noexcept { return tryLockShared(retryDuration); } // STL-compliant version
+
+      // -- lock status --
+
+      /// @brief Check whether the object is locked exclusively (or a writer is waiting for readers to leave)
+      inline bool isLocked() const noexcept { return (this->_writer.load(std::memory_order_relaxed) != 0); }
+      /// @brief Get number of readers currently owning a shared lock (approximation: sum of stripes)
+      inline uint32_t readerCount() const noexcept {
+        uint32_t count = 0;
+        for (const Stripe& stripe : this->_stripes)
+          count += stripe.readers.load(std::memory_order_relaxed);
+        return count;
+      }
+      /// @brief Get number of reader stripes
+      static constexpr inline uint32_t stripeCount() noexcept { return _StripeCount; }
+
+    private:
+      struct alignas(64) Stripe final {
+        std::atomic<uint32_t> readers{ 0 };
+      };
+
+      // stripe of current thread (distributed round-robin when threads use it for the first time)
+      static inline uint32_t _currentStripe() noexcept {
+        static std::atomic<uint32_t> nextStripe{ 0 };
+        thread_local uint32_t stripeIndex = nextStripe.fetch_add(1u, std::memory_order_relaxed) % _StripeCount;
+        return stripeIndex;
+      }
+
+      // register reader, then verify that no writer is active (seq_cst: see '_isReaderFree')
+      inline bool _tryLockStripe(Stripe& stripe) noexcept {
+        if (this->_writer.load(std::memory_order_relaxed) == 0) {
+          stripe.readers.fetch_add(1u, std::memory_order_seq_cst);
+          if (this->_writer.load(std::memory_order_seq_cst) == 0)
+            return true;
+          stripe.readers.fetch_sub(1u, std::memory_order_release); // writer arrived -> back off
+        }
+        return false;
+      }
+      inline bool _setWriterFlag() noexcept {
+        uint32_t expected = 0;
+        return (this->_writer.load(std::memory_order_relaxed) == 0
+             && this->_writer.compare_exchange_strong(expected, 1u, std::memory_order_seq_cst, std::memory_order_relaxed));
+      }
+      // verify that all readers have left (after setting writer flag: readers registered later see the flag and back off)
+      inline bool _isReaderFree() const noexcept {
+        for (const Stripe& stripe : this->_stripes) {
+          if (stripe.readers.load(std::memory_order_seq_cst) != 0)
+            return false;
+        }
+        return true;
+      }
+
+    private:
+      alignas(64) std::atomic<uint32_t> _writer{ 0 };
+      Stripe _stripes[_StripeCount];
+    };
+
+  }
+}
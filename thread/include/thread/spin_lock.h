@@ -19,9 +19,11 @@ IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <thread>
 #include <atomic>
 #include <chrono>
+#include "./futex.h"
 
 namespace pandora {
   namespace thread {
@@ -91,6 +93,115 @@ namespace pandora {
     private:
       std::atomic_flag _status = ATOMIC_FLAG_INIT;
     };
+
+    // ---
+
+    /// @class AdaptiveSpinLock
+    /// @brief Synchronization primitive to protect data from being simultaneously accessed, adapted to contention.
+    /// @description Same usage as SpinLock, but designed to stay efficient under contention:
+    ///              - test-and-test-and-set: waiting threads spin on a relaxed load (shared cache line) instead of read-modify-write operations;
+    ///              - CPU pause instructions with exponential backoff between attempts (no system call while spinning);
+    ///              - after a spin budget, waiting threads sleep on a futex (woken up by 'unlock' only if some threads are sleeping).
+    ///              Uncontended lock/unlock only involve one atomic operation each.
+    /// @remarks Recommended when critical sections can be long or when there are more threads than CPU cores.
+    ///          For very short critical sections with few threads, SpinLock can be slightly faster.
+    class AdaptiveSpinLock final {
+    public:
+      /// @brief Create an new unlocked instance
+      AdaptiveSpinLock() noexcept {}
+      AdaptiveSpinLock(const AdaptiveSpinLock&) = delete;
+      AdaptiveSpinLock(AdaptiveSpinLock&&) = delete;
+      AdaptiveSpinLock& operator=(const AdaptiveSpinLock&) = delete;
+      AdaptiveSpinLock& operator=(AdaptiveSpinLock&&) = delete;
+
+      // -- simple lock management --
+
+      /// @brief Wait until object unlocked, then lock it
+      inline void lock() noexcept {
+        uint32_t expected = _unlocked;
+        if (!this->_status.compare_exchange_strong(expected, _locked, std::memory_order_acquire, std::memory_order_relaxed)) {
+          if (!_spinLock(_spinBudget)) {
+            uint32_t status = this->_status.exchange(_lockedWithSleepers, std::memory_order_acquire);
+            while (status != _unlocked) {
+              futexWait(this->_status, _lockedWithSleepers);
+              status = this->_status.exchange(_lockedWithSleepers, std::memory_order_acquire);
+            }
+          }
+        }
+      }
+
+      /// @brief Only lock the object if there's no need to wait (already unlocked)
+      /// @returns True on lock success, false if already locked by another owner
+      inline bool tryLock() noexcept {
+        uint32_t expected = _unlocked;
+        return (this->_status.load(std::memory_order_relaxed) == _unlocked
+             && this->_status.compare_exchange_strong(expected, _locked, std::memory_order_acquire, std::memory_order_relaxed));
+      }
+      inline bool try_lock() noexcept { return tryLock(); } // STL-compliant version
+
+      /// @brief Unlock the object (and wake up one sleeping thread, if any)
+      /// @warning Should only be called after having called lock() (by the thread that currently owns the object).
+      inline void unlock() noexcept {
+        if (this->_status.exchange(_unlocked, std::memory_order_release) == _lockedWithSleepers)
+          futexWake(this->_status, 1u);
+      }
+
+      // -- lock with timeout --
+
+      /// @brief Only wait for a specific period for the object to be unlocked.
+      /// @returns True on lock success, false if timeout
+      template <typename _RepetitionType, typename _PeriodType>
+      inline bool tryLock(const std::chrono::duration<_RepetitionType, _PeriodType>& retryDuration) noexcept {
+        if (!tryLock())
+          return tryLockUntil(std::chrono::time_point<std::chrono::steady_clock>(std::chrono::steady_clock::now() + retryDuration));
+        return true;
+      }
+      template <typename _RepetitionType, typename _PeriodType>
+      inline bool try_lock_for(const std::chrono::duration<_RepetitionType, _PeriodType>& retryDuration) noexcept { return tryLock(retryDuration); } // STL-compliant version
+
+      /// @brief Only wait until a specific time-point for the object to be unlocked.
+      /// @returns True on lock success, false if timeout
+      template <typename _ClockType, typename _DurationType>
+      inline bool tryLockUntil(const std::chrono::time_point<_ClockType, _DurationType>& timeoutTimePoint) noexcept {
+        if (_spinLock(_spinBudget))
+          return true;
+        uint32_t status = this->_status.exchange(_lockedWithSleepers, std::memory_order_acquire);
+        while (status != _unlocked) {
+          auto remainingTime = timeoutTimePoint - _ClockType::now();
+          if (remainingTime <= decltype(remainingTime)::zero())
+            return false; // status left with sleepers flag: at worst, one useless wake-up call on next unlock
+          futexWaitFor(this->_status, _lockedWithSleepers, remainingTime);
+          status = this->_status.exchange(_lockedWithSleepers, std::memory_order_acquire);
+        }
+        return true;
+      }
+      template <typename _ClockType, typename _DurationType>
+      inline bool try_lock_until(const std::chrono::time_point<_ClockType, _DurationType>& timeoutTimePoint) noexcept { return tryLockUntil(timeoutTimePoint); } // STL-compliant version
+
+    private:
+      // spin with exponential backoff, until locked or until spin budget is reached
+      inline bool _spinLock(uint32_t spinBudget) noexcept {
+        uint32_t backoff = 1u;
+        for (uint32_t spinCount = 0; spinCount < spinBudget; spinCount += backoff) {
+          if (tryLock())
+            return true;
+          for (uint32_t i = 0; i < backoff; ++i)
+            cpuRelax();
+          if (backoff < _maxBackoff)
+            backoff <<= 1;
+        }
+        return false;
+      }
+
+    private:
+      static constexpr uint32_t _unlocked = 0;
+      static constexpr uint32_t _locked = 1u;
+      static constexpr uint32_t _lockedWithSleepers = 2u; // locked + some threads may be sleeping on futex
+      static constexpr uint32_t _spinBudget = 2048u;      // number of pause instructions before sleeping
+      static constexpr uint32_t _maxBackoff = 64u;
+
+      std::atomic<uint32_t> _status{ _unlocked };
+    };
     
   }
 }
@@ -0,0 +1,355 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <exception>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <initializer_list>
+#include <algorithm>
+#include <utility>
+#include <system/trace.h>
+#include "./thread_pool.h"
+
+namespace pandora {
+  namespace thread {
+    class TaskGraph;
+
+    /// @brief Job parameter used to dispatch task graph nodes to a thread pool
+    struct TaskGraphJob final {
+      TaskGraph* graph = nullptr;
+      uint32_t node = 0;
+    };
+
+    /// @brief Timing report of the last execution of a task graph
+    struct TaskGraphReport final {
+      std::chrono::nanoseconds totalDuration{ 0 };        ///< Wall-clock duration of the run (first dispatch -> last node done)
+      std::chrono::nanoseconds criticalPathDuration{ 0 }; ///< Sum of the durations of the nodes in the critical path
+      std::vector<uint32_t> criticalPath;                 ///< Nodes of the longest dependency chain (from first to last node)
+      std::vector<std::chrono::nanoseconds> nodeDurations;///< Processing duration of each node (index = node ID)
+    };
+
+    // ---
+
+    /// @class TaskGraph
+    /// @brief Directed acyclic graph of tasks, executed by a thread pool in dependency order.
+    /// @description Nodes are declared with their predecessors: a node is dispatched to the pool as soon as all its predecessors are done
+    ///              (atomic dependency counters, no central scheduler). One ready successor is run directly by the worker that completed
+    ///              the last dependency (no queue round-trip), the other ready successors are inserted in the pool.
+    ///              The graph is built once and can then be run many times: after the first run (or after a call to build()),
+    ///              runs don't allocate any memory (except in the thread pool queue).
+    ///              After each run, a timing report provides the duration of each node and the critical path (longest chain of nodes).
+    /// @remarks - Compatible pools: any pool with a 'bool addJob(TaskGraphJob)' method and a common runner set to TaskGraph::processJob
+    ///            (ex: TaskGraph::Pool, or WorkStealingThreadPool/BoundedThreadPool with 'wait' mode and TaskGraphJob parameter).
+    ///          - If a task throws, the nodes that have not been started yet are skipped, and the first exception is rethrown by run().
+    /// @warning - A graph can't be modified or run again while it is running.
+    ///          - run() must not be called by a worker of the pool used to run the graph (deadlock if all workers wait).
+    class TaskGraph final {
+    public:
+      using Pool = ThreadPool<TaskGraphJob, ThreadRunnerMode::single, TaskRunnerType::functionPointer>;
+      using task_type = std::function<void()>;
+      using NodeId = uint32_t;
+
+      TaskGraph() = default;
+      TaskGraph(const TaskGraph&) = delete;
+      TaskGraph(TaskGraph&&) = delete;
+      TaskGraph& operator=(const TaskGraph&) = delete;
+      TaskGraph& operator=(TaskGraph&&) = delete;
+      ~TaskGraph() noexcept = default;
+
+      // -- graph definition --
+
+      /// @brief Number of nodes in the graph
+      inline size_t size() const noexcept { return this->_nodes.size(); }
+      /// @brief Get label of a node
+      inline const std::string& label(NodeId node) const { return this->_nodes.at(node).label; }
+
+      /// @brief Add a node (with optional predecessors: must already exist)
+      /// @returns ID of the new node (index in graph)
+      /// @throws - std::out_of_range if a predecessor doesn't exist
+      ///         - std::logic_error if the graph is running
+      NodeId addNode(task_type task, std::initializer_list<NodeId> predecessors = {}, std::string label = std::string{}) {
+        _verifyNotRunning();
+        for (auto predecessor : predecessors) {
+          if (predecessor >= this->_nodes.size())
+            throw std::out_of_range("TaskGraph: predecessor node not found");
+        }
+        NodeId node = static_cast<NodeId>(this->_nodes.size());
+        this->_nodes.emplace_back(std::move(task), std::move(label));
+        for (auto predecessor : predecessors)
+          _linkNodes(predecessor, node);
+        return node;
+      }
+      /// @brief Add a dependency between existing nodes ('successor' will only start when 'predecessor' is done)
+      /// @remarks Allows forward declarations. Cycles are detected by build()/run().
+      /// @throws - std::out_of_range if a node doesn't exist
+      ///         - std::logic_error if the graph is running
+      void addDependency(NodeId predecessor, NodeId successor) {
+        _verifyNotRunning();
+        if (predecessor >= this->_nodes.size() || successor >= this->_nodes.size())
+          throw std::out_of_range("TaskGraph: node not found");
+        _linkNodes(predecessor, successor);
+      }
+
+      /// @brief Remove all nodes
+      void clear() {
+        _verifyNotRunning();
+        this->_nodes.clear();
+        this->_isBuilt = false;
+      }
+
+      /// @brief Validate graph and pre-allocate execution data (optional: done by first run if not called)
+      /// @returns False if the graph contains a cycle
+      bool build() {
+        _verifyNotRunning();
+        if (this->_isBuilt)
+          return true;
+        const size_t nodeCount = this->_nodes.size();
+
+        // topological order (Kahn) -> cycle detection
+        this->_order.clear();
+        this->_order.reserve(nodeCount);
+        std::unique_ptr<std::atomic<uint32_t>[]> pendingDependencies(new std::atomic<uint32_t>[nodeCount > 0 ? nodeCount : 1u]);
+        for (NodeId node = 0; node < nodeCount; ++node) {
+          pendingDependencies[node].store(this->_nodes[node].predecessorCount, std::memory_order_relaxed);
+          if (this->_nodes[node].predecessorCount == 0u)
+            this->_order.emplace_back(node);
+        }
+        for (size_t i = 0; i < this->_order.size(); ++i) {
+          for (auto successor : this->_nodes[this->_order[i]].successors) {
+            if (pendingDependencies[successor].fetch_sub(1u, std::memory_order_relaxed) == 1u)
+              this->_order.emplace_back(successor);
+          }
+        }
+        if (this->_order.size() != nodeCount) {
+          this->_order.clear();
+          return false;
+        }
+
+        // execution data (reused by all runs)
+        this->_pendingDependencies = std::move(pendingDependencies);
+        this->_roots.clear();
+        for (NodeId node = 0; node < nodeCount; ++node) {
+          if (this->_nodes[node].predecessorCount == 0u)
+            this->_roots.emplace_back(node);
+        }
+        this->_startTimes.assign(nodeCount, clock_type::time_point{});
+        this->_endTimes.assign(nodeCount, clock_type::time_point{});
+        this->_pathDurations.assign(nodeCount, std::chrono::nanoseconds(0));
+        this->_pathPredecessors.assign(nodeCount, _noNode);
+        this->_report.nodeDurations.assign(nodeCount, std::chrono::nanoseconds(0));
+        this->_report.criticalPath.reserve(nodeCount);
+        this->_isBuilt = true;
+        return true;
+      }
+
+      // -- execution --
+
+      /// @brief Run all tasks of the graph in a thread pool, and wait until they're done
+      /// @returns False if the graph contains a cycle or if the pool is not running (nothing executed)
+      /// @throws - first exception thrown by a task (other tasks are skipped);
+      ///         - std::logic_error if the graph is already running.
+      template <typename _PoolType>
+      bool run(_PoolType& pool) {
+        if (!build() || pool.size() == 0)
+          return false;
+        if (this->_nodes.empty()) {
+          _resetReport();
+          return true;
+        }
+
+        // reset counters
+        for (NodeId node = 0; node < this->_nodes.size(); ++node)
+          this->_pendingDependencies[node].store(this->_nodes[node].predecessorCount, std::memory_order_relaxed);
+        this->_remainingNodes.store(static_cast<uint32_t>(this->_nodes.size()), std::memory_order_relaxed);
+        this->_hasFailed.store(false, std::memory_order_relaxed);
+        this->_error = nullptr;
+        this->_pool = &pool;
+        this->_dispatcher = &_dispatchToPool<_PoolType>;
+        this->_isRunning.store(true, std::memory_order_release);
+
+        // dispatch root nodes + wait for completion
+        this->_runStartTime = clock_type::now();
+        for (auto root : this->_roots) {
+          if (!pool.addJob(TaskGraphJob{ this, root }))
+            _processNode(root); // pool stopped -> process in current thread (graph must always be completed)
+        }
+        std::unique_lock<std::mutex> guard(this->_lock);
+        while (this->_isRunning.load(std::memory_order_acquire))
+          this->_condition.wait(guard);
+        guard.unlock();
+
+        _computeReport();
+        if (this->_error)
+          std::rethrow_exception(this->_error);
+        return true;
+      }
+
+      /// @brief Timing report of the last run
+      inline const TaskGraphReport& lastReport() const noexcept { return this->_report; }
+
+      /// @brief Common task runner to use in thread pools running task graphs
+      static void processJob(TaskGraphJob& job) noexcept {
+        job.graph->_processNode(job.node);
+      }
+
+    private:
+      using clock_type = std::chrono::steady_clock;
+      static constexpr NodeId _noNode = 0xFFFFFFFFu;
+
+      struct Node final {
+        task_type task;
+        std::string label;
+        std::vector<NodeId> successors;
+        uint32_t predecessorCount = 0;
+        Node(task_type&& task, std::string&& label) : task(std::move(task)), label(std::move(label)) {}
+      };
+
+      inline void _verifyNotRunning() const {
+        if (this->_isRunning.load(std::memory_order_acquire))
+          throw std::logic_error("TaskGraph: graph is running");
+      }
+      inline void _linkNodes(NodeId predecessor, NodeId successor) {
+        this->_nodes[predecessor].successors.emplace_back(successor);
+        ++(this->_nodes[successor].predecessorCount);
+        this->_isBuilt = false;
+      }
+
+      template <typename _PoolType>
+      static bool _dispatchToPool(void* pool, TaskGraphJob job) {
+        return static_cast<_PoolType*>(pool)->addJob(job);
+      }
+
+      // -- node processing --
+
+      // run node task, then release successors (the last ready successor is processed directly by current thread)
+      void _processNode(NodeId node) noexcept {
+        while (node != _noNode) {
+          Node& nodeData = this->_nodes[node];
+          this->_startTimes[node] = clock_type::now();
+          if (!this->_hasFailed.load(std::memory_order_acquire)) {
+            try {
+              nodeData.task();
+            }
+            catch (...) {
+              std::lock_guard<std::mutex> guard(this->_lock);
+              if (!this->_error)
+                this->_error = std::current_exception();
+              this->_hasFailed.store(true, std::memory_order_release);
+              TRACE("TaskGraph: exception thrown by task - remaining tasks skipped");
+            }
+          }
+          this->_endTimes[node] = clock_type::now();
+
+          NodeId nextNode = _noNode;
+          for (auto successor : nodeData.successors) {
+            if (this->_pendingDependencies[successor].fetch_sub(1u, std::memory_order_acq_rel) == 1u) {
+              if (nextNode != _noNode) {
+                if (!this->_dispatcher(this->_pool, TaskGraphJob{ this, nextNode }))
+                  _processNode(nextNode); // pool stopped -> process in current thread
+              }
+              nextNode = successor;
+            }
+          }
+
+          if (this->_remainingNodes.fetch_sub(1u, std::memory_order_acq_rel) == 1u) {
+            std::lock_guard<std::mutex> guard(this->_lock);
+            this->_isRunning.store(false, std::memory_order_release);
+            this->_condition.notify_all();
+          }
+          node = nextNode;
+        }
+      }
+
+      // -- timing report --
+
+      void _resetReport() noexcept {
+        this->_report.totalDuration = std::chrono::nanoseconds(0);
+        this->_report.criticalPathDuration = std::chrono::nanoseconds(0);
+        this->_report.criticalPath.clear();
+      }
+
+      // compute node durations + longest path (in topological order) - no allocation (pre-allocated by build)
+      void _computeReport() noexcept {
+        _resetReport();
+        clock_type::time_point lastEndTime = this->_runStartTime;
+        for (NodeId node = 0; node < this->_nodes.size(); ++node) {
+          this->_report.nodeDurations[node] = std::chrono::duration_cast<std::chrono::nanoseconds>(this->_endTimes[node] - this->_startTimes[node]);
+          this->_pathDurations[node] = std::chrono::nanoseconds(0);
+          this->_pathPredecessors[node] = _noNode;
+          if (this->_endTimes[node] > lastEndTime)
+            lastEndTime = this->_endTimes[node];
+        }
+        this->_report.totalDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(lastEndTime - this->_runStartTime);
+
+        NodeId lastNode = _noNode;
+        for (auto node : this->_order) { // path duration = longest predecessor path + own duration
+          this->_pathDurations[node] += this->_report.nodeDurations[node];
+          if (lastNode == _noNode || this->_pathDurations[node] > this->_pathDurations[lastNode])
+            lastNode = node;
+          for (auto successor : this->_nodes[node].successors) {
+            if (this->_pathPredecessors[successor] == _noNode || this->_pathDurations[node] > this->_pathDurations[successor]) {
+              this->_pathDurations[successor] = this->_pathDurations[node];
+              this->_pathPredecessors[successor] = node;
+            }
+          }
+        }
+        this->_report.criticalPathDuration = this->_pathDurations[lastNode];
+        for (NodeId node = lastNode; node != _noNode; node = this->_pathPredecessors[node])
+          this->_report.criticalPath.emplace_back(node);
+        std::reverse(this->_report.criticalPath.begin(), this->_report.criticalPath.end());
+      }
+
+    private:
+      std::vector<Node> _nodes;
+      std::vector<NodeId> _roots;
+      std::vector<NodeId> _order; // topological order
+      bool _isBuilt = false;
+
+      // execution data
+      std::unique_ptr<std::atomic<uint32_t>[]> _pendingDependencies;
+      std::atomic<uint32_t> _remainingNodes{ 0 };
+      std::atomic<bool> _hasFailed{ false };
+      std::atomic<bool> _isRunning{ false };
+      std::exception_ptr _error;
+      void* _pool = nullptr;
+      bool (*_dispatcher)(void*, TaskGraphJob) = nullptr;
+      std::mutex _lock;
+      std::condition_variable _condition;
+
+      // timing data
+      clock_type::time_point _runStartTime;
+      std::vector<clock_type::time_point> _startTimes;
+      std::vector<clock_type::time_point> _endTimes;
+      std::vector<std::chrono::nanoseconds> _pathDurations;
+      std::vector<NodeId> _pathPredecessors;
+      TaskGraphReport _report;
+    };
+
+  }
+}
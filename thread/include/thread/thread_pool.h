@@ -19,10 +19,12 @@ IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <cassert>
 #include <stdexcept>
 #include <vector>
 #include <queue>
+#include <iterator>
 #include <memory>
 #include <thread>
 #include <mutex>
@@ -31,6 +33,9 @@ IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <utility>
 #include <type_traits>
 #include <system/trace.h>
+#include "./job_result.h"
+#include "./job_group.h"
+#include "./pool_metrics.h"
 
 namespace pandora {
   namespace thread {
@@ -52,34 +57,77 @@ namespace pandora {
     /// @description Simple pool of threads with a pre-defined size.
     ///              The threads are ready to process some jobs asynchronously, without needing to be created (they already exist).
     ///              The tasks will be started by any thread in the pool in the order of their arrival.
+    /// @remarks - Jobs can be inserted in a JobGroup ('addJob(group, ...)'), to wait for them or to cancel them together.
+    ///          - Instrumentation (queue latency, run time, utilization...) can be enabled with the PoolMetrics policy:
+    ///            'pool.metrics().snapshot()'. The default policy (NoPoolMetrics) has no overhead.
     template <typename _JobParamType,                        // Type of data container to process (must be movable)
               ThreadRunnerMode _Mode = ThreadRunnerMode::single, // one function passed on construction / one per job
-              TaskRunnerType _FunctionType = TaskRunnerType::functionPointer> // function pointer / lambda
+              TaskRunnerType _FunctionType = TaskRunnerType::functionPointer, // function pointer / lambda
+              typename _Metrics = NoPoolMetrics> // instrumentation policy: NoPoolMetrics / PoolMetrics
     class ThreadPool final {
     public:
-      using Type = ThreadPool<_JobParamType,_Mode,_FunctionType>;
+      using Type = ThreadPool<_JobParamType,_Mode,_FunctionType,_Metrics>;
+      using metrics_type = _Metrics;
       using size_type = size_t;
       using task_runner_type = typename std::conditional<_FunctionType == TaskRunnerType::lambda, std::function<void(_JobParamType&)>, void (*)(_JobParamType&)>::type;
       using task_runner_move = typename std::conditional<_FunctionType == TaskRunnerType::lambda, task_runner_type&&, task_runner_type>::type;
     protected:
       template<bool cond, typename _T>
       using EnableIf = typename std::enable_if<cond, _T>::type;
+      template<typename _Operation>
+      using OperationResult = typename std::decay<decltype(std::declval<_Operation&>()(std::declval<_JobParamType&>()))>::type;
 
       using job_param_move = typename std::conditional<std::is_class<_JobParamType>::value, _JobParamType&&, _JobParamType>::type;
-      struct JobParamWithRunner { // Job data in 'perJob' mode (parameter + custom runner)
+
+      // optional result slot OR group of a job (tagged pointer: plain jobs only store a null value)
+      class JobLink final {
+      public:
+        JobLink() noexcept = default;
+        explicit JobLink(JobResultSlot* result) noexcept : _value(reinterpret_cast<uintptr_t>(result)) {}
+        explicit JobLink(JobGroupState* group) noexcept : _value(reinterpret_cast<uintptr_t>(group) | _groupTag) {}
+
+        inline bool empty() const noexcept { return (this->_value == 0); }
+        inline JobResultSlot* result() const noexcept {
+          return ((this->_value & _groupTag) == 0) ? reinterpret_cast<JobResultSlot*>(this->_value) : nullptr;
+        }
+        inline JobGroupState* group() const noexcept {
+          return ((this->_value & _groupTag) != 0) ? reinterpret_cast<JobGroupState*>(this->_value & ~_groupTag) : nullptr;
+        }
+      private:
+        static constexpr uintptr_t _groupTag = 0x1u;
+        static_assert(alignof(JobResultSlot) > 1u && alignof(JobGroupState) > 1u, "ThreadPool.JobLink: pointer tag requires aligned types");
+        uintptr_t _value = 0;
+      };
+
+      struct JobParamWithRunner : _Metrics::JobStamp { // Job data in 'perJob' mode (parameter + custom runner + optional result/group)
         _JobParamType param;
         task_runner_type runner;
-        JobParamWithRunner(job_param_move param) : param(std::move(param)), runner(nullptr) {}
-        JobParamWithRunner(job_param_move param, task_runner_move runner) : param(std::move(param)), runner(std::move(runner)) {}
+        JobLink link;
+        JobParamWithRunner(job_param_move param, JobResultSlot* result = nullptr) : param(std::move(param)), runner(nullptr), link(result) {}
+        JobParamWithRunner(job_param_move param, task_runner_move runner, JobResultSlot* result = nullptr)
+          : param(std::move(param)), runner(std::move(runner)), link(result) {}
       };
-      using job_item = typename std::conditional<(_Mode == ThreadRunnerMode::perJob), JobParamWithRunner, _JobParamType>::type;
+      struct JobParamWithResult : _Metrics::JobStamp { // Job data in 'single' mode (parameter + optional result/group)
+        _JobParamType param;
+        JobLink link;
+        JobParamWithResult(job_param_move param, JobResultSlot* result = nullptr) : param(std::move(param)), link(result) {}
+      };
+      using job_item = typename std::conditional<(_Mode == ThreadRunnerMode::perJob), JobParamWithRunner, JobParamWithResult>::type;
 
       struct SharedPoolData { // Synchronization & jobs data - shared with child threads
         bool isRunning = false;
         size_t busyThreads = 0u;
         std::queue<job_item> jobs;
+        JobResultSlab* results = nullptr; // created on first 'submit' call
+        _Metrics metrics;
         mutable std::mutex lock;
         std::condition_variable condition;
+
+        SharedPoolData() = default;
+        ~SharedPoolData() noexcept {
+          if (results != nullptr)
+            results->releaseOwner();
+        }
       };
 
     public:
@@ -122,6 +170,13 @@ namespace pandora {
       /// @brief Number of threads waiting in the pool (ready for new jobs)
       inline size_type freeThreads() const noexcept { std::lock_guard<std::mutex> guard(this->_poolData->lock); return size() - this->_poolData->busyThreads; }
 
+      // -- instrumentation --
+
+      /// @brief Pool metrics: read them with 'metrics().snapshot()' (empty snapshot with NoPoolMetrics policy)
+      inline const _Metrics& metrics() const noexcept { return this->_poolData->metrics; }
+      /// @brief Reset pool metrics (start new measurement period)
+      inline void resetMetrics() noexcept { this->_poolData->metrics.reset(); }
+
       // -- job management --
 
       /// @brief Insert a new job to process (copied) - custom task runner for each job (not available in 'single' runner mode)
@@ -130,8 +185,10 @@ namespace pandora {
                       bool> addJob(const _JobParamType& param, task_runner_move runner) {
         std::unique_lock<std::mutex> guard(this->_poolData->lock);
         bool isSuccess = (this->_poolData->isRunning);
-        if (isSuccess)
+        if (isSuccess) {
           this->_poolData->jobs.emplace(_JobParamType(param), std::move(runner));
+          _onJobInserted();
+        }
         guard.unlock();
 
         this->_poolData->condition.notify_one();
@@ -143,8 +200,10 @@ namespace pandora {
                       bool> addJob(_JobParamType&& param, task_runner_move runner) {
         std::unique_lock<std::mutex> guard(this->_poolData->lock);
         bool isSuccess = (this->_poolData->isRunning);
-        if (isSuccess)
+        if (isSuccess) {
           this->_poolData->jobs.emplace(std::move(param), std::move(runner));
+          _onJobInserted();
+        }
         guard.unlock();
 
         this->_poolData->condition.notify_one();
@@ -157,8 +216,10 @@ namespace pandora {
                       bool> addJob(const _JobParamType& param) {
         std::unique_lock<std::mutex> guard(this->_poolData->lock);
         bool isSuccess = (this->_poolData->isRunning);
-        if (isSuccess)
+        if (isSuccess) {
           this->_poolData->jobs.emplace(_JobParamType(param));
+          _onJobInserted();
+        }
         guard.unlock();
 
         this->_poolData->condition.notify_one();
@@ -168,27 +229,287 @@ namespace pandora {
       inline bool addJob(_JobParamType&& param) {
         std::unique_lock<std::mutex> guard(this->_poolData->lock);
         bool isSuccess = (this->_poolData->isRunning);
-        if (isSuccess)
+        if (isSuccess) {
           this->_poolData->jobs.emplace(std::move(param));
+          _onJobInserted();
+        }
         guard.unlock();
 
         this->_poolData->condition.notify_one();
         return isSuccess;
       }
 
+      /// @brief Insert multiple jobs to process (copied/moved from iterator range) - use common task runner provided in constructor
+      /// @remarks Jobs are all inserted with one lock, and only the required number of threads is awakened.
+      ///          To move the values instead of copying them, use std::make_move_iterator.
+      /// @returns False if the pool is not running (no job inserted)
+      template<typename _Iterator>
+      inline bool addJobs(_Iterator first, _Iterator last) {
+        std::unique_lock<std::mutex> guard(this->_poolData->lock);
+        if (!this->_poolData->isRunning)
+          return false;
+        size_t jobCount = 0;
+        try {
+          for (; first != last; ++first, ++jobCount) {
+            this->_poolData->jobs.emplace(_JobParamType(*first));
+            _onJobInserted();
+          }
+        }
+        catch (...) { // keep jobs already inserted
+          guard.unlock();
+          this->_poolData->condition.notify_all();
+          throw;
+        }
+        size_t idleThreads = size() - this->_poolData->busyThreads;
+        guard.unlock();
+
+        _notifyThreads((jobCount < idleThreads) ? jobCount : idleThreads);
+        return true;
+      }
+      /// @brief Insert multiple jobs to process (moved) - use common task runner provided in constructor
+      /// @remarks Jobs are all inserted with one lock, and only the required number of threads is awakened.
+      /// @returns False if the pool is not running (no job inserted)
+      inline bool addJobs(std::vector<_JobParamType>&& params) {
+        bool isSuccess = addJobs(std::make_move_iterator(params.begin()), std::make_move_iterator(params.end()));
+        if (isSuccess)
+          params.clear();
+        return isSuccess;
+      }
+
+      // -- job management with group --
+
+      /// @brief Insert a new job to process (copied/moved) in a group - use common task runner provided in constructor
+      /// @returns False if the pool is not running or if the group is cancelled (job not inserted)
+      template<typename J = _JobParamType>
+      inline EnableIf<!std::is_class<J>::value || std::is_copy_constructible<J>::value,
+                      bool> addJob(JobGroup& group, const _JobParamType& param) {
+        return _pushGroupJob(group, _JobParamType(param));
+      }
+      inline bool addJob(JobGroup& group, _JobParamType&& param) {
+        return _pushGroupJob(group, std::move(param));
+      }
+      /// @brief Insert a new job to process (copied/moved) in a group - custom task runner for each job (not available in 'single' runner mode)
+      /// @returns False if the pool is not running or if the group is cancelled (job not inserted)
+      template<typename J = _JobParamType, ThreadRunnerMode M = _Mode>
+      inline EnableIf<(!std::is_class<J>::value || std::is_copy_constructible<J>::value) && M == ThreadRunnerMode::perJob,
+                      bool> addJob(JobGroup& group, const _JobParamType& param, task_runner_move runner) {
+        return _pushGroupJob(group, _JobParamType(param), std::move(runner));
+      }
+      template<ThreadRunnerMode M = _Mode>
+      inline EnableIf<M == ThreadRunnerMode::perJob,
+                      bool> addJob(JobGroup& group, _JobParamType&& param, task_runner_move runner) {
+        return _pushGroupJob(group, std::move(param), std::move(runner));
+      }
+
+      /// @brief Insert multiple jobs to process (copied/moved from iterator range) in a group - use common task runner provided in constructor
+      /// @remarks Jobs are all inserted with one lock, and only the required number of threads is awakened.
+      /// @returns False if the pool is not running or if the group is cancelled (no job inserted),
+      ///          or if the group is cancelled during insertion (only the first jobs of the range may have been queued).
+      template<typename _Iterator>
+      inline bool addJobs(JobGroup& group, _Iterator first, _Iterator last) {
+        JobGroupState* state = group.state();
+        std::unique_lock<std::mutex> guard(this->_poolData->lock);
+        if (!this->_poolData->isRunning || state == nullptr || state->isCancelled())
+          return false;
+        size_t jobCount = 0;
+        try {
+          for (; first != last && state->registerJob(); ++first, ++jobCount) {
+            try {
+              this->_poolData->jobs.emplace(_JobParamType(*first));
+            }
+            catch (...) { state->dropQueuedJob(); throw; }
+            _attachGroup(*state);
+          }
+        }
+        catch (...) { // keep jobs already inserted
+          guard.unlock();
+          this->_poolData->condition.notify_all();
+          throw;
+        }
+        size_t idleThreads = size() - this->_poolData->busyThreads;
+        guard.unlock();
+
+        _notifyThreads((jobCount < idleThreads) ? jobCount : idleThreads);
+        return (first == last); // false if cancelled during insertion
+      }
+
+      // -- job management with result handle --
+
+      /// @brief Insert a new job to process (copied/moved) - use common task runner provided in constructor
+      /// @returns Handle to wait for job completion / poll its status / attach a continuation (empty handle if pool not running)
+      template<typename J = _JobParamType>
+      inline EnableIf<!std::is_class<J>::value || std::is_copy_constructible<J>::value,
+                      JobHandle<void> > submit(const _JobParamType& param) {
+        return _pushJobWithResult<void>(_JobParamType(param));
+      }
+      inline JobHandle<void> submit(_JobParamType&& param) {
+        return _pushJobWithResult<void>(std::move(param));
+      }
+
+      /// @brief Insert a new job to process (copied/moved) - custom task runner for each job ('perJob' runner mode, function pointer)
+      /// @returns Handle to wait for job completion / poll its status / attach a continuation (empty handle if pool not running)
+      template<typename J = _JobParamType, ThreadRunnerMode M = _Mode, TaskRunnerType F = _FunctionType>
+      inline EnableIf<(!std::is_class<J>::value || std::is_copy_constructible<J>::value) && M == ThreadRunnerMode::perJob
+                      && F == TaskRunnerType::functionPointer,
+                      JobHandle<void> > submit(const _JobParamType& param, task_runner_type runner) {
+        return _pushJobWithResult<void>(_JobParamType(param), std::move(runner));
+      }
+      template<ThreadRunnerMode M = _Mode, TaskRunnerType F = _FunctionType>
+      inline EnableIf<M == ThreadRunnerMode::perJob && F == TaskRunnerType::functionPointer,
+                      JobHandle<void> > submit(_JobParamType&& param, task_runner_type runner) {
+        return _pushJobWithResult<void>(std::move(param), std::move(runner));
+      }
+
+      /// @brief Insert a new job to process (copied/moved) - custom callable for each job ('perJob' runner mode, lambda):
+      ///        '_ResultType operation(_JobParamType&)': the value returned by the operation can be read with the handle.
+      /// @remarks The result is stored in the pool (no allocation per job): its size is limited (__P_JOB_RESULT_STORAGE_SIZE).
+      /// @returns Handle to wait for job result / poll its status / attach a continuation (empty handle if pool not running)
+      template<typename _Operation, typename J = _JobParamType, ThreadRunnerMode M = _Mode, TaskRunnerType F = _FunctionType>
+      inline EnableIf<(!std::is_class<J>::value || std::is_copy_constructible<J>::value) && M == ThreadRunnerMode::perJob
+                      && F == TaskRunnerType::lambda,
+                      JobHandle<OperationResult<_Operation> > >
+      submit(const _JobParamType& param, _Operation&& operation) {
+        return _pushJobWithResult<OperationResult<_Operation> >(_JobParamType(param), std::forward<_Operation>(operation));
+      }
+      template<typename _Operation, ThreadRunnerMode M = _Mode, TaskRunnerType F = _FunctionType>
+      inline EnableIf<M == ThreadRunnerMode::perJob && F == TaskRunnerType::lambda,
+                      JobHandle<OperationResult<_Operation> > >
+      submit(_JobParamType&& param, _Operation&& operation) {
+        return _pushJobWithResult<OperationResult<_Operation> >(std::move(param), std::forward<_Operation>(operation));
+      }
+
       /// @brief Cancel all jobs that haven't already been started
+      /// @remarks - The handles of cancelled jobs report a 'cancelled' status (and their continuations are called).
+      ///          - Cancelled jobs are removed from their group (if any), but the groups are not cancelled.
+      ///          - To only cancel some specific jobs (and to stop running jobs), use a JobGroup instead.
       inline uint32_t cancelPendingJobs() noexcept {
-        std::lock_guard<std::mutex> guard(this->_poolData->lock);
-        size_t jobCount = this->_poolData->jobs.size();
-        this->_poolData->jobs = std::queue<job_item>{};
+        std::queue<job_item> cancelledJobs;
+        std::unique_lock<std::mutex> guard(this->_poolData->lock);
+        std::swap(this->_poolData->jobs, cancelledJobs);
+        guard.unlock();
+
+        size_t jobCount = cancelledJobs.size();
+        _cancelJobs(cancelledJobs);
         return static_cast<uint32_t>(jobCount);
       }
 
     protected:
+      // -- job result management --
+
+      // insert job with result slot (and optional custom runner)
+      template <typename _ResultType, typename ... _RunnerArgs>
+      JobHandle<_ResultType> _pushJobWithResult(_JobParamType&& param, _RunnerArgs&&... runner) {
+        std::unique_lock<std::mutex> guard(this->_poolData->lock);
+        if (!this->_poolData->isRunning)
+          return JobHandle<_ResultType>{};
+        if (this->_poolData->results == nullptr)
+          this->_poolData->results = JobResultSlab::create();
+
+        JobResultSlot* result = this->_poolData->results->acquire(2u); // references: job + handle
+        try {
+          this->_poolData->jobs.emplace(std::move(param), _toTaskRunner<_ResultType>(*result, std::forward<_RunnerArgs>(runner))..., result);
+        }
+        catch (...) {
+          result->release();
+          result->release();
+          throw;
+        }
+        _onJobInserted();
+        guard.unlock();
+
+        this->_poolData->condition.notify_one();
+        return JobHandle<_ResultType>::adopt(result);
+      }
+
+      // -- job group management --
+
+      // insert job in a group (and optional custom runner)
+      template <typename ... _RunnerArgs>
+      bool _pushGroupJob(JobGroup& group, _JobParamType&& param, _RunnerArgs&&... runner) {
+        JobGroupState* state = group.state();
+        std::unique_lock<std::mutex> guard(this->_poolData->lock);
+        if (!this->_poolData->isRunning || state == nullptr || !state->registerJob())
+          return false;
+        try {
+          this->_poolData->jobs.emplace(std::move(param), std::forward<_RunnerArgs>(runner)...);
+        }
+        catch (...) {
+          state->dropQueuedJob();
+          throw;
+        }
+        _attachGroup(*state);
+        guard.unlock();
+
+        this->_poolData->condition.notify_one();
+        return true;
+      }
+      // reference group in last inserted job + update metrics (with lock)
+      inline void _attachGroup(JobGroupState& state) noexcept {
+        state.addRef();
+        this->_poolData->jobs.back().link = JobLink(&state);
+        _onJobInserted();
+      }
+
+      // verify if a dequeued job belongs to a cancelled group -> if so, discard it (returns false)
+      static inline bool _claimJob(JobGroupState* group) noexcept {
+        if (group == nullptr || group->claimJob())
+          return true;
+        group->release();
+        return false;
+      }
+
+      // adapt custom runner to store its result
+      template <typename _ResultType, typename _Operation>
+      static inline EnableIf<std::is_void<_ResultType>::value,
+                             task_runner_type> _toTaskRunner(JobResultSlot&, _Operation&& operation) {
+        return task_runner_type(std::forward<_Operation>(operation));
+      }
+      template <typename _ResultType, typename _Operation>
+      static inline EnableIf<!std::is_void<_ResultType>::value,
+                             task_runner_type> _toTaskRunner(JobResultSlot& result, _Operation&& operation) {
+        JobResultSlot* resultPtr = &result;
+        return [resultPtr, operation = std::forward<_Operation>(operation)](_JobParamType& param) mutable {
+          resultPtr->template emplaceValue<_ResultType>(operation(param));
+        };
+      }
+
+      // update metrics after inserting a job (with lock)
+      inline void _onJobInserted() noexcept {
+        this->_poolData->metrics.onEnqueue(this->_poolData->jobs.back(), this->_poolData->jobs.size());
+      }
+
+      // awake threads to process new jobs
+      inline void _notifyThreads(size_t threadCount) noexcept {
+        if (threadCount >= size())
+          this->_poolData->condition.notify_all();
+        else {
+          for (size_t i = 0; i < threadCount; ++i)
+            this->_poolData->condition.notify_one();
+        }
+      }
+
+      // mark results of removed jobs as cancelled
+      static void _cancelJobs(std::queue<job_item>& jobs) noexcept {
+        while (!jobs.empty()) {
+          JobResultSlot* result = jobs.front().link.result();
+          JobGroupState* group = jobs.front().link.group();
+          jobs.pop();
+          if (result != nullptr) {
+            result->cancel();
+            result->release();
+          }
+          if (group != nullptr) {
+            group->dropQueuedJob();
+            group->release();
+          }
+        }
+      }
+
       // -- thread management --
 
       // launch thread pool
       void _startThreads(size_t threadCount, task_runner_type& runner) {
+        this->_poolData->metrics.init(threadCount);
         this->_poolData->isRunning = true;
         this->_poolData->busyThreads = 0u;
         this->_threads.reserve(threadCount);
@@ -198,10 +519,12 @@ namespace pandora {
 
       // stop all threads
       void _stopThreads() noexcept {
+        std::queue<job_item> cancelledJobs;
         std::unique_lock<std::mutex> guard(this->_poolData->lock);
         this->_poolData->isRunning = false;
-        this->_poolData->jobs = std::queue<job_item>{};
+        std::swap(this->_poolData->jobs, cancelledJobs);
         guard.unlock();
+        _cancelJobs(cancelledJobs);
 
         this->_poolData->condition.notify_all();
         for (auto& item : this->_threads) {
@@ -221,7 +544,7 @@ namespace pandora {
       // -- thread execution --
 
       // main thread execution loop
-      static void _runThread(std::shared_ptr<SharedPoolData> shared, uint32_t __DEBUG_ARG__(index), task_runner_type commonRunner) noexcept {
+      static void _runThread(std::shared_ptr<SharedPoolData> shared, uint32_t index, task_runner_type commonRunner) noexcept {
         TRACE_N("ThreadPool: thread %u started", index);
         assert(shared != nullptr);
         SharedPoolData& sync = *shared;
@@ -241,11 +564,33 @@ namespace pandora {
             jobs.pop();
             guard.unlock();
 
-            try {
-              _callRunner(jobData, commonRunner);
+            JobResultSlot* result = jobData.link.result();
+            JobGroupState* group = jobData.link.group();
+            if (_claimJob(group)) { // not dropped by group cancellation
+              auto startTime = sync.metrics.onStart(jobData, index);
+              try {
+                _callRunner(jobData, commonRunner);
+                if (result != nullptr)
+                  result->complete(); // continuation run inline
+              }
+              catch (const std::exception& __DEBUG_ARG__(exc)) {
+                TRACE_N("ThreadPool: exception: %s", exc.what());
+                if (result != nullptr)
+                  result->fail(std::current_exception());
+              }
+              catch (...) {
+                TRACE("ThreadPool: unknown exception type thrown");
+                if (result != nullptr)
+                  result->fail(std::current_exception());
+              }
+              if (result != nullptr)
+                result->release();
+              if (group != nullptr) {
+                group->completeJob();
+                group->release();
+              }
+              sync.metrics.onFinish(startTime, index);
             }
-            catch (const std::exception& __DEBUG_ARG__(exc)) { TRACE_N("ThreadPool: exception: %s", exc.what()); }
-            catch (...) { TRACE("ThreadPool: unknown exception type thrown"); }
 
             guard.lock();
             --(sync.busyThreads);
@@ -264,8 +609,8 @@ namespace pandora {
         else
           defaultRunner(jobData.param);
       }
-      static inline void _callRunner(_JobParamType& param, task_runner_type& defaultRunner) {
-        defaultRunner(param);
+      static inline void _callRunner(JobParamWithResult& jobData, task_runner_type& defaultRunner) {
+        defaultRunner(jobData.param);
       }
       // default task runner, if none provided
       static inline void _defaultRunner(_JobParamType&) {
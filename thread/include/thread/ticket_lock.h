@@ -0,0 +1,227 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include "./futex.h"
+
+namespace pandora {
+  namespace thread {
+    /// @class TicketLock
+    /// @brief Synchronization primitive to protect data from being simultaneously accessed, with guaranteed FIFO order (scalable version of OrderedLock).
+    /// @description Same usage as OrderedLock, without any internal mutex or allocation in lock/unlock:
+    ///              - each thread takes a ticket (one atomic increment), and owns the lock when the "serving" counter reaches its ticket;
+    ///              - waiting threads spin with a backoff proportional to their position in the queue, then sleep on a futex;
+    ///              - sleeping threads are distributed in slots (by ticket): unlock() only wakes up the slot of the next ticket.
+    ///              Uncontended lock/unlock only involve one atomic operation each.
+    /// @remarks A thread that times out (tryLock with timeout) abandons its ticket: it's stored in a list of abandoned tickets (slow path, with mutex),
+    ///          and skipped by the previous owner on unlock.
+    class TicketLock final {
+    public:
+      /// @brief Create an new unlocked instance
+      TicketLock() noexcept {}
+      TicketLock(const TicketLock&) = delete;
+      TicketLock(TicketLock&&) = delete;
+      TicketLock& operator=(const TicketLock&) = delete;
+      TicketLock& operator=(TicketLock&&) = delete;
+
+      // -- lock management --
+
+      /// @brief Wait until object unlocked, then lock it (FIFO order)
+      inline void lock() noexcept {
+        uint32_t ticket = this->_nextTicket.fetch_add(1u, std::memory_order_relaxed);
+        if (this->_serving.load(std::memory_order_acquire) != ticket)
+          _waitForTurn(ticket);
+      }
+
+      /// @brief Only lock the object if there's no need to wait (unlocked and no thread in queue)
+      /// @returns True on lock success, false if already locked by another owner
+      inline bool tryLock() noexcept {
+        uint32_t ticket = this->_serving.load(std::memory_order_acquire);
+        return (this->_nextTicket.load(std::memory_order_relaxed) == ticket
+             && this->_nextTicket.compare_exchange_strong(ticket, ticket + 1u, std::memory_order_acquire, std::memory_order_relaxed));
+      }
+      inline bool try_lock() noexcept { return tryLock(); } // STL-compliant version
+
+      /// @brief Unlock the object (next ticket owner is awakened)
+      /// @warning Should only be called after having called lock() (by the thread that currently owns the object).
+      inline void unlock() noexcept {
+        uint32_t ticket = this->_serving.load(std::memory_order_relaxed) + 1u;
+        this->_serving.store(ticket, std::memory_order_seq_cst);
+        while (this->_abandonedCount.load(std::memory_order_seq_cst) != 0 && _skipAbandonedTicket(ticket)) {
+          ++ticket;
+          this->_serving.store(ticket, std::memory_order_seq_cst);
+        }
+
+        Slot& slot = this->_slots[ticket & _slotMask];
+        slot.sequence.fetch_add(1u, std::memory_order_seq_cst);
+        if (slot.sleepers.load(std::memory_order_seq_cst) != 0)
+          futexWakeAll(slot.sequence); // only sleepers of this slot (usually 1 thread)
+      }
+
+      // -- lock with timeout --
+
+      /// @brief Only wait for a specific period for the object to be unlocked.
+      /// @returns True on lock success, false if timeout
+      template <typename _RepetitionType, typename _PeriodType>
+      inline bool tryLock(const std::chrono::duration<_RepetitionType, _PeriodType>& retryDuration) noexcept {
+        return tryLockUntil(std::chrono::time_point<std::chrono::steady_clock>(std::chrono::steady_clock::now() + retryDuration));
+      }
+      template <typename _RepetitionType, typename _PeriodType>
+      inline bool try_lock_for(const std::chrono::duration<_RepetitionType, _PeriodType>& retryDuration) noexcept { return tryLock(retryDuration); } // STL-compliant version
+
+      /// @brief Only wait until a specific time-point for the object to be unlocked.
+      /// @returns True on lock success, false if timeout
+      template <typename _ClockType, typename _DurationType>
+      bool tryLockUntil(const std::chrono::time_point<_ClockType, _DurationType>& timeoutTimePoint) noexcept {
+        uint32_t ticket = this->_nextTicket.fetch_add(1u, std::memory_order_relaxed);
+        uint32_t serving = this->_serving.load(std::memory_order_acquire);
+        if (serving == ticket)
+          return true;
+
+        Slot& slot = this->_slots[ticket & _slotMask];
+        while (true) {
+          uint32_t sequence = _spinForTurn(ticket, serving);
+          if (sequence == _turnReached)
+            return true;
+
+          auto remainingTime = timeoutTimePoint - _ClockType::now();
+          if (remainingTime <= decltype(remainingTime)::zero())
+            return _abandonTicket(ticket); // false, unless served meanwhile
+          slot.sleepers.fetch_add(1u, std::memory_order_seq_cst);
+          if (this->_serving.load(std::memory_order_seq_cst) != ticket)
+            futexWaitFor(slot.sequence, sequence, remainingTime);
+          slot.sleepers.fetch_sub(1u, std::memory_order_relaxed);
+          serving = this->_serving.load(std::memory_order_acquire);
+          if (serving == ticket)
+            return true;
+        }
+      }
+      template <typename _ClockType, typename _DurationType>
+      inline bool try_lock_until(const std::chrono::time_point<_ClockType, _DurationType>& timeoutTimePoint) noexcept { return tryLockUntil(timeoutTimePoint); } // STL-compliant version
+
+      // -- lock status --
+
+      /// @brief Check whether the TicketLock is locked or not
+      inline bool isLocked() const noexcept {
+        return (this->_nextTicket.load(std::memory_order_relaxed) != this->_serving.load(std::memory_order_relaxed));
+      }
+      /// @brief Get number of threads currently waiting for the lock (approximation if abandoned tickets haven't been skipped yet)
+      inline size_t queueSize() const noexcept {
+        uint32_t pendingTickets = this->_nextTicket.load(std::memory_order_relaxed) - this->_serving.load(std::memory_order_relaxed);
+        return (pendingTickets > 1u) ? static_cast<size_t>(pendingTickets - 1u) : 0;
+      }
+
+    private:
+      struct Slot final {
+        std::atomic<uint32_t> sequence{ 0 }; // futex word of sleeping threads (incremented when a ticket of the slot is served)
+        std::atomic<uint32_t> sleepers{ 0 };
+      };
+      static constexpr uint32_t _slotCount = 32u; // power of 2
+      static constexpr uint32_t _slotMask = _slotCount - 1u;
+      static constexpr uint32_t _backoffUnit = 64u; // pause instructions per thread ahead in queue
+      static constexpr uint32_t _spinBudget = 4096u;
+      static constexpr uint32_t _maxSpinningPosition = 2u; // threads further in queue sleep directly
+      static constexpr uint32_t _turnReached = 0xFFFFFFFFu;
+
+      // spin with backoff proportional to queue position, until turn reached or spin budget exhausted
+      // (only the next thread in queue uses the whole budget: other threads sleep sooner, to leave CPU time to the owner)
+      // returns: _turnReached, or slot sequence to use for futex wait
+      inline uint32_t _spinForTurn(uint32_t ticket, uint32_t serving) noexcept {
+        Slot& slot = this->_slots[ticket & _slotMask];
+        for (uint32_t spinCount = 0; spinCount < _spinBudget; ) {
+          uint32_t position = ticket - serving;
+          if (position > _maxSpinningPosition)
+            break;
+          uint32_t backoff = position * _backoffUnit;
+          for (uint32_t i = 0; i < backoff; ++i)
+            cpuRelax();
+          spinCount += backoff;
+          serving = this->_serving.load(std::memory_order_acquire);
+          if (serving == ticket)
+            return _turnReached;
+        }
+        uint32_t sequence = slot.sequence.load(std::memory_order_seq_cst); // read before last check -> futex wait fails if served after it
+        return (this->_serving.load(std::memory_order_acquire) == ticket) ? _turnReached : sequence;
+      }
+
+      // blocking wait until ticket is served
+      void _waitForTurn(uint32_t ticket) noexcept {
+        Slot& slot = this->_slots[ticket & _slotMask];
+        uint32_t serving = this->_serving.load(std::memory_order_acquire);
+        while (true) {
+          uint32_t sequence = _spinForTurn(ticket, serving);
+          if (sequence == _turnReached)
+            return;
+          slot.sleepers.fetch_add(1u, std::memory_order_seq_cst);
+          if (this->_serving.load(std::memory_order_seq_cst) != ticket)
+            futexWait(slot.sequence, sequence);
+          slot.sleepers.fetch_sub(1u, std::memory_order_relaxed);
+          serving = this->_serving.load(std::memory_order_acquire);
+          if (serving == ticket)
+            return;
+        }
+      }
+
+      // -- abandoned tickets (timeout) --
+
+      // store abandoned ticket (after timeout) -> returns true if the ticket was served before being abandoned (lock owned)
+      bool _abandonTicket(uint32_t ticket) noexcept {
+        this->_abandonedCount.fetch_add(1u, std::memory_order_seq_cst); // before insertion: checked by unlock after updating 'serving'
+        try {
+          std::lock_guard<std::mutex> guard(this->_abandonedLock);
+          this->_abandonedTickets.emplace_back(ticket);
+        }
+        catch (...) { // allocation failure: can't leave the queue -> wait for turn
+          this->_abandonedCount.fetch_sub(1u, std::memory_order_relaxed);
+          _waitForTurn(ticket);
+          return true;
+        }
+        return (this->_serving.load(std::memory_order_seq_cst) == ticket && _skipAbandonedTicket(ticket)); // served meanwhile -> cancel abandon
+      }
+      // remove ticket from abandoned tickets -> returns true if it was found
+      bool _skipAbandonedTicket(uint32_t ticket) noexcept {
+        std::lock_guard<std::mutex> guard(this->_abandonedLock);
+        auto it = std::find(this->_abandonedTickets.begin(), this->_abandonedTickets.end(), ticket);
+        if (it == this->_abandonedTickets.end())
+          return false;
+        *it = this->_abandonedTickets.back();
+        this->_abandonedTickets.pop_back();
+        this->_abandonedCount.fetch_sub(1u, std::memory_order_relaxed);
+        return true;
+      }
+
+    private:
+      alignas(64) std::atomic<uint32_t> _nextTicket{ 0 }; // next ticket to distribute
+      alignas(64) std::atomic<uint32_t> _serving{ 0 };    // ticket currently owning the lock
+      Slot _slots[_slotCount];
+
+      std::atomic<uint32_t> _abandonedCount{ 0 };
+      std::mutex _abandonedLock;
+      std::vector<uint32_t> _abandonedTickets;
+    };
+
+  }
+}
@@ -0,0 +1,525 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <stdexcept>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <iterator>
+#include <utility>
+#include <type_traits>
+#include <system/trace.h>
+#include "./thread_pool.h"
+
+namespace pandora {
+  namespace thread {
+    /// @brief Handle of a timer scheduled in a TimerWheel (used to cancel it)
+    /// @remarks Same usage as pattern::Ticket: unique ID (slot index + generation), valid until cancelled or invalidated.
+    class TimerTicket final {
+    public:
+      using Id = uint64_t; ///> Unique identifier type
+
+      /// @brief Create invalid ticket (empty)
+      constexpr TimerTicket() noexcept = default;
+      constexpr TimerTicket(uint32_t index, uint32_t generation) noexcept
+        : _id((static_cast<Id>(generation) << 32) | static_cast<Id>(index)) {}
+      TimerTicket(const TimerTicket&) = default;
+      TimerTicket(TimerTicket&& rhs) noexcept : _id(rhs._id) { rhs._id = 0; }
+      TimerTicket& operator=(const TimerTicket&) = default;
+      TimerTicket& operator=(TimerTicket&& rhs) noexcept { this->_id = rhs._id; rhs._id = 0; return *this; }
+      ~TimerTicket() = default;
+
+      // -- getters --
+
+      constexpr inline Id id() const noexcept { return this->_id; }
+      constexpr inline uint32_t index() const noexcept { return static_cast<uint32_t>(this->_id & 0xFFFFFFFFuLL); }
+      constexpr inline uint32_t generation() const noexcept { return static_cast<uint32_t>(this->_id >> 32); }
+      constexpr inline bool isValid() const noexcept { return (this->_id != 0); }
+      constexpr inline operator bool() const noexcept { return isValid(); }
+      inline void invalidate() noexcept { this->_id = 0; }
+
+      // -- comparisons --
+
+      constexpr inline bool operator==(const TimerTicket& rhs) const noexcept { return (this->_id == rhs._id); }
+      constexpr inline bool operator!=(const TimerTicket& rhs) const noexcept { return (this->_id != rhs._id); }
+      constexpr inline bool operator<(const TimerTicket& rhs) const noexcept { return (this->_id < rhs._id); }
+
+    private:
+      Id _id = 0; // generation always > 0 for valid tickets
+    };
+
+    /// @brief Execution mode of a TimerWheel
+    enum class TimerWheelMode : uint32_t {
+      threaded = 0, ///< Timers processed by a dedicated thread of the TimerWheel
+      manual = 1    ///< Timers processed when 'advance' is called (ex: in a main loop)
+    };
+
+    // ---
+
+    /// @class TimerWheel
+    /// @brief Scheduler of delayed and periodic jobs, inserted in a thread pool when their delay has expired.
+    /// @description Hierarchical timing wheel (4 wheels of 256 slots): time is divided in ticks (resolution of the timers).
+    ///              - one thread processes all timers (or no thread in manual mode): no thread per timer;
+    ///              - insertion and cancellation in O(1), with a TimerTicket handle;
+    ///              - all timers expiring in the same tick are coalesced: their jobs are inserted in the pool as a single batch (pool.addJobs);
+    ///              - timers are stored in a flat array (free slots reused): no allocation per timer once capacity is reached (see reserve).
+    ///              Jobs are never inserted before their delay, but may be inserted up to one tick later.
+    ///              Delays longer than 2^32 ticks are supported (timers are re-inserted each time the top wheel wraps around).
+    /// @warning The pool must outlive the TimerWheel. The pool type must provide 'addJobs(iterator first, iterator last)' (ThreadPool, ElasticThreadPool...).
+    ///          Periodic timers require a copyable job type.
+    template <typename _JobParamType,                        // Type of data container passed to the pool (must be movable)
+              typename _PoolType = ThreadPool<_JobParamType> > // Thread pool receiving the jobs of expired timers
+    class TimerWheel final {
+    public:
+      using Type = TimerWheel<_JobParamType,_PoolType>;
+      using size_type = size_t;
+      using clock_type = std::chrono::steady_clock;
+      using time_point = clock_type::time_point;
+      using duration = clock_type::duration;
+    protected:
+      static constexpr uint32_t _noNode = 0xFFFFFFFFu;
+      static constexpr uint32_t _levels = 4u;    // number of wheels (hierarchy)
+      static constexpr uint32_t _slotBits = 8u;  // 256 slots per wheel -> 2^32 ticks covered
+      static constexpr uint32_t _slotCount = (1u << _slotBits);
+      static constexpr uint64_t _maxTicks = (1uLL << (_levels * _slotBits)) - 1uLL;
+
+      struct TimerNode { // Timer data (in flat array)
+        _JobParamType param;
+        uint64_t expiration = 0;  // tick of expiration
+        uint64_t period = 0;      // ticks between executions (0: one-shot)
+        uint32_t previous = _noNode;
+        uint32_t next = _noNode;  // next timer in bucket (or next free node)
+        uint32_t generation = 1u;
+        uint32_t bucket = _noNode; // bucket index (level * slot count + slot) - _noNode: free node
+        TimerNode(_JobParamType&& param) : param(std::move(param)) {}
+      };
+
+    public:
+      /// @brief Create timer scheduler for a thread pool
+      /// @param pool          Thread pool receiving the jobs (must outlive the scheduler)
+      /// @param tickDuration  Resolution of the timers (duration of a tick)
+      /// @param mode          Timers processed by a dedicated thread (threaded) or by calls to 'advance' (manual)
+      template <typename _RepetitionType = int64_t, typename _PeriodType = std::milli>
+      TimerWheel(_PoolType& pool, const std::chrono::duration<_RepetitionType,_PeriodType>& tickDuration = std::chrono::milliseconds(1),
+                 TimerWheelMode mode = TimerWheelMode::threaded)
+        : _pool(pool),
+          _tickDuration(std::chrono::duration_cast<duration>(tickDuration)),
+          _startTime(clock_type::now()) {
+        if (this->_tickDuration <= duration::zero())
+          throw std::invalid_argument("TimerWheel: tick duration must be positive");
+        for (auto& head : this->_buckets)
+          head = _noNode;
+        if (mode == TimerWheelMode::threaded) {
+          this->_isRunning = true;
+          this->_timerThread = std::thread(&Type::_runTimerThread, this);
+        }
+      }
+      /// @brief Stop scheduler (pending timers are dropped)
+      ~TimerWheel() noexcept {
+        std::unique_lock<std::mutex> guard(this->_lock);
+        this->_isRunning = false;
+        guard.unlock();
+        this->_condition.notify_all();
+        if (this->_timerThread.joinable()) {
+          try { this->_timerThread.join(); }
+          catch (const std::exception& __DEBUG_ARG__(exc)) { TRACE_N("TimerWheel: thread join exception: %s", exc.what()); }
+        }
+      }
+
+      TimerWheel(const Type&) = delete;
+      TimerWheel(Type&&) = delete;
+      Type& operator=(const Type&) = delete;
+      Type& operator=(Type&&) = delete;
+
+      // -- getters --
+
+      inline duration tickDuration() const noexcept { return this->_tickDuration; } ///< Resolution of the timers
+      /// @brief Number of pending timers
+      inline size_type size() const noexcept { std::lock_guard<std::mutex> guard(this->_lock); return this->_timerCount; }
+      inline bool empty() const noexcept { return (size() == 0); }
+      /// @brief Number of timers that can be stored without reallocation
+      inline size_type capacity() const noexcept { std::lock_guard<std::mutex> guard(this->_lock); return this->_nodes.capacity(); }
+      /// @brief Last tick processed (number of ticks since creation)
+      inline uint64_t currentTick() const noexcept { std::lock_guard<std::mutex> guard(this->_lock); return this->_currentTick; }
+
+      /// @brief Pre-allocate storage for a number of timers
+      inline void reserve(size_t timerCount) {
+        std::lock_guard<std::mutex> guard(this->_lock);
+        this->_nodes.reserve(timerCount);
+      }
+
+      // -- timer management --
+
+      /// @brief Schedule a job to insert in the pool after a delay
+      /// @returns Ticket to cancel the timer
+      template <typename _RepetitionType, typename _PeriodType>
+      inline TimerTicket scheduleAfter(const std::chrono::duration<_RepetitionType,_PeriodType>& delay, _JobParamType param) {
+        return scheduleAt(clock_type::now() + std::chrono::duration_cast<duration>(delay), std::move(param));
+      }
+      /// @brief Schedule a job to insert in the pool at a specific time
+      /// @returns Ticket to cancel the timer
+      inline TimerTicket scheduleAt(time_point time, _JobParamType param) {
+        std::unique_lock<std::mutex> guard(this->_lock);
+        return _insertTimer(guard, _toTick(time), 0, std::move(param));
+      }
+      /// @brief Schedule a job to insert in the pool periodically (each period), starting after 'period'
+      /// @remarks If the scheduler falls behind (manual mode not called often enough...), the jobs of missed periods are still inserted.
+      /// @returns Ticket to cancel the timer
+      template <typename _RepetitionType, typename _PeriodType, typename J = _JobParamType>
+      inline typename std::enable_if<std::is_copy_constructible<J>::value, TimerTicket>::type
+      schedulePeriodic(const std::chrono::duration<_RepetitionType,_PeriodType>& period, _JobParamType param) {
+        return schedulePeriodic(period, period, std::move(param));
+      }
+      /// @brief Schedule a job to insert in the pool periodically (each period), starting after 'firstDelay'
+      /// @returns Ticket to cancel the timer
+      template <typename _RepetitionType, typename _PeriodType, typename _DelayRepType, typename _DelayPeriodType, typename J = _JobParamType>
+      inline typename std::enable_if<std::is_copy_constructible<J>::value, TimerTicket>::type
+      schedulePeriodic(const std::chrono::duration<_RepetitionType,_PeriodType>& period,
+                       const std::chrono::duration<_DelayRepType,_DelayPeriodType>& firstDelay, _JobParamType param) {
+        uint64_t periodTicks = static_cast<uint64_t>(std::chrono::duration_cast<duration>(period).count() / this->_tickDuration.count());
+        time_point firstTime = clock_type::now() + std::chrono::duration_cast<duration>(firstDelay);
+        std::unique_lock<std::mutex> guard(this->_lock);
+        return _insertTimer(guard, _toTick(firstTime), (periodTicks > 0u) ? periodTicks : 1u, std::move(param));
+      }
+
+      /// @brief Cancel a pending timer (O(1)) - the ticket is invalidated
+      /// @returns True if the timer was pending (false if already expired (one-shot) / cancelled / invalid)
+      bool cancel(TimerTicket& ticket) noexcept {
+        std::lock_guard<std::mutex> guard(this->_lock);
+        uint32_t index = ticket.index();
+        bool isCancelled = false;
+        if (ticket.isValid() && index < this->_nodes.size()) {
+          TimerNode& node = this->_nodes[index];
+          if (node.generation == ticket.generation() && node.bucket != _noNode) {
+            _unlinkNode(index);
+            _releaseNode(index);
+            isCancelled = true;
+          }
+        }
+        ticket.invalidate();
+        return isCancelled;
+      }
+      /// @brief Cancel all pending timers
+      /// @returns Number of timers cancelled
+      uint32_t cancelAll() noexcept {
+        std::lock_guard<std::mutex> guard(this->_lock);
+        size_t timerCount = this->_timerCount;
+        for (auto& head : this->_buckets) {
+          while (head != _noNode) {
+            uint32_t index = head;
+            _unlinkNode(index);
+            _releaseNode(index);
+          }
+        }
+        return static_cast<uint32_t>(timerCount);
+      }
+
+      // -- manual mode --
+
+      /// @brief Process all ticks elapsed until now: jobs of expired timers are inserted in the pool
+      /// @remarks Only required in manual mode (in threaded mode, the timer thread already calls it).
+      /// @returns Number of jobs inserted in the pool
+      inline size_t advance() { return advance(clock_type::now()); }
+      /// @brief Process all ticks elapsed until a specific time: jobs of expired timers are inserted in the pool
+      /// @returns Number of jobs inserted in the pool
+      size_t advance(time_point time) {
+        const uint64_t targetTick = _toElapsedTicks(time);
+        std::vector<_JobParamType> dueJobs;
+        size_t jobCount = 0;
+        std::unique_lock<std::mutex> guard(this->_lock);
+        while (this->_currentTick < targetTick) {
+          _processTicks(targetTick, dueJobs);
+          if (!dueJobs.empty()) {
+            guard.unlock();
+            jobCount += _dispatch(dueJobs);
+            guard.lock();
+          }
+        }
+        return jobCount;
+      }
+
+    protected:
+      // -- time conversions --
+
+      // tick containing a time (rounded up: timers never expire before their time)
+      inline uint64_t _toTick(time_point time) const noexcept {
+        duration elapsed = time - this->_startTime;
+        if (elapsed <= duration::zero())
+          return 0;
+        return static_cast<uint64_t>((elapsed.count() + this->_tickDuration.count() - 1) / this->_tickDuration.count());
+      }
+      // number of complete ticks elapsed at a time
+      inline uint64_t _toElapsedTicks(time_point time) const noexcept {
+        duration elapsed = time - this->_startTime;
+        return (elapsed > duration::zero()) ? static_cast<uint64_t>(elapsed.count() / this->_tickDuration.count()) : 0;
+      }
+
+      // -- node management (lock must be held by caller) --
+
+      // allocate timer + insert it in wheel
+      TimerTicket _insertTimer(std::unique_lock<std::mutex>& guard, uint64_t expiration, uint64_t period, _JobParamType&& param) {
+        uint32_t index;
+        if (this->_freeNodes != _noNode) {
+          index = this->_freeNodes;
+          this->_freeNodes = this->_nodes[index].next;
+          this->_nodes[index].param = std::move(param);
+        }
+        else {
+          if (this->_nodes.size() >= static_cast<size_t>(_noNode))
+            throw std::length_error("TimerWheel: too many timers");
+          index = static_cast<uint32_t>(this->_nodes.size());
+          this->_nodes.emplace_back(std::move(param));
+        }
+        TimerNode& node = this->_nodes[index];
+        node.expiration = (expiration > this->_currentTick) ? expiration : this->_currentTick + 1u;
+        node.period = period;
+        _linkNode(index);
+        ++(this->_timerCount);
+
+        bool isWakeUpRequired = (node.expiration < this->_wakeUpTick);
+        TimerTicket ticket(index, node.generation);
+        guard.unlock();
+        if (isWakeUpRequired)
+          this->_condition.notify_one();
+        return ticket;
+      }
+      // free timer node (already unlinked)
+      inline void _releaseNode(uint32_t index) noexcept {
+        TimerNode& node = this->_nodes[index];
+        node.bucket = _noNode;
+        if (++(node.generation) == 0)
+          node.generation = 1u;
+        node.next = this->_freeNodes;
+        this->_freeNodes = index;
+        --(this->_timerCount);
+      }
+
+      // insert node in the bucket matching its expiration
+      void _linkNode(uint32_t index) noexcept {
+        TimerNode& node = this->_nodes[index];
+        const uint64_t delay = node.expiration - this->_currentTick;
+        uint32_t level = 0;
+        uint64_t placementTick = node.expiration;
+        if (delay > _maxTicks) // beyond top wheel -> re-inserted when top wheel wraps
+          placementTick = this->_currentTick + _maxTicks;
+        while (level + 1u < _levels && (placementTick - this->_currentTick) >= (1uLL << ((level + 1u) * _slotBits)))
+          ++level;
+        const uint32_t slot = static_cast<uint32_t>((placementTick >> (level * _slotBits)) & (_slotCount - 1u));
+        const uint32_t bucket = level * _slotCount + slot;
+
+        node.bucket = bucket;
+        node.previous = _noNode;
+        node.next = this->_buckets[bucket];
+        if (node.next != _noNode)
+          this->_nodes[node.next].previous = index;
+        this->_buckets[bucket] = index;
+        this->_occupiedSlots[level][slot >> 6] |= (1uLL << (slot & 63u));
+      }
+      // remove node from its bucket
+      void _unlinkNode(uint32_t index) noexcept {
+        TimerNode& node = this->_nodes[index];
+        if (node.previous != _noNode)
+          this->_nodes[node.previous].next = node.next;
+        else
+          this->_buckets[node.bucket] = node.next;
+        if (node.next != _noNode)
+          this->_nodes[node.next].previous = node.previous;
+
+        if (this->_buckets[node.bucket] == _noNode)
+          _clearOccupiedSlot(node.bucket);
+      }
+      inline void _clearOccupiedSlot(uint32_t bucket) noexcept {
+        const uint32_t slot = bucket & (_slotCount - 1u);
+        this->_occupiedSlots[bucket / _slotCount][slot >> 6] &= ~(1uLL << (slot & 63u));
+      }
+
+      // -- tick processing (lock must be held by caller) --
+
+      // offset from a slot to the next occupied slot of a wheel (circular) - _slotCount if wheel is empty
+      uint32_t _findOccupiedSlot(uint32_t level, uint32_t startSlot) const noexcept {
+        for (uint32_t offset = 0; offset < _slotCount; ) {
+          const uint32_t slot = (startSlot + offset) & (_slotCount - 1u);
+          uint64_t word = this->_occupiedSlots[level][slot >> 6] >> (slot & 63u);
+          if (word == 0) { // skip empty part of 64-bit word
+            offset += 64u - (slot & 63u);
+            continue;
+          }
+          while ((word & 1uLL) == 0) {
+            word >>= 1;
+            ++offset;
+          }
+          return (offset < _slotCount) ? offset : _slotCount;
+        }
+        return _slotCount;
+      }
+      // number of ticks until next tick with something to do (expiration in first wheel, or cascade of a non-empty slot)
+      uint64_t _nextEventDistance() const noexcept {
+        uint64_t distance = 0xFFFFFFFFFFFFFFFFuLL;
+        uint32_t offset = _findOccupiedSlot(0, static_cast<uint32_t>((this->_currentTick + 1u) & (_slotCount - 1u)));
+        if (offset < _slotCount)
+          distance = offset + 1u;
+
+        for (uint32_t level = 1u; level < _levels; ++level) {
+          const uint32_t shift = level * _slotBits;
+          const uint64_t block = this->_currentTick >> shift;
+          offset = _findOccupiedSlot(level, static_cast<uint32_t>((block + 1u) & (_slotCount - 1u)));
+          if (offset < _slotCount) {
+            const uint64_t cascadeDistance = ((block + 1u + offset) << shift) - this->_currentTick;
+            if (cascadeDistance < distance)
+              distance = cascadeDistance;
+          }
+        }
+        return distance;
+      }
+
+      // process ticks until target tick, or until a tick with expired timers (jobs stored in 'outJobs')
+      void _processTicks(uint64_t targetTick, std::vector<_JobParamType>& outJobs) {
+        while (this->_currentTick < targetTick && outJobs.empty()) {
+          uint64_t distance = _nextEventDistance();
+          if (distance > targetTick - this->_currentTick) { // nothing to do until target
+            this->_currentTick = targetTick;
+            return;
+          }
+          this->_currentTick += distance;
+          _processCurrentTick(outJobs);
+        }
+      }
+      // cascade higher wheels (on wrap-around) + collect expired timers of current tick
+      void _processCurrentTick(std::vector<_JobParamType>& outJobs) {
+        const uint64_t tick = this->_currentTick;
+        for (uint32_t level = 1u; level < _levels; ++level) {
+          if ((tick & ((1uLL << (level * _slotBits)) - 1u)) != 0)
+            break; // lower wheel hasn't wrapped around
+          const uint32_t bucket = level * _slotCount
+                                + static_cast<uint32_t>((tick >> (level * _slotBits)) & (_slotCount - 1u));
+          uint32_t index = this->_buckets[bucket];
+          this->_buckets[bucket] = _noNode;
+          _clearOccupiedSlot(bucket);
+          while (index != _noNode) { // re-insert in lower wheels
+            uint32_t next = this->_nodes[index].next;
+            _linkNode(index);
+            index = next;
+          }
+        }
+
+        const uint32_t slot = static_cast<uint32_t>(tick & (_slotCount - 1u));
+        uint32_t index = this->_buckets[slot];
+        this->_buckets[slot] = _noNode;
+        _clearOccupiedSlot(slot);
+        while (index != _noNode) {
+          TimerNode& node = this->_nodes[index];
+          uint32_t next = node.next;
+          if (node.period == 0u) { // one-shot -> release
+            outJobs.emplace_back(std::move(node.param));
+            _releaseNode(index);
+          }
+          else { // periodic -> re-insert
+            _pushCopy(outJobs, node.param);
+            node.expiration += node.period;
+            if (node.expiration <= tick)
+              node.expiration = tick + 1u;
+            _linkNode(index);
+          }
+          index = next;
+        }
+      }
+      template <typename J = _JobParamType>
+      static inline typename std::enable_if<std::is_copy_constructible<J>::value>::type
+      _pushCopy(std::vector<_JobParamType>& outJobs, const _JobParamType& param) { outJobs.emplace_back(param); }
+      template <typename J = _JobParamType>
+      static inline typename std::enable_if<!std::is_copy_constructible<J>::value>::type
+      _pushCopy(std::vector<_JobParamType>&, const _JobParamType&) { assert(false); } // periodic timers not available
+
+      // insert jobs of expired timers in pool (all jobs of a tick inserted at once)
+      size_t _dispatch(std::vector<_JobParamType>& jobs) {
+        size_t jobCount = jobs.size();
+        if (!this->_pool.addJobs(std::make_move_iterator(jobs.begin()), std::make_move_iterator(jobs.end()))) {
+          TRACE_N("TimerWheel: %u jobs rejected by pool", static_cast<uint32_t>(jobCount));
+          jobCount = 0;
+        }
+        jobs.clear();
+        return jobCount;
+      }
+
+      // -- threaded mode --
+
+      // timer thread: sleep until next event, process elapsed ticks
+      static void _runTimerThread(Type* parent) noexcept {
+        TRACE("TimerWheel: thread started");
+        std::vector<_JobParamType> dueJobs;
+        std::unique_lock<std::mutex> guard(parent->_lock);
+        while (parent->_isRunning) {
+          try {
+            if (parent->_timerCount == 0u) {
+              parent->_wakeUpTick = 0xFFFFFFFFFFFFFFFFuLL;
+              parent->_condition.wait(guard);
+              continue;
+            }
+
+            const uint64_t elapsedTicks = parent->_toElapsedTicks(clock_type::now());
+            if (parent->_currentTick < elapsedTicks) {
+              parent->_processTicks(elapsedTicks, dueJobs);
+              if (!dueJobs.empty()) {
+                guard.unlock();
+                parent->_dispatch(dueJobs);
+                guard.lock();
+              }
+              continue;
+            }
+
+            parent->_wakeUpTick = parent->_currentTick + parent->_nextEventDistance();
+            parent->_condition.wait_until(guard, parent->_startTime + parent->_tickDuration * static_cast<int64_t>(parent->_wakeUpTick));
+          }
+          catch (const std::exception& __DEBUG_ARG__(exc)) {
+            TRACE_N("TimerWheel: exception: %s", exc.what());
+            dueJobs.clear();
+            if (!guard.owns_lock())
+              guard.lock();
+          }
+        }
+        TRACE("TimerWheel: thread stopped");
+      }
+
+    private:
+      _PoolType& _pool;
+      duration _tickDuration;
+      time_point _startTime;
+      uint64_t _currentTick = 0;
+      uint64_t _wakeUpTick = 0;    // tick at which timer thread will wake up
+      size_t _timerCount = 0;
+
+      std::vector<TimerNode> _nodes;  // flat timer storage
+      uint32_t _freeNodes = _noNode;  // list of free nodes (reused)
+      uint32_t _buckets[_levels * _slotCount];   // first node of each slot
+      uint64_t _occupiedSlots[_levels][_slotCount / 64u] = {};   // non-empty slots of each wheel
+
+      bool _isRunning = false;
+      mutable std::mutex _lock;
+      std::condition_variable _condition;
+      std::thread _timerThread;
+    };
+
+  }
+}
@@ -0,0 +1,391 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <stdexcept>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <utility>
+#include <type_traits>
+#include <system/trace.h>
+#include "./spin_lock.h"
+#include "./thread_pool.h"
+#include "./pool_metrics.h"
+
+namespace pandora {
+  namespace thread {
+    /// @class WorkStealingThreadPool
+    /// @brief Fixed-size pool of threads with one job queue per thread: idle threads steal jobs from busy ones.
+    /// @description Alternative to ThreadPool for short jobs and high thread counts: each worker owns a local job queue,
+    ///              so producers and workers don't all contend for a single lock.
+    ///              - jobs inserted by an external thread are distributed to the worker queues (round-robin);
+    ///              - jobs inserted from inside a job (by a worker of the same pool) are pushed to the local queue of that worker;
+    ///              - each worker processes its most recent local jobs first (better cache locality);
+    ///              - idle workers steal the oldest jobs of other workers, and only sleep when no job is left.
+    /// @remarks Instrumentation (queue latency, run time, utilization, steal counts...) can be enabled with the PoolMetrics policy.
+    /// @warning Unlike ThreadPool, the processing order of jobs is not guaranteed to match their order of arrival.
+    template <typename _JobParamType,                        // Type of data container to process (must be movable)
+              ThreadRunnerMode _Mode = ThreadRunnerMode::single, // one function passed on construction / one per job
+              TaskRunnerType _FunctionType = TaskRunnerType::functionPointer, // function pointer / lambda
+              typename _Metrics = NoPoolMetrics> // instrumentation policy: NoPoolMetrics / PoolMetrics
+    class WorkStealingThreadPool final {
+    public:
+      using Type = WorkStealingThreadPool<_JobParamType,_Mode,_FunctionType,_Metrics>;
+      using metrics_type = _Metrics;
+      using size_type = size_t;
+      using task_runner_type = typename std::conditional<_FunctionType == TaskRunnerType::lambda, std::function<void(_JobParamType&)>, void (*)(_JobParamType&)>::type;
+      using task_runner_move = typename std::conditional<_FunctionType == TaskRunnerType::lambda, task_runner_type&&, task_runner_type>::type;
+    protected:
+      template<bool cond, typename _T>
+      using EnableIf = typename std::enable_if<cond, _T>::type;
+
+      using job_param_move = typename std::conditional<std::is_class<_JobParamType>::value, _JobParamType&&, _JobParamType>::type;
+      struct JobParamWithRunner : _Metrics::JobStamp { // Job data in 'perJob' mode (parameter + custom runner)
+        _JobParamType param;
+        task_runner_type runner;
+        JobParamWithRunner(job_param_move param) : param(std::move(param)), runner(nullptr) {}
+        JobParamWithRunner(job_param_move param, task_runner_move runner) : param(std::move(param)), runner(std::move(runner)) {}
+      };
+      struct JobParamWithStamp : _Metrics::JobStamp { // Job data in 'single' mode with metrics (parameter + insertion time)
+        _JobParamType param;
+        JobParamWithStamp(job_param_move param) : param(std::move(param)) {}
+      };
+      using job_item = typename std::conditional<(_Mode == ThreadRunnerMode::perJob), JobParamWithRunner,
+                                                 typename std::conditional<_Metrics::isEnabled, JobParamWithStamp, _JobParamType>::type>::type;
+
+      struct WorkerQueue { // Local jobs of a worker (back: owner side / front: steal side)
+        SpinLock lock;
+        std::deque<job_item> jobs;
+      };
+      struct SharedPoolData { // Synchronization & jobs data - shared with child threads
+        std::atomic<bool> isRunning{ false };
+        std::atomic<size_t> busyThreads{ 0 };
+        std::atomic<size_t> pendingJobs{ 0 };   // incremented before insertion, decremented after removal (never below real count)
+        std::atomic<size_t> sleepingThreads{ 0 };
+        std::atomic<uint32_t> nextQueue{ 0 };   // round-robin index for external insertions
+        std::unique_ptr<WorkerQueue[]> queues;
+        size_t queueCount = 0;
+        std::mutex sleepLock;
+        std::condition_variable condition;
+        _Metrics metrics;
+      };
+      struct WorkerContext { // Identity of current worker thread (if any)
+        const SharedPoolData* pool = nullptr;
+        uint32_t index = 0;
+      };
+
+    public:
+      /// @brief Create empty thread pool - not running
+      inline WorkStealingThreadPool() : _poolData(std::make_shared<SharedPoolData>()) {}
+      /// @brief Create and start a thread pool - mode: no common runner -> provide a task runner for each job
+      /// @warning in 'single' runner mode, jobs will not be processed!
+      inline WorkStealingThreadPool(size_t threadCount) : _poolData(std::make_shared<SharedPoolData>()) {
+        task_runner_type emptyRunner = nullptr;
+        _startThreads(threadCount, emptyRunner);
+      }
+      /// @brief Create and start a thread pool - mode: common task runner provided in constructor
+      /// @warning Required for standard use of 'single' runner mode, optional to have a default runner in 'perJob' mode.
+      inline WorkStealingThreadPool(size_t threadCount, task_runner_type commonRunner) : _poolData(std::make_shared<SharedPoolData>()) {
+        _startThreads(threadCount, commonRunner);
+      }
+
+      /// @brief Stop thread pool and wait for each thread to stop running
+      ~WorkStealingThreadPool() noexcept { _stopThreads(); }
+
+      WorkStealingThreadPool(const Type&) = delete;
+      Type& operator=(const Type&) = delete;
+      inline WorkStealingThreadPool(Type&& rhs) noexcept : _poolData(std::move(rhs._poolData)) {
+        std::swap(this->_threads, rhs._threads);
+        rhs._poolData = std::make_shared<SharedPoolData>();
+      }
+      inline Type& operator=(Type&& rhs) noexcept {
+        _stopThreads();
+        std::swap(this->_threads, rhs._threads);
+        this->_poolData = std::move(rhs._poolData);
+        rhs._poolData = std::make_shared<SharedPoolData>();
+        return *this;
+      }
+
+      // -- thread pool size --
+
+      inline size_type size() const noexcept { return this->_threads.size(); } ///< Total number of threads in the pool
+      /// @brief Number of active threads in the pool (currently processing a job)
+      inline size_type busyThreads() const noexcept { return this->_poolData->busyThreads.load(std::memory_order_acquire); }
+      /// @brief Number of threads waiting in the pool (ready for new jobs)
+      inline size_type freeThreads() const noexcept { return size() - busyThreads(); }
+      /// @brief Number of jobs waiting to be processed (approximation, if jobs are being inserted/started simultaneously)
+      inline size_type pendingJobs() const noexcept { return this->_poolData->pendingJobs.load(std::memory_order_acquire); }
+
+      // -- instrumentation --
+
+      /// @brief Pool metrics: read them with 'metrics().snapshot()' (empty snapshot with NoPoolMetrics policy)
+      inline const _Metrics& metrics() const noexcept { return this->_poolData->metrics; }
+      /// @brief Reset pool metrics (start new measurement period)
+      inline void resetMetrics() noexcept { this->_poolData->metrics.reset(); }
+
+      // -- job management --
+
+      /// @brief Insert a new job to process (copied) - custom task runner for each job (not available in 'single' runner mode)
+      template<typename J = _JobParamType, ThreadRunnerMode M = _Mode>
+      inline EnableIf<(!std::is_class<J>::value || std::is_copy_constructible<J>::value) && M == ThreadRunnerMode::perJob,
+                      bool> addJob(const _JobParamType& param, task_runner_move runner) {
+        return _pushJob(_JobParamType(param), std::move(runner));
+      }
+      /// @brief Insert a new job to process (moved) - custom task runner for each job (not available in 'single' runner mode)
+      template<ThreadRunnerMode M = _Mode>
+      inline EnableIf<M==ThreadRunnerMode::perJob,
+                      bool> addJob(_JobParamType&& param, task_runner_move runner) {
+        return _pushJob(std::move(param), std::move(runner));
+      }
+
+      /// @brief Insert a new job to process (copied) - use common task runner provided in constructor
+      template<typename J = _JobParamType>
+      inline EnableIf<!std::is_class<J>::value || std::is_copy_constructible<J>::value,
+                      bool> addJob(const _JobParamType& param) {
+        return _pushJob(_JobParamType(param));
+      }
+      /// @brief Insert a new job to process (moved) - use common task runner provided in constructor
+      inline bool addJob(_JobParamType&& param) {
+        return _pushJob(std::move(param));
+      }
+
+      /// @brief Cancel all jobs that haven't already been started
+      inline uint32_t cancelPendingJobs() noexcept {
+        SharedPoolData& sync = *(this->_poolData);
+        size_t jobCount = 0;
+        for (size_t i = 0; i < sync.queueCount; ++i) {
+          WorkerQueue& queue = sync.queues[i];
+          std::lock_guard<SpinLock> guard(queue.lock);
+          jobCount += queue.jobs.size();
+          queue.jobs.clear();
+        }
+        sync.pendingJobs.fetch_sub(jobCount, std::memory_order_acq_rel);
+        return static_cast<uint32_t>(jobCount);
+      }
+
+    protected:
+      // -- job insertion --
+
+      // insert job in local queue (if called by a worker of current pool) or in next worker queue
+      template <typename ... _Args>
+      bool _pushJob(_Args&&... args) {
+        SharedPoolData& sync = *(this->_poolData);
+        if (!sync.isRunning.load(std::memory_order_acquire) || sync.queueCount == 0)
+          return false;
+
+        const WorkerContext& context = _currentWorker();
+        uint32_t queueIndex = (context.pool == &sync)
+                            ? context.index
+                            : sync.nextQueue.fetch_add(1u, std::memory_order_relaxed) % static_cast<uint32_t>(sync.queueCount);
+
+        size_t queueDepth = sync.pendingJobs.fetch_add(1u, std::memory_order_seq_cst) + 1u;
+        WorkerQueue& queue = sync.queues[queueIndex];
+        queue.lock.lock();
+        try {
+          queue.jobs.emplace_back(std::forward<_Args>(args)...);
+          _onJobInserted(sync, queue.jobs.back(), queueDepth);
+        }
+        catch (...) {
+          queue.lock.unlock();
+          sync.pendingJobs.fetch_sub(1u, std::memory_order_acq_rel);
+          throw;
+        }
+        queue.lock.unlock();
+
+        if (sync.sleepingThreads.load(std::memory_order_seq_cst) > 0) {
+          { std::lock_guard<std::mutex> guard(sync.sleepLock); } // ensure that sleeping candidate is already waiting
+          sync.condition.notify_one();
+        }
+        return true;
+      }
+
+      // update metrics after inserting a job (jobs without stamp: metrics disabled)
+      static inline void _onJobInserted(SharedPoolData& sync, typename _Metrics::JobStamp& job, size_t queueDepth) noexcept {
+        sync.metrics.onEnqueue(job, queueDepth);
+      }
+      static inline void _onJobInserted(SharedPoolData&, _JobParamType&, size_t) noexcept {}
+
+      // -- thread management --
+
+      // launch thread pool
+      void _startThreads(size_t threadCount, task_runner_type& runner) {
+        SharedPoolData& sync = *(this->_poolData);
+        sync.metrics.init(threadCount);
+        sync.queues.reset(new WorkerQueue[threadCount ? threadCount : 1u]);
+        sync.queueCount = threadCount;
+        sync.isRunning = true;
+        sync.busyThreads = 0u;
+        this->_threads.reserve(threadCount);
+        for (uint32_t index = 0; index < threadCount; ++index)
+          this->_threads.emplace_back(&Type::_runThread, this->_poolData, index, runner);
+      }
+
+      // stop all threads
+      void _stopThreads() noexcept {
+        SharedPoolData& sync = *(this->_poolData);
+        std::unique_lock<std::mutex> guard(sync.sleepLock);
+        sync.isRunning = false;
+        guard.unlock();
+        cancelPendingJobs();
+
+        sync.condition.notify_all();
+        for (auto& item : this->_threads) {
+          if (item.joinable()) {
+            try {
+              item.join();
+            }
+            catch (const std::exception& __DEBUG_ARG__(exc)) {
+              TRACE_N("WorkStealingThreadPool: thread join exception: %s", exc.what());
+              try { item.detach(); } catch (const std::exception&) {}
+            }
+          }
+        }
+        this->_threads.clear();
+      }
+
+      // -- thread execution --
+
+      // identity of the current thread (set for worker threads)
+      static inline WorkerContext& _currentWorker() noexcept {
+        static thread_local WorkerContext context;
+        return context;
+      }
+
+      // extract most recent job from local queue and process it
+      static inline bool _runLocalJob(SharedPoolData& sync, WorkerQueue& queue, uint32_t index, task_runner_type& runner) {
+        std::unique_lock<SpinLock> guard(queue.lock);
+        if (queue.jobs.empty())
+          return false;
+        job_item jobData(std::move(queue.jobs.back()));
+        queue.jobs.pop_back();
+        guard.unlock();
+
+        _processJob(sync, jobData, index, runner);
+        return true;
+      }
+      // steal oldest job from the queue of another worker and process it
+      static inline bool _runStolenJob(SharedPoolData& sync, uint32_t index, task_runner_type& runner) {
+        for (size_t offset = 1u; offset < sync.queueCount; ++offset) {
+          WorkerQueue& victim = sync.queues[(index + offset) % sync.queueCount];
+          std::unique_lock<SpinLock> guard(victim.lock, std::try_to_lock);
+          if (!guard.owns_lock() || victim.jobs.empty()) // busy queue -> retried on next pass
+            continue;
+          job_item jobData(std::move(victim.jobs.front()));
+          victim.jobs.pop_front();
+          guard.unlock();
+
+          sync.metrics.onSteal(index);
+          _processJob(sync, jobData, index, runner);
+          return true;
+        }
+        return false;
+      }
+      // process extracted job
+      static inline void _processJob(SharedPoolData& sync, job_item& jobData, uint32_t index, task_runner_type& runner) noexcept {
+        sync.busyThreads.fetch_add(1u, std::memory_order_acq_rel); // before decrementing pending jobs: never both at 0 while a job is active
+        sync.pendingJobs.fetch_sub(1u, std::memory_order_acq_rel);
+        auto startTime = _onJobStarted(sync, jobData, index);
+        try {
+          _callRunner(jobData, runner);
+        }
+        catch (const std::exception& __DEBUG_ARG__(exc)) { TRACE_N("WorkStealingThreadPool: exception: %s", exc.what()); }
+        catch (...) { TRACE("WorkStealingThreadPool: unknown exception type thrown"); }
+        sync.metrics.onFinish(startTime, index);
+        sync.busyThreads.fetch_sub(1u, std::memory_order_acq_rel);
+      }
+      // update metrics before processing a job
+      static inline typename _Metrics::StartTime _onJobStarted(SharedPoolData& sync, const typename _Metrics::JobStamp& job, uint32_t index) noexcept {
+        return sync.metrics.onStart(job, index);
+      }
+      static inline typename _Metrics::StartTime _onJobStarted(SharedPoolData&, const _JobParamType&, uint32_t) noexcept {
+        return typename _Metrics::StartTime{};
+      }
+
+      // main thread execution loop
+      static void _runThread(std::shared_ptr<SharedPoolData> shared, uint32_t index, task_runner_type commonRunner) noexcept {
+        TRACE_N("WorkStealingThreadPool: thread %u started", index);
+        assert(shared != nullptr);
+        SharedPoolData& sync = *shared;
+        WorkerQueue& localQueue = sync.queues[index];
+        if (commonRunner == nullptr)
+          commonRunner = &Type::_defaultRunner;
+
+        WorkerContext& context = _currentWorker();
+        context.pool = &sync;
+        context.index = index;
+
+        while (sync.isRunning.load(std::memory_order_acquire)) {
+          bool isFound = false;
+          try {
+            isFound = (_runLocalJob(sync, localQueue, index, commonRunner) || _runStolenJob(sync, index, commonRunner));
+          }
+          catch (...) { TRACE("WorkStealingThreadPool: job extraction failure"); }
+
+          if (!isFound) {
+            if (sync.pendingJobs.load(std::memory_order_acquire) > 0) { // job being inserted, or victim queue busy -> retry
+              std::this_thread::yield();
+            }
+            else { // no job left -> sleep until next insertion
+              std::unique_lock<std::mutex> guard(sync.sleepLock);
+              sync.sleepingThreads.fetch_add(1u, std::memory_order_seq_cst);
+              while (sync.isRunning.load(std::memory_order_acquire) && sync.pendingJobs.load(std::memory_order_seq_cst) == 0)
+                sync.condition.wait(guard);
+              sync.sleepingThreads.fetch_sub(1u, std::memory_order_seq_cst);
+            }
+          }
+        }
+
+        context.pool = nullptr;
+        TRACE_N("WorkStealingThreadPool: thread %u stopped", index);
+      }
+
+      // specialized calls to task runner
+      static inline void _callRunner(JobParamWithRunner& jobData, task_runner_type& defaultRunner) {
+        if (jobData.runner != nullptr)
+          jobData.runner(jobData.param);
+        else
+          defaultRunner(jobData.param);
+      }
+      static inline void _callRunner(JobParamWithStamp& jobData, task_runner_type& defaultRunner) {
+        defaultRunner(jobData.param);
+      }
+      static inline void _callRunner(_JobParamType& param, task_runner_type& defaultRunner) {
+        defaultRunner(param);
+      }
+      // default task runner, if none provided
+      static inline void _defaultRunner(_JobParamType&) {
+        TRACE("WorkStealingThreadPool: no common runner provided.");
+      }
+
+    private:
+      std::vector<std::thread> _threads;
+      std::shared_ptr<SharedPoolData> _poolData;
+    };
+
+  }
+}
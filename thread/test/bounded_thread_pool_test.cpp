@@ -0,0 +1,183 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <thread/bounded_thread_pool.h>
+
+using namespace pandora::thread;
+
+class BoundedThreadPoolTest : public testing::Test {
+public:
+protected:
+  //static void SetUpTestCase() {}
+  //static void TearDownTestCase() {}
+
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+
+// -- helpers --
+
+static std::atomic<int> boundedTotalValue{ 0 };
+void _boundedTaskRunner(int& param) {
+  boundedTotalValue += param;
+  std::this_thread::sleep_for(std::chrono::milliseconds(1u));
+}
+void _boundedTaskRunner(std::unique_ptr<int>& param) {
+  if (param != nullptr)
+    boundedTotalValue += *param;
+}
+void _boundedExceptionRunner(int& val) {
+  if (val == 42)
+    throw val;
+  boundedTotalValue += val;
+  throw std::runtime_error("ok");
+}
+
+template <typename T>
+bool _waitForBoundedPoolCompletion(const T& pool) {
+  auto timeoutTime = std::chrono::steady_clock::now() + std::chrono::milliseconds(5000u);
+  while (std::chrono::steady_clock::now() < timeoutTime) {
+    if (pool.pendingJobs() == 0u && pool.busyThreads() == 0u) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1u));
+      if (pool.pendingJobs() == 0u && pool.busyThreads() == 0u) // second check, in case a thread was about to increment its counter
+        return true;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(100u));
+  }
+  return false;
+}
+
+
+// -- special constructors --
+
+TEST_F(BoundedThreadPoolTest, emptyPool) {
+  BoundedThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool;
+  EXPECT_EQ(size_t{ 0u }, pool.size());
+  EXPECT_EQ(size_t{ 0u }, pool.capacity());
+  EXPECT_EQ(size_t{ 0u }, pool.busyThreads());
+  EXPECT_EQ(size_t{ 0u }, pool.freeThreads());
+  EXPECT_EQ(size_t{ 0u }, pool.pendingJobs());
+  EXPECT_FALSE(pool.addJob(5));
+  EXPECT_EQ(0u, pool.cancelPendingJobs());
+
+  BoundedThreadPool<int, ThreadRunnerMode::perJob, TaskRunnerType::lambda, FullQueueHandling::wait> pool2;
+  EXPECT_EQ(size_t{ 0u }, pool2.size());
+  EXPECT_FALSE(pool2.addJob(5, [](int&) {}));
+  EXPECT_EQ(0u, pool2.cancelPendingJobs());
+}
+
+TEST_F(BoundedThreadPoolTest, movedPool) {
+  BoundedThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool1;
+  BoundedThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool2(4u, 16u, &_boundedTaskRunner);
+  BoundedThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool3(5u, 16u, &_boundedTaskRunner);
+
+  BoundedThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> poolMoved1(std::move(pool1));
+  BoundedThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> poolMoved2(std::move(pool2));
+  pool1 = std::move(pool3);
+  EXPECT_EQ(0u, poolMoved1.size());
+  EXPECT_EQ(4u, poolMoved2.size());
+  EXPECT_EQ(5u, pool1.size());
+  EXPECT_EQ(16u, pool1.capacity());
+  EXPECT_FALSE(pool3.addJob(1));
+  EXPECT_TRUE(pool1.addJob(1));
+}
+
+
+// -- job processing --
+
+TEST_F(BoundedThreadPoolTest, commonRunner) {
+  BoundedThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool(4u, 64u, &_boundedTaskRunner);
+  EXPECT_EQ(size_t{ 4u }, pool.size());
+  EXPECT_EQ(pool.size(), pool.freeThreads());
+
+  boundedTotalValue = 0;
+  for (int i = 0; i < 64; ++i)
+    EXPECT_TRUE(pool.addJob(2));
+  EXPECT_TRUE(_waitForBoundedPoolCompletion(pool));
+  EXPECT_EQ(128, boundedTotalValue.load());
+  EXPECT_EQ(pool.size(), pool.freeThreads());
+
+  // move-only type
+  BoundedThreadPool<std::unique_ptr<int>, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool2(2u, 8u, &_boundedTaskRunner);
+  boundedTotalValue = 0;
+  EXPECT_TRUE(pool2.addJob(std::make_unique<int>(2)));
+  EXPECT_TRUE(_waitForBoundedPoolCompletion(pool2));
+  EXPECT_EQ(2, boundedTotalValue.load());
+}
+
+TEST_F(BoundedThreadPoolTest, runnerPerJob) {
+  BoundedThreadPool<int, ThreadRunnerMode::perJob, TaskRunnerType::lambda> pool(3u, 128u, [](int& val) { boundedTotalValue += val; });
+
+  boundedTotalValue = 0;
+  for (int i = 0; i < 32; ++i)
+    EXPECT_TRUE(pool.addJob(1, [](int& val) { boundedTotalValue += 2*val; }));
+  for (int i = 0; i < 32; ++i)
+    EXPECT_TRUE(pool.addJob(1));
+  EXPECT_TRUE(_waitForBoundedPoolCompletion(pool));
+  EXPECT_EQ(96, boundedTotalValue.load());
+}
+
+// -- full queue --
+
+TEST_F(BoundedThreadPoolTest, fullQueueReject) {
+  BoundedThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool(1u, 4u, &_boundedTaskRunner);
+  boundedTotalValue = 0;
+
+  int accepted = 0;
+  for (int i = 0; i < 32; ++i) {
+    if (pool.addJob(1))
+      ++accepted;
+  }
+  EXPECT_LT(accepted, 32);
+  EXPECT_GE(accepted, 4);
+  auto cancelled = pool.cancelPendingJobs();
+  EXPECT_TRUE(_waitForBoundedPoolCompletion(pool));
+  EXPECT_EQ(accepted, boundedTotalValue.load() + static_cast<int>(cancelled));
+}
+
+TEST_F(BoundedThreadPoolTest, fullQueueWait) {
+  BoundedThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer, FullQueueHandling::wait> pool(2u, 4u, &_boundedTaskRunner);
+  boundedTotalValue = 0;
+
+  for (int i = 0; i < 32; ++i)
+    EXPECT_TRUE(pool.addJob(1));
+  EXPECT_TRUE(_waitForBoundedPoolCompletion(pool));
+  EXPECT_EQ(32, boundedTotalValue.load());
+}
+
+// -- exception management --
+
+TEST_F(BoundedThreadPoolTest, runnerWithException) {
+  BoundedThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool(1u, 4u, &_boundedExceptionRunner);
+  boundedTotalValue = 0;
+
+  EXPECT_TRUE(pool.addJob(2));
+  EXPECT_TRUE(_waitForBoundedPoolCompletion(pool));
+  EXPECT_EQ(2, boundedTotalValue.load());
+
+  EXPECT_TRUE(pool.addJob(42));
+  EXPECT_TRUE(_waitForBoundedPoolCompletion(pool));
+  EXPECT_EQ(2, boundedTotalValue.load());
+}
@@ -0,0 +1,180 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include <gtest/gtest.h>
+#include <thread/coroutine.h>
+#if defined(__P_THREAD_COROUTINES)
+# include <thread>
+# include <chrono>
+# include <stdexcept>
+# include <vector>
+
+  using namespace pandora::thread;
+
+  class CoroutineTest : public testing::Test {
+  public:
+  protected:
+    //static void SetUpTestCase() {}
+    //static void TearDownTestCase() {}
+
+    void SetUp() override {}
+    void TearDown() override {}
+  };
+
+  // -- helpers --
+
+  static Task<int> __coroutineValue(int value) {
+    co_return value;
+  }
+  static Task<int> __coroutineSum(int count) {
+    int sum = 0;
+    for (int i = 1; i <= count; ++i)
+      sum += co_await __coroutineValue(i);
+    co_return sum;
+  }
+  static Task<int> __coroutineThrow() {
+    throw std::runtime_error("coroutine error");
+    co_return 0;
+  }
+  static Task<void> __coroutineCatch(bool& outIsCaught) {
+    try { co_await __coroutineThrow(); }
+    catch (const std::runtime_error&) { outIsCaught = true; }
+  }
+
+  static Task<std::thread::id> __coroutineWorkerId(CoroutineThreadPool& pool, bool& outIsScheduled) {
+    outIsScheduled = co_await scheduleOn(pool);
+    co_return std::this_thread::get_id();
+  }
+
+  static Task<void> __coroutineLockIncrement(CoroutineThreadPool& pool, AsyncLock& lock, int& counter) {
+    co_await scheduleOn(pool);
+    for (int i = 0; i < 100; ++i) {
+      auto guard = co_await lock.scopedLock();
+      ++counter;
+      if (i == 50)
+        co_await scheduleOn(pool); // suspend while locked -> other coroutines wait for lock
+    }
+  }
+  static Task<void> __coroutineWait(AsyncSemaphore& done) {
+    co_await done.wait();
+  }
+
+
+  // -- task --
+
+  TEST_F(CoroutineTest, taskResult) {
+    EXPECT_EQ(7, syncWait(__coroutineValue(7)));
+    EXPECT_EQ(55, syncWait(__coroutineSum(10)));
+
+    Task<int> task = __coroutineSum(4);
+    EXPECT_TRUE(task.isValid());
+    EXPECT_FALSE(task.isReady()); // lazy
+    Task<int> moved = std::move(task);
+    EXPECT_FALSE(task.isValid());
+    Task<int>& self = moved;
+    moved = std::move(self); // self-assignment: coroutine kept
+    EXPECT_TRUE(moved.isValid());
+    EXPECT_EQ(10, syncWait(std::move(moved)));
+
+    Task<int> emptyTask;
+    EXPECT_FALSE(emptyTask.isValid());
+    EXPECT_TRUE(emptyTask.isReady());
+  }
+
+  TEST_F(CoroutineTest, taskException) {
+    EXPECT_THROW(syncWait(__coroutineThrow()), std::runtime_error);
+    bool isCaught = false;
+    syncWait(__coroutineCatch(isCaught));
+    EXPECT_TRUE(isCaught);
+  }
+
+  TEST_F(CoroutineTest, frameArena) {
+    void* first = CoroutineFrameArena::allocate(100u);
+    ASSERT_TRUE(first != nullptr);
+    CoroutineFrameArena::deallocate(first, 100u);
+    void* second = CoroutineFrameArena::allocate(120u); // same size class -> recycled
+    EXPECT_EQ(first, second);
+    CoroutineFrameArena::deallocate(second, 120u);
+
+    void* big = CoroutineFrameArena::allocate(CoroutineFrameArena::maxBlockSize + 1u);
+    ASSERT_TRUE(big != nullptr);
+    CoroutineFrameArena::deallocate(big, CoroutineFrameArena::maxBlockSize + 1u);
+  }
+
+  // -- executors --
+
+  TEST_F(CoroutineTest, scheduleOnPool) {
+    CoroutineThreadPool pool(2, &resumeCoroutine);
+    bool isScheduled = false;
+    std::thread::id workerId = syncWait(__coroutineWorkerId(pool, isScheduled));
+    EXPECT_TRUE(isScheduled);
+    EXPECT_NE(std::this_thread::get_id(), workerId);
+
+    CoroutineThreadPool stoppedPool;
+    workerId = syncWait(__coroutineWorkerId(stoppedPool, isScheduled));
+    EXPECT_FALSE(isScheduled);
+    EXPECT_EQ(std::this_thread::get_id(), workerId);
+  }
+
+  static Task<int64_t> __coroutineSleep(CoroutineTimerWheel<>& timers) {
+    auto start = std::chrono::steady_clock::now();
+    co_await sleepFor(timers, std::chrono::milliseconds(20));
+    co_await sleepUntil(timers, std::chrono::system_clock::now() + std::chrono::milliseconds(10));
+    co_await sleepFor(timers, std::chrono::milliseconds(-5)); // already expired -> no suspension
+    co_return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+  }
+  TEST_F(CoroutineTest, sleepTimers) {
+    CoroutineThreadPool pool(1, &resumeCoroutine);
+    CoroutineTimerWheel<> timers(pool, std::chrono::milliseconds(1));
+    int64_t elapsed = syncWait(__coroutineSleep(timers));
+    EXPECT_GE(elapsed, 29LL);
+    EXPECT_TRUE(timers.empty());
+  }
+
+  // -- synchronization --
+
+  TEST_F(CoroutineTest, asyncSemaphore) {
+    AsyncSemaphore semaphore(2u);
+    EXPECT_EQ(2u, semaphore.count());
+    EXPECT_TRUE(semaphore.tryWait());
+    syncWait(__coroutineWait(semaphore)); // available -> no suspension
+    EXPECT_FALSE(semaphore.tryWait());
+    semaphore.notify(3u);
+    EXPECT_EQ(3u, semaphore.count());
+  }
+
+  TEST_F(CoroutineTest, asyncLock) {
+    CoroutineThreadPool pool(4, &resumeCoroutine);
+    AsyncLock lock;
+    int counter = 0;
+    std::vector<Task<void> > tasks;
+    for (int i = 0; i < 8; ++i)
+      tasks.emplace_back(__coroutineLockIncrement(pool, lock, counter));
+
+    std::vector<std::thread> waiters;
+    for (auto& task : tasks) // each task started by a thread, then moved to the pool
+      waiters.emplace_back([&task]() { syncWait(std::move(task)); });
+    for (auto& waiter : waiters)
+      waiter.join();
+
+    EXPECT_EQ(800, counter);
+    EXPECT_TRUE(lock.tryLock());
+    EXPECT_FALSE(lock.tryLock());
+    lock.unlock();
+  }
+#endif
@@ -0,0 +1,234 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <thread/elastic_thread_pool.h>
+
+using namespace pandora::thread;
+
+class ElasticThreadPoolTest : public testing::Test {
+public:
+protected:
+  //static void SetUpTestCase() {}
+  //static void TearDownTestCase() {}
+
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+
+// -- helpers --
+
+static std::atomic<int> elasticTotalValue{ 0 };
+static std::atomic<bool> elasticIsBlocked{ false };
+
+void _elasticTaskRunner(int& param) {
+  if (param < 0) { // blocking job
+    while (elasticIsBlocked.load())
+      std::this_thread::sleep_for(std::chrono::microseconds(100u));
+    return;
+  }
+  elasticTotalValue += param;
+}
+
+static ElasticPoolParams _elasticParams(size_t minThreads, size_t maxThreads, uint32_t latencyUs, uint32_t idleTimeoutMs) {
+  ElasticPoolParams params;
+  params.minThreads = minThreads;
+  params.maxThreads = maxThreads;
+  params.growthLatency = std::chrono::microseconds(latencyUs);
+  params.idleTimeout = std::chrono::milliseconds(idleTimeoutMs);
+  return params;
+}
+template <typename T>
+bool _waitForElasticPoolCompletion(const T& pool) {
+  auto timeoutTime = std::chrono::steady_clock::now() + std::chrono::milliseconds(5000u);
+  while (std::chrono::steady_clock::now() < timeoutTime) {
+    if (pool.pendingJobs() == 0u && pool.busyThreads() == 0u) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1u));
+      if (pool.pendingJobs() == 0u && pool.busyThreads() == 0u)
+        return true;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(100u));
+  }
+  return false;
+}
+template <typename T>
+bool _waitForElasticPoolSize(const T& pool, size_t threadCount) {
+  for (int retry = 0; retry < 5000 && pool.size() != threadCount; ++retry)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1u));
+  return (pool.size() == threadCount);
+}
+
+
+// -- special constructors --
+
+TEST_F(ElasticThreadPoolTest, emptyPool) {
+  ElasticThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool;
+  EXPECT_EQ(size_t{ 0u }, pool.size());
+  EXPECT_EQ(size_t{ 0u }, pool.busyThreads());
+  EXPECT_EQ(size_t{ 0u }, pool.spawnedThreads());
+  EXPECT_FALSE(pool.addJob(5));
+  EXPECT_FALSE(pool.resize(2u));
+  EXPECT_EQ(size_t{ 0u }, pool.size());
+  EXPECT_EQ(0u, pool.cancelPendingJobs());
+
+  ElasticThreadPool<int, ThreadRunnerMode::perJob, TaskRunnerType::lambda> pool2;
+  EXPECT_FALSE(pool2.addJob(5, [](int&) {}));
+}
+
+TEST_F(ElasticThreadPoolTest, movedPool) {
+  ElasticThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool1;
+  ElasticThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool2(_elasticParams(2u, 4u, 1000u, 10000u), &_elasticTaskRunner);
+  ElasticThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> poolMoved(std::move(pool2));
+  pool1 = std::move(poolMoved);
+  EXPECT_EQ(size_t{ 2u }, pool1.size());
+  EXPECT_EQ(size_t{ 2u }, pool1.minThreads());
+  EXPECT_EQ(size_t{ 4u }, pool1.maxThreads());
+  EXPECT_EQ(size_t{ 2u }, pool1.spawnedThreads());
+  EXPECT_EQ(size_t{ 0u }, poolMoved.size());
+  EXPECT_FALSE(pool2.addJob(1));
+  EXPECT_TRUE(pool1.addJob(0));
+}
+
+TEST_F(ElasticThreadPoolTest, defaultLimits) {
+  ElasticThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool(ElasticPoolParams{}, &_elasticTaskRunner);
+  EXPECT_EQ(size_t{ 1u }, pool.size());
+  EXPECT_TRUE(pool.maxThreads() >= size_t{ 1u });
+
+  ElasticThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool2(_elasticParams(3u, 2u, 1000u, 10000u), &_elasticTaskRunner);
+  EXPECT_EQ(size_t{ 3u }, pool2.size());
+  EXPECT_EQ(size_t{ 3u }, pool2.maxThreads()); // max >= min
+}
+
+// -- growth / retirement --
+
+TEST_F(ElasticThreadPoolTest, growWithQueueLatency) {
+  ElasticThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool(_elasticParams(1u, 3u, 1000u, 10000u), &_elasticTaskRunner);
+  elasticTotalValue = 0;
+  elasticIsBlocked = true;
+  EXPECT_TRUE(pool.addJob(-1));
+  EXPECT_TRUE(pool.addJob(1));
+  EXPECT_EQ(size_t{ 1u }, pool.size());
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(5u)); // pending job waited more than growth latency
+  EXPECT_TRUE(pool.addJob(2));
+  EXPECT_TRUE(_waitForElasticPoolSize(pool, 2u));
+  EXPECT_EQ(size_t{ 2u }, pool.spawnedThreads());
+  for (int retry = 0; retry < 5000 && elasticTotalValue.load() != 3; ++retry)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1u));
+  EXPECT_EQ(3, elasticTotalValue.load());
+
+  elasticIsBlocked = false;
+  EXPECT_TRUE(_waitForElasticPoolCompletion(pool));
+  EXPECT_TRUE(pool.size() <= size_t{ 3u });
+}
+
+TEST_F(ElasticThreadPoolTest, growWhileAllThreadsBlocked) {
+  ElasticThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool(_elasticParams(2u, 3u, 2000u, 10000u), &_elasticTaskRunner);
+  elasticTotalValue = 0;
+  elasticIsBlocked = true;
+  EXPECT_TRUE(pool.addJob(-1));
+  EXPECT_TRUE(pool.addJob(-1));
+  for (int retry = 0; retry < 5000 && pool.busyThreads() != 2u; ++retry)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1u));
+  EXPECT_TRUE(pool.addJob(5)); // all threads blocked, no other insertion/extraction
+
+  EXPECT_TRUE(_waitForElasticPoolSize(pool, 3u)); // thread added by latency monitoring
+  for (int retry = 0; retry < 5000 && elasticTotalValue.load() != 5; ++retry)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1u));
+  EXPECT_EQ(5, elasticTotalValue.load());
+  EXPECT_EQ(size_t{ 3u }, pool.spawnedThreads());
+
+  elasticIsBlocked = false;
+  EXPECT_TRUE(_waitForElasticPoolCompletion(pool));
+}
+
+TEST_F(ElasticThreadPoolTest, retireIdleThreads) {
+  ElasticThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool(_elasticParams(1u, 4u, 1000u, 20u), &_elasticTaskRunner);
+  EXPECT_TRUE(pool.resize(3u));
+  EXPECT_EQ(size_t{ 3u }, pool.size());
+  EXPECT_EQ(size_t{ 3u }, pool.spawnedThreads());
+
+  EXPECT_TRUE(_waitForElasticPoolSize(pool, 1u)); // idle timeout -> back to min size
+  EXPECT_EQ(size_t{ 2u }, pool.retiredThreads());
+  std::this_thread::sleep_for(std::chrono::milliseconds(40u));
+  EXPECT_EQ(size_t{ 1u }, pool.size());
+
+  elasticTotalValue = 0;
+  EXPECT_TRUE(pool.addJob(4)); // retired threads joined
+  EXPECT_TRUE(_waitForElasticPoolCompletion(pool));
+  EXPECT_EQ(4, elasticTotalValue.load());
+}
+
+TEST_F(ElasticThreadPoolTest, resizeKeepsPendingJobs) {
+  ElasticThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool(_elasticParams(2u, 2u, 1000000u, 10000u), &_elasticTaskRunner);
+  elasticTotalValue = 0;
+  elasticIsBlocked = true;
+  EXPECT_TRUE(pool.addJob(-1));
+  EXPECT_TRUE(pool.addJob(-1));
+  for (int retry = 0; retry < 5000 && pool.busyThreads() != 2u; ++retry)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1u));
+  std::vector<int> values{ 1, 2, 4, 8 };
+  EXPECT_TRUE(pool.addJobs(values.begin(), values.end()));
+
+  EXPECT_TRUE(pool.resize(0u)); // busy threads retired after current job, last thread after processing pending jobs
+  EXPECT_EQ(size_t{ 0u }, pool.minThreads());
+  elasticIsBlocked = false;
+  EXPECT_TRUE(_waitForElasticPoolCompletion(pool)); // no other insertion -> pending jobs processed anyway
+  EXPECT_EQ(15, elasticTotalValue.load());
+  EXPECT_TRUE(_waitForElasticPoolSize(pool, 0u));
+  EXPECT_EQ(size_t{ 0u }, pool.pendingJobs());
+  EXPECT_EQ(size_t{ 2u }, pool.retiredThreads());
+
+  EXPECT_TRUE(pool.resize(4u));
+  EXPECT_EQ(size_t{ 4u }, pool.maxThreads());
+  EXPECT_TRUE(pool.addJob(16));
+  EXPECT_TRUE(_waitForElasticPoolCompletion(pool));
+  EXPECT_EQ(31, elasticTotalValue.load());
+  EXPECT_EQ(size_t{ 4u }, pool.size());
+  EXPECT_EQ(size_t{ 6u }, pool.spawnedThreads());
+  EXPECT_EQ(size_t{ 2u }, pool.retiredThreads());
+}
+
+TEST_F(ElasticThreadPoolTest, growFromEmptyPool) {
+  ElasticThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool(_elasticParams(0u, 2u, 1000000u, 10000u), &_elasticTaskRunner);
+  EXPECT_EQ(size_t{ 0u }, pool.size());
+  elasticTotalValue = 0;
+  EXPECT_TRUE(pool.addJob(3)); // no thread -> created without waiting for growth latency
+  EXPECT_TRUE(_waitForElasticPoolCompletion(pool));
+  EXPECT_EQ(3, elasticTotalValue.load());
+  EXPECT_EQ(size_t{ 1u }, pool.size());
+}
+
+// -- job processing --
+
+TEST_F(ElasticThreadPoolTest, runnerPerJob) {
+  ElasticThreadPool<int, ThreadRunnerMode::perJob, TaskRunnerType::lambda> pool(_elasticParams(1u, 4u, 100u, 10000u), [](int& val) { elasticTotalValue += val; });
+  elasticTotalValue = 0;
+  for (int i = 0; i < 32; ++i) {
+    EXPECT_TRUE(pool.addJob(1, [](int& val) { elasticTotalValue += 2*val; }));
+    EXPECT_TRUE(pool.addJob(1));
+  }
+  EXPECT_TRUE(_waitForElasticPoolCompletion(pool));
+  EXPECT_EQ(96, elasticTotalValue.load());
+  EXPECT_TRUE(pool.size() >= size_t{ 1u } && pool.size() <= size_t{ 4u });
+}
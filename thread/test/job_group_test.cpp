@@ -0,0 +1,240 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include <gtest/gtest.h>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <thread/job_group.h>
+#include <thread/thread_pool.h>
+
+using namespace pandora::thread;
+
+class JobGroupTest : public testing::Test {
+public:
+protected:
+  //static void SetUpTestCase() {}
+  //static void TearDownTestCase() {}
+
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+// -- helpers --
+
+static std::atomic<uint32_t> __groupJobCount{ 0 };
+static void __groupCountJob(int&) {
+  __groupJobCount.fetch_add(1u);
+}
+
+struct __GroupBlockingJob final { // wait for cancellation of its group
+  CancellationToken token;
+  std::atomic<bool>* isStarted;
+};
+static void __groupBlockingJob(__GroupBlockingJob& job) {
+  if (job.isStarted != nullptr) {
+    job.isStarted->store(true);
+    while (!job.token.isCancelled())
+      std::this_thread::yield();
+  }
+  else
+    __groupJobCount.fetch_add(1u);
+}
+struct __GroupCancellingValue final { // cancel group when converted to job param
+  JobGroup* group;
+  int value;
+  bool isCancelling;
+  operator int() const {
+    if (isCancelling)
+      group->cancel();
+    return value;
+  }
+};
+static void __waitGroupJobStarted(const std::atomic<bool>& isStarted) {
+  for (int retry = 0; retry < 4000 && !isStarted.load(); ++retry)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+
+// -- cancellation token --
+
+TEST_F(JobGroupTest, tokenStatus) {
+  CancellationToken emptyToken;
+  EXPECT_FALSE(emptyToken.isCancellable());
+  EXPECT_FALSE(emptyToken.isCancelled());
+
+  JobGroup group;
+  CancellationToken token = group.token();
+  CancellationToken tokenCopy(token);
+  EXPECT_TRUE(token.isCancellable());
+  EXPECT_FALSE(token.isCancelled());
+  EXPECT_FALSE(group.isCancelled());
+  EXPECT_EQ(uint32_t{ 0 }, group.pendingJobs());
+  EXPECT_TRUE(group.tryWait(std::chrono::milliseconds(1))); // empty group: done
+
+  EXPECT_EQ(uint32_t{ 0 }, group.cancel());
+  EXPECT_TRUE(group.isCancelled());
+  EXPECT_TRUE(token.isCancelled());
+  EXPECT_TRUE(tokenCopy.isCancelled());
+
+  JobGroup movedGroup(std::move(group));
+  EXPECT_TRUE(movedGroup.isCancelled());
+  movedGroup = JobGroup{};
+  EXPECT_TRUE(token.isCancelled()); // state kept alive by token
+}
+
+// -- groups in thread pool --
+
+TEST_F(JobGroupTest, waitGroupJobs) {
+  __groupJobCount = 0;
+  ThreadPool<int> pool(2, &__groupCountJob);
+  JobGroup group;
+  for (int i = 0; i < 50; ++i)
+    EXPECT_TRUE(pool.addJob(group, i));
+  std::vector<int> batch(50, 0);
+  EXPECT_TRUE(pool.addJobs(group, batch.begin(), batch.end()));
+
+  group.wait();
+  EXPECT_EQ(uint32_t{ 100u }, __groupJobCount.load());
+  EXPECT_EQ(uint32_t{ 0 }, group.pendingJobs());
+  EXPECT_FALSE(group.isCancelled());
+
+  EXPECT_TRUE(pool.addJob(group, 0)); // group reusable after completion
+  EXPECT_TRUE(group.tryWait(std::chrono::seconds(4)));
+  EXPECT_EQ(uint32_t{ 101u }, __groupJobCount.load());
+}
+
+TEST_F(JobGroupTest, cancelDuringBatchInsertion) {
+  __groupJobCount = 0;
+  ThreadPool<int> pool(1, &__groupCountJob);
+  JobGroup group;
+  std::vector<__GroupCancellingValue> batch;
+  for (int i = 0; i < 10; ++i)
+    batch.push_back(__GroupCancellingValue{ &group, i, (i == 3) });
+
+  EXPECT_FALSE(pool.addJobs(group, batch.begin(), batch.end())); // cancelled after 4th job -> 6 last jobs not inserted
+  EXPECT_TRUE(group.tryWait(std::chrono::seconds(4)));
+  EXPECT_EQ(uint32_t{ 0 }, group.pendingJobs());
+  EXPECT_LE(__groupJobCount.load(), uint32_t{ 4u });
+  EXPECT_FALSE(pool.addJobs(group, batch.begin(), batch.end())); // cancelled group: rejected
+}
+
+TEST_F(JobGroupTest, cancelQueuedAndRunningJobs) {
+  __groupJobCount = 0;
+  ThreadPool<__GroupBlockingJob> pool(1, &__groupBlockingJob);
+  JobGroup group, otherGroup;
+  std::atomic<bool> isStarted{ false };
+
+  EXPECT_TRUE(pool.addJob(group, __GroupBlockingJob{ group.token(), &isStarted })); // blocks the only thread until cancellation
+  __waitGroupJobStarted(isStarted);
+  ASSERT_TRUE(isStarted.load());
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(pool.addJob(group, __GroupBlockingJob{ CancellationToken{}, nullptr }));
+    if ((i & 0x3) == 0) {
+      EXPECT_TRUE(pool.addJob(otherGroup, __GroupBlockingJob{ CancellationToken{}, nullptr }));
+    }
+  }
+  EXPECT_EQ(uint32_t{ 101u }, group.pendingJobs());
+  EXPECT_FALSE(group.tryWait(std::chrono::milliseconds(10)));
+
+  EXPECT_EQ(uint32_t{ 100u }, group.cancel()); // queued jobs dropped immediately
+  EXPECT_TRUE(group.tryWait(std::chrono::seconds(4))); // running job stopped by token
+  EXPECT_EQ(uint32_t{ 0 }, group.pendingJobs());
+  EXPECT_FALSE(pool.addJob(group, __GroupBlockingJob{ CancellationToken{}, nullptr })); // cancelled group: rejected
+
+  EXPECT_TRUE(otherGroup.tryWait(std::chrono::seconds(4))); // other group not affected
+  EXPECT_FALSE(otherGroup.isCancelled());
+  EXPECT_EQ(uint32_t{ 25u }, __groupJobCount.load()); // only jobs of other group
+}
+
+TEST_F(JobGroupTest, cancelPerJobRunners) {
+  ThreadPool<int, ThreadRunnerMode::perJob, TaskRunnerType::lambda> pool(1);
+  JobGroup group;
+  CancellationToken token = group.token();
+  std::atomic<bool> isStarted{ false };
+  std::atomic<uint32_t> jobCount{ 0 };
+
+  EXPECT_TRUE(pool.addJob(group, 0, [token, &isStarted](int&) {
+    isStarted = true;
+    while (!token.isCancelled())
+      std::this_thread::yield();
+  }));
+  __waitGroupJobStarted(isStarted);
+  for (int i = 0; i < 10; ++i)
+    EXPECT_TRUE(pool.addJob(group, i, [&jobCount](int&) { ++jobCount; }));
+
+  EXPECT_EQ(uint32_t{ 10u }, group.cancel());
+  group.wait();
+  EXPECT_TRUE(pool.addJob(0, [&jobCount](int&) { ++jobCount; })); // jobs out of group: not affected
+  for (int retry = 0; retry < 4000 && jobCount.load() == 0; ++retry)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  EXPECT_EQ(uint32_t{ 1u }, jobCount.load());
+}
+
+TEST_F(JobGroupTest, poolCancellationAndDestruction) {
+  __groupJobCount = 0;
+  JobGroup group;
+  std::atomic<bool> isStarted{ false };
+  {
+    ThreadPool<__GroupBlockingJob> pool(1, &__groupBlockingJob);
+    JobGroup blockingGroup;
+    EXPECT_TRUE(pool.addJob(blockingGroup, __GroupBlockingJob{ blockingGroup.token(), &isStarted }));
+    __waitGroupJobStarted(isStarted);
+    for (int i = 0; i < 20; ++i)
+      EXPECT_TRUE(pool.addJob(group, __GroupBlockingJob{ CancellationToken{}, nullptr }));
+
+    EXPECT_EQ(uint32_t{ 20u }, pool.cancelPendingJobs()); // removed from group, group not cancelled
+    EXPECT_TRUE(group.tryWait(std::chrono::milliseconds(100)));
+    EXPECT_FALSE(group.isCancelled());
+
+    for (int i = 0; i < 20; ++i)
+      EXPECT_TRUE(pool.addJob(group, __GroupBlockingJob{ CancellationToken{}, nullptr }));
+    EXPECT_EQ(uint32_t{ 20u }, group.pendingJobs());
+    blockingGroup.cancel();
+  } // pool destroyed -> remaining jobs dropped
+  EXPECT_TRUE(group.tryWait(std::chrono::milliseconds(100)));
+  EXPECT_EQ(uint32_t{ 0 }, group.pendingJobs());
+  EXPECT_TRUE(__groupJobCount.load() <= 20u);
+}
+
+TEST_F(JobGroupTest, multiThreadCancellation) {
+  std::atomic<uint32_t> jobCount{ 0 };
+  ThreadPool<int, ThreadRunnerMode::perJob, TaskRunnerType::lambda> pool(4);
+  for (int round = 0; round < 20; ++round) {
+    JobGroup group;
+    CancellationToken token = group.token();
+    std::thread producer([&pool, &group, &jobCount, token]() {
+      for (int i = 0; i < 200; ++i) {
+        if (!pool.addJob(group, i, [&jobCount, token](int& value) {
+              if (!token.isCancelled())
+                ++jobCount;
+              if (value == 50)
+                std::this_thread::yield();
+            }))
+          break;
+      }
+    });
+    std::this_thread::yield();
+    group.cancel();
+    producer.join();
+    EXPECT_TRUE(group.tryWait(std::chrono::seconds(4)));
+    EXPECT_EQ(uint32_t{ 0 }, group.pendingJobs());
+  }
+  EXPECT_TRUE(jobCount.load() <= 20u * 200u);
+}
@@ -0,0 +1,123 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include <gtest/gtest.h>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <thread/lock_free_queue.h>
+
+using namespace pandora::thread;
+
+class LockFreeQueueTest : public testing::Test {
+public:
+protected:
+  //static void SetUpTestCase() {}
+  //static void TearDownTestCase() {}
+
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+
+// -- single thread operations --
+
+TEST_F(LockFreeQueueTest, pushPopBaseType) {
+  LockFreeQueue<int> queue(5u);
+  EXPECT_EQ(size_t{ 8u }, queue.capacity());
+  EXPECT_EQ(size_t{ 0u }, queue.size());
+  EXPECT_TRUE(queue.empty());
+
+  int value = -1;
+  EXPECT_FALSE(queue.pop(value));
+  for (int i = 0; i < 8; ++i)
+    EXPECT_TRUE(queue.push(i));
+  EXPECT_FALSE(queue.push(8));
+  EXPECT_EQ(size_t{ 8u }, queue.size());
+
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(i, value);
+  }
+  EXPECT_FALSE(queue.pop(value));
+  EXPECT_TRUE(queue.empty());
+
+  for (int lap = 0; lap < 3; ++lap) { // wrap-around
+    for (int i = 0; i < 6; ++i)
+      EXPECT_TRUE(queue.emplace(i));
+    EXPECT_EQ(size_t{ 6u }, queue.clear());
+    EXPECT_TRUE(queue.empty());
+  }
+}
+
+TEST_F(LockFreeQueueTest, pushConsumeMoveOnlyType) {
+  LockFreeQueue<std::unique_ptr<int> > queue(2u);
+  EXPECT_TRUE(queue.push(std::make_unique<int>(4)));
+  EXPECT_TRUE(queue.emplace(new int(5)));
+  EXPECT_FALSE(queue.push(std::make_unique<int>(6)));
+
+  int total = 0;
+  EXPECT_TRUE(queue.consume([&total](std::unique_ptr<int>&& value) { total += *value; }));
+  std::unique_ptr<int> value;
+  EXPECT_TRUE(queue.pop(value));
+  ASSERT_TRUE(value != nullptr);
+  total += *value;
+  EXPECT_EQ(9, total);
+  EXPECT_FALSE(queue.consume([](std::unique_ptr<int>&&) {}));
+
+  EXPECT_TRUE(queue.push(std::make_unique<int>(7))); // destroyed with queue
+}
+
+// -- concurrent operations --
+
+TEST_F(LockFreeQueueTest, multiProducerMultiConsumer) {
+  LockFreeQueue<uint32_t> queue(64u);
+  const uint32_t itemsPerProducer = 20000u;
+  std::atomic<uint64_t> total{ 0 };
+  std::atomic<uint32_t> consumed{ 0 };
+
+  std::vector<std::thread> threads;
+  for (uint32_t p = 0; p < 3u; ++p) {
+    threads.emplace_back([&queue, itemsPerProducer]() {
+      for (uint32_t i = 1u; i <= itemsPerProducer; ++i) {
+        while (!queue.push(i))
+          std::this_thread::yield();
+      }
+    });
+  }
+  for (uint32_t c = 0; c < 3u; ++c) {
+    threads.emplace_back([&queue, &total, &consumed, itemsPerProducer]() {
+      uint32_t value = 0;
+      while (consumed.load() < 3u*itemsPerProducer) {
+        if (queue.pop(value)) {
+          total += value;
+          ++consumed;
+        }
+        else
+          std::this_thread::yield();
+      }
+    });
+  }
+  for (auto& it : threads)
+    it.join();
+
+  uint64_t expected = 3uLL * (static_cast<uint64_t>(itemsPerProducer) * (itemsPerProducer + 1u) / 2u);
+  EXPECT_EQ(expected, total.load());
+  EXPECT_TRUE(queue.empty());
+}
@@ -0,0 +1,211 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <thread/numa_thread_pool.h>
+
+using namespace pandora::thread;
+
+class NumaThreadPoolTest : public testing::Test {
+public:
+protected:
+  //static void SetUpTestCase() {}
+  //static void TearDownTestCase() {}
+
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+
+// -- helpers --
+
+static std::atomic<int> numaTotalValue{ 0 };
+static std::atomic<bool> numaIsBlocked{ false };
+static std::atomic<int> numaAffinityCalls{ 0 };
+
+void _numaTaskRunner(int& param) {
+  if (param < 0) { // blocking job
+    while (numaIsBlocked.load())
+      std::this_thread::sleep_for(std::chrono::microseconds(100u));
+    return;
+  }
+  numaTotalValue += param;
+}
+bool _numaFakeAffinitySetter(std::thread&, int32_t cpuMask) {
+  ++numaAffinityCalls;
+  return (cpuMask > 0);
+}
+bool _numaFakeWorkerAffinitySetter(std::thread&, const WorkerPlacement& placement) {
+  ++numaAffinityCalls;
+  return (placement.cpus.empty() || placement.cpus[0] != 999u); // CPU 999: simulate failure
+}
+
+template <typename T>
+bool _waitForNumaPoolCompletion(const T& pool) {
+  auto timeoutTime = std::chrono::steady_clock::now() + std::chrono::milliseconds(5000u);
+  while (std::chrono::steady_clock::now() < timeoutTime) {
+    if (pool.pendingJobs() == 0u && pool.busyThreads() == 0u) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1u));
+      if (pool.pendingJobs() == 0u && pool.busyThreads() == 0u)
+        return true;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(100u));
+  }
+  return false;
+}
+template <typename T>
+bool _waitForNumaBusyThreads(const T& pool, uint32_t node, size_t busyThreads) {
+  for (int retry = 0; retry < 5000 && pool.busyThreads(node) != busyThreads; ++retry)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1u));
+  return (pool.busyThreads(node) == busyThreads);
+}
+
+
+// -- placement --
+
+TEST_F(NumaThreadPoolTest, unpinnedPlacement) {
+  auto placements = unpinnedWorkerPlacement(5u, 2u);
+  ASSERT_EQ(size_t{ 5u }, placements.size());
+  EXPECT_EQ(0u, placements[0].node);
+  EXPECT_EQ(1u, placements[1].node);
+  EXPECT_EQ(0u, placements[4].node);
+  for (const auto& placement : placements) {
+    EXPECT_EQ(0, placement.cpuMask);
+  }
+  placements = unpinnedWorkerPlacement(2u, 0u);
+  EXPECT_EQ(0u, placements[1].node);
+}
+
+TEST_F(NumaThreadPoolTest, emptyPool) {
+  NumaThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool;
+  EXPECT_EQ(size_t{ 0u }, pool.size());
+  EXPECT_EQ(0u, pool.nodeCount());
+  EXPECT_EQ(size_t{ 0u }, pool.busyThreads());
+  EXPECT_EQ(size_t{ 0u }, pool.pendingJobs(0u));
+  EXPECT_FALSE(pool.addJob(5));
+  EXPECT_FALSE(pool.addJob(5, 0u));
+  EXPECT_EQ(0u, pool.cancelPendingJobs());
+
+  NumaThreadPool<int, ThreadRunnerMode::perJob, TaskRunnerType::lambda> pool2;
+  EXPECT_FALSE(pool2.addJob(5, [](int&) {}, 1u));
+}
+
+TEST_F(NumaThreadPoolTest, movedPool) {
+  NumaThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool1;
+  NumaThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool2(unpinnedWorkerPlacement(3u, 2u), &_numaTaskRunner);
+  NumaThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> poolMoved(std::move(pool2));
+  pool1 = std::move(poolMoved);
+  EXPECT_EQ(size_t{ 3u }, pool1.size());
+  EXPECT_EQ(2u, pool1.nodeCount());
+  EXPECT_EQ(size_t{ 2u }, pool1.size(0u));
+  EXPECT_EQ(size_t{ 1u }, pool1.size(1u));
+  EXPECT_EQ(size_t{ 0u }, poolMoved.size());
+  EXPECT_FALSE(pool2.addJob(1));
+  EXPECT_TRUE(pool1.addJob(0));
+}
+
+TEST_F(NumaThreadPoolTest, pinnedWorkers) {
+  std::vector<WorkerPlacement> placements(3u);
+  placements[0].cpuMask = 0x1;
+  placements[1].node = 1u;
+  placements[1].cpuMask = 0x2;
+  placements[2].node = 1u; // not pinned
+  numaAffinityCalls = 0;
+  {
+    NumaThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool(placements, &_numaTaskRunner, &_numaFakeAffinitySetter);
+    EXPECT_EQ(size_t{ 3u }, pool.size());
+    EXPECT_EQ(size_t{ 2u }, pool.pinnedThreads());
+    EXPECT_EQ(2, numaAffinityCalls.load());
+  }
+  NumaThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> unpinnedPool(placements, &_numaTaskRunner);
+  EXPECT_EQ(size_t{ 0u }, unpinnedPool.pinnedThreads());
+}
+
+TEST_F(NumaThreadPoolTest, pinnedWorkersWithCpuList) {
+  std::vector<WorkerPlacement> placements(4u);
+  placements[0].cpus = { 40u, 41u }; // CPU indexes above 32: not representable in cpuMask
+  placements[1].node = 1u;
+  placements[1].cpuMask = 0x2;
+  placements[2].node = 1u;
+  placements[2].cpus = { 999u };    // failure
+  numaAffinityCalls = 0;
+  {
+    NumaThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool(placements, &_numaTaskRunner, &_numaFakeWorkerAffinitySetter);
+    EXPECT_EQ(size_t{ 4u }, pool.size());
+    EXPECT_EQ(size_t{ 2u }, pool.pinnedThreads());
+    EXPECT_EQ(3, numaAffinityCalls.load()); // last worker not pinned
+  }
+  numaAffinityCalls = 0;
+  NumaThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> maskPool(placements, &_numaTaskRunner, &_numaFakeAffinitySetter);
+  EXPECT_EQ(size_t{ 1u }, maskPool.pinnedThreads()); // only 'cpuMask' used
+  EXPECT_EQ(1, numaAffinityCalls.load());
+}
+
+// -- job processing --
+
+TEST_F(NumaThreadPoolTest, nodeHints) {
+  NumaThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool(unpinnedWorkerPlacement(2u, 2u), &_numaTaskRunner);
+  numaTotalValue = 0;
+  numaIsBlocked = true;
+  EXPECT_TRUE(pool.addJob(-1, 0u)); // block worker of node 0
+  EXPECT_TRUE(_waitForNumaBusyThreads(pool, 0u, 1u));
+
+  EXPECT_TRUE(pool.addJob(1, 0u)); // node-local job -> not processed by node 1
+  EXPECT_TRUE(pool.addJob(2, 1u));
+  EXPECT_TRUE(pool.addJob(4, anyNumaNode()));
+  EXPECT_TRUE(pool.addJob(8, 7u)); // unknown node -> any worker
+  for (int retry = 0; retry < 5000 && numaTotalValue.load() != 14; ++retry)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1u));
+  EXPECT_EQ(14, numaTotalValue.load());
+  EXPECT_EQ(size_t{ 1u }, pool.pendingJobs());
+  EXPECT_EQ(size_t{ 1u }, pool.pendingJobs(0u));
+  EXPECT_EQ(size_t{ 0u }, pool.pendingJobs(anyNumaNode()));
+
+  numaIsBlocked = false;
+  EXPECT_TRUE(_waitForNumaPoolCompletion(pool));
+  EXPECT_EQ(15, numaTotalValue.load());
+}
+
+TEST_F(NumaThreadPoolTest, cancelNodeJobs) {
+  NumaThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool(unpinnedWorkerPlacement(1u, 1u), &_numaTaskRunner);
+  numaTotalValue = 0;
+  numaIsBlocked = true;
+  EXPECT_TRUE(pool.addJob(-1));
+  EXPECT_TRUE(_waitForNumaBusyThreads(pool, 0u, 1u));
+  EXPECT_TRUE(pool.addJob(1, 0u));
+  EXPECT_TRUE(pool.addJob(2));
+  EXPECT_EQ(2u, pool.cancelPendingJobs());
+  numaIsBlocked = false;
+  EXPECT_TRUE(_waitForNumaPoolCompletion(pool));
+  EXPECT_EQ(0, numaTotalValue.load());
+}
+
+TEST_F(NumaThreadPoolTest, runnerPerJob) {
+  NumaThreadPool<int, ThreadRunnerMode::perJob, TaskRunnerType::lambda> pool(unpinnedWorkerPlacement(4u, 2u), [](int& val) { numaTotalValue += val; });
+  numaTotalValue = 0;
+  for (int i = 0; i < 32; ++i) {
+    EXPECT_TRUE(pool.addJob(1, [](int& val) { numaTotalValue += 2*val; }, static_cast<uint32_t>(i % 3)));
+    EXPECT_TRUE(pool.addJob(1, static_cast<uint32_t>(i % 2)));
+  }
+  EXPECT_TRUE(_waitForNumaPoolCompletion(pool));
+  EXPECT_EQ(96, numaTotalValue.load());
+}
@@ -0,0 +1,131 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <thread/parallel_for.h>
+#include <thread/work_stealing_thread_pool.h>
+
+using namespace pandora::thread;
+
+class ParallelForTest : public testing::Test {
+public:
+protected:
+  //static void SetUpTestCase() {}
+  //static void TearDownTestCase() {}
+
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+
+// -- parallelFor --
+
+TEST_F(ParallelForTest, parallelForEmptyRange) {
+  ParallelPool pool(2u, &processParallelJob);
+  int calls = 0;
+  parallelFor(pool, 5u, 5u, [&calls](size_t) { ++calls; });
+  parallelFor(pool, 6u, 5u, [&calls](size_t) { ++calls; });
+  EXPECT_EQ(0, calls);
+}
+
+TEST_F(ParallelForTest, parallelForSerial) {
+  ParallelPool stoppedPool;
+  std::vector<int> values(100u, 0);
+  parallelFor(stoppedPool, 0, values.size(), [&values](size_t index) { values[index] += static_cast<int>(index); });
+  for (size_t i = 0; i < values.size(); ++i)
+    EXPECT_EQ(static_cast<int>(i), values[i]);
+
+  ParallelPool pool(2u, &processParallelJob);
+  parallelFor(pool, 0, values.size(), [&values](size_t index) { values[index] += 1; }, 1000u); // under grain size
+  for (size_t i = 0; i < values.size(); ++i)
+    EXPECT_EQ(static_cast<int>(i) + 1, values[i]);
+}
+
+TEST_F(ParallelForTest, parallelForEachIndexOnce) {
+  ParallelPool pool(4u, &processParallelJob);
+  for (size_t length : { size_t{ 2u }, size_t{ 7u }, size_t{ 100u }, size_t{ 12345u }, size_t{ 1000000u } }) {
+    std::vector<std::atomic<int> > counters(length + 10u);
+    for (auto& counter : counters)
+      counter = 0;
+    parallelFor(pool, 10u, counters.size(), [&counters](size_t index) { ++counters[index]; });
+    for (size_t i = 0; i < counters.size(); ++i)
+      EXPECT_EQ((i < 10u) ? 0 : 1, counters[i].load());
+  }
+
+  WorkStealingThreadPool<ParallelJob, ThreadRunnerMode::single, TaskRunnerType::functionPointer> stealingPool(3u, &processParallelJob);
+  std::atomic<size_t> total{ 0 };
+  const auto operation = [&total](size_t index) { total += index; };
+  parallelFor(stealingPool, 0, 1000u, operation, 8u);
+  EXPECT_EQ(size_t{ 499500u }, total.load());
+}
+
+TEST_F(ParallelForTest, parallelForException) {
+  ParallelPool pool(2u, &processParallelJob);
+  EXPECT_THROW(parallelFor(pool, 0, 1000u, [](size_t index) { if (index == 700u) throw std::runtime_error("failure"); }),
+               std::runtime_error);
+
+  std::atomic<int> calls{ 0 };
+  parallelFor(pool, 0, 1000u, [&calls](size_t) { ++calls; }); // pool still usable
+  EXPECT_EQ(1000, calls.load());
+}
+
+// -- parallelReduce --
+
+TEST_F(ParallelForTest, parallelReduceSum) {
+  ParallelPool pool(4u, &processParallelJob);
+  EXPECT_EQ(uint64_t{ 42u }, parallelReduce(pool, 3u, 3u, uint64_t{ 42u }, [](size_t index) { return static_cast<uint64_t>(index); },
+                                            [](uint64_t lhs, uint64_t rhs) { return lhs + rhs; }));
+
+  uint64_t sum = parallelReduce(pool, 0, 1000001u, uint64_t{ 0 }, [](size_t index) { return static_cast<uint64_t>(index); },
+                                [](uint64_t lhs, uint64_t rhs) { return lhs + rhs; });
+  EXPECT_EQ(uint64_t{ 500000500000u }, sum);
+
+  ParallelPool stoppedPool;
+  sum = parallelReduce(stoppedPool, 0, 101u, uint64_t{ 0 }, [](size_t index) { return static_cast<uint64_t>(index); },
+                       [](uint64_t lhs, uint64_t rhs) { return lhs + rhs; });
+  EXPECT_EQ(uint64_t{ 5050u }, sum);
+}
+
+TEST_F(ParallelForTest, parallelReduceOrdered) {
+  ParallelPool pool(4u, &processParallelJob);
+  const std::string alphabet = "abcdefghijklmnopqrstuvwxyz";
+  for (int retry = 0; retry < 20; ++retry) {
+    std::string result = parallelReduce(pool, 0, alphabet.size(), std::string{}, [&alphabet](size_t index) { return std::string(1u, alphabet[index]); },
+                                        [](std::string lhs, std::string rhs) { return lhs + rhs; }); // associative, not commutative
+    EXPECT_EQ(alphabet, result);
+  }
+}
+
+// -- parallelTransform --
+
+TEST_F(ParallelForTest, parallelTransformValues) {
+  ParallelPool pool(3u, &processParallelJob);
+  std::vector<int> input(10000u);
+  for (size_t i = 0; i < input.size(); ++i)
+    input[i] = static_cast<int>(i);
+  std::vector<int> output(input.size(), -1);
+
+  auto outEnd = parallelTransform(pool, input.begin(), input.end(), output.begin(), [](int value) { return value * 2; });
+  EXPECT_TRUE(outEnd == output.end());
+  for (size_t i = 0; i < output.size(); ++i)
+    EXPECT_EQ(static_cast<int>(i) * 2, output[i]);
+}
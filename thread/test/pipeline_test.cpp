@@ -0,0 +1,240 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <thread/pipeline.h>
+
+using namespace pandora::thread;
+
+class PipelineTest : public testing::Test {
+public:
+protected:
+  //static void SetUpTestCase() {}
+  //static void TearDownTestCase() {}
+
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+
+// -- channel --
+
+TEST_F(PipelineTest, channelPushPop) {
+  PipelineChannel<int> channel(2u);
+  uint64_t blockedTime = 0;
+  PipelineBatch<int> batch;
+  batch.items = { 1, 2, 3 };
+  EXPECT_TRUE(channel.push(std::move(batch), blockedTime));
+  batch.items = { 4 };
+  EXPECT_TRUE(channel.tryPush(std::move(batch)));
+  batch.items = { 5 };
+  EXPECT_FALSE(channel.tryPush(std::move(batch))); // full
+  EXPECT_EQ(size_t{ 4u }, channel.depth());
+  EXPECT_EQ(size_t{ 4u }, channel.highWater());
+
+  PipelineBatch<int> result;
+  EXPECT_TRUE(channel.pop(result));
+  ASSERT_EQ(size_t{ 3u }, result.items.size());
+  EXPECT_EQ(1, result.items[0]);
+  EXPECT_EQ(size_t{ 1u }, channel.depth());
+  channel.close();
+  EXPECT_FALSE(channel.tryPush(std::move(batch)));
+  EXPECT_TRUE(channel.pop(result)); // remaining batch still available
+  EXPECT_EQ(4, result.items[0]);
+  EXPECT_FALSE(channel.pop(result)); // closed + empty
+  EXPECT_EQ(uint64_t{ 0 }, blockedTime);
+}
+
+TEST_F(PipelineTest, channelBackpressure) {
+  PipelineChannel<int> channel(2u);
+  uint64_t blockedTime = 0;
+  std::thread producer([&channel, &blockedTime]() {
+    for (int i = 0; i < 20; ++i) {
+      PipelineBatch<int> batch;
+      batch.items.emplace_back(i);
+      EXPECT_TRUE(channel.push(std::move(batch), blockedTime));
+    }
+    channel.close();
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  EXPECT_TRUE(channel.depth() <= size_t{ 2u }); // bounded
+
+  int expected = 0;
+  PipelineBatch<int> result;
+  while (channel.pop(result)) {
+    ASSERT_EQ(size_t{ 1u }, result.items.size());
+    EXPECT_EQ(expected++, result.items[0]); // single producer/consumer -> FIFO
+  }
+  producer.join();
+  EXPECT_EQ(20, expected);
+  EXPECT_TRUE(blockedTime > 0u);
+  EXPECT_TRUE(channel.highWater() <= size_t{ 2u });
+}
+
+// -- pipeline --
+
+TEST_F(PipelineTest, emptyPipeline) {
+  Pipeline<int> pipeline;
+  EXPECT_FALSE(pipeline.isRunning());
+  EXPECT_EQ(size_t{ 0 }, pipeline.stageCount());
+  EXPECT_FALSE(pipeline.push(1));
+  EXPECT_TRUE(pipeline.metrics().empty());
+  pipeline.close();
+  pipeline.join();
+
+  std::vector<int> outputs;
+  auto directPipeline = PipelineBuilder<int>().build([&outputs](int&& value) { outputs.emplace_back(value); });
+  EXPECT_EQ(size_t{ 1u }, directPipeline.stageCount());
+  EXPECT_TRUE(directPipeline.push(7));
+  directPipeline.close();
+  directPipeline.join();
+  EXPECT_FALSE(directPipeline.isRunning());
+  EXPECT_FALSE(directPipeline.push(8));
+  ASSERT_EQ(size_t{ 1u }, outputs.size());
+  EXPECT_EQ(7, outputs[0]);
+}
+
+TEST_F(PipelineTest, typedStagesUnordered) {
+  PipelineOptions options;
+  options.queueCapacity = 4u;
+  options.batchSize = 8u;
+  std::atomic<int64_t> total{ 0 };
+  std::atomic<uint32_t> outputCount{ 0 };
+  {
+    auto pipeline = PipelineBuilder<int>(options)
+                    .addStage("parse", 2u, [](int&& value) { return std::to_string(value); })
+                    .addStage("length", 3u, [](std::string&& text) { return static_cast<int64_t>(std::stoi(text)) * 2; })
+                    .build([&total, &outputCount](int64_t&& value) { total += value; ++outputCount; });
+    EXPECT_TRUE(pipeline.isRunning());
+    EXPECT_EQ(size_t{ 3u }, pipeline.stageCount());
+    for (int i = 1; i <= 500; ++i)
+      EXPECT_TRUE(pipeline.push(i));
+    std::vector<int> values(500, 1);
+    EXPECT_EQ(size_t{ 500u }, pipeline.push(values.begin(), values.end()));
+  } // destruction: wait for pending items
+  EXPECT_EQ(uint32_t{ 1000u }, outputCount.load());
+  EXPECT_EQ(int64_t{ 2 * (500 * 501 / 2) + 1000 }, total.load());
+}
+
+TEST_F(PipelineTest, orderedOutput) {
+  PipelineOptions options;
+  options.queueCapacity = 8u;
+  options.batchSize = 4u;
+  options.order = PipelineOrder::ordered;
+  std::vector<int> outputs;
+  auto pipeline = PipelineBuilder<int>(options)
+                  .addStage("jitter", 4u, [](int&& value) {
+                    if ((value % 7) == 0)
+                      std::this_thread::sleep_for(std::chrono::microseconds(200)); // out-of-order completion
+                    return value;
+                  })
+                  .addStage("square", 3u, [](int&& value) -> int {
+                    if (value == 100)
+                      throw std::runtime_error("dropped item");
+                    return value * value;
+                  })
+                  .build([&outputs](int&& value) { outputs.emplace_back(value); });
+  for (int i = 0; i < 300; ++i) {
+    if (!pipeline.tryPush(int(i))) {
+      EXPECT_TRUE(pipeline.push(i));
+    }
+  }
+  pipeline.close();
+  pipeline.join();
+
+  ASSERT_EQ(size_t{ 299u }, outputs.size());
+  int expected = 0;
+  for (auto value : outputs) {
+    if (expected == 100)
+      ++expected; // dropped by exception
+    EXPECT_EQ(expected * expected, value);
+    ++expected;
+  }
+  auto metrics = pipeline.metrics();
+  ASSERT_EQ(size_t{ 3u }, metrics.size());
+  EXPECT_EQ(uint64_t{ 1u }, metrics[1].errorCount);
+  EXPECT_EQ(uint64_t{ 299u }, metrics[2].itemCount);
+}
+
+TEST_F(PipelineTest, metricsAndBottleneck) {
+  PipelineOptions options;
+  options.queueCapacity = 2u;
+  options.batchSize = 1u;
+  auto pipeline = PipelineBuilder<std::unique_ptr<int> >(options) // move-only items
+                  .addStage("fast", 1u, [](std::unique_ptr<int>&& value) { return std::move(value); })
+                  .addStage("slow", 1u, [](std::unique_ptr<int>&& value) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                    return *value;
+                  })
+                  .build([](int&&) {});
+  for (int i = 0; i < 40; ++i)
+    EXPECT_TRUE(pipeline.push(std::unique_ptr<int>(new int(i))));
+  pipeline.close();
+  pipeline.join();
+
+  auto metrics = pipeline.metrics();
+  ASSERT_EQ(size_t{ 3u }, metrics.size());
+  EXPECT_EQ(std::string("fast"), metrics[0].name);
+  EXPECT_EQ(std::string("slow"), metrics[1].name);
+  EXPECT_EQ(std::string("output"), metrics[2].name);
+  for (const auto& stage : metrics) {
+    EXPECT_EQ(uint32_t{ 1u }, stage.parallelism);
+    EXPECT_EQ(uint64_t{ 40u }, stage.itemCount);
+    EXPECT_EQ(uint64_t{ 0 }, stage.errorCount);
+    EXPECT_EQ(size_t{ 0 }, stage.queueDepth);
+    EXPECT_TRUE(stage.elapsedTime > 0u);
+    EXPECT_TRUE(stage.throughput() > 0.0);
+  }
+  EXPECT_EQ(size_t{ 1u }, pipeline.bottleneckStage());
+  EXPECT_TRUE(metrics[1].busyTime >= uint64_t{ 40u * 2000000u });
+  EXPECT_TRUE(metrics[0].blockedTime > 0u); // backpressure from slow stage
+  EXPECT_TRUE(metrics[1].queueHighWater >= size_t{ 1u });
+  EXPECT_TRUE(metrics[1].utilization() > metrics[0].utilization());
+}
+
+TEST_F(PipelineTest, cancelPipeline) {
+  PipelineOptions options;
+  options.queueCapacity = 4u;
+  options.batchSize = 1u;
+  std::atomic<uint32_t> outputCount{ 0 };
+  auto pipeline = PipelineBuilder<int>(options)
+                  .addStage("slow", 1u, [](int&& value) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    return value;
+                  })
+                  .build([&outputCount](int&&) { ++outputCount; });
+  std::thread producer([&pipeline]() {
+    for (int i = 0; i < 10000; ++i) {
+      if (!pipeline.push(i))
+        break;
+    }
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  pipeline.cancel(); // unblocks producer
+  producer.join();
+  EXPECT_FALSE(pipeline.isRunning());
+  EXPECT_FALSE(pipeline.push(1));
+  EXPECT_TRUE(outputCount.load() < 10000u);
+}
@@ -0,0 +1,151 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include <gtest/gtest.h>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <thread/pool_metrics.h>
+#include <thread/thread_pool.h>
+#include <thread/work_stealing_thread_pool.h>
+
+using namespace pandora::thread;
+
+class PoolMetricsTest : public testing::Test {
+public:
+protected:
+  //static void SetUpTestCase() {}
+  //static void TearDownTestCase() {}
+
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+// -- helpers --
+
+static std::atomic<uint32_t> __metricsJobCount{ 0 };
+static void __metricsSleepJob(int& durationMs) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(durationMs));
+  __metricsJobCount.fetch_add(1u);
+}
+static void __waitMetricsJobCount(uint32_t count) {
+  for (int retry = 0; retry < 4000 && __metricsJobCount.load() < count; ++retry)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+template <typename _PoolType>
+static void __waitMetricsRunCount(const _PoolType& pool, uint64_t count) { // run time recorded after job completion
+  for (int retry = 0; retry < 4000 && pool.metrics().snapshot().runTime.count() < count; ++retry)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+
+// -- histogram --
+
+TEST_F(PoolMetricsTest, histogramBuckets) {
+  for (uint64_t value = 0; value < 100000u; value += 7u) {
+    uint32_t index = HistogramSnapshot::bucketIndex(value);
+    EXPECT_LE(HistogramSnapshot::bucketLowerBound(index), value);
+    EXPECT_GT(HistogramSnapshot::bucketLowerBound(index + 1u), value);
+  }
+  EXPECT_EQ(5u, HistogramSnapshot::bucketIndex(5u));
+  EXPECT_EQ(HistogramSnapshot::bucketCount - 1u, HistogramSnapshot::bucketIndex(UINT64_MAX));
+  uint64_t value = 123456789u;
+  uint64_t lowerBound = HistogramSnapshot::bucketLowerBound(HistogramSnapshot::bucketIndex(value));
+  EXPECT_LE(value - lowerBound, value / HistogramSnapshot::subBucketCount); // relative error
+}
+
+TEST_F(PoolMetricsTest, histogramStatistics) {
+  LatencyHistogram histogram;
+  HistogramSnapshot empty = histogram.snapshot();
+  EXPECT_EQ(0u, empty.count());
+  EXPECT_EQ(0u, empty.percentile(50.0));
+  EXPECT_EQ(0u, empty.minimum());
+
+  for (uint64_t i = 1u; i <= 1000u; ++i)
+    histogram.record(i * 1000u);
+  histogram.record(std::chrono::microseconds(-5)); // negative -> 0
+  HistogramSnapshot snapshot = histogram.snapshot();
+  EXPECT_EQ(1001u, snapshot.count());
+  EXPECT_EQ(0u, snapshot.minimum());
+  EXPECT_EQ(1000000u, snapshot.maximum());
+  EXPECT_EQ(500500000u, snapshot.sum());
+  EXPECT_NEAR(500000.0, static_cast<double>(snapshot.percentile(50.0)), 500000.0 / 16.0);
+  EXPECT_NEAR(990000.0, static_cast<double>(snapshot.percentile(99.0)), 990000.0 / 16.0);
+  EXPECT_EQ(1000000u, snapshot.percentile(100.0));
+
+  histogram.reset();
+  EXPECT_EQ(0u, histogram.snapshot().count());
+}
+
+// -- pools --
+
+TEST_F(PoolMetricsTest, disabledMetrics) {
+  ThreadPool<int> pool(1, &__metricsSleepJob);
+  EXPECT_FALSE(decltype(pool)::metrics_type::isEnabled);
+  PoolMetricsSnapshot snapshot = pool.metrics().snapshot();
+  EXPECT_EQ(0u, snapshot.runTime.count());
+  EXPECT_TRUE(snapshot.workers.empty());
+}
+
+TEST_F(PoolMetricsTest, threadPoolMetrics) {
+  __metricsJobCount = 0;
+  ThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer, PoolMetrics> pool(2, &__metricsSleepJob);
+  for (int i = 0; i < 6; ++i)
+    pool.addJob(4);
+  __waitMetricsJobCount(6u);
+  pool.submit(1).wait();
+  __waitMetricsRunCount(pool, 7u);
+
+  PoolMetricsSnapshot snapshot = pool.metrics().snapshot();
+  EXPECT_EQ(7u, snapshot.runTime.count());
+  EXPECT_EQ(7u, snapshot.queueLatency.count());
+  EXPECT_GE(snapshot.runTime.maximum(), 4000000u);
+  EXPECT_GE(snapshot.queueLatency.maximum(), 4000000u); // jobs 3-6 waited at least one job
+  EXPECT_GE(snapshot.queueDepthHighWater, 4u);
+  ASSERT_EQ(size_t{ 2u }, snapshot.workers.size());
+  EXPECT_EQ(7u, snapshot.workers[0].jobCount + snapshot.workers[1].jobCount);
+  EXPECT_GT(snapshot.utilization(), 0.0);
+  EXPECT_LE(snapshot.utilization(), 1.0);
+
+  pool.resetMetrics();
+  snapshot = pool.metrics().snapshot();
+  EXPECT_EQ(0u, snapshot.runTime.count());
+  EXPECT_EQ(0u, snapshot.workers[0].jobCount);
+}
+
+TEST_F(PoolMetricsTest, workStealingPoolMetrics) {
+  __metricsJobCount = 0;
+  WorkStealingThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer, PoolMetrics> pool(3, &__metricsSleepJob);
+  for (int i = 0; i < 12; ++i)
+    pool.addJob((i % 3 == 0) ? 8 : 0); // unbalanced queues -> stealing
+  __waitMetricsJobCount(12u);
+  __waitMetricsRunCount(pool, 12u);
+
+  PoolMetricsSnapshot snapshot = pool.metrics().snapshot();
+  EXPECT_EQ(12u, snapshot.queueLatency.count());
+  EXPECT_EQ(12u, snapshot.runTime.count());
+  EXPECT_GE(snapshot.queueDepthHighWater, 1u);
+  ASSERT_EQ(size_t{ 3u }, snapshot.workers.size());
+  uint64_t jobCount = 0, stealCount = 0;
+  for (const auto& worker : snapshot.workers) {
+    jobCount += worker.jobCount;
+    stealCount += worker.stealCount;
+  }
+  EXPECT_EQ(12u, jobCount);
+  EXPECT_LE(stealCount, 12u);
+}
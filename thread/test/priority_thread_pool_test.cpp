@@ -0,0 +1,220 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <functional>
+#include <thread/priority_thread_pool.h>
+
+using namespace pandora::thread;
+
+class PriorityThreadPoolTest : public testing::Test {
+public:
+protected:
+  //static void SetUpTestCase() {}
+  //static void TearDownTestCase() {}
+
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+
+// -- helpers --
+
+static std::atomic<int> priorityTotalValue{ 0 };
+static std::atomic<bool> priorityIsBlocked{ false };
+static std::mutex priorityOrderLock;
+static std::vector<int> priorityOrder;
+
+void _priorityTaskRunner(int& param) {
+  if (param < 0) { // blocking job
+    while (priorityIsBlocked.load())
+      std::this_thread::sleep_for(std::chrono::microseconds(100u));
+    return;
+  }
+  priorityTotalValue += param;
+  std::lock_guard<std::mutex> guard(priorityOrderLock);
+  priorityOrder.emplace_back(param);
+}
+
+template <typename T>
+bool _waitForPriorityPoolCompletion(const T& pool) {
+  auto timeoutTime = std::chrono::steady_clock::now() + std::chrono::milliseconds(5000u);
+  while (std::chrono::steady_clock::now() < timeoutTime) {
+    if (pool.pendingJobs() == 0u && pool.busyThreads() == 0u) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1u));
+      if (pool.pendingJobs() == 0u && pool.busyThreads() == 0u)
+        return true;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(100u));
+  }
+  return false;
+}
+template <typename T>
+bool _waitForPriorityBusyThreads(const T& pool, size_t busyThreads) {
+  for (int retry = 0; retry < 5000 && pool.busyThreads() != busyThreads; ++retry)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1u));
+  return (pool.busyThreads() == busyThreads);
+}
+std::vector<int> _readPriorityOrder() {
+  std::lock_guard<std::mutex> guard(priorityOrderLock);
+  std::vector<int> order = priorityOrder;
+  priorityOrder.clear();
+  return order;
+}
+
+
+// -- special constructors --
+
+TEST_F(PriorityThreadPoolTest, emptyPool) {
+  PriorityThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool;
+  EXPECT_EQ(size_t{ 0u }, pool.size());
+  EXPECT_EQ(size_t{ 0u }, pool.busyThreads());
+  EXPECT_EQ(size_t{ 0u }, pool.freeThreads(JobPriority::high));
+  EXPECT_FALSE(pool.addJob(5));
+  EXPECT_FALSE(pool.addJob(5, JobPriority::low, std::chrono::steady_clock::now()));
+  EXPECT_EQ(0u, pool.cancelPendingJobs());
+
+  PriorityThreadPool<int, ThreadRunnerMode::perJob, TaskRunnerType::lambda> pool2;
+  EXPECT_FALSE(pool2.addJob(5, [](int&) {}, JobPriority::high));
+}
+
+TEST_F(PriorityThreadPoolTest, movedPool) {
+  PriorityThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool1;
+  PriorityThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool2(3u, &_priorityTaskRunner);
+  PriorityThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> poolMoved(std::move(pool2));
+  pool1 = std::move(poolMoved);
+  EXPECT_EQ(size_t{ 3u }, pool1.size());
+  EXPECT_EQ(size_t{ 0u }, poolMoved.size());
+  EXPECT_FALSE(pool2.addJob(1));
+  EXPECT_TRUE(pool1.addJob(0));
+}
+
+// -- job ordering --
+
+TEST_F(PriorityThreadPoolTest, strictPriorities) {
+  PriorityThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool(1u, &_priorityTaskRunner, std::chrono::milliseconds(0));
+  _readPriorityOrder();
+  priorityIsBlocked = true;
+  EXPECT_TRUE(pool.addJob(-1, JobPriority::high));
+  EXPECT_TRUE(_waitForPriorityBusyThreads(pool, 1u));
+  EXPECT_EQ(size_t{ 1u }, pool.busyThreads(JobPriority::high));
+  EXPECT_EQ(size_t{ 0u }, pool.busyThreads(JobPriority::low));
+  EXPECT_EQ(size_t{ 0u }, pool.freeThreads(JobPriority::low));
+
+  EXPECT_TRUE(pool.addJob(3, JobPriority::low));
+  EXPECT_TRUE(pool.addJob(2, JobPriority::normal));
+  EXPECT_TRUE(pool.addJob(1, JobPriority::high));
+  EXPECT_TRUE(pool.addJob(4, JobPriority::low));
+  EXPECT_EQ(size_t{ 4u }, pool.pendingJobs());
+  EXPECT_EQ(size_t{ 2u }, pool.pendingJobs(JobPriority::low));
+  priorityIsBlocked = false;
+
+  EXPECT_TRUE(_waitForPriorityPoolCompletion(pool));
+  EXPECT_EQ((std::vector<int>{ 1, 2, 3, 4 }), _readPriorityOrder());
+  EXPECT_EQ(size_t{ 1u }, pool.freeThreads(JobPriority::low));
+}
+
+TEST_F(PriorityThreadPoolTest, agingPriorities) {
+  PriorityThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool(1u, &_priorityTaskRunner, std::chrono::milliseconds(5));
+  _readPriorityOrder();
+  priorityIsBlocked = true;
+  EXPECT_TRUE(pool.addJob(-1));
+  EXPECT_TRUE(_waitForPriorityBusyThreads(pool, 1u));
+
+  EXPECT_TRUE(pool.addJob(2, JobPriority::low));
+  std::this_thread::sleep_for(std::chrono::milliseconds(20)); // low job waited more than 2*aging delay
+  EXPECT_TRUE(pool.addJob(1, JobPriority::high));
+  EXPECT_TRUE(pool.addJob(3, JobPriority::low));
+  priorityIsBlocked = false;
+
+  EXPECT_TRUE(_waitForPriorityPoolCompletion(pool));
+  EXPECT_EQ((std::vector<int>{ 2, 1, 3 }), _readPriorityOrder());
+}
+
+TEST_F(PriorityThreadPoolTest, deadlines) {
+  PriorityThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool(1u, &_priorityTaskRunner, std::chrono::milliseconds(0));
+  _readPriorityOrder();
+  priorityIsBlocked = true;
+  EXPECT_TRUE(pool.addJob(-1));
+  EXPECT_TRUE(_waitForPriorityBusyThreads(pool, 1u));
+
+  auto now = std::chrono::steady_clock::now();
+  EXPECT_TRUE(pool.addJob(4, JobPriority::normal));
+  EXPECT_TRUE(pool.addJob(3, JobPriority::normal, now + std::chrono::hours(1))); // deadline jobs before other jobs of lane
+  EXPECT_TRUE(pool.addJob(2, JobPriority::high));
+  EXPECT_TRUE(pool.addJob(1, JobPriority::low, now)); // deadline reached -> before all other jobs
+  priorityIsBlocked = false;
+
+  EXPECT_TRUE(_waitForPriorityPoolCompletion(pool));
+  EXPECT_EQ((std::vector<int>{ 1, 2, 3, 4 }), _readPriorityOrder());
+}
+
+// -- dedicated threads --
+
+TEST_F(PriorityThreadPoolTest, dedicatedThreads) {
+  PriorityThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer>::lane_params lanes;
+  lanes[static_cast<size_t>(JobPriority::high)].dedicatedThreads = 1u;
+  lanes[static_cast<size_t>(JobPriority::high)].isThreadPriorityUsed = false;
+  lanes[static_cast<size_t>(JobPriority::high)].threadPriority = toThreadPriority(JobPriority::high);
+  PriorityThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool(1u, &_priorityTaskRunner, std::chrono::milliseconds(10), lanes);
+  EXPECT_EQ(size_t{ 2u }, pool.size());
+  EXPECT_EQ(size_t{ 2u }, pool.freeThreads(JobPriority::high));
+  EXPECT_EQ(size_t{ 1u }, pool.freeThreads(JobPriority::low));
+
+  // shared thread blocked by low job -> high job still processed by dedicated thread
+  priorityTotalValue = 0;
+  priorityIsBlocked = true;
+  EXPECT_TRUE(pool.addJob(-1, JobPriority::low));
+  EXPECT_TRUE(_waitForPriorityBusyThreads(pool, 1u));
+  EXPECT_EQ(size_t{ 1u }, pool.busyThreads(JobPriority::low));
+  EXPECT_EQ(size_t{ 0u }, pool.freeThreads(JobPriority::low));
+  EXPECT_EQ(size_t{ 1u }, pool.freeThreads(JobPriority::high));
+  EXPECT_TRUE(pool.addJob(5, JobPriority::high));
+  for (int retry = 0; retry < 5000 && priorityTotalValue.load() != 5; ++retry)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1u));
+  EXPECT_EQ(5, priorityTotalValue.load());
+
+  EXPECT_TRUE(pool.addJob(3, JobPriority::normal)); // not processed by dedicated thread
+  std::this_thread::sleep_for(std::chrono::milliseconds(5u));
+  EXPECT_EQ(size_t{ 1u }, pool.pendingJobs(JobPriority::normal));
+  EXPECT_EQ(1u, pool.cancelPendingJobs(JobPriority::normal));
+  priorityIsBlocked = false;
+  EXPECT_TRUE(_waitForPriorityPoolCompletion(pool));
+  EXPECT_EQ(5, priorityTotalValue.load());
+  _readPriorityOrder();
+}
+
+// -- job processing --
+
+TEST_F(PriorityThreadPoolTest, runnerPerJob) {
+  PriorityThreadPool<int, ThreadRunnerMode::perJob, TaskRunnerType::lambda> pool(3u, [](int& val) { priorityTotalValue += val; });
+  priorityTotalValue = 0;
+  for (int i = 0; i < 32; ++i) {
+    EXPECT_TRUE(pool.addJob(1, [](int& val) { priorityTotalValue += 2*val; }, static_cast<JobPriority>(i % 3)));
+    EXPECT_TRUE(pool.addJob(1, static_cast<JobPriority>(i % 3)));
+  }
+  EXPECT_TRUE(pool.addJob(1, [](int& val) { priorityTotalValue += val; }, JobPriority::low, std::chrono::steady_clock::now()));
+  EXPECT_TRUE(_waitForPriorityPoolCompletion(pool));
+  EXPECT_EQ(97, priorityTotalValue.load());
+}
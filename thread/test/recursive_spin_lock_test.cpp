@@ -20,6 +20,7 @@ IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <thread>
 #include <mutex>
 #include <future>
+#include <vector>
 #include <thread/recursive_spin_lock.h>
 
 using namespace pandora::thread;
@@ -233,3 +234,54 @@ TEST_F(RecursiveSpinLockTest, multiThreadLock) {
   mutex.unlock();
   EXPECT_TRUE(promiseBase.wait_for(std::chrono::milliseconds(2000LL)) != std::future_status::timeout);
 }
+
+
+// -- adaptive recursive spin-lock --
+
+TEST_F(RecursiveSpinLockTest, adaptiveReLock) {
+  AdaptiveRecursiveSpinLock mutex;
+  std::thread::id threadId = std::this_thread::get_id();
+  EXPECT_EQ(std::thread::id(), mutex.owner());
+  EXPECT_FALSE(mutex.unlock());
+
+  mutex.lock();
+  EXPECT_EQ(threadId, mutex.owner());
+  EXPECT_TRUE(mutex.tryLock());
+  EXPECT_TRUE(mutex.tryLock(std::chrono::milliseconds(1000LL)));
+  EXPECT_TRUE(mutex.try_lock_until(std::chrono::steady_clock::now() + std::chrono::milliseconds(1000LL)));
+  EXPECT_TRUE(mutex.unlock());
+  EXPECT_TRUE(mutex.unlock());
+  EXPECT_TRUE(mutex.unlock());
+  EXPECT_EQ(threadId, mutex.owner());
+  EXPECT_TRUE(mutex.unlock());
+  EXPECT_EQ(std::thread::id(), mutex.owner());
+  EXPECT_FALSE(mutex.unlock());
+
+  mutex.lock();
+  auto promise = std::async(std::launch::async, [&mutex]() {
+    EXPECT_FALSE(mutex.tryLock());
+    EXPECT_FALSE(mutex.unlock());
+    EXPECT_FALSE(mutex.tryLock(std::chrono::milliseconds(5LL)));
+  });
+  promise.get();
+  EXPECT_TRUE(mutex.unlock());
+}
+
+TEST_F(RecursiveSpinLockTest, adaptiveMultiThreadLock) {
+  AdaptiveRecursiveSpinLock mutex;
+  uint32_t counter = 0;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&mutex, &counter]() {
+      for (int i = 0; i < 10000; ++i) {
+        std::lock_guard<AdaptiveRecursiveSpinLock> lock(mutex);
+        std::lock_guard<AdaptiveRecursiveSpinLock> reLock(mutex);
+        ++counter;
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  EXPECT_EQ(80000u, counter);
+  EXPECT_EQ(std::thread::id(), mutex.owner());
+}
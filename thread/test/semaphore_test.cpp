@@ -20,6 +20,9 @@ IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <memory>
 #include <chrono>
 #include <future>
+#include <atomic>
+#include <thread>
+#include <vector>
 #include <thread/semaphore.h>
 
 using namespace pandora::thread;
@@ -466,3 +469,55 @@ TEST_F(SemaphoreTest, orderVerification) {
   sema.notifyAll();
   std::this_thread::sleep_for(std::chrono::milliseconds(1LL));
 }
+
+TEST_F(SemaphoreTest, notifyCountWaiters) {
+  Semaphore sema;
+  std::atomic<uint32_t> awakeThreads{ 0 };
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&sema, &awakeThreads]() {
+      sema.wait();
+      ++awakeThreads;
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(5LL));
+  EXPECT_EQ(0u, awakeThreads.load());
+
+  sema.notify(2u);
+  for (int retry = 0; retry < 2000 && awakeThreads.load() < 2u; ++retry)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1LL));
+  std::this_thread::sleep_for(std::chrono::milliseconds(5LL));
+  EXPECT_EQ(2u, awakeThreads.load());
+
+  // mixed single/multi-unit waiters
+  auto promiseMulti = std::async(std::launch::async, [&sema]() {
+    EXPECT_TRUE(sema.tryWait(3u, std::chrono::milliseconds(2000LL)));
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(2LL));
+  sema.notify(5u);
+  for (auto& thread : threads)
+    thread.join();
+  EXPECT_EQ(4u, awakeThreads.load());
+  EXPECT_TRUE(promiseMulti.wait_for(std::chrono::milliseconds(2000LL)) != std::future_status::timeout);
+  EXPECT_FALSE(sema.tryWait());
+}
+
+TEST_F(SemaphoreTest, producerConsumer) {
+  Semaphore items;
+  std::atomic<uint32_t> consumed{ 0 };
+  std::vector<std::thread> consumers;
+  for (int i = 0; i < 4; ++i) {
+    consumers.emplace_back([&items, &consumed]() {
+      for (int j = 0; j < 25000; ++j) {
+        items.wait();
+        ++consumed;
+      }
+    });
+  }
+  for (int i = 0; i < 100000; ++i)
+    items.notify();
+  for (auto& consumer : consumers)
+    consumer.join();
+  EXPECT_EQ(100000u, consumed.load());
+  EXPECT_EQ(0u, items.reset());
+}
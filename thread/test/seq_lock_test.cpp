@@ -0,0 +1,116 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include <thread/seq_lock.h>
+
+using namespace pandora::thread;
+
+class SeqLockTest : public testing::Test {
+public:
+protected:
+  //static void SetUpTestCase() {}
+  //static void TearDownTestCase() {}
+
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+struct __SeqLockSnapshot {
+  int32_t a = 0;
+  int32_t b = 0;
+  uint64_t c = 0;
+  char label[5] = { 0 }; // size not multiple of words
+};
+
+
+// -- read/write --
+
+TEST_F(SeqLockTest, loadStore) {
+  SeqLock<__SeqLockSnapshot> snapshot;
+  EXPECT_EQ(0u, snapshot.version());
+  __SeqLockSnapshot value = snapshot.load();
+  EXPECT_EQ(0, value.a);
+  EXPECT_EQ(0u, value.c);
+
+  value.a = 5;
+  value.b = -7;
+  value.c = 0xFFFFFFFF00000001uLL;
+  memcpy(value.label, "abcd", 5);
+  snapshot.store(value);
+  EXPECT_EQ(1u, snapshot.version());
+
+  __SeqLockSnapshot copy;
+  EXPECT_TRUE(snapshot.tryLoad(copy));
+  EXPECT_EQ(5, copy.a);
+  EXPECT_EQ(-7, copy.b);
+  EXPECT_EQ(0xFFFFFFFF00000001uLL, copy.c);
+  EXPECT_STREQ("abcd", copy.label);
+
+  snapshot.update([](__SeqLockSnapshot& data) { ++data.a; data.b = 0; });
+  EXPECT_EQ(2u, snapshot.version());
+  copy = snapshot.load();
+  EXPECT_EQ(6, copy.a);
+  EXPECT_EQ(0, copy.b);
+  EXPECT_EQ(0xFFFFFFFF00000001uLL, copy.c);
+
+  SeqLock<double> number(2.5);
+  EXPECT_EQ(2.5, number.load());
+}
+
+// -- concurrency test --
+
+TEST_F(SeqLockTest, consistentSnapshots) {
+  SeqLock<__SeqLockSnapshot> snapshot;
+  std::atomic<bool> isRunning{ true };
+  std::atomic<uint32_t> errorCount{ 0 };
+
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 4; ++t) {
+    readers.emplace_back([&snapshot, &isRunning, &errorCount]() {
+      while (isRunning.load(std::memory_order_relaxed)) {
+        __SeqLockSnapshot value = snapshot.load();
+        if (value.a != -value.b || static_cast<uint64_t>(value.a) * 3u != value.c)
+          errorCount.fetch_add(1u, std::memory_order_relaxed);
+      }
+    });
+  }
+  std::vector<std::thread> writers;
+  for (int t = 0; t < 2; ++t) {
+    writers.emplace_back([&snapshot]() {
+      for (int i = 0; i < 5000; ++i) {
+        snapshot.update([](__SeqLockSnapshot& data) {
+          ++data.a;
+          data.b = -data.a;
+          data.c = static_cast<uint64_t>(data.a) * 3u;
+        });
+      }
+    });
+  }
+  for (auto& writer : writers)
+    writer.join();
+  isRunning = false;
+  for (auto& reader : readers)
+    reader.join();
+
+  EXPECT_EQ(0u, errorCount.load());
+  EXPECT_EQ(10000, snapshot.load().a);
+  EXPECT_EQ(10000u, snapshot.version());
+}
@@ -0,0 +1,163 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include <gtest/gtest.h>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <future>
+#include <vector>
+#include <thread/shared_spin_lock.h>
+
+using namespace pandora::thread;
+
+class SharedSpinLockTest : public testing::Test {
+public:
+protected:
+  //static void SetUpTestCase() {}
+  //static void TearDownTestCase() {}
+
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+// -- helpers --
+
+template <typename _LockType>
+static void __verifySharedLockModes() {
+  _LockType mutex;
+  EXPECT_FALSE(mutex.isLocked());
+  EXPECT_EQ(0u, mutex.readerCount());
+
+  // exclusive
+  mutex.lock();
+  EXPECT_TRUE(mutex.isLocked());
+  EXPECT_FALSE(mutex.tryLock());
+  EXPECT_FALSE(mutex.tryLockShared());
+  EXPECT_FALSE(mutex.tryLockShared(std::chrono::milliseconds(2)));
+  mutex.unlock();
+  EXPECT_FALSE(mutex.isLocked());
+  EXPECT_TRUE(mutex.try_lock_for(std::chrono::milliseconds(1)));
+  mutex.unlock();
+
+  // shared
+  mutex.lockShared();
+  EXPECT_TRUE(mutex.tryLockShared());
+  EXPECT_EQ(2u, mutex.readerCount());
+  EXPECT_FALSE(mutex.isLocked());
+  EXPECT_FALSE(mutex.tryLock());
+  EXPECT_FALSE(mutex.tryLock(std::chrono::milliseconds(2)));
+  EXPECT_TRUE(mutex.tryLockShared()); // failed writer timeout -> readers not blocked anymore
+  mutex.unlockShared();
+  mutex.unlockShared();
+  mutex.unlockShared();
+  EXPECT_EQ(0u, mutex.readerCount());
+
+  { // STL guards
+    std::shared_lock<_LockType> reader1(mutex);
+    std::shared_lock<_LockType> reader2(mutex);
+    EXPECT_EQ(2u, mutex.readerCount());
+  }
+  {
+    std::unique_lock<_LockType> writer(mutex);
+    EXPECT_TRUE(mutex.isLocked());
+  }
+  EXPECT_TRUE(mutex.tryLock());
+  mutex.unlock();
+}
+
+template <typename _LockType>
+static void __verifySharedLockConcurrency() {
+  _LockType mutex;
+  uint32_t values[2] = { 0, 0 }; // always equal when not locked exclusively
+  std::atomic<uint32_t> errorCount{ 0 };
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 6; ++t) {
+    threads.emplace_back([&mutex, &values, &errorCount]() {
+      for (int i = 0; i < 20000; ++i) {
+        std::shared_lock<_LockType> guard(mutex);
+        if (values[0] != values[1])
+          errorCount.fetch_add(1u, std::memory_order_relaxed);
+      }
+    });
+  }
+  for (int t = 0; t < 2; ++t) {
+    threads.emplace_back([&mutex, &values]() {
+      for (int i = 0; i < 2000; ++i) {
+        std::lock_guard<_LockType> guard(mutex);
+        ++values[0];
+        ++values[1];
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  EXPECT_EQ(0u, errorCount.load());
+  EXPECT_EQ(4000u, values[0]);
+  EXPECT_EQ(4000u, values[1]);
+  EXPECT_FALSE(mutex.isLocked());
+  EXPECT_EQ(0u, mutex.readerCount());
+}
+
+
+// -- SharedSpinLock --
+
+TEST_F(SharedSpinLockTest, lockModes) {
+  __verifySharedLockModes<SharedSpinLock>();
+}
+
+TEST_F(SharedSpinLockTest, writerPreference) {
+  SharedSpinLock mutex;
+  mutex.lockShared();
+
+  std::atomic<bool> isWriterLocked{ false };
+  auto writer = std::async(std::launch::async, [&mutex, &isWriterLocked]() {
+    mutex.lock();
+    isWriterLocked = true;
+    mutex.unlock();
+  });
+  for (int retry = 0; retry < 200 && mutex.tryLockShared(); ++retry) { // wait until writer is pending
+    mutex.unlockShared();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_FALSE(mutex.tryLockShared()); // new readers blocked by pending writer
+  EXPECT_FALSE(isWriterLocked);
+
+  mutex.unlockShared();
+  EXPECT_TRUE(writer.wait_for(std::chrono::milliseconds(2000)) != std::future_status::timeout);
+  EXPECT_TRUE(isWriterLocked);
+  EXPECT_TRUE(mutex.tryLockShared());
+  mutex.unlockShared();
+}
+
+TEST_F(SharedSpinLockTest, multiThreadLock) {
+  __verifySharedLockConcurrency<SharedSpinLock>();
+}
+
+// -- StripedSharedSpinLock --
+
+TEST_F(SharedSpinLockTest, stripedLockModes) {
+  EXPECT_EQ(16u, StripedSharedSpinLock<>::stripeCount());
+  __verifySharedLockModes<StripedSharedSpinLock<> >();
+  __verifySharedLockModes<StripedSharedSpinLock<1u> >();
+}
+
+TEST_F(SharedSpinLockTest, stripedMultiThreadLock) {
+  __verifySharedLockConcurrency<StripedSharedSpinLock<> >();
+  __verifySharedLockConcurrency<StripedSharedSpinLock<4u> >();
+}
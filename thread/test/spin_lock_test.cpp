@@ -20,6 +20,8 @@ IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <thread>
 #include <mutex>
 #include <future>
+#include <atomic>
+#include <vector>
 #include <thread/spin_lock.h>
 
 using namespace pandora::thread;
@@ -157,3 +159,84 @@ TEST_F(SpinLockTest, multiThreadLock) {
   mutex.unlock();
   EXPECT_TRUE(promiseBase.wait_for(std::chrono::milliseconds(2000LL)) != std::future_status::timeout);
 }
+
+
+// -- adaptive spin-lock --
+
+TEST_F(SpinLockTest, adaptiveLockUnlock) {
+  AdaptiveSpinLock mutex;
+  mutex.lock();
+  EXPECT_FALSE(mutex.tryLock());
+  mutex.unlock();
+
+  EXPECT_TRUE(mutex.tryLock());
+  EXPECT_FALSE(mutex.try_lock());
+  mutex.unlock();
+  EXPECT_TRUE(mutex.tryLock(std::chrono::milliseconds(1)));
+  mutex.unlock();
+  EXPECT_TRUE(mutex.try_lock_until(std::chrono::steady_clock::now() + std::chrono::milliseconds(1)));
+  mutex.unlock();
+
+  { // scope
+    std::lock_guard<AdaptiveSpinLock> lock(mutex);
+    EXPECT_FALSE(mutex.tryLock());
+    EXPECT_FALSE(mutex.tryLock(std::chrono::milliseconds(1)));
+
+    auto timeout = std::chrono::steady_clock::now() + std::chrono::milliseconds(16LL);
+    EXPECT_FALSE(mutex.tryLockUntil(timeout));
+    EXPECT_TRUE(std::chrono::steady_clock::now() >= timeout - std::chrono::milliseconds(2LL));//core switch error margin
+  } // end of scope
+  EXPECT_TRUE(mutex.tryLock());
+  mutex.unlock();
+}
+
+TEST_F(SpinLockTest, adaptiveMultiThreadLock) {
+  AdaptiveSpinLock mutex;
+  uint32_t counter = 0;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&mutex, &counter]() {
+      for (int i = 0; i < 20000; ++i) {
+        std::lock_guard<AdaptiveSpinLock> lock(mutex);
+        ++counter;
+        if ((i & 0x3FF) == 0) // long critical section -> other threads sleep on futex
+          std::this_thread::sleep_for(std::chrono::microseconds(50));
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  EXPECT_EQ(160000u, counter);
+
+  // sleeping thread woken up by unlock
+  mutex.lock();
+  auto promise = std::async(std::launch::async, [&mutex]() {
+    EXPECT_TRUE(mutex.tryLock(std::chrono::milliseconds(2000LL)));
+    mutex.unlock();
+    mutex.lock();
+    mutex.unlock();
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10LL));
+  mutex.unlock();
+  EXPECT_TRUE(promise.wait_for(std::chrono::milliseconds(2000LL)) != std::future_status::timeout);
+}
+
+TEST_F(SpinLockTest, futexWaitWake) {
+  std::atomic<uint32_t> word{ 0 };
+  futexWait(word, 1u); // different value -> no wait
+  EXPECT_FALSE(futexWaitFor(word, 0u, std::chrono::milliseconds(0)));
+
+  auto start = std::chrono::steady_clock::now();
+  futexWaitFor(word, 0u, std::chrono::milliseconds(5));
+  EXPECT_TRUE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(4));
+
+  auto promise = std::async(std::launch::async, [&word]() {
+    while (word.load() == 0)
+      futexWait(word, 0u);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(2LL));
+  word.store(1u);
+  futexWakeAll(word);
+  EXPECT_TRUE(promise.wait_for(std::chrono::milliseconds(2000LL)) != std::future_status::timeout);
+  cpuRelax();
+}
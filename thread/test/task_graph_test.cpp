@@ -0,0 +1,152 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <thread/task_graph.h>
+#include <thread/work_stealing_thread_pool.h>
+
+using namespace pandora::thread;
+
+class TaskGraphTest : public testing::Test {
+public:
+protected:
+  //static void SetUpTestCase() {}
+  //static void TearDownTestCase() {}
+
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+
+// -- graph definition --
+
+TEST_F(TaskGraphTest, emptyGraph) {
+  TaskGraph graph;
+  TaskGraph::Pool pool(2u, &TaskGraph::processJob);
+  EXPECT_EQ(size_t{ 0u }, graph.size());
+  EXPECT_TRUE(graph.build());
+  EXPECT_TRUE(graph.run(pool));
+  EXPECT_EQ(size_t{ 0u }, graph.lastReport().criticalPath.size());
+
+  TaskGraph::Pool stoppedPool;
+  graph.addNode([]() {});
+  EXPECT_FALSE(graph.run(stoppedPool));
+}
+
+TEST_F(TaskGraphTest, invalidGraph) {
+  TaskGraph graph;
+  auto first = graph.addNode([]() {}, {}, "first");
+  EXPECT_THROW(graph.addNode([]() {}, { 5u }), std::out_of_range);
+  EXPECT_THROW(graph.addDependency(first, 7u), std::out_of_range);
+  auto second = graph.addNode([]() {}, { first }, "second");
+  EXPECT_EQ(std::string("second"), graph.label(second));
+  EXPECT_TRUE(graph.build());
+
+  graph.addDependency(second, first); // cycle
+  EXPECT_FALSE(graph.build());
+  TaskGraph::Pool pool(2u, &TaskGraph::processJob);
+  EXPECT_FALSE(graph.run(pool));
+
+  graph.clear();
+  EXPECT_EQ(size_t{ 0u }, graph.size());
+  EXPECT_TRUE(graph.build());
+}
+
+// -- execution --
+
+TEST_F(TaskGraphTest, dependencyOrder) {
+  constexpr uint32_t transformCount = 8u;
+  std::atomic<int> step{ 0 };
+  std::atomic<int> errors{ 0 };
+  std::atomic<int> transformed{ 0 };
+  std::atomic<int> written{ 0 };
+
+  TaskGraph graph;
+  auto parse = graph.addNode([&]() { if (step.exchange(1) != 0) ++errors; }, {}, "parse");
+  std::vector<TaskGraph::NodeId> transforms;
+  for (uint32_t i = 0; i < transformCount; ++i) {
+    transforms.emplace_back(graph.addNode([&]() {
+      if (step.load() != 1) ++errors;
+      ++transformed;
+    }, { parse }, "transform"));
+  }
+  auto merge = graph.addNode([&]() {
+    if (transformed.load() != static_cast<int>(transformCount)) ++errors;
+    step = 2;
+  }, {}, "merge");
+  for (auto transform : transforms)
+    graph.addDependency(transform, merge);
+  graph.addNode([&]() { if (step.load() != 2) ++errors; ++written; }, { merge }, "write");
+  EXPECT_TRUE(graph.build());
+
+  TaskGraph::Pool pool(4u, &TaskGraph::processJob);
+  for (int run = 1; run <= 20; ++run) { // build once, run many times
+    step = 0;
+    transformed = 0;
+    EXPECT_TRUE(graph.run(pool));
+    EXPECT_EQ(0, errors.load());
+    EXPECT_EQ(run, written.load());
+  }
+
+  // other pool type
+  WorkStealingThreadPool<TaskGraphJob, ThreadRunnerMode::single, TaskRunnerType::functionPointer> stealingPool(3u, &TaskGraph::processJob);
+  step = 0;
+  transformed = 0;
+  EXPECT_TRUE(graph.run(stealingPool));
+  EXPECT_EQ(0, errors.load());
+  EXPECT_EQ(21, written.load());
+}
+
+TEST_F(TaskGraphTest, taskException) {
+  std::atomic<int> processed{ 0 };
+  TaskGraph graph;
+  auto first = graph.addNode([&]() { ++processed; });
+  auto failing = graph.addNode([]() { throw std::runtime_error("failure"); }, { first });
+  graph.addNode([&]() { ++processed; }, { failing });
+
+  TaskGraph::Pool pool(2u, &TaskGraph::processJob);
+  EXPECT_THROW(graph.run(pool), std::runtime_error);
+  EXPECT_EQ(1, processed.load());
+  EXPECT_THROW(graph.run(pool), std::runtime_error); // graph still usable
+  EXPECT_EQ(2, processed.load());
+}
+
+TEST_F(TaskGraphTest, criticalPathReport) {
+  TaskGraph graph;
+  auto root = graph.addNode([]() {}, {}, "root");
+  auto slow = graph.addNode([]() { std::this_thread::sleep_for(std::chrono::milliseconds(30)); }, { root }, "slow");
+  auto fast = graph.addNode([]() { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }, { root }, "fast");
+  auto end = graph.addNode([]() {}, { slow, fast }, "end");
+
+  TaskGraph::Pool pool(2u, &TaskGraph::processJob);
+  ASSERT_TRUE(graph.run(pool));
+  const TaskGraphReport& report = graph.lastReport();
+  ASSERT_EQ(size_t{ 4u }, report.nodeDurations.size());
+  EXPECT_GE(report.nodeDurations[slow], std::chrono::milliseconds(30));
+  ASSERT_EQ(size_t{ 3u }, report.criticalPath.size());
+  EXPECT_EQ(root, report.criticalPath[0]);
+  EXPECT_EQ(slow, report.criticalPath[1]);
+  EXPECT_EQ(end, report.criticalPath[2]);
+  EXPECT_GE(report.criticalPathDuration, report.nodeDurations[slow]);
+  EXPECT_GE(report.totalDuration, report.criticalPathDuration);
+}
@@ -18,6 +18,9 @@ IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 *******************************************************************************/
 #include <gtest/gtest.h>
 #include <stdexcept>
+#include <string>
+#include <vector>
+#include <atomic>
 #include <thread>
 #include <chrono>
 #include <functional>
@@ -355,6 +358,44 @@ TEST_F(ThreadPoolTest, runnerPerJobWithDefault) {
   EXPECT_TRUE(pool.addJob(std::make_unique<int>(2), &_taskRunner));
 }
 
+// -- bulk insertion --
+TEST_F(ThreadPoolTest, addJobsCommonRunner) {
+  int startVal = totalValue;
+  ThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> emptyPool;
+  std::vector<int> params{ 1, 2, 3, 4 };
+  EXPECT_FALSE(emptyPool.addJobs(params.begin(), params.end()));
+  EXPECT_FALSE(emptyPool.addJobs(std::vector<int>{ 1, 2 }));
+
+  ThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool(3u, &_taskRunner);
+  EXPECT_TRUE(pool.addJobs(params.begin(), params.begin())); // empty range
+  EXPECT_TRUE(pool.addJobs(params.begin(), params.end()));
+  _waitForJobsCompletion(pool);
+  EXPECT_EQ(startVal + 10, totalValue);
+  EXPECT_EQ(size_t{ 4u }, params.size()); // copied
+
+  EXPECT_TRUE(pool.addJobs(std::move(params)));
+  _waitForJobsCompletion(pool);
+  EXPECT_EQ(startVal + 20, totalValue);
+  EXPECT_TRUE(params.empty());
+
+  int values[] = { 5, 5 };
+  EXPECT_TRUE(pool.addJobs(&values[0], &values[2]));
+  _waitForJobsCompletion(pool);
+  EXPECT_EQ(startVal + 30, totalValue);
+}
+
+TEST_F(ThreadPoolTest, addJobsMoveOnly) {
+  int startVal = totalValue;
+  ThreadPool<std::unique_ptr<int>, ThreadRunnerMode::perJob, TaskRunnerType::functionPointer> pool(2u, &_taskRunner);
+  std::vector<std::unique_ptr<int> > params;
+  for (int i = 0; i < 16; ++i)
+    params.emplace_back(std::make_unique<int>(2));
+  EXPECT_TRUE(pool.addJobs(std::move(params)));
+  EXPECT_TRUE(params.empty());
+  _waitForJobsCompletion(pool);
+  EXPECT_EQ(startVal + 32, totalValue);
+}
+
 // -- exception management --
 TEST_F(ThreadPoolTest, runnerWithException) {
   int startVal = totalValue;
@@ -368,3 +409,161 @@ TEST_F(ThreadPoolTest, runnerWithException) {
   _waitForJobsCompletion(pool);
   EXPECT_EQ(startVal + 2, totalValue);
 }
+
+// -- job result handles --
+
+TEST_F(ThreadPoolTest, submitEmptyPool) {
+  ThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool;
+  JobHandle<void> handle = pool.submit(5);
+  EXPECT_FALSE(handle.isValid());
+  EXPECT_FALSE(handle.isReady());
+  EXPECT_FALSE(handle.tryWait(std::chrono::milliseconds(1)));
+  EXPECT_THROW(handle.get(), std::logic_error);
+  EXPECT_FALSE(handle.then([](JobHandle<void>&) {}));
+}
+
+TEST_F(ThreadPoolTest, submitCommonRunner) {
+  int startVal = totalValue;
+  ThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool(1u, &_taskRunner);
+
+  std::vector<JobHandle<void> > handles;
+  for (int i = 0; i < 8; ++i)
+    handles.emplace_back(pool.submit(1));
+  for (auto& handle : handles) {
+    EXPECT_TRUE(handle.isValid());
+    handle.wait();
+    EXPECT_TRUE(handle.isReady());
+    EXPECT_EQ(JobStatus::completed, handle.status());
+    EXPECT_NO_THROW(handle.get());
+  }
+  EXPECT_EQ(startVal + 8, totalValue);
+  EXPECT_TRUE(pool.addJob(1)); // standard jobs still available
+  _waitForJobsCompletion(pool);
+  EXPECT_EQ(startVal + 9, totalValue);
+}
+
+TEST_F(ThreadPoolTest, submitRunnerPerJob) {
+  ThreadPool<int, ThreadRunnerMode::perJob, TaskRunnerType::functionPointer> pool(2u);
+  int startVal = totalValue;
+  JobHandle<void> handle = pool.submit(3, &_taskRunner);
+  EXPECT_TRUE(handle.tryWait(std::chrono::seconds(5)));
+  EXPECT_EQ(JobStatus::completed, handle.status());
+  EXPECT_EQ(startVal + 3, totalValue);
+
+  ThreadPool<int, ThreadRunnerMode::perJob, TaskRunnerType::lambda> pool2(2u);
+  JobHandle<int> intHandle = pool2.submit(21, [](int& val) { return val * 2; });
+  EXPECT_EQ(42, intHandle.get());
+  JobHandle<std::string> strHandle = pool2.submit(4, [](int& val) { return std::string(static_cast<size_t>(val), 'a'); });
+  EXPECT_EQ(std::string("aaaa"), strHandle.get());
+  JobHandle<void> voidHandle = pool2.submit(1, [](int&) {});
+  EXPECT_NO_THROW(voidHandle.get());
+
+  JobHandle<int> copy = intHandle; // shared result
+  EXPECT_EQ(42, copy.get());
+}
+
+TEST_F(ThreadPoolTest, submitWithException) {
+  ThreadPool<int, ThreadRunnerMode::perJob, TaskRunnerType::lambda> pool(1u);
+  JobHandle<int> handle = pool.submit(1, [](int&) -> int { throw std::runtime_error("failure"); });
+  handle.wait();
+  EXPECT_EQ(JobStatus::failed, handle.status());
+  EXPECT_THROW(handle.get(), std::runtime_error);
+
+  JobHandle<int> nextHandle = pool.submit(2, [](int& val) { return val; }); // worker still running
+  EXPECT_EQ(2, nextHandle.get());
+}
+
+TEST_F(ThreadPoolTest, submitContinuation) {
+  ThreadPool<int, ThreadRunnerMode::perJob, TaskRunnerType::lambda> pool(2u);
+  std::atomic<int> continuationValue{ 0 };
+  std::atomic<int> continuationCount{ 0 };
+
+  // continuation set before completion -> run by worker
+  JobHandle<int> slowHandle = pool.submit(5, [](int& val) { std::this_thread::sleep_for(std::chrono::milliseconds(20)); return val; });
+  EXPECT_TRUE(slowHandle.then([&](JobHandle<int>& result) { continuationValue += result.get(); ++continuationCount; }));
+  EXPECT_FALSE(slowHandle.then([&](JobHandle<int>&) { ++continuationCount; })); // only one continuation
+  slowHandle.wait();
+  for (int retry = 0; retry < 500 && continuationCount.load() == 0; ++retry)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  EXPECT_EQ(5, continuationValue.load());
+
+  // continuation set after completion -> run immediately
+  JobHandle<int> fastHandle = pool.submit(3, [](int& val) { return val; });
+  fastHandle.wait();
+  EXPECT_TRUE(fastHandle.then([&](JobHandle<int>& result) { continuationValue += result.get(); ++continuationCount; }));
+  EXPECT_EQ(8, continuationValue.load());
+  EXPECT_EQ(2, continuationCount.load());
+
+  // continuation chaining a new job
+  JobHandle<int> chainedHandle;
+  std::atomic<bool> isChained{ false };
+  JobHandle<int> firstHandle = pool.submit(1, [](int& val) { return val; });
+  firstHandle.then([&](JobHandle<int>& result) {
+    chainedHandle = pool.submit(result.get() + 1, [](int& val) { return val * 10; });
+    isChained = true;
+  });
+  for (int retry = 0; retry < 5000 && !isChained.load(); ++retry)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  ASSERT_TRUE(isChained.load());
+  EXPECT_EQ(20, chainedHandle.get());
+}
+
+TEST_F(ThreadPoolTest, submitConcurrentContinuations) {
+  ThreadPool<int, ThreadRunnerMode::perJob, TaskRunnerType::lambda> pool(2u);
+  for (int iteration = 0; iteration < 200; ++iteration) {
+    std::atomic<int> continuationCount{ 0 };
+    std::atomic<int> acceptedCount{ 0 };
+    std::atomic<bool> isStarted{ false };
+    JobHandle<int> handle = pool.submit(iteration, [&isStarted](int& val) {
+      while (!isStarted.load()) { std::this_thread::yield(); }
+      return val;
+    });
+    JobHandle<int> copy1(handle), copy2(handle); // then() called from two handles at the same time (racing with completion)
+    std::thread first([&]() {
+      while (!isStarted.load()) { std::this_thread::yield(); }
+      if (copy1.then([&](JobHandle<int>&) { ++continuationCount; }))
+        ++acceptedCount;
+    });
+    std::thread second([&]() {
+      while (!isStarted.load()) { std::this_thread::yield(); }
+      if (copy2.then([&](JobHandle<int>&) { ++continuationCount; }))
+        ++acceptedCount;
+    });
+    isStarted = true;
+    first.join();
+    second.join();
+    EXPECT_EQ(iteration, handle.get());
+    for (int retry = 0; retry < 500 && continuationCount.load() == 0; ++retry)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    EXPECT_EQ(1, acceptedCount.load());
+    EXPECT_EQ(1, continuationCount.load());
+  }
+}
+
+TEST_F(ThreadPoolTest, submitCancelled) {
+  std::atomic<int> cancelledCount{ 0 };
+  JobHandle<int> lastHandle;
+  {
+    ThreadPool<int, ThreadRunnerMode::perJob, TaskRunnerType::lambda> pool(1u);
+    JobHandle<int> blockingHandle = pool.submit(1, [](int& val) { std::this_thread::sleep_for(std::chrono::milliseconds(50)); return val; });
+    std::vector<JobHandle<int> > handles;
+    for (int i = 0; i < 4; ++i) {
+      handles.emplace_back(pool.submit(i, [](int& val) { return val; }));
+      handles.back().then([&](JobHandle<int>& result) { if (result.status() == JobStatus::cancelled) ++cancelledCount; });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_EQ(4u, pool.cancelPendingJobs());
+    EXPECT_EQ(4, cancelledCount.load());
+    for (auto& handle : handles) {
+      EXPECT_TRUE(handle.isReady());
+      EXPECT_EQ(JobStatus::cancelled, handle.status());
+      EXPECT_THROW(handle.get(), std::logic_error);
+    }
+    EXPECT_EQ(1, blockingHandle.get());
+
+    JobHandle<int> stillBlocking = pool.submit(1, [](int& val) { std::this_thread::sleep_for(std::chrono::milliseconds(50)); return val; });
+    lastHandle = pool.submit(2, [](int& val) { return val; });
+  } // pool destroyed -> pending job cancelled, handle still usable
+  EXPECT_TRUE(lastHandle.isReady());
+  EXPECT_EQ(JobStatus::cancelled, lastHandle.status());
+}
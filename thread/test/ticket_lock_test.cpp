@@ -0,0 +1,176 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include <gtest/gtest.h>
+#include <thread>
+#include <mutex>
+#include <future>
+#include <vector>
+#include <thread/ticket_lock.h>
+
+using namespace pandora::thread;
+
+class TicketLockTest : public testing::Test {
+public:
+protected:
+  //static void SetUpTestCase() {}
+  //static void TearDownTestCase() {}
+
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+// wait until a number of threads are queued
+static void __waitTicketQueueSize(TicketLock& mutex, size_t queueSize) {
+  for (int retry = 0; retry < 2000 && mutex.queueSize() < queueSize; ++retry)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1LL));
+}
+
+
+// -- lock operations --
+
+TEST_F(TicketLockTest, lockUnlockedInstance) {
+  TicketLock mutex;
+  EXPECT_FALSE(mutex.isLocked());
+  EXPECT_EQ(size_t{ 0 }, mutex.queueSize());
+
+  mutex.lock();
+  EXPECT_TRUE(mutex.isLocked());
+  EXPECT_FALSE(mutex.tryLock());
+  mutex.unlock();
+  EXPECT_FALSE(mutex.isLocked());
+
+  EXPECT_TRUE(mutex.tryLock());
+  EXPECT_FALSE(mutex.try_lock());
+  mutex.unlock();
+  EXPECT_TRUE(mutex.tryLock(std::chrono::milliseconds(1)));
+  mutex.unlock();
+  EXPECT_TRUE(mutex.try_lock_for(std::chrono::milliseconds(1)));
+  mutex.unlock();
+  EXPECT_TRUE(mutex.tryLockUntil(std::chrono::steady_clock::now() + std::chrono::milliseconds(1)));
+  mutex.unlock();
+  EXPECT_TRUE(mutex.try_lock_until(std::chrono::steady_clock::now() + std::chrono::milliseconds(1)));
+  mutex.unlock();
+
+  { // scope
+    std::lock_guard<TicketLock> lock(mutex);
+    EXPECT_FALSE(mutex.tryLock());
+  } // end of scope
+  EXPECT_TRUE(mutex.tryLock());
+  mutex.unlock();
+}
+
+TEST_F(TicketLockTest, tryLockFailure) {
+  TicketLock mutex;
+  std::lock_guard<TicketLock> lock(mutex);
+
+  EXPECT_FALSE(mutex.tryLock());
+  EXPECT_FALSE(mutex.tryLock(std::chrono::milliseconds(1)));
+  EXPECT_FALSE(mutex.try_lock_for(std::chrono::microseconds(1)));
+
+  auto timeout = std::chrono::steady_clock::now() + std::chrono::milliseconds(16LL);
+  EXPECT_FALSE(mutex.tryLockUntil(timeout));
+  EXPECT_TRUE(std::chrono::steady_clock::now() >= timeout - std::chrono::milliseconds(2LL));//core switch error margin
+  EXPECT_TRUE(mutex.isLocked());
+}
+
+
+// -- concurrency test --
+
+TEST_F(TicketLockTest, multiThreadLock) {
+  TicketLock mutex;
+  uint32_t counter = 0;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&mutex, &counter]() {
+      for (int i = 0; i < 20000; ++i) {
+        std::lock_guard<TicketLock> lock(mutex);
+        ++counter;
+        if ((i & 0x3FF) == 0) // long critical section -> other threads sleep on futex
+          std::this_thread::sleep_for(std::chrono::microseconds(50));
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  EXPECT_EQ(160000u, counter);
+  EXPECT_FALSE(mutex.isLocked());
+}
+
+TEST_F(TicketLockTest, orderVerification) {
+  std::vector<int> lockOrder;
+  TicketLock mutex;
+  mutex.lock();
+
+  std::vector<std::future<void> > promises;
+  for (int i = 1; i <= 4; ++i) {
+    promises.emplace_back(std::async(std::launch::async, [&mutex, &lockOrder, i]() {
+      if (i % 2) { // mix blocking/timed waits
+        mutex.lock();
+      }
+      else {
+        EXPECT_TRUE(mutex.tryLock(std::chrono::milliseconds(2000LL)));
+      }
+      lockOrder.push_back(i);
+      mutex.unlock();
+    }));
+    __waitTicketQueueSize(mutex, static_cast<size_t>(i));
+  }
+  EXPECT_EQ(size_t{ 4u }, mutex.queueSize());
+  mutex.unlock();
+
+  for (auto& promise : promises)
+    EXPECT_TRUE(promise.wait_for(std::chrono::milliseconds(2000LL)) != std::future_status::timeout);
+  EXPECT_TRUE(lockOrder.size() == 4 && lockOrder[0] == 1 && lockOrder[1] == 2 && lockOrder[2] == 3 && lockOrder[3] == 4);
+  EXPECT_TRUE(mutex.tryLock());
+  mutex.unlock();
+}
+
+TEST_F(TicketLockTest, abandonedTickets) {
+  std::vector<int> lockOrder;
+  TicketLock mutex;
+  mutex.lock();
+
+  auto promise1 = std::async(std::launch::async, [&mutex]() {
+    EXPECT_FALSE(mutex.tryLock(std::chrono::milliseconds(20LL))); // abandoned ticket
+  });
+  __waitTicketQueueSize(mutex, 1u);
+  auto promise2 = std::async(std::launch::async, [&mutex, &lockOrder]() {
+    mutex.lock();
+    lockOrder.push_back(2);
+    mutex.unlock();
+  });
+  __waitTicketQueueSize(mutex, 2u);
+  EXPECT_TRUE(promise1.wait_for(std::chrono::milliseconds(2000LL)) != std::future_status::timeout);
+  EXPECT_EQ(size_t{ 2u }, mutex.queueSize()); // abandoned ticket not skipped yet
+
+  mutex.unlock(); // skip abandoned ticket
+  EXPECT_TRUE(promise2.wait_for(std::chrono::milliseconds(2000LL)) != std::future_status::timeout);
+  EXPECT_TRUE(lockOrder.size() == 1 && lockOrder[0] == 2);
+  EXPECT_FALSE(mutex.isLocked());
+  EXPECT_TRUE(mutex.tryLock());
+  mutex.unlock();
+
+  // many abandoned tickets (more than slots)
+  mutex.lock();
+  for (int i = 0; i < 40; ++i)
+    EXPECT_FALSE(mutex.tryLock(std::chrono::microseconds(10LL)));
+  mutex.unlock();
+  EXPECT_TRUE(mutex.tryLock(std::chrono::milliseconds(2000LL)));
+  mutex.unlock();
+}
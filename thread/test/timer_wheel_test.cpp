@@ -0,0 +1,255 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <thread/thread_pool.h>
+#include <thread/timer_wheel.h>
+
+using namespace pandora::thread;
+
+class TimerWheelTest : public testing::Test {
+public:
+protected:
+  //static void SetUpTestCase() {}
+  //static void TearDownTestCase() {}
+
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+
+// -- helpers --
+
+// pool replacement: store received jobs + number of insertions
+struct TimerWheelTestPool final {
+  std::vector<int> jobs;
+  size_t batchCount = 0;
+  bool isRunning = true;
+
+  template <typename _Iterator>
+  bool addJobs(_Iterator first, _Iterator last) {
+    if (!isRunning)
+      return false;
+    ++batchCount;
+    for (; first != last; ++first)
+      jobs.emplace_back(*first);
+    return true;
+  }
+};
+using ManualTimerWheel = TimerWheel<int, TimerWheelTestPool>;
+
+static std::atomic<int> timerWheelTotalValue{ 0 };
+void _timerWheelTaskRunner(int& param) { timerWheelTotalValue += param; }
+
+
+// -- ticket --
+
+TEST_F(TimerWheelTest, ticket) {
+  TimerTicket empty;
+  EXPECT_FALSE(empty.isValid());
+  EXPECT_FALSE(empty);
+  EXPECT_EQ(uint64_t{ 0 }, empty.id());
+
+  TimerTicket ticket(5u, 2u);
+  EXPECT_TRUE(ticket.isValid());
+  EXPECT_EQ(5u, ticket.index());
+  EXPECT_EQ(2u, ticket.generation());
+  TimerTicket copy = ticket;
+  EXPECT_TRUE(copy == ticket);
+  EXPECT_FALSE(copy != ticket);
+  TimerTicket moved = std::move(copy);
+  EXPECT_TRUE(moved == ticket);
+  EXPECT_FALSE(copy.isValid());
+  moved.invalidate();
+  EXPECT_FALSE(moved.isValid());
+}
+
+// -- manual mode --
+
+TEST_F(TimerWheelTest, oneShotTimers) {
+  TimerWheelTestPool pool;
+  ManualTimerWheel timers(pool, std::chrono::milliseconds(1), TimerWheelMode::manual);
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_TRUE(timers.empty());
+  EXPECT_EQ(std::chrono::steady_clock::duration(std::chrono::milliseconds(1)), timers.tickDuration());
+
+  EXPECT_TRUE(timers.scheduleAt(start + std::chrono::milliseconds(10), 1).isValid());
+  EXPECT_TRUE(timers.scheduleAt(start + std::chrono::milliseconds(10), 2).isValid());
+  EXPECT_TRUE(timers.scheduleAt(start + std::chrono::milliseconds(10), 3).isValid());
+  EXPECT_TRUE(timers.scheduleAt(start + std::chrono::milliseconds(50), 4).isValid());
+  EXPECT_TRUE(timers.scheduleAfter(std::chrono::hours(1), 5).isValid());
+  EXPECT_EQ(size_t{ 5u }, timers.size());
+
+  EXPECT_EQ(size_t{ 0u }, timers.advance(start + std::chrono::milliseconds(5)));
+  EXPECT_TRUE(pool.jobs.empty());
+  EXPECT_EQ(size_t{ 3u }, timers.advance(start + std::chrono::milliseconds(12))); // same tick -> coalesced
+  EXPECT_EQ(size_t{ 1u }, pool.batchCount);
+  EXPECT_EQ(size_t{ 2u }, timers.size());
+  EXPECT_EQ(size_t{ 1u }, timers.advance(start + std::chrono::milliseconds(60)));
+  EXPECT_EQ(size_t{ 2u }, pool.batchCount);
+  EXPECT_EQ((std::vector<int>{ 3, 2, 1, 4 }), pool.jobs);
+  EXPECT_EQ(size_t{ 1u }, timers.size());
+  EXPECT_TRUE(timers.currentTick() >= uint64_t{ 60u });
+
+  EXPECT_EQ(1u, timers.cancelAll());
+  EXPECT_TRUE(timers.empty());
+}
+
+TEST_F(TimerWheelTest, pastTimers) {
+  TimerWheelTestPool pool;
+  ManualTimerWheel timers(pool, std::chrono::milliseconds(1), TimerWheelMode::manual);
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(size_t{ 0u }, timers.advance(start + std::chrono::milliseconds(20)));
+  timers.scheduleAt(start, 7); // already expired -> next tick
+  EXPECT_EQ(size_t{ 1u }, timers.advance(start + std::chrono::milliseconds(22)));
+  EXPECT_EQ((std::vector<int>{ 7 }), pool.jobs);
+}
+
+TEST_F(TimerWheelTest, longDelays) {
+  TimerWheelTestPool pool;
+  ManualTimerWheel timers(pool, std::chrono::milliseconds(1), TimerWheelMode::manual);
+  auto start = std::chrono::steady_clock::now();
+  timers.scheduleAt(start + std::chrono::milliseconds(300), 1);      // 2nd wheel
+  timers.scheduleAt(start + std::chrono::milliseconds(70000), 2);    // 3rd wheel
+  timers.scheduleAt(start + std::chrono::hours(5), 3);               // 4th wheel
+  timers.scheduleAt(start + std::chrono::hours(24 * 60), 4);         // beyond last wheel (> 2^32 ticks)
+
+  EXPECT_EQ(size_t{ 0u }, timers.advance(start + std::chrono::milliseconds(299)));
+  EXPECT_EQ(size_t{ 1u }, timers.advance(start + std::chrono::milliseconds(302)));
+  EXPECT_EQ(size_t{ 0u }, timers.advance(start + std::chrono::milliseconds(69999)));
+  EXPECT_EQ(size_t{ 1u }, timers.advance(start + std::chrono::milliseconds(70002)));
+  EXPECT_EQ(size_t{ 0u }, timers.advance(start + std::chrono::hours(5) - std::chrono::milliseconds(1)));
+  EXPECT_EQ(size_t{ 1u }, timers.advance(start + std::chrono::hours(5) + std::chrono::milliseconds(2)));
+  EXPECT_EQ(size_t{ 0u }, timers.advance(start + std::chrono::hours(24 * 60) - std::chrono::milliseconds(1)));
+  EXPECT_EQ(size_t{ 1u }, timers.advance(start + std::chrono::hours(24 * 60) + std::chrono::milliseconds(2)));
+  EXPECT_EQ((std::vector<int>{ 1, 2, 3, 4 }), pool.jobs);
+  EXPECT_TRUE(timers.empty());
+}
+
+TEST_F(TimerWheelTest, periodicTimers) {
+  TimerWheelTestPool pool;
+  ManualTimerWheel timers(pool, std::chrono::milliseconds(1), TimerWheelMode::manual);
+  auto start = std::chrono::steady_clock::now();
+  TimerTicket ticket = timers.schedulePeriodic(std::chrono::milliseconds(10), 1);
+  TimerTicket ticket2 = timers.schedulePeriodic(std::chrono::milliseconds(100), std::chrono::milliseconds(0), 2);
+  EXPECT_TRUE(ticket.isValid() && ticket2.isValid());
+
+  for (int ms = 1; ms <= 105; ++ms)
+    timers.advance(start + std::chrono::milliseconds(ms));
+  size_t ones = 0, twos = 0;
+  for (auto job : pool.jobs)
+    (job == 1) ? ++ones : ++twos;
+  EXPECT_TRUE(ones >= 9u && ones <= 10u);
+  EXPECT_EQ(size_t{ 2u }, twos);
+  EXPECT_EQ(size_t{ 2u }, timers.size());
+
+  EXPECT_TRUE(timers.cancel(ticket));
+  EXPECT_FALSE(ticket.isValid());
+  EXPECT_EQ(size_t{ 1u }, timers.size());
+  pool.jobs.clear();
+  EXPECT_EQ(size_t{ 9u }, timers.advance(start + std::chrono::milliseconds(1050))); // catch-up: missed periods (201 -> 1001) still inserted
+  EXPECT_EQ((std::vector<int>(9, 2)), pool.jobs);
+}
+
+TEST_F(TimerWheelTest, cancelTimers) {
+  TimerWheelTestPool pool;
+  ManualTimerWheel timers(pool, std::chrono::milliseconds(1), TimerWheelMode::manual);
+  auto start = std::chrono::steady_clock::now();
+  TimerTicket first = timers.scheduleAt(start + std::chrono::milliseconds(10), 1);
+  TimerTicket second = timers.scheduleAt(start + std::chrono::milliseconds(10), 2);
+  TimerTicket third = timers.scheduleAt(start + std::chrono::milliseconds(1000), 3);
+  TimerTicket copy = second;
+
+  EXPECT_TRUE(timers.cancel(second));
+  EXPECT_FALSE(timers.cancel(copy)); // already cancelled
+  EXPECT_TRUE(timers.cancel(third));
+  EXPECT_EQ(size_t{ 1u }, timers.size());
+  EXPECT_EQ(size_t{ 1u }, timers.advance(start + std::chrono::milliseconds(2000)));
+  EXPECT_EQ((std::vector<int>{ 1 }), pool.jobs);
+  EXPECT_FALSE(timers.cancel(first)); // already expired
+
+  TimerTicket reused = timers.scheduleAt(start + std::chrono::milliseconds(3000), 4); // node reused -> old tickets still invalid
+  TimerTicket stale(reused.index(), reused.generation() - 1u);
+  EXPECT_FALSE(timers.cancel(stale));
+  EXPECT_EQ(size_t{ 1u }, timers.size());
+  TimerTicket empty;
+  EXPECT_FALSE(timers.cancel(empty));
+}
+
+TEST_F(TimerWheelTest, rejectedJobs) {
+  TimerWheelTestPool pool;
+  pool.isRunning = false;
+  ManualTimerWheel timers(pool, std::chrono::milliseconds(1), TimerWheelMode::manual);
+  auto start = std::chrono::steady_clock::now();
+  timers.scheduleAt(start + std::chrono::milliseconds(1), 1);
+  EXPECT_EQ(size_t{ 0u }, timers.advance(start + std::chrono::milliseconds(5)));
+  EXPECT_TRUE(timers.empty());
+}
+
+TEST_F(TimerWheelTest, millionTimers) {
+  TimerWheelTestPool pool;
+  ManualTimerWheel timers(pool, std::chrono::milliseconds(1), TimerWheelMode::manual);
+  auto start = std::chrono::steady_clock::now();
+  const int timerCount = 1000000;
+  timers.reserve(static_cast<size_t>(timerCount));
+  EXPECT_TRUE(timers.capacity() >= static_cast<size_t>(timerCount));
+
+  std::vector<TimerTicket> tickets;
+  tickets.reserve(static_cast<size_t>(timerCount));
+  for (int i = 0; i < timerCount; ++i)
+    tickets.emplace_back(timers.scheduleAt(start + std::chrono::milliseconds(1 + (i % 100000)), 1));
+  EXPECT_EQ(static_cast<size_t>(timerCount), timers.size());
+  for (int i = 0; i < timerCount; i += 2)
+    EXPECT_TRUE(timers.cancel(tickets[static_cast<size_t>(i)]));
+  EXPECT_EQ(static_cast<size_t>(timerCount/2), timers.size());
+
+  EXPECT_EQ(static_cast<size_t>(timerCount/2), timers.advance(start + std::chrono::milliseconds(100005)));
+  EXPECT_EQ(static_cast<size_t>(timerCount/2), pool.jobs.size());
+  EXPECT_TRUE(timers.empty());
+  EXPECT_TRUE(timers.capacity() >= static_cast<size_t>(timerCount)); // storage kept for reuse
+}
+
+// -- threaded mode --
+
+TEST_F(TimerWheelTest, threadPoolTimers) {
+  ThreadPool<int> pool(2u, &_timerWheelTaskRunner);
+  timerWheelTotalValue = 0;
+  {
+    TimerWheel<int> timers(pool, std::chrono::milliseconds(1));
+    timers.scheduleAfter(std::chrono::milliseconds(5), 1);
+    timers.scheduleAfter(std::chrono::milliseconds(10), 2);
+    TimerTicket cancelled = timers.scheduleAfter(std::chrono::milliseconds(15), 100);
+    TimerTicket periodic = timers.schedulePeriodic(std::chrono::milliseconds(2), 1000);
+    EXPECT_TRUE(timers.cancel(cancelled));
+
+    for (int retry = 0; retry < 5000 && timerWheelTotalValue.load() < 2003; ++retry)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1u));
+    EXPECT_TRUE(timers.cancel(periodic));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20u));
+    EXPECT_TRUE(timers.empty());
+  }
+  for (int retry = 0; retry < 5000 && (pool.busyThreads() != 0u); ++retry)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1u));
+  EXPECT_EQ(3, timerWheelTotalValue.load() % 1000);
+  EXPECT_TRUE(timerWheelTotalValue.load() >= 2003);
+}
@@ -0,0 +1,193 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*******************************************************************************/
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <thread/work_stealing_thread_pool.h>
+
+using namespace pandora::thread;
+
+class WorkStealingThreadPoolTest : public testing::Test {
+public:
+protected:
+  //static void SetUpTestCase() {}
+  //static void TearDownTestCase() {}
+
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+
+// -- helpers --
+
+static std::atomic<int> stealingTotalValue{ 0 };
+void _stealingTaskRunner(int& param) {
+  stealingTotalValue += param;
+  std::this_thread::sleep_for(std::chrono::milliseconds(1u));
+}
+void _stealingTaskRunner(std::unique_ptr<int>& param) {
+  if (param != nullptr)
+    stealingTotalValue += *param;
+}
+void _stealingExceptionRunner(int& val) {
+  if (val == 42)
+    throw val;
+  stealingTotalValue += val;
+  throw std::runtime_error("ok");
+}
+
+template <typename T>
+bool _waitForStealingPoolCompletion(const T& pool) {
+  auto timeoutTime = std::chrono::steady_clock::now() + std::chrono::milliseconds(5000u);
+  while (std::chrono::steady_clock::now() < timeoutTime) {
+    if (pool.pendingJobs() == 0u && pool.busyThreads() == 0u) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1u));
+      if (pool.pendingJobs() == 0u && pool.busyThreads() == 0u) // second check, in case a thread was about to increment its counter
+        return true;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(100u));
+  }
+  return false;
+}
+
+
+// -- special constructors --
+
+TEST_F(WorkStealingThreadPoolTest, emptyPool) {
+  WorkStealingThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool;
+  EXPECT_EQ(size_t{ 0u }, pool.size());
+  EXPECT_EQ(size_t{ 0u }, pool.busyThreads());
+  EXPECT_EQ(size_t{ 0u }, pool.freeThreads());
+  EXPECT_EQ(size_t{ 0u }, pool.pendingJobs());
+  EXPECT_FALSE(pool.addJob(5));
+  EXPECT_EQ(0u, pool.cancelPendingJobs());
+
+  WorkStealingThreadPool<int, ThreadRunnerMode::perJob, TaskRunnerType::lambda> pool2;
+  EXPECT_EQ(size_t{ 0u }, pool2.size());
+  EXPECT_FALSE(pool2.addJob(5, [](int&) {}));
+  EXPECT_EQ(0u, pool2.cancelPendingJobs());
+}
+
+TEST_F(WorkStealingThreadPoolTest, movedPool) {
+  WorkStealingThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool1;
+  WorkStealingThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool2(4u, &_stealingTaskRunner);
+  WorkStealingThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool3(5u, &_stealingTaskRunner);
+
+  WorkStealingThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> poolMoved1(std::move(pool1));
+  WorkStealingThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> poolMoved2(std::move(pool2));
+  pool1 = std::move(pool3);
+  EXPECT_EQ(0u, poolMoved1.size());
+  EXPECT_EQ(4u, poolMoved2.size());
+  EXPECT_EQ(5u, pool1.size());
+  EXPECT_FALSE(pool3.addJob(1));
+  EXPECT_TRUE(pool1.addJob(1));
+}
+
+
+// -- job processing --
+
+TEST_F(WorkStealingThreadPoolTest, commonRunner) {
+  WorkStealingThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool(4u, &_stealingTaskRunner);
+  EXPECT_EQ(size_t{ 4u }, pool.size());
+  EXPECT_EQ(pool.size(), pool.freeThreads());
+
+  stealingTotalValue = 0;
+  for (int i = 0; i < 64; ++i)
+    EXPECT_TRUE(pool.addJob(2));
+  EXPECT_TRUE(_waitForStealingPoolCompletion(pool));
+  EXPECT_EQ(128, stealingTotalValue.load());
+  EXPECT_EQ(size_t{ 0u }, pool.busyThreads());
+  EXPECT_EQ(pool.size(), pool.freeThreads());
+
+  // move-only type
+  WorkStealingThreadPool<std::unique_ptr<int>, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool2(2u, &_stealingTaskRunner);
+  stealingTotalValue = 0;
+  EXPECT_TRUE(pool2.addJob(std::make_unique<int>(2)));
+  EXPECT_TRUE(_waitForStealingPoolCompletion(pool2));
+  EXPECT_EQ(2, stealingTotalValue.load());
+}
+
+TEST_F(WorkStealingThreadPoolTest, runnerPerJob) {
+  WorkStealingThreadPool<int, ThreadRunnerMode::perJob, TaskRunnerType::lambda> pool(3u, [](int& val) { stealingTotalValue += val; });
+
+  stealingTotalValue = 0;
+  for (int i = 0; i < 32; ++i)
+    EXPECT_TRUE(pool.addJob(1, [](int& val) { stealingTotalValue += 2*val; }));
+  for (int i = 0; i < 32; ++i)
+    EXPECT_TRUE(pool.addJob(1));
+  EXPECT_TRUE(_waitForStealingPoolCompletion(pool));
+  EXPECT_EQ(96, stealingTotalValue.load());
+}
+
+TEST_F(WorkStealingThreadPoolTest, cancelPendingJobs) {
+  WorkStealingThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool(2u, &_stealingTaskRunner);
+
+  stealingTotalValue = 0;
+  int nbJobs = 200;
+  for (int i = 0; i < nbJobs; ++i)
+    EXPECT_TRUE(pool.addJob(1));
+  std::this_thread::sleep_for(std::chrono::milliseconds(2u));
+  auto cancelled = pool.cancelPendingJobs();
+  EXPECT_LT(0u, cancelled);
+  EXPECT_TRUE(_waitForStealingPoolCompletion(pool));
+  EXPECT_EQ(nbJobs, stealingTotalValue.load() + static_cast<int>(cancelled));
+  EXPECT_EQ(size_t{ 0u }, pool.pendingJobs());
+}
+
+// -- jobs inserted by workers (local queues) + stealing --
+
+TEST_F(WorkStealingThreadPoolTest, nestedJobs) {
+  using PoolType = WorkStealingThreadPool<int, ThreadRunnerMode::perJob, TaskRunnerType::lambda>;
+  PoolType pool(4u);
+  std::atomic<int> leafCount{ 0 };
+
+  std::function<void(int&)> splitter;
+  splitter = [&pool, &leafCount, &splitter](int& depth) {
+    if (depth > 0) {
+      auto subRunner = splitter;
+      pool.addJob(depth - 1, std::move(subRunner));
+      auto subRunner2 = splitter;
+      pool.addJob(depth - 1, std::move(subRunner2));
+    }
+    else
+      ++leafCount;
+  };
+  auto rootRunner = splitter;
+  EXPECT_TRUE(pool.addJob(8, std::move(rootRunner)));
+  EXPECT_TRUE(_waitForStealingPoolCompletion(pool));
+  EXPECT_EQ(256, leafCount.load());
+}
+
+// -- exception management --
+
+TEST_F(WorkStealingThreadPoolTest, runnerWithException) {
+  WorkStealingThreadPool<int, ThreadRunnerMode::single, TaskRunnerType::functionPointer> pool(1u, &_stealingExceptionRunner);
+  stealingTotalValue = 0;
+
+  EXPECT_TRUE(pool.addJob(2));
+  EXPECT_TRUE(_waitForStealingPoolCompletion(pool));
+  EXPECT_EQ(2, stealingTotalValue.load());
+
+  EXPECT_TRUE(pool.addJob(42));
+  EXPECT_TRUE(_waitForStealingPoolCompletion(pool));
+  EXPECT_EQ(2, stealingTotalValue.load());
+}
@@ -0,0 +1,59 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+--------------------------------------------------------------------------------
+Description : display helpers for benchmark utility
+*******************************************************************************/
+#pragma once
+
+#ifdef _MSC_VER
+# define _CRT_SECURE_NO_WARNINGS
+#endif
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include "report.h"
+
+// display section title
+inline void printTitle(const std::string& title) {
+  printf("------------------------------------------------------------\n %s\n------------------------------------------------------------\n\n", title.c_str());
+}
+
+// display title of a result table (also used as section name in exported reports)
+inline void printTableTitle(const std::string& title) {
+  printf("%s:\n", title.c_str());
+  BenchmarkReport::instance().setSection(title);
+}
+
+// display header of a result table (one column per thread count, or per other 'unit')
+inline void printResultHeader(const std::string& label, const uint32_t* threadCounts, size_t length, const char* unit = "thr.") {
+  BenchmarkReport::instance().setColumns(threadCounts, length, unit);
+  printf("%-24s", label.c_str());
+  for (size_t i = 0; i < length; ++i)
+    printf("| %4u %-4s ", threadCounts[i], unit);
+  printf("|\n");
+}
+
+// display one line of a result table (durations in nanoseconds, or in other 'unit')
+inline void printResultLine(const std::string& label, const int64_t* results, size_t length, const char* unit = "ns") {
+  BenchmarkReport::instance().addRow(label, results, length, unit);
+  printf("%-24s", label.c_str());
+  for (size_t i = 0; i < length; ++i)
+    printf("|%7lld %s ", static_cast<long long>(results[i]), unit);
+  printf("|\n");
+}
@@ -0,0 +1,142 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+--------------------------------------------------------------------------------
+Description : measure lock contention and fairness for benchmark utility
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread/spin_lock.h>
+#include <thread/recursive_spin_lock.h>
+#include <thread/ordered_lock.h>
+#include <thread/ticket_lock.h>
+#include <thread/semaphore.h>
+
+#define _BENCHMARK_LOCK_OPERATIONS 200000u
+#define _BENCHMARK_LOCK_FAIRNESS_PERIOD_MS 100
+#define _BENCHMARK_PING_PONG_ROUND_TRIPS 20000u
+
+// thread counts for lock benchmarks (independent of CPU count: show behavior under over-subscription)
+inline std::vector<uint32_t> lockBenchmarkThreadCounts() {
+  return std::vector<uint32_t>{ 1u, 2u, 4u, 8u, 16u, 32u, 64u };
+}
+
+// lock/unlock from multiple threads with a critical section of 'criticalIterations', and measure average duration per critical section
+template <typename _LockType>
+int64_t benchmarkLockContention(uint32_t threadCount, uint32_t criticalIterations) {
+  _LockType lock;
+  volatile uint32_t sharedValue = 0;
+  const uint32_t operationsPerThread = _BENCHMARK_LOCK_OPERATIONS / threadCount;
+  std::vector<std::thread> threads;
+  threads.reserve(threadCount);
+
+  auto start = std::chrono::high_resolution_clock::now();
+  for (uint32_t t = 0; t < threadCount; ++t) {
+    threads.emplace_back([&lock, &sharedValue, operationsPerThread, criticalIterations]() {
+      for (uint32_t i = 0; i < operationsPerThread; ++i) {
+        std::lock_guard<_LockType> guard(lock);
+        for (uint32_t j = 0; j <= criticalIterations; ++j)
+          sharedValue = sharedValue + j;
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  auto end = std::chrono::high_resolution_clock::now();
+  return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / (operationsPerThread * threadCount));
+}
+
+// lock/unlock from multiple threads during a fixed period, and measure unfairness: (max - min) / average acquisitions per thread, in percent
+template <typename _LockType>
+int64_t benchmarkLockFairness(uint32_t threadCount, uint32_t criticalIterations) {
+  _LockType lock;
+  volatile uint32_t sharedValue = 0;
+  std::atomic<bool> isStarted{ false };
+  std::atomic<bool> isRunning{ true };
+  std::vector<uint64_t> acquisitions(threadCount, 0);
+  std::vector<std::thread> threads;
+  threads.reserve(threadCount);
+
+  for (uint32_t t = 0; t < threadCount; ++t) {
+    threads.emplace_back([&lock, &sharedValue, &isStarted, &isRunning, &acquisitions, t, criticalIterations]() {
+      while (!isStarted.load(std::memory_order_acquire)) // same start for all threads
+        std::this_thread::yield();
+      uint64_t count = 0;
+      while (isRunning.load(std::memory_order_relaxed)) {
+        std::lock_guard<_LockType> guard(lock);
+        for (uint32_t j = 0; j <= criticalIterations; ++j)
+          sharedValue = sharedValue + j;
+        ++count;
+      }
+      acquisitions[t] = count;
+    });
+  }
+  isStarted.store(true, std::memory_order_release);
+  std::this_thread::sleep_for(std::chrono::milliseconds(_BENCHMARK_LOCK_FAIRNESS_PERIOD_MS));
+  isRunning.store(false, std::memory_order_relaxed);
+  for (auto& thread : threads)
+    thread.join();
+
+  uint64_t minCount = acquisitions[0], maxCount = acquisitions[0], total = 0;
+  for (auto count : acquisitions) {
+    if (count < minCount) minCount = count;
+    if (count > maxCount) maxCount = count;
+    total += count;
+  }
+  return (total > 0u) ? static_cast<int64_t>((maxCount - minCount) * 100u * threadCount / total) : 0;
+}
+
+// ---
+
+// pairs of threads notifying each other alternately with two semaphores, and measure average duration of a round trip (2 wake-ups) for each pair
+inline int64_t benchmarkSemaphorePingPong(uint32_t pairCount) {
+  const uint32_t roundTrips = _BENCHMARK_PING_PONG_ROUND_TRIPS / pairCount;
+  std::vector<std::unique_ptr<pandora::thread::Semaphore[]> > semaphores;
+  std::vector<std::thread> threads;
+  semaphores.reserve(pairCount);
+  threads.reserve(pairCount * 2u);
+
+  auto start = std::chrono::high_resolution_clock::now();
+  for (uint32_t p = 0; p < pairCount; ++p) {
+    semaphores.emplace_back(new pandora::thread::Semaphore[2]);
+    pandora::thread::Semaphore* pair = semaphores.back().get();
+    threads.emplace_back([pair, roundTrips]() { // ping
+      for (uint32_t i = 0; i < roundTrips; ++i) {
+        pair[0].notify();
+        pair[1].wait();
+      }
+    });
+    threads.emplace_back([pair, roundTrips]() { // pong
+      for (uint32_t i = 0; i < roundTrips; ++i) {
+        pair[0].wait();
+        pair[1].notify();
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  auto end = std::chrono::high_resolution_clock::now();
+  return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / roundTrips);
+}
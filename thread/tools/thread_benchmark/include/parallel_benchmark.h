@@ -0,0 +1,78 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+--------------------------------------------------------------------------------
+Description : measure scaling of data-parallel helpers for benchmark utility
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <thread/parallel_for.h>
+
+#define _BENCHMARK_PARALLEL_VALUES 4000000u
+#define _BENCHMARK_PARALLEL_REPEAT 10u
+
+// measure average duration (microseconds) of an operation executed with a parallel pool of 'threadCount' threads
+// (threadCount == 0: pool not started -> serial execution by current thread)
+template <typename _Operation>
+int64_t benchmarkParallelOperation(uint32_t threadCount, _Operation&& operation) {
+  pandora::thread::ParallelPool pool = (threadCount > 0)
+                                     ? pandora::thread::ParallelPool(threadCount, &pandora::thread::processParallelJob)
+                                     : pandora::thread::ParallelPool();
+  operation(pool); // warm-up
+
+  auto start = std::chrono::high_resolution_clock::now();
+  for (uint32_t i = 0; i < _BENCHMARK_PARALLEL_REPEAT; ++i)
+    operation(pool);
+  auto end = std::chrono::high_resolution_clock::now();
+  return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / _BENCHMARK_PARALLEL_REPEAT);
+}
+
+// parallelFor: fill buffer with computed values (uniform cost per index)
+inline int64_t benchmarkParallelFor(uint32_t threadCount, std::vector<float>& buffer) {
+  return benchmarkParallelOperation(threadCount, [&buffer](pandora::thread::ParallelPool& pool) {
+    pandora::thread::parallelFor(pool, 0, buffer.size(), [&buffer](size_t index) {
+      buffer[index] = std::sqrt(static_cast<float>(index)) * 0.5f;
+    }, 1024u);
+  });
+}
+
+// parallelFor: non-uniform cost per index (balancing between threads)
+inline int64_t benchmarkParallelForUnbalanced(uint32_t threadCount, std::vector<float>& buffer) {
+  const size_t length = buffer.size() / 64u;
+  return benchmarkParallelOperation(threadCount, [&buffer, length](pandora::thread::ParallelPool& pool) {
+    pandora::thread::parallelFor(pool, 0, length, [&buffer, length](size_t index) {
+      float value = 0.f;
+      const size_t iterations = (index * 128u) / length; // cost grows with index
+      for (size_t i = 0; i < iterations; ++i)
+        value += std::sqrt(static_cast<float>(index + i));
+      buffer[index] = value;
+    }, 16u);
+  });
+}
+
+// parallelReduce: sum of buffer values
+inline int64_t benchmarkParallelReduce(uint32_t threadCount, const std::vector<float>& buffer, double& outResult) {
+  return benchmarkParallelOperation(threadCount, [&buffer, &outResult](pandora::thread::ParallelPool& pool) {
+    outResult = pandora::thread::parallelReduce(pool, 0, buffer.size(), 0.0, [&buffer](size_t index) { return static_cast<double>(buffer[index]); },
+                                                [](double lhs, double rhs) { return lhs + rhs; }, 1024u);
+  });
+}
@@ -0,0 +1,212 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+--------------------------------------------------------------------------------
+Description : measure job throughput of thread pools for benchmark utility
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <memory>
+#include <thread/thread_pool.h>
+#include <thread/work_stealing_thread_pool.h>
+#include <thread/bounded_thread_pool.h>
+
+#define _BENCHMARK_POOL_JOBS 200000u
+#define _BENCHMARK_QUEUE_CAPACITY 4096u
+#define _BENCHMARK_LATENCY_ROUNDS 5000u
+
+// number of processed jobs (reset before each measure)
+inline std::atomic<uint32_t>& processedJobs() noexcept {
+  static std::atomic<uint32_t> counter{ 0 };
+  return counter;
+}
+
+// short job: active work loop (param = number of iterations), then count job as processed
+inline void benchmarkJob(uint32_t& iterations) noexcept {
+  volatile uint32_t sink = 0;
+  for (uint32_t i = 0; i < iterations; ++i)
+    sink = sink + i;
+  processedJobs().fetch_add(1u, std::memory_order_release);
+}
+
+// wait until all jobs have been processed
+inline void waitForProcessedJobs(uint32_t jobCount) noexcept {
+  while (processedJobs().load(std::memory_order_acquire) < jobCount)
+    std::this_thread::yield();
+}
+
+// types of pools to compare
+using MutexQueuePool = pandora::thread::ThreadPool<uint32_t, pandora::thread::ThreadRunnerMode::single,
+                                                   pandora::thread::TaskRunnerType::functionPointer>;
+using WorkStealingPool = pandora::thread::WorkStealingThreadPool<uint32_t, pandora::thread::ThreadRunnerMode::single,
+                                                                 pandora::thread::TaskRunnerType::functionPointer>;
+using InstrumentedMutexQueuePool = pandora::thread::ThreadPool<uint32_t, pandora::thread::ThreadRunnerMode::single,
+                                                               pandora::thread::TaskRunnerType::functionPointer,
+                                                               pandora::thread::PoolMetrics>;
+using InstrumentedWorkStealingPool = pandora::thread::WorkStealingThreadPool<uint32_t, pandora::thread::ThreadRunnerMode::single,
+                                                                             pandora::thread::TaskRunnerType::functionPointer,
+                                                                             pandora::thread::PoolMetrics>;
+using PerJobPool = pandora::thread::ThreadPool<uint32_t, pandora::thread::ThreadRunnerMode::perJob,
+                                               pandora::thread::TaskRunnerType::functionPointer>;
+using PerJobLambdaPool = pandora::thread::ThreadPool<uint32_t, pandora::thread::ThreadRunnerMode::perJob,
+                                                     pandora::thread::TaskRunnerType::lambda>;
+template <pandora::thread::ThreadRunnerMode _Mode, pandora::thread::TaskRunnerType _FunctionType>
+using InstrumentedPool = pandora::thread::ThreadPool<uint32_t, _Mode, _FunctionType, pandora::thread::PoolMetrics>;
+using BoundedQueuePool = pandora::thread::BoundedThreadPool<uint32_t, pandora::thread::ThreadRunnerMode::single,
+                                                            pandora::thread::TaskRunnerType::functionPointer,
+                                                            pandora::thread::FullQueueHandling::wait>;
+
+// create started pool (specialized for pools with specific constructor params)
+template <typename _PoolType>
+struct BenchmarkPoolFactory {
+  static inline std::unique_ptr<_PoolType> create(uint32_t threadCount) {
+    return std::unique_ptr<_PoolType>(new _PoolType(threadCount, &benchmarkJob));
+  }
+};
+template <>
+struct BenchmarkPoolFactory<BoundedQueuePool> {
+  static inline std::unique_ptr<BoundedQueuePool> create(uint32_t threadCount) {
+    return std::unique_ptr<BoundedQueuePool>(new BoundedQueuePool(threadCount, _BENCHMARK_QUEUE_CAPACITY, &benchmarkJob));
+  }
+};
+
+// insert a job in a pool (specialized for pools with a custom runner per job)
+template <typename _PoolType>
+struct BenchmarkJobInsertion {
+  static inline void insert(_PoolType& pool, uint32_t jobIterations) { pool.addJob(jobIterations); }
+};
+template <pandora::thread::TaskRunnerType _FunctionType, typename _Metrics>
+struct BenchmarkJobInsertion<pandora::thread::ThreadPool<uint32_t, pandora::thread::ThreadRunnerMode::perJob, _FunctionType, _Metrics> > {
+  template <typename _PoolType>
+  static inline void insert(_PoolType& pool, uint32_t jobIterations) {
+    pool.addJob(jobIterations, [](uint32_t& iterations) { benchmarkJob(iterations); });
+  }
+};
+
+// copy metrics of a pool (if the pool type supports instrumentation)
+template <typename _PoolType>
+inline auto readPoolMetrics(const _PoolType& pool, pandora::thread::PoolMetricsSnapshot& outMetrics, int) -> decltype(pool.metrics(), void()) {
+  outMetrics = pool.metrics().snapshot();
+}
+template <typename _PoolType>
+inline void readPoolMetrics(const _PoolType&, pandora::thread::PoolMetricsSnapshot&, long) {}
+
+// ---
+
+// list of thread counts to measure (1, 2, 4, ... up to hardware concurrency)
+inline std::vector<uint32_t> benchmarkThreadCounts() {
+  uint32_t maxThreads = std::thread::hardware_concurrency();
+  if (maxThreads < 2u)
+    maxThreads = 2u;
+
+  std::vector<uint32_t> threadCounts;
+  for (uint32_t count = 1u; count < maxThreads; count <<= 1)
+    threadCounts.emplace_back(count);
+  threadCounts.emplace_back(maxThreads);
+  return threadCounts;
+}
+
+// insert jobs in a pool from multiple producers, and measure average duration per job
+// (optional: copy pool metrics, if instrumented)
+template <typename _PoolType>
+int64_t benchmarkPoolThroughput(uint32_t threadCount, uint32_t producerCount, uint32_t jobIterations,
+                                pandora::thread::PoolMetricsSnapshot* outMetrics = nullptr) {
+  std::unique_ptr<_PoolType> poolHolder = BenchmarkPoolFactory<_PoolType>::create(threadCount);
+  _PoolType& pool = *poolHolder;
+  processedJobs() = 0;
+  const uint32_t jobsPerProducer = _BENCHMARK_POOL_JOBS / producerCount;
+  const uint32_t jobCount = jobsPerProducer * producerCount;
+
+  auto start = std::chrono::high_resolution_clock::now();
+  std::vector<std::thread> producers;
+  producers.reserve(producerCount);
+  for (uint32_t p = 0; p < producerCount; ++p) {
+    producers.emplace_back([&pool, jobsPerProducer, jobIterations]() {
+      for (uint32_t i = 0; i < jobsPerProducer; ++i)
+        BenchmarkJobInsertion<_PoolType>::insert(pool, jobIterations);
+    });
+  }
+  for (auto& producer : producers)
+    producer.join();
+  waitForProcessedJobs(jobCount);
+  auto end = std::chrono::high_resolution_clock::now();
+
+  if (outMetrics != nullptr)
+    readPoolMetrics(pool, *outMetrics, 0);
+  return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / jobCount);
+}
+
+// insert jobs in a pool by batches ('batchSize' == 0: one call to addJob per job), and measure average duration per job
+inline int64_t benchmarkBatchSubmission(uint32_t threadCount, uint32_t batchSize, uint32_t jobIterations) {
+  MutexQueuePool pool(threadCount, &benchmarkJob);
+  processedJobs() = 0;
+  const uint32_t jobCount = (batchSize > 0) ? (_BENCHMARK_POOL_JOBS / batchSize) * batchSize : _BENCHMARK_POOL_JOBS;
+  std::vector<uint32_t> batch;
+  batch.reserve(batchSize);
+
+  auto start = std::chrono::high_resolution_clock::now();
+  if (batchSize == 0) {
+    for (uint32_t i = 0; i < jobCount; ++i)
+      pool.addJob(jobIterations);
+  }
+  else {
+    for (uint32_t i = 0; i < jobCount; i += batchSize) {
+      batch.assign(batchSize, jobIterations);
+      pool.addJobs(std::move(batch));
+    }
+  }
+  waitForProcessedJobs(jobCount);
+  auto end = std::chrono::high_resolution_clock::now();
+
+  return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / jobCount);
+}
+
+// -- latency --
+
+struct PoolLatencyResult final {
+  int64_t median = 0;     // enqueue-to-start latency (ns)
+  int64_t percentile99 = 0;
+  int64_t percentile999 = 0;
+};
+
+// insert bursts of jobs (one per thread) in an instrumented pool, wait until they're processed,
+// and measure the latency between insertion and job start (thread wake-up + dispatch)
+template <typename _PoolType>
+PoolLatencyResult benchmarkPoolLatency(uint32_t threadCount, uint32_t jobIterations) {
+  std::unique_ptr<_PoolType> poolHolder = BenchmarkPoolFactory<_PoolType>::create(threadCount);
+  _PoolType& pool = *poolHolder;
+  processedJobs() = 0;
+
+  for (uint32_t round = 1u; round <= _BENCHMARK_LATENCY_ROUNDS; ++round) {
+    for (uint32_t i = 0; i < threadCount; ++i)
+      BenchmarkJobInsertion<_PoolType>::insert(pool, jobIterations);
+    waitForProcessedJobs(round * threadCount);
+  }
+
+  pandora::thread::PoolMetricsSnapshot metrics = pool.metrics().snapshot();
+  PoolLatencyResult result;
+  result.median = static_cast<int64_t>(metrics.queueLatency.percentile(50.0));
+  result.percentile99 = static_cast<int64_t>(metrics.queueLatency.percentile(99.0));
+  result.percentile999 = static_cast<int64_t>(metrics.queueLatency.percentile(99.9));
+  return result;
+}
@@ -0,0 +1,146 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+--------------------------------------------------------------------------------
+--------------------------------------------------------------------------------
+Description : machine-readable export of benchmark results (CSV / JSON)
+*******************************************************************************/
+#pragma once
+
+#ifdef _MSC_VER
+# define _CRT_SECURE_NO_WARNINGS
+#endif
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <thread>
+
+#ifndef __P_THREAD_BENCHMARK_VERSION_MAJOR
+# define __P_THREAD_BENCHMARK_VERSION_MAJOR 0
+# define __P_THREAD_BENCHMARK_VERSION_MINOR 0
+# define __P_THREAD_BENCHMARK_VERSION_PATCH 0
+#endif
+
+// one measured value (table cell)
+struct BenchmarkRecord final {
+  std::string section; // table title
+  std::string row;     // measured type/operation
+  uint32_t column;     // thread count (or other 'columnUnit')
+  std::string columnUnit;
+  int64_t value;
+  std::string unit;
+};
+
+// collection of all measured values (filled by display helpers), to export them in CSV/JSON files
+class BenchmarkReport final {
+public:
+  static inline BenchmarkReport& instance() noexcept {
+    static BenchmarkReport report;
+    return report;
+  }
+
+  // -- record results --
+
+  inline void setSection(const std::string& section) { this->_section = section; }
+  inline void setColumns(const uint32_t* columns, size_t length, const char* columnUnit) {
+    this->_columns.assign(columns, columns + length);
+    this->_columnUnit = columnUnit;
+  }
+  inline void addRow(const std::string& label, const int64_t* results, size_t length, const char* unit) {
+    std::string unitName(unit);
+    while (!unitName.empty() && unitName.back() == ' ') // alignment spaces
+      unitName.pop_back();
+    for (size_t i = 0; i < length && i < this->_columns.size(); ++i)
+      this->_records.push_back(BenchmarkRecord{ this->_section, label, this->_columns[i], this->_columnUnit, results[i], unitName });
+  }
+  inline const std::vector<BenchmarkRecord>& records() const noexcept { return this->_records; }
+
+  // -- export --
+
+  // write CSV file: one line per value (section,row,column,column_unit,value,unit)
+  bool writeCsv(const char* path) const {
+    FILE* file = fopen(path, "w");
+    if (file == nullptr)
+      return false;
+    fprintf(file, "section,row,column,column_unit,value,unit\n");
+    for (const auto& record : this->_records) {
+      fprintf(file, "%s,%s,%u,%s,%lld,%s\n", _toCsvField(record.section).c_str(), _toCsvField(record.row).c_str(), record.column,
+              _toCsvField(record.columnUnit).c_str(), static_cast<long long>(record.value), _toCsvField(record.unit).c_str());
+    }
+    return (fclose(file) == 0);
+  }
+
+  // write JSON file: library version + hardware concurrency + array of values
+  bool writeJson(const char* path) const {
+    FILE* file = fopen(path, "w");
+    if (file == nullptr)
+      return false;
+    fprintf(file, "{\n  \"version\": \"%d.%d.%d\",\n  \"hardwareConcurrency\": %u,\n  \"results\": [",
+            __P_THREAD_BENCHMARK_VERSION_MAJOR, __P_THREAD_BENCHMARK_VERSION_MINOR, __P_THREAD_BENCHMARK_VERSION_PATCH,
+            std::thread::hardware_concurrency());
+    for (size_t i = 0; i < this->_records.size(); ++i) {
+      const BenchmarkRecord& record = this->_records[i];
+      fprintf(file, "%s\n    { \"section\": \"%s\", \"row\": \"%s\", \"column\": %u, \"columnUnit\": \"%s\", \"value\": %lld, \"unit\": \"%s\" }",
+              (i > 0) ? "," : "", _toJsonString(record.section).c_str(), _toJsonString(record.row).c_str(), record.column,
+              _toJsonString(record.columnUnit).c_str(), static_cast<long long>(record.value), _toJsonString(record.unit).c_str());
+    }
+    fprintf(file, "\n  ]\n}\n");
+    return (fclose(file) == 0);
+  }
+
+private:
+  BenchmarkReport() = default;
+
+  // quote field if it contains separators/quotes
+  static std::string _toCsvField(const std::string& value) {
+    if (value.find_first_of(",\"\n") == std::string::npos)
+      return value;
+    std::string quoted = "\"";
+    for (char c : value) {
+      if (c == '"')
+        quoted += '"';
+      quoted += c;
+    }
+    return quoted + "\"";
+  }
+  // escape special characters
+  static std::string _toJsonString(const std::string& value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char c : value) {
+      switch (c) {
+        case '"':  escaped += "\\\""; break;
+        case '\\': escaped += "\\\\"; break;
+        case '\n': escaped += "\\n"; break;
+        case '\t': escaped += "\\t"; break;
+        default:
+          if (static_cast<unsigned char>(c) >= 0x20u)
+            escaped += c;
+          break;
+      }
+    }
+    return escaped;
+  }
+
+private:
+  std::string _section;
+  std::vector<uint32_t> _columns;
+  std::string _columnUnit;
+  std::vector<BenchmarkRecord> _records;
+};
@@ -0,0 +1,74 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+--------------------------------------------------------------------------------
+Description : measure timer scheduling/cancellation/expiration for benchmark utility
+*******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+#include <vector>
+#include <thread/timer_wheel.h>
+
+// pool replacement: count received jobs (measure timer wheel only)
+struct BenchmarkTimerPool final {
+  size_t jobCount = 0;
+  template <typename _Iterator>
+  inline bool addJobs(_Iterator first, _Iterator last) {
+    jobCount += static_cast<size_t>(std::distance(first, last));
+    return true;
+  }
+};
+using BenchmarkTimerWheel = pandora::thread::TimerWheel<uint32_t, BenchmarkTimerPool>;
+
+struct TimerBenchmarkResult final {
+  int64_t insertion = 0;    // average duration per timer (nanoseconds)
+  int64_t cancellation = 0;
+  int64_t expiration = 0;
+};
+
+// measure insertion of 'timerCount' timers (delays spread over 100 seconds), cancellation of half of them, expiration of other half
+inline TimerBenchmarkResult benchmarkTimerWheel(uint32_t timerCount) {
+  BenchmarkTimerPool pool;
+  BenchmarkTimerWheel timers(pool, std::chrono::milliseconds(1), pandora::thread::TimerWheelMode::manual);
+  std::vector<pandora::thread::TimerTicket> tickets;
+  tickets.reserve(timerCount);
+  timers.reserve(timerCount);
+  TimerBenchmarkResult result;
+  auto baseTime = std::chrono::steady_clock::now();
+
+  auto start = std::chrono::high_resolution_clock::now();
+  for (uint32_t i = 0; i < timerCount; ++i)
+    tickets.emplace_back(timers.scheduleAt(baseTime + std::chrono::milliseconds(1u + (i * 7919u) % 100000u), i));
+  auto end = std::chrono::high_resolution_clock::now();
+  result.insertion = static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / timerCount);
+
+  start = std::chrono::high_resolution_clock::now();
+  for (uint32_t i = 0; i < timerCount; i += 2u)
+    timers.cancel(tickets[i]);
+  end = std::chrono::high_resolution_clock::now();
+  result.cancellation = static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / ((timerCount + 1u) / 2u));
+
+  const uint32_t expiredCount = timerCount / 2u;
+  start = std::chrono::high_resolution_clock::now();
+  timers.advance(baseTime + std::chrono::milliseconds(100002));
+  end = std::chrono::high_resolution_clock::now();
+  result.expiration = (expiredCount > 0u) ? static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / expiredCount) : 0;
+  return result;
+}
@@ -0,0 +1,314 @@
+/*******************************************************************************
+MIT License
+Copyright (c) 2021 Romain Vinders
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+--------------------------------------------------------------------------------
+Benchmark utility to compare the efficiency of thread pools and synchronization primitives under contention.
+*******************************************************************************/
+#ifdef _MSC_VER
+# define _CRT_SECURE_NO_WARNINGS
+#endif
+#if defined(__ANDROID__)
+# include <system/api/android_app.h>
+#endif
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "pool_benchmark.h"
+#include "parallel_benchmark.h"
+#include "timer_benchmark.h"
+#include "lock_benchmark.h"
+#include "display.h"
+#include "report.h"
+
+#define _TINY_JOB_ITERATIONS  0u
+#define _SHORT_JOB_ITERATIONS 200u
+#define _LONG_JOB_ITERATIONS  5000u
+
+// -- thread pool benchmarks --
+
+// benchmark - job queue contention (average duration per job, for each thread count)
+void measurePrintPoolBenchmarks(const char* jobLabel, uint32_t producerCount, uint32_t jobIterations) {
+  std::vector<uint32_t> threadCounts = benchmarkThreadCounts();
+  std::vector<int64_t> mutexQueueResults, workStealingResults, boundedQueueResults;
+  for (auto threadCount : threadCounts) {
+    mutexQueueResults.emplace_back(benchmarkPoolThroughput<MutexQueuePool>(threadCount, producerCount, jobIterations));
+    workStealingResults.emplace_back(benchmarkPoolThroughput<WorkStealingPool>(threadCount, producerCount, jobIterations));
+    boundedQueueResults.emplace_back(benchmarkPoolThroughput<BoundedQueuePool>(threadCount, producerCount, jobIterations));
+  }
+
+  printTableTitle(std::string(jobLabel) + " - " + std::to_string(producerCount) + " producer(s)");
+  printResultHeader("Pool type", threadCounts.data(), threadCounts.size());
+  printResultLine("ThreadPool", mutexQueueResults.data(), mutexQueueResults.size());
+  printResultLine("WorkStealingThreadPool", workStealingResults.data(), workStealingResults.size());
+  printResultLine("BoundedThreadPool", boundedQueueResults.data(), boundedQueueResults.size());
+  printf("\n");
+}
+
+// benchmark - per-item insertion vs batched insertion (average duration per job, for each thread count)
+void measurePrintBatchBenchmarks(uint32_t jobIterations) {
+  const uint32_t batchSizes[] = { 0u, 1u, 16u, 256u, 4096u };
+  std::vector<uint32_t> threadCounts = benchmarkThreadCounts();
+
+  printTableTitle("Batch insertion - tiny jobs");
+  printResultHeader("Insertion", threadCounts.data(), threadCounts.size());
+  for (auto batchSize : batchSizes) {
+    std::vector<int64_t> results;
+    for (auto threadCount : threadCounts)
+      results.emplace_back(benchmarkBatchSubmission(threadCount, batchSize, jobIterations));
+    std::string label = (batchSize == 0) ? std::string("addJob (per item)") : std::string("addJobs x") + std::to_string(batchSize);
+    printResultLine(label, results.data(), results.size());
+  }
+  printf("\n");
+}
+
+// benchmark - cost of pool instrumentation (average duration per job) + metrics of last instrumented run
+void measurePrintMetricsBenchmarks(uint32_t jobIterations) {
+  std::vector<uint32_t> threadCounts = benchmarkThreadCounts();
+  std::vector<int64_t> mutexQueueResults, instrumentedResults, workStealingResults, instrumentedStealingResults;
+  pandora::thread::PoolMetricsSnapshot metrics;
+  for (auto threadCount : threadCounts) {
+    mutexQueueResults.emplace_back(benchmarkPoolThroughput<MutexQueuePool>(threadCount, 1u, jobIterations));
+    instrumentedResults.emplace_back(benchmarkPoolThroughput<InstrumentedMutexQueuePool>(threadCount, 1u, jobIterations, &metrics));
+    workStealingResults.emplace_back(benchmarkPoolThroughput<WorkStealingPool>(threadCount, 1u, jobIterations));
+    instrumentedStealingResults.emplace_back(benchmarkPoolThroughput<InstrumentedWorkStealingPool>(threadCount, 1u, jobIterations));
+  }
+
+  printTableTitle("Pool instrumentation - short jobs - 1 producer");
+  printResultHeader("Pool type", threadCounts.data(), threadCounts.size());
+  printResultLine("ThreadPool", mutexQueueResults.data(), mutexQueueResults.size());
+  printResultLine("ThreadPool (metrics)", instrumentedResults.data(), instrumentedResults.size());
+  printResultLine("WorkStealingThreadPool", workStealingResults.data(), workStealingResults.size());
+  printResultLine("WorkStealing (metrics)", instrumentedStealingResults.data(), instrumentedStealingResults.size());
+  printf("ThreadPool (metrics, %u thr.): queue latency p50/p99/max = %llu/%llu/%llu ns, run time p50/p99 = %llu/%llu ns,\n"
+         "                               queue high-water = %u jobs, utilization = %.1f %%\n\n",
+         threadCounts.back(),
+         static_cast<unsigned long long>(metrics.queueLatency.percentile(50.0)), static_cast<unsigned long long>(metrics.queueLatency.percentile(99.0)),
+         static_cast<unsigned long long>(metrics.queueLatency.maximum()),
+         static_cast<unsigned long long>(metrics.runTime.percentile(50.0)), static_cast<unsigned long long>(metrics.runTime.percentile(99.0)),
+         static_cast<uint32_t>(metrics.queueDepthHighWater), metrics.utilization() * 100.0);
+}
+
+// benchmark - ThreadPool runner modes: throughput (average duration per job) + latency between insertion and job start
+void measurePrintPoolModeBenchmarks(uint32_t jobIterations) {
+  using pandora::thread::ThreadRunnerMode;
+  using pandora::thread::TaskRunnerType;
+  std::vector<uint32_t> threadCounts = benchmarkThreadCounts();
+  std::vector<int64_t> singleResults, perJobResults, lambdaResults;
+  std::vector<PoolLatencyResult> singleLatency, perJobLatency, lambdaLatency;
+  for (auto threadCount : threadCounts) {
+    singleResults.emplace_back(benchmarkPoolThroughput<MutexQueuePool>(threadCount, 1u, jobIterations));
+    perJobResults.emplace_back(benchmarkPoolThroughput<PerJobPool>(threadCount, 1u, jobIterations));
+    lambdaResults.emplace_back(benchmarkPoolThroughput<PerJobLambdaPool>(threadCount, 1u, jobIterations));
+    singleLatency.emplace_back(benchmarkPoolLatency<InstrumentedPool<ThreadRunnerMode::single, TaskRunnerType::functionPointer> >(threadCount, jobIterations));
+    perJobLatency.emplace_back(benchmarkPoolLatency<InstrumentedPool<ThreadRunnerMode::perJob, TaskRunnerType::functionPointer> >(threadCount, jobIterations));
+    lambdaLatency.emplace_back(benchmarkPoolLatency<InstrumentedPool<ThreadRunnerMode::perJob, TaskRunnerType::lambda> >(threadCount, jobIterations));
+  }
+
+  printTableTitle("ThreadPool runner modes - short jobs - 1 producer");
+  printResultHeader("Runner mode", threadCounts.data(), threadCounts.size());
+  printResultLine("single (function)", singleResults.data(), singleResults.size());
+  printResultLine("perJob (function)", perJobResults.data(), perJobResults.size());
+  printResultLine("perJob (lambda)", lambdaResults.data(), lambdaResults.size());
+  printf("\n");
+
+  const std::pair<const char*, const std::vector<PoolLatencyResult>*> modes[] = {
+    { "single (function)", &singleLatency }, { "perJob (function)", &perJobLatency }, { "perJob (lambda)", &lambdaLatency }
+  };
+  printTableTitle("ThreadPool runner modes - insertion-to-start latency (bursts of 1 job per thread)");
+  printResultHeader("Runner mode", threadCounts.data(), threadCounts.size());
+  for (const auto& mode : modes) {
+    std::vector<int64_t> median, percentile99, percentile999;
+    for (const auto& latency : *mode.second) {
+      median.emplace_back(latency.median);
+      percentile99.emplace_back(latency.percentile99);
+      percentile999.emplace_back(latency.percentile999);
+    }
+    printResultLine(std::string(mode.first) + " p50", median.data(), median.size());
+    printResultLine(std::string(mode.first) + " p99", percentile99.data(), percentile99.size());
+    printResultLine(std::string(mode.first) + " p99.9", percentile999.data(), percentile999.size());
+  }
+  printf("\n");
+}
+
+// -- data-parallel helpers --
+
+// benchmark - scaling of parallel helpers (average duration per call, for each thread count)
+void measurePrintParallelBenchmarks() {
+  std::vector<uint32_t> threadCounts = benchmarkThreadCounts();
+  threadCounts.insert(threadCounts.begin(), 0u); // serial reference
+  std::vector<float> buffer(_BENCHMARK_PARALLEL_VALUES, 0.f);
+  std::vector<int64_t> forResults, unbalancedResults, reduceResults;
+  double sum = 0.0;
+  for (auto threadCount : threadCounts) {
+    forResults.emplace_back(benchmarkParallelFor(threadCount, buffer));
+    unbalancedResults.emplace_back(benchmarkParallelForUnbalanced(threadCount, buffer));
+    reduceResults.emplace_back(benchmarkParallelReduce(threadCount, buffer, sum));
+  }
+
+  printTableTitle("Data-parallel helpers - " + std::to_string(_BENCHMARK_PARALLEL_VALUES) + " values (0 thr.: serial, by calling thread)");
+  printResultHeader("Operation", threadCounts.data(), threadCounts.size());
+  printResultLine("parallelFor", forResults.data(), forResults.size(), "us");
+  printResultLine("parallelFor (unbalanced)", unbalancedResults.data(), unbalancedResults.size(), "us");
+  printResultLine("parallelReduce", reduceResults.data(), reduceResults.size(), "us");
+  printf("(reduce result: %f)\n\n", sum);
+}
+
+// -- timers --
+
+// benchmark - timer wheel operations (average duration per timer, for each number of pending timers)
+void measurePrintTimerBenchmarks() {
+  const uint32_t timerCounts[] = { 1000u, 100000u, 1000000u };
+  std::vector<uint32_t> columns;
+  std::vector<int64_t> insertionResults, cancellationResults, expirationResults;
+  for (auto timerCount : timerCounts) {
+    TimerBenchmarkResult result = benchmarkTimerWheel(timerCount);
+    columns.emplace_back(timerCount / 1000u);
+    insertionResults.emplace_back(result.insertion);
+    cancellationResults.emplace_back(result.cancellation);
+    expirationResults.emplace_back(result.expiration);
+  }
+
+  printTableTitle("Timer wheel - pending timers (1 ms ticks, delays up to 100 s)");
+  printResultHeader("Operation", columns.data(), columns.size(), "k");
+  printResultLine("scheduleAt", insertionResults.data(), insertionResults.size());
+  printResultLine("cancel", cancellationResults.data(), cancellationResults.size());
+  printResultLine("expiration (advance)", expirationResults.data(), expirationResults.size());
+  printf("\n");
+}
+
+// -- locks --
+
+// benchmark - lock contention (average duration per critical section, for each thread count)
+void measurePrintLockBenchmarks(const char* sectionLabel, uint32_t criticalIterations) {
+  std::vector<uint32_t> threadCounts = lockBenchmarkThreadCounts();
+  std::vector<int64_t> mutexResults, spinLockResults, adaptiveResults, recursiveResults, orderedResults, ticketResults;
+  for (auto threadCount : threadCounts) {
+    mutexResults.emplace_back(benchmarkLockContention<std::mutex>(threadCount, criticalIterations));
+    spinLockResults.emplace_back(benchmarkLockContention<pandora::thread::SpinLock>(threadCount, criticalIterations));
+    adaptiveResults.emplace_back(benchmarkLockContention<pandora::thread::AdaptiveSpinLock>(threadCount, criticalIterations));
+    recursiveResults.emplace_back(benchmarkLockContention<pandora::thread::RecursiveSpinLock>(threadCount, criticalIterations));
+    orderedResults.emplace_back(benchmarkLockContention<pandora::thread::OrderedLock>(threadCount, criticalIterations));
+    ticketResults.emplace_back(benchmarkLockContention<pandora::thread::TicketLock>(threadCount, criticalIterations));
+  }
+
+  printTableTitle(std::string(sectionLabel) + " critical sections (" + std::to_string(criticalIterations) + " iterations)");
+  printResultHeader("Lock type", threadCounts.data(), threadCounts.size());
+  printResultLine("std::mutex", mutexResults.data(), mutexResults.size());
+  printResultLine("SpinLock", spinLockResults.data(), spinLockResults.size());
+  printResultLine("AdaptiveSpinLock", adaptiveResults.data(), adaptiveResults.size());
+  printResultLine("RecursiveSpinLock", recursiveResults.data(), recursiveResults.size());
+  printResultLine("OrderedLock", orderedResults.data(), orderedResults.size());
+  printResultLine("TicketLock", ticketResults.data(), ticketResults.size());
+  printf("\n");
+}
+
+// benchmark - FIFO locks: fairness (acquisition spread between threads)
+void measurePrintFairLockBenchmarks(uint32_t criticalIterations) {
+  std::vector<uint32_t> threadCounts = lockBenchmarkThreadCounts();
+  std::vector<int64_t> orderedFairness, ticketFairness, mutexFairness;
+  for (auto threadCount : threadCounts) {
+    mutexFairness.emplace_back(benchmarkLockFairness<std::mutex>(threadCount, criticalIterations));
+    orderedFairness.emplace_back(benchmarkLockFairness<pandora::thread::OrderedLock>(threadCount, criticalIterations));
+    ticketFairness.emplace_back(benchmarkLockFairness<pandora::thread::TicketLock>(threadCount, criticalIterations));
+  }
+
+  printTableTitle("FIFO locks - unfairness ((max-min)/avg acquisitions per thread)");
+  printResultHeader("Lock type", threadCounts.data(), threadCounts.size());
+  printResultLine("std::mutex", mutexFairness.data(), mutexFairness.size(), "% ");
+  printResultLine("OrderedLock", orderedFairness.data(), orderedFairness.size(), "% ");
+  printResultLine("TicketLock", ticketFairness.data(), ticketFairness.size(), "% ");
+  printf("\n");
+}
+
+// benchmark - semaphore wake-up latency (average duration per round trip, for each number of thread pairs)
+void measurePrintSemaphoreBenchmarks() {
+  std::vector<uint32_t> pairCounts{ 1u, 2u, 4u, 8u };
+  std::vector<int64_t> results;
+  for (auto pairCount : pairCounts)
+    results.emplace_back(benchmarkSemaphorePingPong(pairCount));
+
+  printTableTitle("Semaphore ping-pong (2 threads per pair)");
+  printResultHeader("Primitive", pairCounts.data(), pairCounts.size(), "pair");
+  printResultLine("Semaphore (round trip)", results.data(), results.size());
+  printf("\n");
+}
+
+// ---
+
+// Main execution of benchmark utility
+void runBenchmarks() {
+  printTitle("Benchmark utility: thread pools (average duration per job)");
+  for (uint32_t producerCount = 1u; producerCount <= 4u; producerCount *= 4u) {
+    measurePrintPoolBenchmarks("Tiny jobs", producerCount, _TINY_JOB_ITERATIONS);
+    measurePrintPoolBenchmarks("Short jobs", producerCount, _SHORT_JOB_ITERATIONS);
+    measurePrintPoolBenchmarks("Long jobs", producerCount, _LONG_JOB_ITERATIONS);
+  }
+  measurePrintBatchBenchmarks(_TINY_JOB_ITERATIONS);
+  measurePrintMetricsBenchmarks(_SHORT_JOB_ITERATIONS);
+  measurePrintPoolModeBenchmarks(_SHORT_JOB_ITERATIONS);
+
+  printTitle("Benchmark utility: data-parallel helpers (average duration per call)");
+  measurePrintParallelBenchmarks();
+
+  printTitle("Benchmark utility: timers (average duration per timer)");
+  measurePrintTimerBenchmarks();
+
+  printTitle("Benchmark utility: locks (average duration per critical section)");
+  measurePrintLockBenchmarks("Empty", _TINY_JOB_ITERATIONS);
+  measurePrintLockBenchmarks("Short", _SHORT_JOB_ITERATIONS / 4u);
+  measurePrintLockBenchmarks("Long", _SHORT_JOB_ITERATIONS * 4u);
+  measurePrintFairLockBenchmarks(_SHORT_JOB_ITERATIONS / 4u);
+
+  printTitle("Benchmark utility: semaphores (average duration per round trip)");
+  measurePrintSemaphoreBenchmarks();
+}
+
+// ---
+
+#if defined(__ANDROID__)
+  void android_main(struct android_app* state) {
+    pandora::system::AndroidApp::instance().init(state);
+    runBenchmarks();
+  }
+#else
+  int main(int argc, char** argv) {
+    const char* csvPath = nullptr;
+    const char* jsonPath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+      if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc)
+        csvPath = argv[++i];
+      else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+        jsonPath = argv[++i];
+      else {
+        printf("Usage: %s [--csv <output_path>] [--json <output_path>]\n", argv[0]);
+        return (strcmp(argv[i], "--help") == 0) ? 0 : 1;
+      }
+    }
+
+    runBenchmarks();
+    if (csvPath != nullptr && !BenchmarkReport::instance().writeCsv(csvPath)) {
+      fprintf(stderr, "Failed to write CSV report: %s\n", csvPath);
+      return 1;
+    }
+    if (jsonPath != nullptr && !BenchmarkReport::instance().writeJson(jsonPath)) {
+      fprintf(stderr, "Failed to write JSON report: %s\n", jsonPath);
+      return 1;
+    }
+    return 0;
+  }
+#endif